@@ -1568,6 +1568,9 @@ static std::pair<std::string, std::string> GenerateForwardFunctionContents(
   // [Generation] Get Outs Map
   std::string outs_contents_str = "";
   std::string inplace_mapping_str = "";
+  // The data saved for backward from the inplace inputs is kept before
+  // TraceOp writes them.
+  std::string prepare_inplace_write_str = "";
   for (const proto::OpProto::Var& output : out_vars) {
     const std::string& output_name = output.name();
     std::string outnum = "1";
@@ -1629,6 +1632,12 @@ static std::pair<std::string, std::string> GenerateForwardFunctionContents(
       const char* INPLACE_MAPPING_TEMPLATE = R"({"%s", "%s"},)";
       inplace_mapping_str += paddle::string::Sprintf(
           INPLACE_MAPPING_TEMPLATE, inplace_input_name, output_name);
+
+      const char* PREPARE_INPLACE_WRITE_TEMPLATE =
+          "  egr::EagerUtils::PrepareInplaceWrite(%s);\n";
+      prepare_inplace_write_str +=
+          paddle::string::Sprintf(PREPARE_INPLACE_WRITE_TEMPLATE,
+                                  LegalizeVarName(inplace_input_name));
     } else {
       if (output.duplicable()) {
         outnum = output_name + "Num";
@@ -1750,6 +1759,26 @@ static std::pair<std::string, std::string> GenerateForwardFunctionContents(
 
   VLOG(6) << "Generated Outs Map";
 
+  // [Generation] Backward Inplace
+  // The grads of a node are consumed by it, so a grad op may write its
+  // output into the buffer of an input grad which nothing else holds.
+  // Skipped if the node runs more than one op, which may read the grad
+  // again, or builds a higher order graph.
+  const auto* op_base_info =
+      paddle::framework::OpInfoMap::Instance().GetNullable(op_base_type);
+  if (allow_backward_inplace && grad_slots_str.size() > 0 && op_base_info &&
+      op_base_info->infer_inplace_) {
+    grad_slots_str.pop_back();  // Remove trailing ","
+    const char* BWD_INPLACE_TEMPLATE =
+        "  if (!create_graph) {\n"
+        "    egr::EagerUtils::PerformBackwardInplace(\"%s\", grads, "
+        "hooked_grads, { %s }, %s, &%s);\n"
+        "  }\n";
+    generated_grad_function_body +=
+        paddle::string::Sprintf(BWD_INPLACE_TEMPLATE, op_base_type,
+                                grad_slots_str, ins_name, outs_name);
+  }
+
   // [Generation] Apply View Strategy (Tensor)
   if (inplace_map.empty() && view_op_map.count(op_type)) {
     const char* HANDLE_VIEW_BETWEEN_INPUT_AND_OUTPUT =
@@ -1793,6 +1822,7 @@ static std::pair<std::string, std::string> GenerateForwardFunctionContents(
   std::string trace_op_str = paddle::string::Sprintf(
       FWD_TRACE_OP_TEMPLATE, op_type, inplace_mapping_str);
 
+  trace_op_body_str += prepare_inplace_write_str;
   trace_op_body_str += trace_op_str;
   trace_op_body_str += "\n";
 
@@ -2021,7 +2051,8 @@ static std::string GenerateSingleOpBase(
         std::vector<std::shared_ptr<paddle::imperative::VariableWrapper>>>&
         grad_outs,
     const paddle::framework::AttributeMap& grad_attrs,
-    bool is_op_base_per_duplicable_input, size_t* outs_size) {
+    bool is_op_base_per_duplicable_input, bool allow_backward_inplace,
+    size_t* outs_size) {
   std::string generated_grad_function_body = "";
 
   const std::string& ins_name = "ins" + std::to_string(*outs_size);
@@ -2038,6 +2069,7 @@ static std::string GenerateSingleOpBase(
     if (in.duplicable()) duplicable_input_name_set.insert(in.name());
   }
   std::string ins_contents_str = "";
+  std::string grad_slots_str = "";
   for (auto iter : grad_ins) {
     const std::string& grad_input_name = iter.first;
 
@@ -2068,6 +2100,8 @@ static std::string GenerateSingleOpBase(
           "{ \"%s\", egr::EagerUtils::TrySyncToVars(hooked_grads[%d]) },";
       ins_contents_str += paddle::string::Sprintf(
           GRAD_INS_GRAD_CONTENT_TEMPLATE, grad_input_name, fwd_output_position);
+      grad_slots_str += paddle::string::Sprintf(
+          "{ \"%s\", %d },", grad_input_name, fwd_output_position);
 
     } else {
       PADDLE_THROW(platform::errors::Fatal(
@@ -2424,6 +2458,8 @@ static std::string GenerateGradNodeCCContents(
     op_base_infos.emplace_back(std::move(op_base_info));
   }
 
+  bool allow_backward_inplace =
+      op_base_infos.size() == 1 && !is_op_base_per_duplicable_input;
   size_t outs_size = 0;
   for (size_t i = 0; i < op_base_infos.size(); i++) {
     const auto& op_base_info = op_base_infos[i];
@@ -2442,7 +2478,8 @@ static std::string GenerateGradNodeCCContents(
         fwd_op_type, op_base_type, fwd_inputs_name_pos_map,
         fwd_outputs_name_pos_map, in_vars, grad_ins_fwd_slotname_map,
         grad_ins_grad_slotname_map, grad_outs_slotname_map, grad_ins, grad_outs,
-        grad_attrs, is_op_base_per_duplicable_input, &outs_size);
+        grad_attrs, is_op_base_per_duplicable_input, allow_backward_inplace,
+        &outs_size);
   }
 
   if (is_op_base_per_duplicable_input) {
@@ -904,6 +904,12 @@ class DygraphForwardFunctionGenerator(DygraphFunctionGeneratorBase):
                 function_name = GetIntermediateAPIFunctionName(function_name)
 
         forward_call_str = f"{indent}auto api_result = paddle::experimental::{namespace}{function_name}({inputs_call_args_str});"
+        if is_inplaced:
+            # Keep the data saved for backward before the api writes it
+            prepare_inplace_write_str = ""
+            for inplace_name in inplace_map.keys():
+                prepare_inplace_write_str += f"{indent}egr::EagerUtils::PrepareInplaceWrite({inplace_name});\n"
+            forward_call_str = prepare_inplace_write_str + forward_call_str
         num_outputs = len(forward_outputs_position_map.keys()) - len(
             intermediate_outputs)
 
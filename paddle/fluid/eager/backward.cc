@@ -529,10 +529,9 @@ GeneralGrad* GeneralGrad::general_grad_ = new GeneralGrad();
 std::vector<paddle::experimental::Tensor> RunBackward(
     const std::vector<paddle::experimental::Tensor>& tensors,  // output
     const std::vector<paddle::experimental::Tensor>& grad_tensors,
-    bool retain_graph, bool create_graph = false,
-    const std::vector<paddle::experimental::Tensor>& inputs = {},
-    bool allow_unused = false,
-    const std::vector<paddle::experimental::Tensor>& no_grad_vars = {}) {
+    bool retain_graph, bool create_graph,
+    const std::vector<paddle::experimental::Tensor>& inputs, bool allow_unused,
+    const std::vector<paddle::experimental::Tensor>& no_grad_vars) {
   VLOG(6) << "Start Backward";
 
   // *Gradient Hook should happen at node-level
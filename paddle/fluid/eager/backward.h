@@ -34,6 +34,18 @@ std::vector<paddle::experimental::Tensor> Grad(
     bool only_inputs = false, bool allow_unused = false,
     const std::vector<paddle::experimental::Tensor>& no_grad_vars = {});
 
+// RunBackward():
+// the backward of Backward() and Grad(), without advancing the step of the
+// autotune that Backward() takes once per training step, for the backward
+// run inside a grad node, such as the one of a recomputed segment.
+std::vector<paddle::experimental::Tensor> RunBackward(
+    const std::vector<paddle::experimental::Tensor>& tensors,
+    const std::vector<paddle::experimental::Tensor>& grad_tensors,
+    bool retain_graph, bool create_graph = false,
+    const std::vector<paddle::experimental::Tensor>& inputs = {},
+    bool allow_unused = false,
+    const std::vector<paddle::experimental::Tensor>& no_grad_vars = {});
+
 // Reserved for gradient()
 
 }  // namespace egr
@@ -0,0 +1,290 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/eager/recompute/recompute_node.h"
+
+#include "paddle/fluid/eager/api/utils/global_utils.h"
+#include "paddle/fluid/eager/backward.h"
+#include "paddle/fluid/eager/utils.h"
+#include "paddle/fluid/framework/generator.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/errors.h"
+
+#include "glog/logging.h"
+
+namespace egr {
+
+namespace {
+
+// Sets whether the ops record their grad nodes, till the end of the scope.
+class HasGradGuard {
+ public:
+  explicit HasGradGuard(bool has_grad)
+      : prev_has_grad_(egr::Controller::Instance().HasGrad()) {
+    egr::Controller::Instance().SetHasGrad(has_grad);
+  }
+
+  ~HasGradGuard() { egr::Controller::Instance().SetHasGrad(prev_has_grad_); }
+
+ private:
+  bool prev_has_grad_;
+};
+
+// Sets the random state, till the end of the scope.
+class RNGStateGuard {
+ public:
+  RNGStateGuard(const GradNodeRecompute::RNGState& state, bool enable)
+      : enable_(enable) {
+    if (enable_) {
+      prev_state_ = GradNodeRecompute::GetRNGState(state.place);
+      GradNodeRecompute::SetRNGState(state);
+    }
+  }
+
+  ~RNGStateGuard() {
+    if (enable_) {
+      GradNodeRecompute::SetRNGState(prev_state_);
+    }
+  }
+
+ private:
+  bool enable_;
+  GradNodeRecompute::RNGState prev_state_;
+};
+
+// Sets the AMP state, till the end of the scope.
+class AMPStateGuard {
+ public:
+  explicit AMPStateGuard(const GradNodeRecompute::AMPState& state)
+      : prev_state_(GradNodeRecompute::GetAMPState()) {
+    GradNodeRecompute::SetAMPState(state);
+  }
+
+  ~AMPStateGuard() { GradNodeRecompute::SetAMPState(prev_state_); }
+
+ private:
+  GradNodeRecompute::AMPState prev_state_;
+};
+
+}  // namespace
+
+GradNodeRecompute::RNGState GradNodeRecompute::GetRNGState(
+    const phi::Place& place) {
+  RNGState state;
+  state.place = place;
+  state.cpu_state = paddle::framework::DefaultCPUGenerator()->GetState();
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (paddle::platform::is_gpu_place(place)) {
+    state.gpu_state =
+        paddle::framework::GetDefaultCUDAGenerator(place.GetDeviceId())
+            ->GetState();
+  }
+#endif
+  return state;
+}
+
+void GradNodeRecompute::SetRNGState(const RNGState& state) {
+  paddle::framework::DefaultCPUGenerator()->SetState(state.cpu_state);
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (paddle::platform::is_gpu_place(state.place)) {
+    paddle::framework::GetDefaultCUDAGenerator(state.place.GetDeviceId())
+        ->SetState(state.gpu_state);
+  }
+#endif
+}
+
+GradNodeRecompute::AMPState GradNodeRecompute::GetAMPState() {
+  AMPState state;
+  const auto& tracer = egr::Controller::Instance().GetCurrentTracer();
+  state.level = tracer->GetAmpLevel();
+  state.dtype = tracer->GetAmpDtype();
+  auto& ops = paddle::imperative::AmpOperators::Instance();
+  state.allow_ops = *ops.GetMutableAllowOps();
+  state.block_ops = *ops.GetMutableBlockOps();
+  return state;
+}
+
+void GradNodeRecompute::SetAMPState(const AMPState& state) {
+  const auto& tracer = egr::Controller::Instance().GetCurrentTracer();
+  tracer->SetAmpLevel(state.level);
+  tracer->SetAmpDtype(state.dtype);
+  auto& ops = paddle::imperative::AmpOperators::Instance();
+  *ops.GetMutableAllowOps() = state.allow_ops;
+  *ops.GetMutableBlockOps() = state.block_ops;
+}
+
+GradNodeRecompute::GradNodeRecompute(
+    const RecomputeFunction& fn,
+    const std::vector<paddle::experimental::Tensor>& inputs,
+    size_t num_outputs, bool preserve_rng_state, const RNGState& rng_state,
+    const AMPState& amp_state)
+    : GradNodeBase(num_outputs, inputs.size()),
+      fn_(fn),
+      preserve_rng_state_(preserve_rng_state),
+      rng_state_(rng_state),
+      amp_state_(amp_state) {
+  inputs_.reserve(inputs.size());
+  inputs_stop_gradient_.reserve(inputs.size());
+  for (const auto& input : inputs) {
+    inputs_.emplace_back(input, false);
+    auto* meta = EagerUtils::nullable_autograd_meta(input);
+    inputs_stop_gradient_.push_back(meta == nullptr || meta->StopGradient());
+  }
+}
+
+void GradNodeRecompute::ClearTensorWrappers() {
+  for (auto& input : inputs_) {
+    input.clear();
+  }
+  inputs_cleared_ = true;
+}
+
+paddle::small_vector<std::vector<paddle::experimental::Tensor>,
+                     kSlotSmallVectorSize>
+GradNodeRecompute::operator()(
+    paddle::small_vector<std::vector<paddle::experimental::Tensor>,
+                         kSlotSmallVectorSize>& grads,  // NOLINT
+    bool create_graph, bool is_new_grad) {
+  VLOG(3) << "Running Eager Backward Node: " << name();
+  PADDLE_ENFORCE_EQ(
+      create_graph, false,
+      paddle::platform::errors::Unimplemented(
+          "The backward of a recomputed segment does not support "
+          "create_graph, since its graph is built during the backward."));
+  PADDLE_ENFORCE_EQ(
+      is_new_grad, false,
+      paddle::platform::errors::Unimplemented(
+          "The backward of a recomputed segment can not be run by "
+          "paddle.grad, since its replay accumulates the grads of the "
+          "parameters in the segment. Please use backward instead."));
+  PADDLE_ENFORCE_EQ(
+      inputs_cleared_, false,
+      paddle::platform::errors::PreconditionNotMet(
+          "The inputs of the recomputed segment have been released by the "
+          "last backward. Please set retain_graph=True in the first backward "
+          "to run the backward of the segment again."));
+
+  paddle::small_vector<std::vector<paddle::experimental::Tensor>,
+                       kSlotSmallVectorSize>
+      hooked_grads = ApplyGradientHooks(grads);
+
+  // The inputs of the replay are leaves, which get the grads of the
+  // segment inputs.
+  std::vector<paddle::experimental::Tensor> inputs;
+  inputs.reserve(inputs_.size());
+  for (size_t i = 0; i < inputs_.size(); ++i) {
+    paddle::experimental::Tensor input = inputs_[i].recover();
+    paddle::experimental::Tensor detached;
+    if (input.defined()) {
+      detached.set_impl(input.impl());
+      detached.set_name(input.name());
+      EagerUtils::autograd_meta(&detached)->SetStopGradient(
+          inputs_stop_gradient_[i]);
+    }
+    inputs.emplace_back(std::move(detached));
+  }
+
+  std::vector<paddle::experimental::Tensor> outputs;
+  {
+    VLOG(6) << "Replay the forward of the recomputed segment";
+    RNGStateGuard rng_guard(rng_state_, preserve_rng_state_);
+    AMPStateGuard amp_guard(amp_state_);
+    HasGradGuard guard(true);
+    outputs = fn_(inputs);
+  }
+  PADDLE_ENFORCE_EQ(
+      outputs.size(), hooked_grads.size(),
+      paddle::platform::errors::InvalidArgument(
+          "The replay of the recomputed segment returns %d outputs, but its "
+          "forward returned %d.",
+          outputs.size(), hooked_grads.size()));
+
+  std::vector<paddle::experimental::Tensor> targets;
+  std::vector<paddle::experimental::Tensor> target_grads;
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    auto* meta = EagerUtils::nullable_autograd_meta(outputs[i]);
+    if (hooked_grads[i].empty() || !hooked_grads[i][0].initialized() ||
+        meta == nullptr || meta->StopGradient()) {
+      continue;
+    }
+    targets.emplace_back(outputs[i]);
+    target_grads.emplace_back(hooked_grads[i][0]);
+  }
+  if (!targets.empty()) {
+    // Not Backward(), which would advance the autotune step once more for
+    // each recomputed segment of a training step.
+    RunBackward(targets, target_grads, false);
+  }
+
+  paddle::small_vector<std::vector<paddle::experimental::Tensor>,
+                       kSlotSmallVectorSize>
+      grad_outputs(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (inputs_stop_gradient_[i]) continue;
+    auto* grad = EagerUtils::mutable_grad(inputs[i]);
+    if (grad && grad->initialized()) {
+      grad_outputs[i].emplace_back(*grad);
+    }
+  }
+  return grad_outputs;
+}
+
+std::vector<paddle::experimental::Tensor> Recompute(
+    const RecomputeFunction& fn,
+    const std::vector<paddle::experimental::Tensor>& inputs,
+    bool preserve_rng_state) {
+  bool trace_backward = egr::Controller::Instance().HasGrad();
+  GradNodeRecompute::RNGState rng_state;
+  if (trace_backward && preserve_rng_state) {
+    rng_state = GradNodeRecompute::GetRNGState(
+        egr::Controller::Instance().GetExpectedPlace());
+  }
+
+  std::vector<paddle::experimental::Tensor> outputs;
+  {
+    HasGradGuard guard(false);
+    outputs = fn(inputs);
+  }
+  if (!trace_backward) return outputs;
+  // The backward is run out of the auto cast scope of the forward.
+  GradNodeRecompute::AMPState amp_state = GradNodeRecompute::GetAMPState();
+
+  for (const auto& output : outputs) {
+    for (const auto& input : inputs) {
+      PADDLE_ENFORCE_NE(
+          output.impl(), input.impl(),
+          paddle::platform::errors::InvalidArgument(
+              "The recomputed segment returns its input %s as an output, "
+              "which is not supported.",
+              input.name()));
+    }
+  }
+
+  auto grad_node = std::make_shared<GradNodeRecompute>(
+      fn, inputs, outputs.size(), preserve_rng_state, rng_state, amp_state);
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    grad_node->SetGradOutMeta(inputs[i], i);
+  }
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    AutogradMeta* meta = EagerUtils::autograd_meta(&outputs[i]);
+    meta->WeakSetStopGradient(false);
+    EagerUtils::SetOutRankWithSlot(meta, i);
+    EagerUtils::SetHistory(meta, grad_node);
+    grad_node->SetGradInMeta(outputs[i], i);
+    EagerUtils::CheckAndRetainGrad(outputs[i]);
+  }
+  return outputs;
+}
+
+}  // namespace egr
@@ -0,0 +1,115 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/fluid/eager/grad_node_info.h"
+#include "paddle/fluid/eager/tensor_wrapper.h"
+#include "paddle/fluid/imperative/amp_auto_cast.h"
+#include "paddle/phi/core/generator.h"
+
+namespace egr {
+
+// The forward of a recomputed segment. It should compute the same outputs
+// from the same inputs each time, given the same random state.
+using RecomputeFunction =
+    std::function<std::vector<paddle::experimental::Tensor>(
+        const std::vector<paddle::experimental::Tensor>&)>;
+
+/**
+ * GradNodeRecompute is the grad node of a segment run by Recompute. It
+ * saves only the inputs of the segment, instead of the activations saved
+ * by the nodes of its ops, and replays the segment when the backward
+ * reaches it: the replay builds the graph of the segment from the saved
+ * inputs, with the random and AMP states of the forward, and runs the
+ * backward of that graph with the grads of the segment outputs. The
+ * parameters used in the segment get their grads accumulated by the replay,
+ * so the node can not be run by egr::Grad, which must not touch the grads.
+ * **/
+class GradNodeRecompute : public GradNodeBase {
+ public:
+  // The states of the generators used by the ops on place.
+  struct RNGState {
+    phi::Place place;
+    phi::Generator::GeneratorState cpu_state;
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+    phi::Generator::GeneratorState gpu_state;
+#endif
+  };
+
+  static RNGState GetRNGState(const phi::Place& place);
+  static void SetRNGState(const RNGState& state);
+
+  // The auto cast level, dtype and op lists used by the ops.
+  struct AMPState {
+    paddle::imperative::AmpLevel level{paddle::imperative::AmpLevel::O0};
+    std::string dtype;
+    std::unordered_set<std::string> allow_ops;
+    std::unordered_set<std::string> block_ops;
+  };
+
+  static AMPState GetAMPState();
+  static void SetAMPState(const AMPState& state);
+
+  GradNodeRecompute(const RecomputeFunction& fn,
+                    const std::vector<paddle::experimental::Tensor>& inputs,
+                    size_t num_outputs, bool preserve_rng_state,
+                    const RNGState& rng_state, const AMPState& amp_state);
+
+  ~GradNodeRecompute() override = default;
+
+  paddle::small_vector<std::vector<paddle::experimental::Tensor>,
+                       kSlotSmallVectorSize>
+  operator()(paddle::small_vector<std::vector<paddle::experimental::Tensor>,
+                                  kSlotSmallVectorSize>& grads,  // NOLINT
+             bool create_graph = false,
+             bool is_new_grad = false) override;
+
+  void ClearTensorWrappers() override;
+
+  std::string name() override { return "GradNodeRecompute"; }
+
+  std::shared_ptr<GradNodeBase> Copy() const override {
+    return std::shared_ptr<GradNodeRecompute>(new GradNodeRecompute(*this));
+  }
+
+ private:
+  RecomputeFunction fn_;
+  std::vector<TensorWrapper> inputs_;
+  std::vector<bool> inputs_stop_gradient_;
+  bool inputs_cleared_{false};
+
+  bool preserve_rng_state_;
+  RNGState rng_state_;
+  AMPState amp_state_;
+};
+
+/**
+ * Runs fn on inputs without recording the graph of its ops, and records a
+ * GradNodeRecompute for its outputs instead, so the activations inside fn
+ * are freed after the forward and recomputed by the backward. The replay
+ * runs with the AMP state of the forward, and with preserve_rng_state, with
+ * its random state, so ops such as dropout produce the same masks.
+ * **/
+std::vector<paddle::experimental::Tensor> Recompute(
+    const RecomputeFunction& fn,
+    const std::vector<paddle::experimental::Tensor>& inputs,
+    bool preserve_rng_state = true);
+
+}  // namespace egr
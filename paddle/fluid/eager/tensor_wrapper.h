@@ -68,6 +68,8 @@ class TensorWrapper {
           PADDLE_THROW(paddle::platform::errors::Fatal(
               "Unrecognized tensor type for no_need_buffer feature"));
         }
+      } else {
+        save_snapshot(tensor);
       }
       return;
     }
@@ -87,6 +89,7 @@ class TensorWrapper {
       }
     } else {
       intermidiate_tensor_.set_impl(tensor.impl());
+      save_snapshot(tensor);
     }
     // TODO(jiabin): This may has server performance issue
     intermidiate_tensor_.set_name(tensor.name() + "@Saved");
@@ -142,6 +145,12 @@ class TensorWrapper {
                  "no_need_buffer_ is true.";
       return;
     }
+    if (preserved_ && *preserved_) {
+      VLOG(6) << "There's no need to check inplace_version because Tensor '"
+              << intermidiate_tensor_.name()
+              << "' has been copied before the inplace operation.";
+      return;
+    }
     if (intermidiate_tensor_.impl() &&
         phi::DenseTensor::classof(intermidiate_tensor_.impl().get())) {
       phi::DenseTensor* dense_tensor =
@@ -170,13 +179,40 @@ class TensorWrapper {
     }
   }
 
-  void clear() { intermidiate_tensor_.reset(); }
+  void clear() {
+    intermidiate_tensor_.reset();
+    copy_on_write_hook_.reset();
+  }
 
  private:
+  /**
+   * Saves a shallow copy of the dense tensor instead of the tensor itself,
+   * and copies its data only if the tensor is written inplace afterwards,
+   * so that the backward still gets the data of the forward.
+   * **/
+  void save_snapshot(const paddle::experimental::Tensor& tensor) {
+    if (!tensor.impl() || !phi::DenseTensor::classof(tensor.impl().get())) {
+      return;
+    }
+    phi::DenseTensor* dense_tensor =
+        static_cast<phi::DenseTensor*>(tensor.impl().get());
+    if (!dense_tensor->initialized()) {
+      return;
+    }
+    auto tw_dense_tensor = std::make_shared<phi::DenseTensor>(*dense_tensor);
+    intermidiate_tensor_.set_impl(tw_dense_tensor);
+    preserved_ = std::make_shared<bool>(false);
+    copy_on_write_hook_ =
+        EagerUtils::AddCopyOnWriteHook(tw_dense_tensor, preserved_);
+  }
+
   bool full_reserved_ = false;
   bool no_need_buffer_ = false;
   paddle::experimental::Tensor intermidiate_tensor_;
   std::weak_ptr<egr::GradNodeBase> weak_grad_node_;
   uint32_t inplace_version_snapshot_ = 0;
+  // Copies the saved data before an inplace write, and sets preserved_
+  std::shared_ptr<std::function<void()>> copy_on_write_hook_;
+  std::shared_ptr<bool> preserved_;
 };
 }  // namespace egr
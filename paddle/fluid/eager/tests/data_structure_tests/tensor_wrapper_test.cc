@@ -78,3 +78,41 @@ TEST(TensorWrapper, Basic) {
   auto tw2 = egr::TensorWrapper(et3, true);
   CHECK(tw2.recover().initialized() == false);
 }
+
+TEST(TensorWrapper, CopyOnInplaceWrite) {
+  auto alloc = std::make_unique<paddle::experimental::DefaultAllocator>(
+      paddle::platform::CPUPlace());
+  phi::DenseTensorMeta meta =
+      phi::DenseTensorMeta(phi::DataType::FLOAT32, phi::make_ddim({1, 2}));
+  std::shared_ptr<phi::DenseTensor> dt =
+      std::make_shared<phi::DenseTensor>(alloc.get(), meta);
+  auto* dt_ptr = dt->mutable_data<float>(paddle::platform::CPUPlace());
+  dt_ptr[0] = 5.0f;
+  dt_ptr[1] = 10.0f;
+  paddle::experimental::Tensor et;
+  et.set_impl(dt);
+  et.set_name("et");
+  auto tw0 = egr::TensorWrapper(et, false);
+  auto tw1 = egr::TensorWrapper(et, true);
+
+  // An inplace op writes et after its data is kept for the wrappers.
+  egr::EagerUtils::PrepareInplaceWrite(et);
+  dt_ptr[0] = 6.0f;
+  dt_ptr[1] = 11.0f;
+  et.bump_inplace_version();
+
+  for (auto* tw : {&tw0, &tw1}) {
+    auto recovered = tw->recover();
+    auto* recovered_ptr =
+        static_cast<phi::DenseTensor*>(recovered.impl().get())->data<float>();
+    CHECK_EQ(recovered_ptr[0], 5.0f);
+    CHECK_EQ(recovered_ptr[1], 10.0f);
+  }
+  CHECK_EQ(dt->data<float>()[0], 6.0f);
+  CHECK_EQ(dt->data<float>()[1], 11.0f);
+
+  // A write which skips PrepareInplaceWrite is still detected.
+  auto tw2 = egr::TensorWrapper(et, false);
+  et.bump_inplace_version();
+  ASSERT_ANY_THROW(tw2.recover());
+}
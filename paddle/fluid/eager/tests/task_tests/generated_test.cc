@@ -14,7 +14,10 @@
 
 // Eager Dygraph
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -28,6 +31,7 @@
 #include "paddle/fluid/imperative/tracer.h"
 
 #include "paddle/fluid/eager/api/generated/fluid_generated/dygraph_forward_api.h"
+#include "paddle/fluid/platform/device_context.h"
 #include "paddle/phi/core/kernel_registry.h"
 
 PD_DECLARE_KERNEL(full, CPU, ALL_LAYOUT);
@@ -65,6 +69,106 @@ TEST(Generated, Sigmoid) {
   eager_test::CompareGradTensorWithValue<float>(tensor, 0.25);
 }
 
+// Counts the allocations of the CPU device context and the bytes they hold.
+class CountingAllocator : public phi::Allocator {
+ public:
+  explicit CountingAllocator(const phi::Allocator* underlying)
+      : underlying_(const_cast<phi::Allocator*>(underlying)) {}
+
+  AllocationPtr Allocate(size_t bytes_size) override {
+    auto allocation = underlying_->Allocate(bytes_size);
+    ++calls_;
+    live_bytes_ += allocation->size();
+    peak_bytes_ = std::max(peak_bytes_, live_bytes_);
+    auto deleter = allocation.get_deleter();
+    return AllocationPtr(allocation.release(),
+                         [this, deleter](phi::Allocation* ptr) {
+                           live_bytes_ -= ptr->size();
+                           deleter(ptr);
+                         });
+  }
+
+  // Starts a step, whose peak is counted from the bytes held now.
+  void Reset() {
+    calls_ = 0;
+    peak_bytes_ = live_bytes_;
+  }
+
+  size_t calls() const { return calls_; }
+  size_t peak_bytes() const { return peak_bytes_; }
+  size_t live_bytes() const { return live_bytes_; }
+
+ private:
+  phi::Allocator* underlying_;
+  size_t calls_{0};
+  size_t live_bytes_{0};
+  size_t peak_bytes_{0};
+};
+
+TEST(Generated, SigmoidBackwardInplace) {
+  eager_test::InitEnv(paddle::platform::CPUPlace());
+  auto* dev_ctx = paddle::platform::DeviceContextPool::Instance().Get(
+      paddle::platform::CPUPlace());
+  const phi::Allocator* allocator = &dev_ctx->GetAllocator();
+  // Static, as the deleters of its allocations refer to it.
+  static CountingAllocator counting_allocator(allocator);
+  dev_ctx->SetAllocator(&counting_allocator);
+
+  auto grad_dense = [](const paddle::experimental::Tensor& tensor) {
+    return std::dynamic_pointer_cast<phi::DenseTensor>(
+        EagerUtils::unsafe_autograd_meta(tensor)->Grad().impl());
+  };
+  auto grad_values = [&](const paddle::experimental::Tensor& tensor) {
+    auto dense = grad_dense(tensor);
+    const float* ptr = dense->data<float>();
+    return std::vector<float>(ptr, ptr + dense->numel());
+  };
+
+  // dz/dy = z * (1 - z) and dy/dx = y * (1 - y), with y = 0.5
+  const float z = 1.f / (1.f + std::exp(-0.5f));
+  const float y_grad = z * (1.f - z);
+  const float x_grad = y_grad * 0.25f;
+
+  // The grad node of y writes x@GRAD into the buffer of y@GRAD, unless
+  // y@GRAD is retained.
+  size_t calls[2];
+  size_t peak_bytes[2];
+  for (bool retain_y_grad : {false, true}) {
+    paddle::experimental::Tensor x = egr_utils_api::CreateTensorWithValue(
+        phi::make_ddim({4, 16}), paddle::platform::CPUPlace(),
+        phi::DataType::FLOAT32, phi::DataLayout::NCHW, 0.0, true);
+    egr_utils_api::RetainGradForTensor(x);
+    auto y = sigmoid_dygraph_function(x, {});
+    if (retain_y_grad) egr_utils_api::RetainGradForTensor(y);
+    auto out = sigmoid_dygraph_function(y, {});
+
+    std::vector<paddle::experimental::Tensor> target_tensors = {out};
+    counting_allocator.Reset();
+    const size_t live_bytes = counting_allocator.live_bytes();
+    Backward(target_tensors, {});
+    calls[retain_y_grad] = counting_allocator.calls();
+    peak_bytes[retain_y_grad] = counting_allocator.peak_bytes() - live_bytes;
+    VLOG(3) << "Backward with y@GRAD " << (retain_y_grad ? "" : "not ")
+            << "retained calls the allocator " << calls[retain_y_grad]
+            << " times, peak " << peak_bytes[retain_y_grad] << " bytes.";
+
+    for (float value : grad_values(x)) {
+      ASSERT_NEAR(value, x_grad, 1e-6f);
+    }
+    if (retain_y_grad) {
+      for (float value : grad_values(y)) {
+        ASSERT_NEAR(value, y_grad, 1e-6f);
+      }
+      ASSERT_NE(grad_dense(x)->data<float>(), grad_dense(y)->data<float>());
+    }
+  }
+  dev_ctx->SetAllocator(allocator);
+
+  // Only the run with y@GRAD retained allocates a buffer for x@GRAD.
+  ASSERT_EQ(calls[false] + 1, calls[true]);
+  ASSERT_LE(peak_bytes[false], peak_bytes[true]);
+}
+
 TEST(Generated, Matmul_v2) {
   // Prepare Device Contexts
   eager_test::InitEnv(paddle::platform::CPUPlace());
@@ -0,0 +1,199 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "paddle/fluid/eager/api/all.h"
+#include "paddle/fluid/eager/api/utils/tensor_utils.h"
+#include "paddle/fluid/eager/autograd_meta.h"
+#include "paddle/fluid/eager/backward.h"
+#include "paddle/fluid/eager/recompute/recompute_node.h"
+#include "paddle/fluid/eager/utils.h"
+
+#include "paddle/fluid/eager/tests/test_utils.h"
+#include "paddle/fluid/imperative/tracer.h"
+
+#include "paddle/fluid/eager/api/generated/fluid_generated/dygraph_forward_api.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/autotune/switch_autotune.h"
+
+PD_DECLARE_KERNEL(full, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(matmul, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(matmul_grad, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(sigmoid, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(sigmoid_grad, CPU, ALL_LAYOUT);
+
+namespace egr {
+
+static paddle::experimental::Tensor CreateLeaf(
+    const std::vector<int64_t>& dims, float value) {
+  paddle::experimental::Tensor tensor = egr_utils_api::CreateTensorWithValue(
+      phi::make_ddim(dims), paddle::platform::CPUPlace(),
+      phi::DataType::FLOAT32, phi::DataLayout::NCHW, value, true);
+  egr_utils_api::RetainGradForTensor(tensor);
+  return tensor;
+}
+
+static std::vector<float> GradValues(const paddle::experimental::Tensor& t) {
+  auto grad_dense = std::dynamic_pointer_cast<phi::DenseTensor>(
+      EagerUtils::unsafe_autograd_meta(t)->Grad().impl());
+  const float* ptr = grad_dense->data<float>();
+  return std::vector<float>(ptr, ptr + grad_dense->numel());
+}
+
+TEST(Recompute, MatmulSigmoid) {
+  eager_test::InitEnv(paddle::platform::CPUPlace());
+  auto tracer = std::make_shared<paddle::imperative::Tracer>();
+  paddle::imperative::SetCurrentTracer(tracer);
+
+  std::vector<std::vector<float>> x_grads;
+  std::vector<std::vector<float>> w_grads;
+  for (bool recompute : {false, true}) {
+    auto x = CreateLeaf({4, 16}, 0.1f);
+    auto w = CreateLeaf({16, 8}, 0.2f);
+    // w is a parameter of the segment, not one of its inputs
+    RecomputeFunction segment =
+        [&w](const std::vector<paddle::experimental::Tensor>& inputs) {
+          auto y = matmul_v2_dygraph_function(
+              inputs[0], w, {{"trans_x", false}, {"trans_y", false}});
+          return std::vector<paddle::experimental::Tensor>{
+              sigmoid_dygraph_function(y, {})};
+        };
+
+    std::vector<paddle::experimental::Tensor> outputs =
+        recompute ? Recompute(segment, {x}) : segment({x});
+    ASSERT_EQ(outputs.size(), 1UL);
+    if (recompute) {
+      // The activation of matmul is not saved by the graph.
+      ASSERT_EQ(EagerUtils::grad_node(outputs[0])->name(),
+                "GradNodeRecompute");
+    }
+    auto out_dense =
+        std::dynamic_pointer_cast<phi::DenseTensor>(outputs[0].impl());
+    for (int64_t i = 0; i < out_dense->numel(); ++i) {
+      ASSERT_NEAR(out_dense->data<float>()[i],
+                  1.f / (1.f + std::exp(-16 * 0.1f * 0.2f)), 1e-6f);
+    }
+
+    Backward(outputs, {});
+    x_grads.push_back(GradValues(x));
+    w_grads.push_back(GradValues(w));
+  }
+
+  ASSERT_EQ(x_grads[0].size(), x_grads[1].size());
+  for (size_t i = 0; i < x_grads[0].size(); ++i) {
+    ASSERT_NEAR(x_grads[0][i], x_grads[1][i], 1e-6f);
+  }
+  ASSERT_EQ(w_grads[0].size(), w_grads[1].size());
+  for (size_t i = 0; i < w_grads[0].size(); ++i) {
+    ASSERT_NEAR(w_grads[0][i], w_grads[1][i], 1e-6f);
+  }
+}
+
+TEST(Recompute, BackwardTwice) {
+  eager_test::InitEnv(paddle::platform::CPUPlace());
+  auto tracer = std::make_shared<paddle::imperative::Tracer>();
+  paddle::imperative::SetCurrentTracer(tracer);
+
+  auto x = CreateLeaf({4, 4}, 0.f);
+  RecomputeFunction segment =
+      [](const std::vector<paddle::experimental::Tensor>& inputs) {
+        return std::vector<paddle::experimental::Tensor>{
+            sigmoid_dygraph_function(inputs[0], {})};
+      };
+  auto outputs = Recompute(segment, {x});
+
+  Backward(outputs, {}, true);
+  for (float value : GradValues(x)) {
+    ASSERT_NEAR(value, 0.25f, 1e-6f);
+  }
+  // the inputs are released by a backward without retain_graph
+  Backward(outputs, {});
+  for (float value : GradValues(x)) {
+    ASSERT_NEAR(value, 0.5f, 1e-6f);
+  }
+  ASSERT_ANY_THROW(Backward(outputs, {}));
+}
+
+TEST(Recompute, AutoTuneStep) {
+  eager_test::InitEnv(paddle::platform::CPUPlace());
+  auto tracer = std::make_shared<paddle::imperative::Tracer>();
+  paddle::imperative::SetCurrentTracer(tracer);
+
+  auto x = CreateLeaf({4, 4}, 0.f);
+  RecomputeFunction segment =
+      [](const std::vector<paddle::experimental::Tensor>& inputs) {
+        return std::vector<paddle::experimental::Tensor>{
+            sigmoid_dygraph_function(inputs[0], {})};
+      };
+  // two segments, whose backwards run inside the one of the step
+  auto outputs = Recompute(segment, Recompute(segment, {x}));
+
+  const int64_t step_id = phi::autotune::AutoTuneStatus::Instance().StepID();
+  Backward(outputs, {});
+  EXPECT_EQ(phi::autotune::AutoTuneStatus::Instance().StepID(), step_id + 1);
+}
+
+TEST(Recompute, ReplayWithAMPState) {
+  eager_test::InitEnv(paddle::platform::CPUPlace());
+  auto tracer = std::make_shared<paddle::imperative::Tracer>();
+  paddle::imperative::SetCurrentTracer(tracer);
+
+  auto x = CreateLeaf({4, 4}, 0.f);
+  std::vector<paddle::imperative::AmpLevel> levels;
+  RecomputeFunction segment =
+      [&levels, &tracer](
+          const std::vector<paddle::experimental::Tensor>& inputs) {
+        levels.push_back(tracer->GetAmpLevel());
+        return std::vector<paddle::experimental::Tensor>{
+            sigmoid_dygraph_function(inputs[0], {})};
+      };
+
+  tracer->SetAmpLevel(paddle::imperative::AmpLevel::O1);
+  auto outputs = Recompute(segment, {x});
+  tracer->SetAmpLevel(paddle::imperative::AmpLevel::O0);
+  Backward(outputs, {});
+
+  // The replay runs at the level of the forward, then the level is restored.
+  ASSERT_EQ(levels.size(), 2UL);
+  ASSERT_EQ(levels[1], paddle::imperative::AmpLevel::O1);
+  ASSERT_EQ(tracer->GetAmpLevel(), paddle::imperative::AmpLevel::O0);
+}
+
+TEST(Recompute, GeneralGrad) {
+  eager_test::InitEnv(paddle::platform::CPUPlace());
+  auto tracer = std::make_shared<paddle::imperative::Tracer>();
+  paddle::imperative::SetCurrentTracer(tracer);
+
+  auto x = CreateLeaf({4, 16}, 0.1f);
+  auto w = CreateLeaf({16, 8}, 0.2f);
+  RecomputeFunction segment =
+      [&w](const std::vector<paddle::experimental::Tensor>& inputs) {
+        auto y = matmul_v2_dygraph_function(
+            inputs[0], w, {{"trans_x", false}, {"trans_y", false}});
+        return std::vector<paddle::experimental::Tensor>{
+            sigmoid_dygraph_function(y, {})};
+      };
+  auto outputs = Recompute(segment, {x});
+
+  // paddle.grad must not accumulate the grad of w, which the replay does.
+  ASSERT_ANY_THROW(Grad(outputs, {x}));
+  ASSERT_FALSE(EagerUtils::unsafe_autograd_meta(w)->Grad().initialized());
+}
+
+}  // namespace egr
@@ -24,7 +24,9 @@
 #include "paddle/phi/core/tensor_meta.h"
 
 #include "paddle/fluid/framework/data_layout.h"
+#include "paddle/fluid/framework/op_info.h"
 #include "paddle/fluid/framework/phi_utils.h"
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/framework/variable.h"
 
 PADDLE_DEFINE_EXPORTED_bool(retain_grad_for_all_tensor, true,
@@ -244,6 +246,65 @@ std::vector<std::shared_ptr<EagerVariable>> EagerUtils::CreateVars(
   return res;
 }
 
+void EagerUtils::PrepareInplaceWrite(
+    const paddle::experimental::Tensor& target) {
+  if (target.impl() && phi::DenseTensor::classof(target.impl().get())) {
+    auto* dense_tensor = static_cast<phi::DenseTensor*>(target.impl().get());
+    dense_tensor->InplaceVersionCounter().RunPreWriteHooks();
+  }
+}
+
+void EagerUtils::PerformBackwardInplace(
+    const std::string& op_type,
+    const paddle::small_vector<std::vector<paddle::experimental::Tensor>,
+                               kSlotSmallVectorSize>& grads,
+    const paddle::small_vector<std::vector<paddle::experimental::Tensor>,
+                               kSlotSmallVectorSize>& hooked_grads,
+    const std::map<std::string, size_t>& grad_slots,
+    const std::map<std::string, std::vector<std::shared_ptr<EagerVariable>>>&
+        ins,
+    std::map<std::string, std::vector<std::shared_ptr<EagerVariable>>>* outs) {
+  auto* op_info = paddle::framework::OpInfoMap::Instance().GetNullable(op_type);
+  if (op_info == nullptr || !op_info->infer_inplace_) return;
+
+  for (auto& pair : op_info->infer_inplace_(true)) {
+    auto slot_iter = grad_slots.find(pair.first);
+    auto in_iter = ins.find(pair.first);
+    auto out_iter = outs->find(pair.second);
+    if (slot_iter == grad_slots.end() || in_iter == ins.end() ||
+        out_iter == outs->end() || in_iter->second.size() != 1 ||
+        out_iter->second.size() != 1 || !in_iter->second[0] ||
+        !out_iter->second[0]) {
+      continue;
+    }
+    size_t slot = slot_iter->second;
+    if (slot >= grads.size() || grads[slot].size() != 1 ||
+        hooked_grads[slot].size() != 1) {
+      continue;
+    }
+    // The grad tensor is held by the buffer of the engine and its copy in
+    // hooked_grads, and its holder by the tensor and the synced input.
+    const auto& grad_impl = grads[slot][0].impl();
+    if (!grad_impl || grad_impl != hooked_grads[slot][0].impl() ||
+        grad_impl.use_count() != 2) {
+      continue;
+    }
+    auto* in_var = in_iter->second[0]->MutableVar();
+    if (!in_var->IsType<paddle::framework::LoDTensor>()) continue;
+    auto* in_tensor = in_var->GetMutable<paddle::framework::LoDTensor>();
+    if (!in_tensor->IsInitialized() || in_tensor->Holder().use_count() != 2) {
+      continue;
+    }
+    auto* out_var = out_iter->second[0]->MutableVar();
+    if (out_var->IsInitialized()) continue;
+    auto* out_tensor = out_var->GetMutable<paddle::framework::LoDTensor>();
+    out_tensor->ShareBufferWith(*in_tensor);
+    out_tensor->Resize(in_tensor->dims());
+    VLOG(4) << "Inplace performed in op " << op_type << ": " << pair.second
+            << " -> " << pair.first;
+  }
+}
+
 void EagerUtils::HandleViewBetweenInputAndOutput(
     const std::shared_ptr<EagerVariable>& input_var,
     const std::shared_ptr<EagerVariable>& view_output_var) {
@@ -359,6 +420,25 @@ void EagerUtils::Output2Result(
   }
 }
 
+std::shared_ptr<std::function<void()>> EagerUtils::AddCopyOnWriteHook(
+    const std::shared_ptr<phi::DenseTensor>& saved,
+    const std::shared_ptr<bool>& preserved) {
+  // Only a weak reference, so that clearing the wrapper frees the data.
+  std::weak_ptr<phi::DenseTensor> weak_saved = saved;
+  auto hook = std::make_shared<std::function<void()>>([weak_saved,
+                                                       preserved]() {
+    auto saved = weak_saved.lock();
+    if (!saved || !saved->initialized()) return;
+    phi::DenseTensor copy;
+    paddle::framework::TensorCopySync(*saved, saved->place(), &copy);
+    saved->ShareBufferWith(copy);
+    *preserved = true;
+    VLOG(6) << "Copied the saved tensor before it is written inplace";
+  });
+  saved->InplaceVersionCounter().AddPreWriteHook(hook);
+  return hook;
+}
+
 paddle::experimental::Tensor EagerUtils::RecoverTensorWrapper(
     TensorWrapper* tw) {
   return tw->recover();
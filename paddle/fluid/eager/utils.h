@@ -168,12 +168,47 @@ class EagerUtils {
     }
   }
 
+  // Runs the copy-on-write of the snapshots of target saved by the
+  // TensorWrappers, before an inplace op writes target.
+  static void PrepareInplaceWrite(const paddle::experimental::Tensor& target);
+
+  // Backward Inplace Strategy
+  /**
+   * Lets an output of the grad op reuse the buffer of its input, as the
+   * infer_inplace_ of op_type allows, like PerformBackwardInplace of the
+   * imperative BasicEngine. grad_slots maps the inputs which come from
+   * hooked_grads to their slots, and an input is reused only if nothing
+   * but grads and hooked_grads holds its tensor, i.e. no hook, retain_grad
+   * or view shares it.
+   * **/
+  static void PerformBackwardInplace(
+      const std::string& op_type,
+      const paddle::small_vector<std::vector<paddle::experimental::Tensor>,
+                                 kSlotSmallVectorSize>& grads,
+      const paddle::small_vector<std::vector<paddle::experimental::Tensor>,
+                                 kSlotSmallVectorSize>& hooked_grads,
+      const std::map<std::string, size_t>& grad_slots,
+      const std::map<std::string, std::vector<std::shared_ptr<EagerVariable>>>&
+          ins,
+      std::map<std::string, std::vector<std::shared_ptr<EagerVariable>>>*
+          outs);
+
   // View Strategy
   static void HandleViewBetweenInputAndOutput(
       const std::shared_ptr<EagerVariable>& input_var,
       const std::shared_ptr<EagerVariable>& view_output_var);
 
   // TensorWrapper Utils
+  /**
+   * Keeps the data of saved, the snapshot of a dense tensor held by a
+   * TensorWrapper, when the tensor is written inplace: the returned hook
+   * copies the data into a buffer of saved and sets preserved. It is
+   * registered on the inplace version counter which they share, and runs
+   * only while the wrapper owns it.
+   * **/
+  static std::shared_ptr<std::function<void()>> AddCopyOnWriteHook(
+      const std::shared_ptr<phi::DenseTensor>& saved,
+      const std::shared_ptr<bool>& preserved);
   static paddle::experimental::Tensor RecoverTensorWrapper(TensorWrapper* tw);
   static std::vector<paddle::experimental::Tensor> RecoverTensorWrapper(
       std::vector<TensorWrapper>* tw);
@@ -0,0 +1,221 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/constant_folding_pass.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/fluid/framework/convert_utils.h"
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/phi/core/compat/convert_utils.h"
+#include "paddle/phi/core/kernel_factory.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// The ops which have side effects or a different result on every run.
+const std::unordered_set<std::string>& UnfoldableOps() {
+  static const std::unordered_set<std::string> ops = {
+      "feed",
+      "fetch",
+      "save",
+      "save_combine",
+      "load",
+      "load_combine",
+      "print",
+      "assert",
+      "read",
+      "dropout",
+      "seed",
+      "uniform_random",
+      "gaussian_random",
+      "truncated_gaussian_random",
+      "randint",
+      "randperm",
+      "bernoulli",
+      "multinomial",
+      "sampling_id"};
+  return ops;
+}
+
+// The ops which produce a constant without any input.
+const std::unordered_set<std::string>& ConstantSourceOps() {
+  static const std::unordered_set<std::string> ops = {"fill_constant",
+                                                      "assign_value"};
+  return ops;
+}
+
+bool HasCPUKernel(const std::string& op_type) {
+  auto& all_kernels = OperatorWithKernel::AllOpKernels();
+  auto it = all_kernels.find(op_type);
+  if (it != all_kernels.end()) {
+    for (auto& kernel_pair : it->second) {
+      if (platform::is_cpu_place(kernel_pair.first.place_)) {
+        return true;
+      }
+    }
+  }
+  auto phi_kernels = phi::KernelFactory::Instance().SelectKernelMap(
+      phi::TransToPhiKernelName(op_type));
+  for (auto& kernel_pair : phi_kernels) {
+    if (kernel_pair.first.backend() == phi::Backend::CPU) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool HasSubBlock(const OpDesc& op) {
+  for (auto& name : op.AttrNames()) {
+    auto type = op.GetAttrType(name);
+    if (type == proto::AttrType::BLOCK || type == proto::AttrType::BLOCKS) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool IsLoDTensorVar(const Node* node) {
+  return node->IsVar() && node->Var() &&
+         node->Var()->GetType() == proto::VarType::LOD_TENSOR;
+}
+
+// A persistable var which no op of the graph writes, or whose writer has
+// been folded.
+bool IsConstant(const Node* var, const Scope& scope) {
+  if (!IsLoDTensorVar(var) || !var->Var()->Persistable() ||
+      !var->inputs.empty()) {
+    return false;
+  }
+  auto* scope_var = scope.FindVar(var->Name());
+  return scope_var != nullptr && scope_var->IsType<LoDTensor>() &&
+         scope_var->Get<LoDTensor>().IsInitialized();
+}
+
+}  // namespace
+
+void ConstantFoldingPass::ApplyImpl(ir::Graph* graph) const {
+  PADDLE_ENFORCE_NOT_NULL(
+      graph, platform::errors::InvalidArgument("Graph cannot be nullptr."));
+  FusePassBase::Init("constant_folding", graph);
+  auto* scope = param_scope();
+  PADDLE_ENFORCE_NOT_NULL(
+      scope, platform::errors::InvalidArgument("Scope cannot be nullptr."));
+
+  // A var written more than once is not a constant, even if one of its
+  // writers is.
+  std::unordered_map<std::string, int> var_nodes;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar()) {
+      ++var_nodes[node->Name()];
+    }
+  }
+
+  auto foldable = [&](Node* op) {
+    if (op->Op() == nullptr) return false;
+    const std::string& type = op->Op()->Type();
+    if (UnfoldableOps().count(type) || HasSubBlock(*op->Op()) ||
+        !HasCPUKernel(type)) {
+      return false;
+    }
+    if (op->inputs.empty() && !ConstantSourceOps().count(type)) {
+      return false;
+    }
+    if (op->outputs.empty()) return false;
+    for (auto* in : op->inputs) {
+      if (!IsConstant(in, *scope)) return false;
+    }
+    for (auto* out : op->outputs) {
+      if (!IsLoDTensorVar(out) || out->Var()->Persistable() ||
+          var_nodes[out->Name()] != 1 || scope->FindVar(out->Name())) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  // The ops are visited in topological order, so a chain of constant ops,
+  // such as fill_constant and cast, is folded in one sweep.
+  int found_count = 0;
+  for (auto* op : TopologySortOperations(*graph)) {
+    if (!foldable(op)) continue;
+
+    for (auto* out : op->outputs) {
+      scope->Var(out->Name())->GetMutable<LoDTensor>();
+    }
+    auto op_base = OpRegistry::CreateOp(*op->Op());
+    op_base->Run(*scope, platform::CPUPlace());
+
+    bool complete = true;
+    for (auto* out : op->outputs) {
+      if (!out->outputs.empty() &&
+          !scope->FindVar(out->Name())->Get<LoDTensor>().IsInitialized()) {
+        complete = false;
+      }
+    }
+    if (!complete) {
+      // Some output used by the graph, such as a LoDTensor with only the
+      // dims, has no data to be stored.
+      std::vector<std::string> names;
+      for (auto* out : op->outputs) names.push_back(out->Name());
+      scope->EraseVars(names);
+      continue;
+    }
+
+    std::unordered_set<const Node*> nodes2rm = {op};
+    for (auto* out : op->outputs) {
+      out->inputs.clear();
+      if (out->outputs.empty()) {
+        // Such as the XShape of transpose2, which nothing reads.
+        scope->EraseVars({out->Name()});
+        nodes2rm.insert(out);
+      } else {
+        auto& tensor = scope->FindVar(out->Name())->Get<LoDTensor>();
+        out->Var()->SetPersistable(true);
+        out->Var()->SetShape(phi::vectorize(tensor.dims()));
+        out->Var()->SetDataType(framework::TransToProtoVarType(tensor.dtype()));
+      }
+    }
+    for (auto* in : op->inputs) {
+      in->outputs.erase(std::remove(in->outputs.begin(), in->outputs.end(), op),
+                        in->outputs.end());
+      if (in->outputs.empty() && var_nodes[in->Name()] == 1) {
+        scope->EraseVars({in->Name()});
+        nodes2rm.insert(in);
+      }
+    }
+    for (auto* node : nodes2rm) {
+      if (node->IsVar()) --var_nodes[node->Name()];
+      graph->RemoveNode(const_cast<Node*>(node));
+    }
+    ++found_count;
+  }
+  AddStatis(found_count);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(constant_folding_pass,
+              paddle::framework::ir::ConstantFoldingPass);
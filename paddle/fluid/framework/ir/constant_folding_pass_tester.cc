@@ -0,0 +1,95 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/constant_folding_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/phi/core/kernel_registry.h"
+
+USE_OP_ITSELF(transpose2);
+USE_OP_ITSELF(scale);
+
+PD_DECLARE_KERNEL(transpose, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(scale, CPU, ALL_LAYOUT);
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+TEST(ConstantFoldingPass, basic) {
+  // inputs                     operator            output
+  // --------------------------------------------------------
+  // w                          transpose2       -> w_t, xshape
+  // w_t                        scale            -> w_s
+  // x                          relu             -> relu_out
+  // (relu_out, w_s)            mul              -> mul_out
+  Layers layers;
+  auto* x = layers.data("x", {4, 3});
+  auto* w = layers.data("w", {2, 3}, true);
+  auto* w_t = layers.transpose2(w, {1, 0}, true);
+  auto* w_s = layers.scale(w_t, 2.f, 1.f, true);
+  auto* relu_out = layers.relu(x);
+  layers.mul(relu_out, w_s);
+
+  Scope scope;
+  auto* w_tensor = scope.Var("w")->GetMutable<LoDTensor>();
+  w_tensor->Resize({2, 3});
+  float* w_data = w_tensor->mutable_data<float>(platform::CPUPlace());
+  for (int i = 0; i < 6; ++i) {
+    w_data[i] = static_cast<float>(i);
+  }
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(layers.main_program()));
+  graph->SetNotOwned("__param_scope__", &scope);
+  auto pass = PassRegistry::Instance().Get("constant_folding_pass");
+  graph.reset(pass->Apply(graph.release()));
+  VLOG(3) << DebugString(graph);
+
+  // The transpose2 and scale of the weight are folded into w_s, and the
+  // relu of the input is not.
+  EXPECT_EQ(GetNumOpNodes(graph, "transpose2"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "scale"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "relu"), 1);
+  EXPECT_EQ(GetNumOpNodes(graph, "mul"), 1);
+  for (auto* node : graph->Nodes()) {
+    EXPECT_NE(node->Name(), "w");
+    EXPECT_NE(node->Name(), w_t->Name());
+    if (node->IsVar() && node->Name() == w_s->Name()) {
+      EXPECT_TRUE(node->Var()->Persistable());
+      EXPECT_TRUE(node->inputs.empty());
+      EXPECT_EQ(node->Var()->GetShape(), std::vector<int64_t>({3, 2}));
+    }
+  }
+
+  EXPECT_EQ(scope.FindVar("w"), nullptr);
+  EXPECT_EQ(scope.FindVar(w_t->Name()), nullptr);
+  auto* folded = scope.FindVar(w_s->Name());
+  ASSERT_NE(folded, nullptr);
+  auto& w_s_tensor = folded->Get<LoDTensor>();
+  ASSERT_EQ(w_s_tensor.dims(), phi::make_ddim({3, 2}));
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      EXPECT_EQ(w_s_tensor.data<float>()[i * 2 + j],
+                2.f * static_cast<float>(j * 3 + i) + 1.f);
+    }
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(constant_folding_pass);
@@ -14,8 +14,15 @@
 
 #include "paddle/fluid/framework/ir/cost_model.h"
 
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
 #include <memory>
+#include <sstream>
+#include <utility>
+#include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/platform/errors.h"
 #include "paddle/fluid/platform/place.h"
@@ -34,6 +41,9 @@ CostData::~CostData() {
   // here.
 }
 
+bool CostData::IsOpMeasured(int op_id) const {
+  return op_time_ms_.count(op_id) > 0;
+}
 double CostData::GetOpTimeMs(int op_id) const { return op_time_ms_.at(op_id); }
 double CostData::GetOpMemoryBytes(int op_id) const {
   return op_memory_bytes_.at(op_id);
@@ -245,7 +255,10 @@ CostData CostModel::ProfileMeasure(
   // TODO(zhhsplendid): handle the case that Profiler is already enabled
   SetTracerOption(platform::TracerOption::kAllOpDetail);
   EnableProfiler(profiler_state);
-  executor.Run(main_program, &scope, /*block_id = */ 0);
+  // Keep the vars in scope after the run for their runtime dims
+  executor.Run(main_program, &scope, /*block_id = */ 0,
+               /*create_local_scope = */ false, /*create_vars = */ true,
+               /*skip_ref_cnt_vars = */ {}, /*force_disable_gc = */ true);
 
   std::unique_ptr<std::vector<std::vector<Event>>> time_events(
       new std::vector<std::vector<Event>>());
@@ -262,8 +275,327 @@ CostData CostModel::ProfileMeasure(
   CostData cost_data;
   cost_data.SetCostData(main_program, *time_events);
 
+  if (main_program.Size() > 0) {
+    CostData::VarDims var_dims;
+    for (const VarDesc* var_desc : main_program.Block(0).AllVars()) {
+      const Variable* var = scope.FindVar(var_desc->Name());
+      if (var == nullptr || !var->IsType<LoDTensor>()) {
+        continue;
+      }
+      const LoDTensor& tensor = var->Get<LoDTensor>();
+      if (tensor.IsInitialized()) {
+        var_dims[var_desc->Name()] = phi::vectorize(tensor.dims());
+      }
+    }
+    cost_data.SetVarDims(std::move(var_dims));
+  }
+
   return cost_data;
 }
 
+// The var of a dense tensor, or nullptr for the other vars
+static const VarDesc* FindTensorVar(const BlockDesc& block,
+                                    const std::string& name) {
+  const VarDesc* var = block.FindVarRecursive(name);
+  if (var == nullptr || var->GetType() != proto::VarType::LOD_TENSOR) {
+    return nullptr;
+  }
+  return var;
+}
+
+// The runtime dims of var in var_dims if any, otherwise its VarDesc shape
+static std::vector<int64_t> VarShape(const VarDesc& var,
+                                     const CostData::VarDims* var_dims) {
+  if (var_dims != nullptr) {
+    auto it = var_dims->find(var.Name());
+    if (it != var_dims->end()) {
+      return it->second;
+    }
+  }
+  return var.GetShape();
+}
+
+// The number of the elements of shape from dim begin, with the unknown dims
+// counted as 1
+static int64_t KnownNumel(const std::vector<int64_t>& shape,
+                          size_t begin = 0) {
+  int64_t numel = 1;
+  for (size_t i = begin; i < shape.size(); ++i) {
+    numel *= std::max<int64_t>(shape[i], 1);
+  }
+  return numel;
+}
+
+static double TensorsNumel(const VariableNameMap& vars, const BlockDesc& block,
+                           const CostData::VarDims* var_dims) {
+  double numel = 0;
+  for (auto& it : vars) {
+    for (auto& name : it.second) {
+      const VarDesc* var = FindTensorVar(block, name);
+      if (var != nullptr) {
+        numel += KnownNumel(VarShape(*var, var_dims));
+      }
+    }
+  }
+  return numel;
+}
+
+static double TensorsBytes(const VariableNameMap& vars, const BlockDesc& block,
+                           const CostData::VarDims* var_dims) {
+  double bytes = 0;
+  for (auto& it : vars) {
+    for (auto& name : it.second) {
+      const VarDesc* var = FindTensorVar(block, name);
+      if (var != nullptr) {
+        bytes += static_cast<double>(KnownNumel(VarShape(*var, var_dims))) *
+                 SizeOfType(var->GetDataType());
+      }
+    }
+  }
+  return bytes;
+}
+
+// The shape of the first var of parameter param in vars
+static std::vector<int64_t> ParamShape(const BlockDesc& block,
+                                       const VariableNameMap& vars,
+                                       const std::string& param,
+                                       const CostData::VarDims* var_dims) {
+  auto it = vars.find(param);
+  if (it == vars.end() || it->second.empty()) {
+    return {};
+  }
+  const VarDesc* var = FindTensorVar(block, it->second[0]);
+  return var == nullptr ? std::vector<int64_t>() : VarShape(*var, var_dims);
+}
+
+std::string OpCostTable::Key(const OpDesc& op, const BlockDesc& block,
+                             const std::string& device,
+                             const CostData::VarDims* var_dims) {
+  // Such as "mul X=float32[16,784] Y=float32[784,100] -> Out=float32[16,100]
+  // @cpu"
+  std::ostringstream os;
+  os << op.Type();
+  auto append = [&](const VariableNameMap& vars) {
+    for (auto& it : vars) {
+      os << " " << it.first << "=";
+      for (size_t i = 0; i < it.second.size(); ++i) {
+        if (i > 0) os << ",";
+        const VarDesc* var = FindTensorVar(block, it.second[i]);
+        if (var == nullptr) {
+          os << "?";
+          continue;
+        }
+        os << DataTypeToString(var->GetDataType()) << "[";
+        auto shape = VarShape(*var, var_dims);
+        for (size_t d = 0; d < shape.size(); ++d) {
+          os << (d > 0 ? "," : "") << shape[d];
+        }
+        os << "]";
+      }
+    }
+  };
+  append(op.Inputs());
+  os << " ->";
+  append(op.Outputs());
+  os << " @" << ToLowerCopy(device);
+  return os.str();
+}
+
+void OpCostTable::Update(const ProgramDesc& program, const CostData& cost_data,
+                         const std::string& device) {
+  const BlockDesc& block = program.Block(0);
+  for (size_t i = 0; i < block.OpSize(); ++i) {
+    if (!cost_data.IsOpMeasured(i)) {
+      continue;
+    }
+    const OpDesc& op = *block.Op(i);
+    const CostData::VarDims* var_dims = &cost_data.GetVarDims();
+    Update(Key(op, block, device, var_dims), cost_data.GetOpTimeMs(i),
+           TensorsBytes(op.Outputs(), block, var_dims));
+  }
+}
+
+void OpCostTable::Update(const std::string& key, double time_ms,
+                         double memory_bytes, int64_t count) {
+  PADDLE_ENFORCE_GT(count, 0,
+                    platform::errors::InvalidArgument(
+                        "The count of the measurements of op %s should be "
+                        "positive, but received %d.",
+                        key, count));
+  Entry& entry = entries_[key];
+  const int64_t total = entry.count + count;
+  entry.time_ms = (entry.time_ms * entry.count + time_ms * count) / total;
+  entry.memory_bytes =
+      (entry.memory_bytes * entry.count + memory_bytes * count) / total;
+  entry.count = total;
+}
+
+bool OpCostTable::Find(const std::string& key, OpCost* cost) const {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return false;
+  }
+  cost->time_ms = it->second.time_ms;
+  cost->memory_bytes = it->second.memory_bytes;
+  cost->measured = true;
+  return true;
+}
+
+void OpCostTable::Save(const std::string& path) const {
+  std::ofstream fout(path);
+  PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                    platform::errors::Unavailable(
+                        "Cannot open %s to save the op cost table.", path));
+  fout << std::setprecision(12);
+  for (auto& it : entries_) {
+    fout << it.first << "\t" << it.second.time_ms << "\t"
+         << it.second.memory_bytes << "\t" << it.second.count << "\n";
+  }
+}
+
+void OpCostTable::Load(const std::string& path) {
+  std::ifstream fin(path);
+  PADDLE_ENFORCE_EQ(
+      static_cast<bool>(fin), true,
+      platform::errors::NotFound("Cannot open the op cost table %s.", path));
+  std::string line;
+  while (std::getline(fin, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    std::vector<std::string> fields;
+    std::istringstream is(line);
+    std::string field;
+    while (std::getline(is, field, '\t')) {
+      fields.push_back(field);
+    }
+    PADDLE_ENFORCE_EQ(fields.size(), 4UL,
+                      platform::errors::InvalidArgument(
+                          "The line \"%s\" of the op cost table %s should "
+                          "hold a key, a time, a memory and a count.",
+                          line, path));
+    Update(fields[0], std::stod(fields[1]), std::stod(fields[2]),
+           std::stoll(fields[3]));
+  }
+}
+
+AnalyticCostEstimator::AnalyticCostEstimator(const std::string& device) {
+  // The order of magnitude of a server CPU core group and of a data center
+  // GPU; SetAnalyticEstimator takes the numbers of the actual device.
+  if (ToLowerCopy(device) == "gpu") {
+    gflops_ = 10000;
+    gbytes_per_sec_ = 500;
+    op_overhead_ms_ = 0.01;
+  } else {
+    gflops_ = 100;
+    gbytes_per_sec_ = 20;
+    op_overhead_ms_ = 0.002;
+  }
+}
+
+double AnalyticCostEstimator::Flops(
+    const OpDesc& op, const BlockDesc& block,
+    const CostData::VarDims* var_dims) const {
+  const std::string& type = op.Type();
+  auto int_attr = [&](const std::string& name, int default_value) {
+    return op.HasAttr(name) ? BOOST_GET_CONST(int, op.GetAttr(name))
+                            : default_value;
+  };
+  if (type == "mul" || type == "fc") {
+    // Out[M, N] = X[M, K] * Y[K, N]
+    bool is_mul = type == "mul";
+    auto x = ParamShape(block, op.Inputs(), is_mul ? "X" : "Input", var_dims);
+    int num_col_dims =
+        int_attr(is_mul ? "x_num_col_dims" : "in_num_col_dims", 1);
+    return 2.0 * TensorsNumel(op.Outputs(), block, var_dims) *
+           KnownNumel(x, num_col_dims);
+  }
+  if (type == "matmul" || type == "matmul_v2") {
+    auto x = ParamShape(block, op.Inputs(), "X", var_dims);
+    bool trans_x = op.GetAttrIfExists<bool>(type == "matmul" ? "transpose_X"
+                                                             : "trans_x");
+    int64_t k = 1;
+    if (x.size() == 1) {
+      k = x[0];
+    } else if (x.size() > 1) {
+      k = trans_x ? x[x.size() - 2] : x.back();
+    }
+    return 2.0 * KnownNumel(ParamShape(block, op.Outputs(), "Out", var_dims)) *
+           std::max<int64_t>(k, 1);
+  }
+  if (type == "conv2d" || type == "depthwise_conv2d" || type == "conv3d") {
+    // Each output element takes C / groups * the kernel size of the filter.
+    auto filter = ParamShape(block, op.Inputs(), "Filter", var_dims);
+    auto output = ParamShape(block, op.Outputs(), "Output", var_dims);
+    return 2.0 * KnownNumel(output) * KnownNumel(filter, 1);
+  }
+  // The elementwise ops and the others take about one flop per output.
+  return TensorsNumel(op.Outputs(), block, var_dims);
+}
+
+double AnalyticCostEstimator::AccessBytes(
+    const OpDesc& op, const BlockDesc& block,
+    const CostData::VarDims* var_dims) const {
+  return TensorsBytes(op.Inputs(), block, var_dims) +
+         TensorsBytes(op.Outputs(), block, var_dims);
+}
+
+double AnalyticCostEstimator::OutputBytes(
+    const OpDesc& op, const BlockDesc& block,
+    const CostData::VarDims* var_dims) const {
+  return TensorsBytes(op.Outputs(), block, var_dims);
+}
+
+OpCost AnalyticCostEstimator::Estimate(
+    const OpDesc& op, const BlockDesc& block,
+    const CostData::VarDims* var_dims) const {
+  OpCost cost;
+  double compute_ms = Flops(op, block, var_dims) / (gflops_ * 1e6);
+  double memory_ms =
+      AccessBytes(op, block, var_dims) / (gbytes_per_sec_ * 1e6);
+  cost.time_ms = std::max(compute_ms, memory_ms) + op_overhead_ms_;
+  cost.memory_bytes = OutputBytes(op, block, var_dims);
+  cost.measured = false;
+  return cost;
+}
+
+void CostModel::UpdateCostTable(const ProgramDesc& main_program,
+                                const CostData& cost_data,
+                                const std::string& device) {
+  cost_table_.Update(main_program, cost_data, device);
+}
+
+OpCost CostModel::QueryOpCost(const OpDesc& op, const BlockDesc& block,
+                              const std::string& device,
+                              const CostData::VarDims* var_dims) const {
+  OpCost cost;
+  if (cost_table_.Find(OpCostTable::Key(op, block, device, var_dims), &cost)) {
+    return cost;
+  }
+  auto it = estimators_.find(ToLowerCopy(device));
+  if (it != estimators_.end()) {
+    return it->second.Estimate(op, block, var_dims);
+  }
+  return AnalyticCostEstimator(device).Estimate(op, block, var_dims);
+}
+
+double CostModel::PredictProgramTimeMs(
+    const ProgramDesc& program, const std::string& device,
+    const CostData::VarDims* var_dims) const {
+  const BlockDesc& block = program.Block(0);
+  double time_ms = 0;
+  for (size_t i = 0; i < block.OpSize(); ++i) {
+    time_ms += QueryOpCost(*block.Op(i), block, device, var_dims).time_ms;
+  }
+  return time_ms;
+}
+
+void CostModel::SetAnalyticEstimator(const std::string& device,
+                                     const AnalyticCostEstimator& estimator) {
+  std::string device_lower_case = ToLowerCopy(device);
+  estimators_.erase(device_lower_case);
+  estimators_.emplace(device_lower_case, estimator);
+}
+
 }  // namespace framework
 }  // namespace paddle
@@ -20,6 +20,7 @@
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "paddle/fluid/framework/ir/graph.h"
@@ -34,12 +35,16 @@ namespace framework {
 
 class CostData {
  public:
+  // From the var name to the dims of its tensor at runtime
+  using VarDims = std::map<std::string, std::vector<int64_t>>;
+
   CostData() {}
 
   ~CostData();
 
   // Support global block only
   // TODO(zhhsplendid): add support for sub-block
+  bool IsOpMeasured(int op_id) const;
   double GetOpTimeMs(int op_id) const;
   double GetOpMemoryBytes(int op_id) const;
   double GetWholeTimeMs() const;
@@ -48,6 +53,11 @@ class CostData {
   const ir::Graph* GetGraph() const;
   const ProgramDesc* GetProgram() const;
 
+  // The dims of the dense tensors of the global block after the measured
+  // run, which fill in the dims unknown at compile time, such as the batch.
+  const VarDims& GetVarDims() const { return var_dims_; }
+  void SetVarDims(VarDims var_dims) { var_dims_ = std::move(var_dims); }
+
   // Support Time Event only
   // TODO(zhhsplendid): add memory
   bool SetCostData(
@@ -63,6 +73,7 @@ class CostData {
   std::map<int, double>
       op_memory_bytes_;         // from Op Node id to total memory bytes
   std::map<int, double> comm_;  // from Op Node id to communicate cost
+  VarDims var_dims_;
   double whole_time_ms_{
       NOT_MEASURED};  // time cost of the whole program or graph
   double whole_memory_bytes_{
@@ -71,6 +82,82 @@ class CostData {
       NOT_MEASURED};  // communication cost of the whole program or graph
 };
 
+// The cost of running an op once.
+struct OpCost {
+  double time_ms{CostData::NOT_MEASURED};
+  // The bytes of the outputs of the op
+  double memory_bytes{CostData::NOT_MEASURED};
+  // Whether time_ms is measured, or estimated by AnalyticCostEstimator
+  bool measured{false};
+};
+
+// The measured op costs keyed by the op type, the dtypes and shapes of its
+// inputs and outputs and the device, averaged over the measurements. The
+// table is saved as text, so the measurements of earlier runs can be loaded
+// by the later ones.
+class OpCostTable {
+ public:
+  // The shapes are the dims in var_dims if any, otherwise the VarDesc shapes
+  // where the dims unknown at compile time are -1.
+  static std::string Key(const OpDesc& op, const BlockDesc& block,
+                         const std::string& device,
+                         const CostData::VarDims* var_dims = nullptr);
+
+  // Records the op times in cost_data of the global block of program
+  // measured on device, keyed by the runtime dims of cost_data.
+  void Update(const ProgramDesc& program, const CostData& cost_data,
+              const std::string& device);
+  // count should be positive.
+  void Update(const std::string& key, double time_ms, double memory_bytes,
+              int64_t count = 1);
+
+  bool Find(const std::string& key, OpCost* cost) const;
+  size_t Size() const { return entries_.size(); }
+
+  // Each line holds a key, the time, the memory and the number of the
+  // measurements, separated by tabs. Load merges the entries of path into
+  // the table.
+  void Save(const std::string& path) const;
+  void Load(const std::string& path);
+
+ private:
+  struct Entry {
+    double time_ms{0};
+    double memory_bytes{0};
+    int64_t count{0};
+  };
+  std::map<std::string, Entry> entries_;
+};
+
+// Estimates the time of an op by the roofline of the device: the larger of
+// its FLOPs over the peak FLOPS and its input and output bytes over the
+// memory bandwidth, plus the overhead of running an op. The shapes are the
+// dims in var_dims if any, as in OpCostTable::Key, and the dims unknown at
+// compile time otherwise count as 1.
+class AnalyticCostEstimator {
+ public:
+  explicit AnalyticCostEstimator(const std::string& device);
+  AnalyticCostEstimator(double gflops, double gbytes_per_sec,
+                        double op_overhead_ms)
+      : gflops_(gflops),
+        gbytes_per_sec_(gbytes_per_sec),
+        op_overhead_ms_(op_overhead_ms) {}
+
+  double Flops(const OpDesc& op, const BlockDesc& block,
+               const CostData::VarDims* var_dims = nullptr) const;
+  double AccessBytes(const OpDesc& op, const BlockDesc& block,
+                     const CostData::VarDims* var_dims = nullptr) const;
+  double OutputBytes(const OpDesc& op, const BlockDesc& block,
+                     const CostData::VarDims* var_dims = nullptr) const;
+  OpCost Estimate(const OpDesc& op, const BlockDesc& block,
+                  const CostData::VarDims* var_dims = nullptr) const;
+
+ private:
+  double gflops_;
+  double gbytes_per_sec_;
+  double op_overhead_ms_;
+};
+
 class CostModel {
  public:
   CostModel() {}
@@ -80,6 +167,35 @@ class CostModel {
       const ProgramDesc& main_program, const ProgramDesc& startup_program,
       const std::string& device,
       const std::vector<std::string>& fetch_cost_list) const;
+
+  // Records the op times of a ProfileMeasure of main_program in the table.
+  void UpdateCostTable(const ProgramDesc& main_program,
+                       const CostData& cost_data, const std::string& device);
+
+  // The measured cost of op in the table, otherwise the analytic estimate.
+  // The table is keyed by the runtime dims, so var_dims should hold the dims
+  // of the vars whose shapes are unknown at compile time, such as the
+  // GetVarDims of a measurement with the same inputs.
+  OpCost QueryOpCost(const OpDesc& op, const BlockDesc& block,
+                     const std::string& device,
+                     const CostData::VarDims* var_dims = nullptr) const;
+
+  // The sum of the op costs of the global block of program, which is what
+  // the placement and fusion decisions compare.
+  double PredictProgramTimeMs(
+      const ProgramDesc& program, const std::string& device,
+      const CostData::VarDims* var_dims = nullptr) const;
+
+  // Replaces the default estimator of device.
+  void SetAnalyticEstimator(const std::string& device,
+                            const AnalyticCostEstimator& estimator);
+
+  const OpCostTable& GetCostTable() const { return cost_table_; }
+  OpCostTable* MutableCostTable() { return &cost_table_; }
+
+ private:
+  OpCostTable cost_table_;
+  std::map<std::string, AnalyticCostEstimator> estimators_;
 };
 
 }  // namespace framework
@@ -13,6 +13,10 @@
 // limitations under the License.
 
 #include "paddle/fluid/framework/ir/cost_model.h"
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <fstream>
+#include <thread>  // NOLINT
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator.h"
@@ -49,10 +53,8 @@ class FakeTestOp : public OperatorBase {
       LoDTensor *tensor = var->GetMutable<LoDTensor>();
       tensor->mutable_data<float>(place);
     }
-    int count = 0;
-    while (count <= 1000) {
-      ++count;
-    }
+    // Long enough for the op times to outweigh the overhead of the executor
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
   }
 };
 
@@ -141,6 +143,153 @@ TEST(CostModelTest, TestProfileMeasure_UnsupportedDevice) {
                paddle::platform::EnforceNotMet);
 }
 
+TEST(CostModelTest, TestPredictProgramTime) {
+  CostModel cost_model;
+  ProgramDesc program = CreateTestProgram();
+  ProgramDesc empty_program;
+  const BlockDesc &block = program.Block(0);
+
+  // Estimated before any measurement
+  OpCost estimated = cost_model.QueryOpCost(*block.Op(0), block, "cpu");
+  EXPECT_FALSE(estimated.measured);
+  EXPECT_GT(estimated.time_ms, 0);
+  EXPECT_GT(cost_model.PredictProgramTimeMs(program, "cpu"), 0);
+
+  CostData cost_data =
+      cost_model.ProfileMeasure(program, empty_program, "cpu", {"time"});
+  cost_model.UpdateCostTable(program, cost_data, "cpu");
+  EXPECT_EQ(cost_model.GetCostTable().Size(), 2UL);
+  const CostData::VarDims *var_dims = &cost_data.GetVarDims();
+  OpCost measured =
+      cost_model.QueryOpCost(*block.Op(0), block, "CPU", var_dims);
+  EXPECT_TRUE(measured.measured);
+  EXPECT_DOUBLE_EQ(measured.time_ms, cost_data.GetOpTimeMs(0));
+  EXPECT_FALSE(
+      cost_model.QueryOpCost(*block.Op(0), block, "gpu", var_dims).measured);
+
+  // The ops take most of the whole time of the program.
+  double predicted_ms =
+      cost_model.PredictProgramTimeMs(program, "cpu", var_dims);
+  double actual_ms = cost_data.GetWholeTimeMs();
+  LOG(INFO) << "Predicted program time: " << predicted_ms
+            << " ms, actual program time: " << actual_ms << " ms.";
+  ASSERT_GT(actual_ms, 0);
+  EXPECT_LT(std::abs(predicted_ms - actual_ms) / actual_ms, 0.5);
+}
+
+TEST(OpCostTableTest, TestKeyRuntimeDims) {
+  ProgramDesc program = CreateTestProgram();
+  BlockDesc *block = program.MutableBlock(0);
+  block->Var("X")->SetShape({-1, 784});
+  const OpDesc &op = *block->Op(0);
+  CostData::VarDims var_dims = {{"X", {16, 784}}};
+
+  std::string key = OpCostTable::Key(op, *block, "cpu", &var_dims);
+  EXPECT_NE(key.find("X=float32[16,784]"), std::string::npos);
+  EXPECT_NE(OpCostTable::Key(op, *block, "cpu").find("X=float32[-1,784]"),
+            std::string::npos);
+
+  CostModel cost_model;
+  cost_model.MutableCostTable()->Update(key, 1.0, 64);
+  EXPECT_TRUE(cost_model.QueryOpCost(op, *block, "cpu", &var_dims).measured);
+  EXPECT_FALSE(cost_model.QueryOpCost(op, *block, "cpu").measured);
+}
+
+TEST(OpCostTableTest, TestSaveLoad) {
+  OpCostTable table;
+  table.Update("op_a", 1.0, 16);
+  table.Update("op_a", 3.0, 16);
+  table.Update("op_b", 0.5, 8);
+  const std::string path = "./test_op_cost_table.txt";
+  table.Save(path);
+
+  OpCostTable loaded;
+  loaded.Load(path);
+  ASSERT_EQ(loaded.Size(), 2UL);
+  OpCost cost;
+  ASSERT_TRUE(loaded.Find("op_a", &cost));
+  EXPECT_DOUBLE_EQ(cost.time_ms, 2.0);
+  EXPECT_DOUBLE_EQ(cost.memory_bytes, 16);
+  EXPECT_FALSE(loaded.Find("op_c", &cost));
+
+  // The loaded measurements are merged by their counts.
+  loaded.Update("op_a", 5.0, 16);
+  ASSERT_TRUE(loaded.Find("op_a", &cost));
+  EXPECT_DOUBLE_EQ(cost.time_ms, 3.0);
+
+  EXPECT_THROW(loaded.Load("./not_exist_op_cost_table.txt"),
+               paddle::platform::EnforceNotMet);
+
+  // A count of 0 would divide the averages by 0.
+  EXPECT_THROW(loaded.Update("op_a", 1.0, 16, 0),
+               paddle::platform::EnforceNotMet);
+  const std::string zero_count_path = "./test_op_cost_table_zero_count.txt";
+  {
+    std::ofstream fout(zero_count_path);
+    fout << "op_d\t1.0\t16\t0\n";
+  }
+  EXPECT_THROW(loaded.Load(zero_count_path), paddle::platform::EnforceNotMet);
+  EXPECT_FALSE(loaded.Find("op_d", &cost));
+}
+
+TEST(AnalyticCostEstimatorTest, TestFlops) {
+  ProgramDesc program;
+  auto *block = program.MutableBlock(0);
+  auto add_var = [&](const std::string &name,
+                     const std::vector<int64_t> &shape) {
+    auto *var = block->Var(name);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    var->SetShape(shape);
+  };
+  add_var("x", {-1, 784});
+  add_var("y", {784, 100});
+  add_var("out", {-1, 100});
+  add_var("relu_out", {-1, 100});
+
+  auto *mul = block->AppendOp();
+  mul->SetType("mul");
+  mul->SetInput("X", {"x"});
+  mul->SetInput("Y", {"y"});
+  mul->SetOutput("Out", {"out"});
+  mul->SetAttr("x_num_col_dims", 1);
+  auto *relu = block->AppendOp();
+  relu->SetType("relu");
+  relu->SetInput("X", {"out"});
+  relu->SetOutput("Out", {"relu_out"});
+
+  AnalyticCostEstimator estimator(/*gflops=*/1, /*gbytes_per_sec=*/1,
+                                  /*op_overhead_ms=*/0);
+  EXPECT_DOUBLE_EQ(estimator.Flops(*mul, *block), 2.0 * 100 * 784);
+  EXPECT_DOUBLE_EQ(estimator.Flops(*relu, *block), 100);
+  EXPECT_DOUBLE_EQ(estimator.AccessBytes(*relu, *block), 2 * 100 * 4);
+  EXPECT_DOUBLE_EQ(estimator.OutputBytes(*relu, *block), 100 * 4);
+  // relu is bound by its 800 bytes, and mul by its bytes of y at 1 GB/s
+  EXPECT_DOUBLE_EQ(estimator.Estimate(*relu, *block).time_ms, 800 / 1e6);
+  EXPECT_DOUBLE_EQ(estimator.Estimate(*mul, *block).time_ms,
+                   (784 + 784 * 100 + 100) * 4 / 1e6);
+
+  // and by its flops with a faster memory
+  CostModel cost_model;
+  cost_model.SetAnalyticEstimator("cpu", AnalyticCostEstimator(1, 1000, 0));
+  EXPECT_DOUBLE_EQ(cost_model.QueryOpCost(*mul, *block, "cpu").time_ms,
+                   2.0 * 100 * 784 / 1e6);
+
+  // The runtime dims take the place of the -1 of the batch.
+  CostData::VarDims var_dims = {
+      {"x", {16, 784}}, {"out", {16, 100}}, {"relu_out", {16, 100}}};
+  EXPECT_DOUBLE_EQ(estimator.Flops(*mul, *block, &var_dims),
+                   2.0 * 16 * 100 * 784);
+  EXPECT_DOUBLE_EQ(estimator.Flops(*relu, *block, &var_dims), 16 * 100);
+  EXPECT_DOUBLE_EQ(estimator.AccessBytes(*relu, *block, &var_dims),
+                   2 * 16 * 100 * 4);
+  EXPECT_DOUBLE_EQ(estimator.OutputBytes(*relu, *block, &var_dims),
+                   16 * 100 * 4);
+  EXPECT_DOUBLE_EQ(
+      cost_model.QueryOpCost(*mul, *block, "cpu", &var_dims).time_ms,
+      2.0 * 16 * 100 * 784 / 1e6);
+}
+
 TEST(CostDataTest, TestGetGraphProgram) {
   CostData cost_data;
   EXPECT_EQ(cost_data.GetGraph(), nullptr);
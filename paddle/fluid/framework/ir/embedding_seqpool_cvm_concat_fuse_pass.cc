@@ -0,0 +1,159 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/framework/ir/embedding_seqpool_cvm_concat_fuse_pass.h"
+
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/ir/pass.h"
+#include "paddle/fluid/framework/op_version_registry.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+class Graph;
+class Node;
+
+namespace {
+static void GetFusedConcatNodes(ir::Graph* graph,
+                                std::vector<Node*>* concat_nodes) {
+  GraphPatternDetector gpd;
+  auto* concat_op_node = gpd.mutable_pattern()
+                             ->NewNode("fused_concat_op")
+                             ->assert_is_op("fusion_seqpool_cvm_concat")
+                             ->assert_op_attr<int>("axis", 1);
+  GraphPatternDetector::handle_t handler = [&](
+      const GraphPatternDetector::subgraph_t& subgraph, Graph* graph) {
+    concat_nodes->push_back(subgraph.at(concat_op_node));
+  };
+  gpd(graph, handler);
+}
+
+static Node* FindInput(Node* op, const std::string& name) {
+  for (auto* in : op->inputs) {
+    if (in->IsVar() && in->Name() == name) {
+      return in;
+    }
+  }
+  return nullptr;
+}
+
+// the lookup producing x, or nullptr if it can not be folded
+static Node* GetFusableLookup(Node* x) {
+  if (x == nullptr || x->Var() == nullptr || x->Var()->Persistable() ||
+      x->inputs.size() != 1 || x->outputs.size() != 1) {
+    return nullptr;
+  }
+  Node* lookup = x->inputs[0];
+  if (!lookup->IsOp() || (lookup->Op()->Type() != "lookup_table" &&
+                          lookup->Op()->Type() != "lookup_table_v2")) {
+    return nullptr;
+  }
+  auto* op = lookup->Op();
+  if (op->HasAttr("padding_idx") &&
+      BOOST_GET_CONST(int64_t, op->GetAttr("padding_idx")) != -1) {
+    return nullptr;
+  }
+  if (op->Input("Ids").size() != 1 || op->Input("W").size() != 1) {
+    return nullptr;
+  }
+  // the fused kernel reads int64 ids only
+  Node* ids = FindInput(lookup, op->Input("Ids")[0]);
+  if (ids == nullptr || ids->Var() == nullptr ||
+      ids->Var()->GetDataType() != proto::VarType::INT64 ||
+      FindInput(lookup, op->Input("W")[0]) == nullptr) {
+    return nullptr;
+  }
+  return lookup;
+}
+}  // anonymous namespace
+
+void EmbeddingSeqPoolCVMConcatFusePass::ApplyImpl(ir::Graph* graph) const {
+  FusePassBase::Init(name_scope_, graph);
+  std::vector<Node*> concat_nodes;
+  GetFusedConcatNodes(graph, &concat_nodes);
+
+  int count = 0;
+  for (auto* concat_node : concat_nodes) {
+    auto* concat_op = concat_node->Op();
+    std::vector<Node*> subgraph_ins;
+    std::vector<std::string> ids_names, w_names;
+    std::unordered_set<std::string> unique_w_names;
+    std::unordered_set<const Node*> marked_nodes({concat_node});
+    bool fusable = true;
+    for (auto& x_name : concat_op->Input("X")) {
+      Node* x = FindInput(concat_node, x_name);
+      Node* lookup = GetFusableLookup(x);
+      if (lookup == nullptr) {
+        fusable = false;
+        break;
+      }
+      auto& ids_name = lookup->Op()->Input("Ids")[0];
+      auto& w_name = lookup->Op()->Input("W")[0];
+      ids_names.push_back(ids_name);
+      w_names.push_back(w_name);
+      if (unique_w_names.insert(w_name).second) {
+        subgraph_ins.push_back(FindInput(lookup, w_name));
+      }
+      subgraph_ins.push_back(FindInput(lookup, ids_name));
+      marked_nodes.insert({lookup, x});
+    }
+    if (!fusable || ids_names.empty()) {
+      continue;
+    }
+    // one table shared by all slots is passed once
+    if (unique_w_names.size() == 1) {
+      w_names.resize(1);
+    }
+    Node* cvm_in = FindInput(concat_node, concat_op->Input("CVM")[0]);
+    Node* concat_out = concat_node->outputs[0];
+
+    // Create New OpDesc
+    OpDesc op_desc;
+    op_desc.SetType("fusion_embedding_seqpool_cvm_concat");
+    op_desc.SetInput("Ids", ids_names);
+    op_desc.SetInput("W", w_names);
+    op_desc.SetInput("CVM", {cvm_in->Name()});
+    op_desc.SetAttr("pooltype", concat_op->GetAttr("pooltype"));
+    op_desc.SetAttr("use_cvm", concat_op->GetAttr("use_cvm"));
+    op_desc.SetAttr("axis", concat_op->GetAttr("axis"));
+    op_desc.SetOutput("Out", {concat_out->Name()});
+    auto* op = graph->CreateOpNode(&op_desc);
+
+    for (auto* in : subgraph_ins) {
+      IR_NODE_LINK_TO(in, op);
+    }
+    IR_NODE_LINK_TO(cvm_in, op);
+    IR_NODE_LINK_TO(op, concat_out);
+
+    GraphSafeRemoveNodes(graph, marked_nodes);
+    count++;
+  }
+  AddStatis(count);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(embedding_seqpool_cvm_concat_fuse_pass,
+              paddle::framework::ir::EmbeddingSeqPoolCVMConcatFusePass);
+REGISTER_PASS_CAPABILITY(embedding_seqpool_cvm_concat_fuse_pass)
+    .AddCombination(
+        paddle::framework::compatible::OpVersionComparatorCombination()
+            .LE("lookup_table", 1)
+            .LE("lookup_table_v2", 1));
@@ -0,0 +1,186 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/framework/ir/embedding_seqpool_cvm_concat_fuse_pass.h"
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::vector<std::string>& inputs,
+           const std::vector<std::string>& outputs) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  if (type == "lookup_table") {
+    op->SetInput("Ids", {inputs[0]});
+    op->SetInput("W", {inputs[1]});
+    op->SetOutput("Out", {outputs[0]});
+    op->SetAttr("padding_idx", static_cast<int64_t>(-1));
+  } else if (type == "fusion_seqpool_cvm_concat") {
+    op->SetInput("X", std::vector<std::string>(inputs.begin(),
+                                               inputs.end() - 1));
+    op->SetInput("CVM", {inputs.back()});
+    op->SetOutput("Out", {outputs[0]});
+    op->SetAttr("pooltype", std::string("SUM"));
+    op->SetAttr("use_cvm", true);
+    op->SetAttr("axis", 1);
+  } else {
+    op->SetInput("X", inputs);
+    op->SetOutput("Out", outputs);
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kForward));
+}
+
+int CountOpType(const ir::Graph* graph,
+                const std::string& op_type =
+                    "fusion_embedding_seqpool_cvm_concat") {
+  int count = 0;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == op_type) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+std::unique_ptr<ir::Graph> ApplyPass(std::unique_ptr<ir::Graph> graph,
+                                     int* before, int* after) {
+  auto pass =
+      PassRegistry::Instance().Get("embedding_seqpool_cvm_concat_fuse_pass");
+  *before = graph->Nodes().size();
+  graph.reset(pass->Apply(graph.release()));
+  *after = graph->Nodes().size();
+  return graph;
+}
+
+ProgramDesc BuildProgramDesc(const std::vector<std::string>& vars) {
+  ProgramDesc prog;
+  for (auto& v : vars) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    if (v.find("ids") == 0) {
+      var->SetDataType(proto::VarType::INT64);
+    } else if (v.find("w") == 0) {
+      var->SetPersistable(true);
+    }
+  }
+  return prog;
+}
+
+/*
+ * Before fuse:
+ *
+ *  ids0  w   ids1  w   ids2  w
+ *     \ /       \ /       \ /
+ *     op1       op2       op3
+ *      |         |         |
+ *      a         b         c     n
+ *       \        |        /     /
+ *        fusion_seqpool_cvm_concat
+ *                 |
+ *                 m
+ *
+ * Type of op1, op2 and op3 are lookup_table.
+ *
+ * After fuse:
+ *   ids0   ids1   ids2   w   n
+ *      \     |      |   /   /
+ * fusion_embedding_seqpool_cvm_concat
+ *                 |
+ *                 m
+ */
+TEST(EmbeddingSeqPoolCVMConcatFusePass, basic) {
+  ProgramDesc prog = BuildProgramDesc(
+      {"ids0", "ids1", "ids2", "w", "a", "b", "c", "m", "n"});
+  SetOp(&prog, "lookup_table", {"ids0", "w"}, {"a"});
+  SetOp(&prog, "lookup_table", {"ids1", "w"}, {"b"});
+  SetOp(&prog, "lookup_table", {"ids2", "w"}, {"c"});
+  SetOp(&prog, "fusion_seqpool_cvm_concat", {"a", "b", "c", "n"}, {"m"});
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  int before, after;
+  graph = ApplyPass(std::move(graph), &before, &after);
+  // Remove 7 Nodes: op1, op2, op3, a, b, c, fusion_seqpool_cvm_concat
+  // Add 1 Node: fusion_embedding_seqpool_cvm_concat
+  EXPECT_EQ(after, before - 6);
+  EXPECT_EQ(CountOpType(graph.get()), 1);
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() &&
+        node->Op()->Type() == "fusion_embedding_seqpool_cvm_concat") {
+      EXPECT_EQ(node->Op()->Input("Ids").size(), 3UL);
+      EXPECT_EQ(node->Op()->Input("W").size(), 1UL);
+    }
+  }
+}
+
+/*
+ * Before fuse:
+ *
+ *  ids0  w0  ids1  w1
+ *     \ /       \ /
+ *     op1       op2
+ *      |         |  \
+ *      a         b   op3
+ *       \        |    |
+ *  fusion_seqpool_cvm_concat
+ *
+ * Type of op1 and op2 are lookup_table, b is also used by op3, so nothing
+ * is fused.
+ */
+TEST(EmbeddingSeqPoolCVMConcatFusePass, shared_output) {
+  ProgramDesc prog = BuildProgramDesc(
+      {"ids0", "ids1", "w0", "w1", "a", "b", "d", "m", "n"});
+  SetOp(&prog, "lookup_table", {"ids0", "w0"}, {"a"});
+  SetOp(&prog, "lookup_table", {"ids1", "w1"}, {"b"});
+  SetOp(&prog, "op3", {"b"}, {"d"});
+  SetOp(&prog, "fusion_seqpool_cvm_concat", {"a", "b", "n"}, {"m"});
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  int before, after;
+  graph = ApplyPass(std::move(graph), &before, &after);
+  EXPECT_EQ(after, before);
+  EXPECT_EQ(CountOpType(graph.get()), 0);
+}
+
+TEST(EmbeddingSeqPoolCVMConcatFusePass, multi_tables) {
+  ProgramDesc prog = BuildProgramDesc(
+      {"ids0", "ids1", "w0", "w1", "a", "b", "m", "n"});
+  SetOp(&prog, "lookup_table", {"ids0", "w0"}, {"a"});
+  SetOp(&prog, "lookup_table", {"ids1", "w1"}, {"b"});
+  SetOp(&prog, "fusion_seqpool_cvm_concat", {"a", "b", "n"}, {"m"});
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  int before, after;
+  graph = ApplyPass(std::move(graph), &before, &after);
+  // Remove 5 Nodes: op1, op2, a, b, fusion_seqpool_cvm_concat
+  // Add 1 Node: fusion_embedding_seqpool_cvm_concat
+  EXPECT_EQ(after, before - 4);
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() &&
+        node->Op()->Type() == "fusion_embedding_seqpool_cvm_concat") {
+      EXPECT_EQ(node->Op()->Input("W"),
+                std::vector<std::string>({"w0", "w1"}));
+    }
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(embedding_seqpool_cvm_concat_fuse_pass);
@@ -241,6 +241,13 @@ int FCFusePass::ApplyFCPattern(Graph* graph, bool with_relu) const {
       desc.SetAttr("Input_scale", mul_op_desc->GetAttr("Input_scale"));
     }
 
+    // The scale of the input set by delete_quant_dequant_linear_op_pass,
+    // which the CPU fc uses to run the int8 gemm.
+    const std::string x_scale = "Input_scale_" + subgraph.at(x)->Name();
+    if (mul_op_desc->HasAttr(x_scale)) {
+      desc.SetAttr(x_scale, mul_op_desc->GetAttr(x_scale));
+    }
+
     bool inscale_flag = false;
     bool outscale_flag = false;
 
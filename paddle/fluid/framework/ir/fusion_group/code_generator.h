@@ -32,7 +32,9 @@ class SubGraph;
 
 class CodeGenerator {
  public:
-  CodeGenerator();
+  // The code is generated for CUDA by default, or for the CPUDeviceCode if
+  // use_cpu is true.
+  explicit CodeGenerator(bool use_cpu = false);
 
   std::string Generate(std::string func_name,
                        const std::vector<OperationExpression>& expressions);
@@ -56,6 +58,10 @@ class CodeGenerator {
       const std::set<int>& input_ids, const std::set<int>& output_ids,
       const std::set<int>& intermediate_ids,
       const std::unordered_map<int, std::string>& dtypes) const;
+  std::string EmitCPUParameters(
+      const std::set<int>& input_ids, const std::set<int>& output_ids,
+      const std::set<int>& intermediate_ids,
+      const std::unordered_map<int, std::string>& dtypes) const;
 
   std::string EmitComputeBody(
       const std::vector<OperationExpression>& expressions,
@@ -67,6 +73,7 @@ class CodeGenerator {
   std::unordered_map<Node*, int> EncodeVarNodes(SubGraph* subgraph);
 
  private:
+  bool use_cpu_;
   std::vector<CodeTemplate> code_templates_;
 };
 
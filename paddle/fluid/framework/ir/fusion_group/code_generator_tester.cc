@@ -21,13 +21,12 @@ limitations under the License. */
 #include "paddle/fluid/framework/ir/pass_tester_helper.h"
 #include "paddle/fluid/platform/device_code.h"
 #include "paddle/fluid/platform/float16.h"
+#include "paddle/fluid/platform/init.h"
 
 namespace phi {
 class DenseTensor;
 }  // namespace phi
 
-#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
-
 namespace paddle {
 namespace framework {
 namespace ir {
@@ -169,6 +168,36 @@ void SetupRandomCPUTensor(LoDTensor* tensor) {
 
 namespace fusion_group = paddle::framework::ir::fusion_group;
 
+// The CPU kernel writes the outputs into cpu_tensors directly.
+void TestCPUMainImpl(std::string func_name, std::string code_str,
+                     std::vector<paddle::framework::LoDTensor> cpu_tensors,
+                     int n, std::vector<int> input_ids,
+                     std::vector<int> output_ids) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceCode device_code(place, func_name, code_str);
+  EXPECT_EQ(device_code.Compile(), true);
+
+  std::vector<float*> cpu_ptrs(cpu_tensors.size());
+  std::vector<void*> args;
+  args.push_back(&n);
+
+  for (auto id : input_ids) {
+    if (id >= 0) {
+      fusion_group::SetupRandomCPUTensor<float>(&cpu_tensors[id]);
+      cpu_ptrs[id] = cpu_tensors[id].data<float>();
+      args.push_back(&cpu_ptrs[id]);
+    }
+  }
+
+  for (auto id : output_ids) {
+    cpu_ptrs[id] = cpu_tensors[id].mutable_data<float>(place);
+    args.push_back(&cpu_ptrs[id]);
+  }
+
+  device_code.Launch(n, &args);
+}
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 template <typename T>
 void TestMainImpl(std::string func_name, std::string code_str,
                   std::vector<paddle::framework::LoDTensor> cpu_tensors, int n,
@@ -248,12 +277,13 @@ void TestMainImpl(std::string func_name, std::string code_str,
     }
   }
 }
+#endif
 
 void TestElementwiseMain(
     std::string func_name, std::string code_str,
     std::vector<fusion_group::OperationExpression> expressions,
     std::vector<int> input_ids, std::vector<int> output_ids,
-    std::string dtype) {
+    std::string dtype, bool use_cpu) {
   std::unordered_set<int> ids;
   for (auto id : input_ids) {
     ids.insert(id);
@@ -271,12 +301,19 @@ void TestElementwiseMain(
   }
 
   int n = cpu_tensors[0].numel();
-  if (dtype == "__half") {
-    TestMainImpl<paddle::platform::float16>(func_name, code_str, cpu_tensors, n,
-                                            input_ids, output_ids);
+  if (use_cpu) {
+    TestCPUMainImpl(func_name, code_str, cpu_tensors, n, input_ids,
+                    output_ids);
   } else {
-    TestMainImpl<float>(func_name, code_str, cpu_tensors, n, input_ids,
-                        output_ids);
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+    if (dtype == "__half") {
+      TestMainImpl<paddle::platform::float16>(func_name, code_str, cpu_tensors,
+                                              n, input_ids, output_ids);
+    } else {
+      TestMainImpl<float>(func_name, code_str, cpu_tensors, n, input_ids,
+                          output_ids);
+    }
+#endif
   }
 
   // Check the results
@@ -290,21 +327,22 @@ void TestElementwiseMain(
 void TestMain(std::string func_name,
               std::vector<fusion_group::OperationExpression> expressions,
               std::vector<int> input_ids, std::vector<int> output_ids,
-              std::string dtype) {
+              std::string dtype, bool use_cpu = false) {
   fusion_group::OperationMap::Init();
-  fusion_group::CodeGenerator code_generator;
+  fusion_group::CodeGenerator code_generator(use_cpu);
   std::string code_str = code_generator.Generate(func_name, expressions);
   VLOG(3) << code_str;
 
   LOG(INFO) << "dtype: " << dtype;
   TestElementwiseMain(func_name, code_str, expressions, input_ids, output_ids,
-                      dtype);
+                      dtype, use_cpu);
 }
 
 void TestMain(fusion_group::SubGraph* subgraph, std::vector<int> input_ids,
-              std::vector<int> output_ids, std::string dtype) {
+              std::vector<int> output_ids, std::string dtype,
+              bool use_cpu = false) {
   fusion_group::OperationMap::Init();
-  fusion_group::CodeGenerator code_generator;
+  fusion_group::CodeGenerator code_generator(use_cpu);
   std::string code_str = code_generator.Generate(subgraph);
   VLOG(3) << code_str;
 
@@ -313,9 +351,16 @@ void TestMain(fusion_group::SubGraph* subgraph, std::vector<int> input_ids,
       code_generator.ConvertToExpressions(subgraph);
 
   TestElementwiseMain(subgraph->GetFuncName(), code_str, expressions, input_ids,
-                      output_ids, dtype);
+                      output_ids, dtype, use_cpu);
 }
 
+bool IsCPUCompilerAvailable() {
+  paddle::framework::InitDevices();
+  paddle::platform::CPUDeviceCode::CheckAvailableStatus();
+  return paddle::platform::CPUDeviceCode::IsAvailable();
+}
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 TEST(code_generator, elementwise) {
   for (std::string dtype : {"float", "__half"}) {
     // t2 = t0 * t1
@@ -368,6 +413,50 @@ TEST(code_generator, elementwise_grad) {
              dtype);
   }
 }
+#endif
+
+// The CPU code only supports float and double, and the host reference is
+// computed in float.
+TEST(code_generator, elementwise_cpu) {
+  if (!IsCPUCompilerAvailable()) {
+    return;
+  }
+
+  std::string dtype = "float";
+  fusion_group::OperationExpression exp1("elementwise_mul", {0, 1}, {2}, dtype,
+                                         dtype);
+  fusion_group::OperationExpression exp2("elementwise_add", {2, 3}, {4}, dtype,
+                                         dtype);
+  fusion_group::OperationExpression exp3("elementwise_sub", {4, 5}, {6}, dtype,
+                                         dtype);
+  fusion_group::OperationExpression exp4("relu", {6}, {7}, dtype, dtype);
+  fusion_group::OperationExpression exp5("sigmoid", {7}, {8}, dtype, dtype);
+  std::vector<fusion_group::OperationExpression> expressions = {
+      exp1, exp2, exp3, exp4, exp5};
+
+  std::vector<int> input_ids = {0, 1, 3, 5};
+  std::vector<int> output_ids = {2, 4, 6, 7, 8};
+  TestMain("elementwise_cpu_kernel_0", expressions, input_ids, output_ids,
+           dtype, true);
+}
+
+TEST(code_generator, elementwise_grad_cpu) {
+  if (!IsCPUCompilerAvailable()) {
+    return;
+  }
+
+  std::string dtype = "float";
+  fusion_group::OperationExpression exp1("relu_grad", {-1, 3, 7}, {6}, dtype,
+                                         dtype);
+  fusion_group::OperationExpression exp2("elementwise_mul_grad", {0, 1, 2, 6},
+                                         {4, 5}, dtype, dtype);
+  std::vector<fusion_group::OperationExpression> expressions = {exp1, exp2};
+
+  std::vector<int> input_ids = {0, 1, 2, 3, 7};
+  std::vector<int> output_ids = {4, 5, 6};
+  TestMain("elementwise_grad_cpu_kernel_0", expressions, input_ids, output_ids,
+           dtype, true);
+}
 
 std::unique_ptr<paddle::framework::ir::Graph> BuildGraph(bool backward,
                                                          std::string dtype) {
@@ -463,6 +552,7 @@ std::unordered_set<paddle::framework::ir::Node*> DistilGradNodes(
   return grad_nodes;
 }
 
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 TEST(code_generator, subgraph) {
   for (std::string dtype : {"float", "__half"}) {
     std::unique_ptr<paddle::framework::ir::Graph> graph =
@@ -501,3 +591,33 @@ TEST(code_generator, subgraph_grad) {
   }
 }
 #endif
+
+TEST(code_generator, subgraph_cpu) {
+  if (!IsCPUCompilerAvailable()) {
+    return;
+  }
+
+  std::unique_ptr<paddle::framework::ir::Graph> graph =
+      BuildGraph(false, "float");
+  fusion_group::SubGraph subgraph(0, "elementwise_cpu_kernel_1", true,
+                                  graph->Nodes());
+
+  std::vector<int> input_ids = {0, 1, 2, 3};
+  std::vector<int> output_ids = {4, 5, 6, 7, 8};
+  TestMain(&subgraph, input_ids, output_ids, "float", true);
+}
+
+TEST(code_generator, subgraph_grad_cpu) {
+  if (!IsCPUCompilerAvailable()) {
+    return;
+  }
+
+  std::unique_ptr<paddle::framework::ir::Graph> graph =
+      BuildGraph(true, "float");
+  fusion_group::SubGraph subgraph(0, "elementwise_grad_cpu_kernel_1", true,
+                                  DistilGradNodes(graph));
+
+  std::vector<int> input_ids = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  std::vector<int> output_ids = {10, 11, 12, 13, 14, 15, 16, 17};
+  TestMain(&subgraph, input_ids, output_ids, "float", true);
+}
@@ -43,16 +43,31 @@ void FusionGroupPass::ApplyImpl(ir::Graph* graph) const {
     // }
 
     fusion_group::OperationMap::Init();
-    int num_elementwise_groups = DetectFusionGroup(graph, 0);
+    int num_elementwise_groups =
+        DetectFusionGroup(graph, platform::CUDAPlace(0), 0);
     AddStatis(num_elementwise_groups);
     LOG(INFO) << "Detect " << num_elementwise_groups
               << " elementwise fusion groups.";
+  } else {
+    platform::CPUPlace place;
+    platform::DeviceCodePool::Init({place});
+    if (!platform::CPUDeviceCode::IsAvailable()) {
+      LOG(WARNING) << "Disable fusion_group on CPU because the C++ compiler "
+                      "is not available.";
+      return;
+    }
+
+    fusion_group::OperationMap::Init();
+    int num_elementwise_groups = DetectFusionGroup(graph, place, 0);
+    AddStatis(num_elementwise_groups);
+    LOG(INFO) << "Detect " << num_elementwise_groups
+              << " elementwise fusion groups on CPU.";
   }
 }
 
-int FusionGroupPass::DetectFusionGroup(Graph* graph, int type) const {
-  // TODO(liuyiqun): supported different places
-  platform::CUDAPlace place = platform::CUDAPlace(0);
+int FusionGroupPass::DetectFusionGroup(Graph* graph,
+                                       const platform::Place& place,
+                                       int type) const {
   int index = platform::DeviceCodePool::Init({place}).size(place);
 
   std::vector<std::vector<Node*>> subgraphs =
@@ -69,7 +84,7 @@ int FusionGroupPass::DetectFusionGroup(Graph* graph, int type) const {
 
     if (subgraph.IsValid(min_subgraph_size)) {
       subgraph.SetFuncName("fused_elementwise_" + std::to_string(index++));
-      if (GenerateCode(&subgraph)) {
+      if (GenerateCode(&subgraph, place)) {
         InsertFusionGroupOp(graph, &subgraph);
         num_subgraphs++;
       }
@@ -78,15 +93,42 @@ int FusionGroupPass::DetectFusionGroup(Graph* graph, int type) const {
   return num_subgraphs;
 }
 
-bool FusionGroupPass::GenerateCode(fusion_group::SubGraph* subgraph) const {
-  fusion_group::CodeGenerator code_generator;
+// The float16 code is only generated for CUDA.
+static bool HasFP16Var(fusion_group::SubGraph* subgraph) {
+  for (auto* n : subgraph->Nodes()) {
+    if (n && n->IsVar() && n->Var() &&
+        n->Var()->GetDataType() == proto::VarType::FP16) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool FusionGroupPass::GenerateCode(fusion_group::SubGraph* subgraph,
+                                   const platform::Place& place) const {
+  bool use_cpu = platform::is_cpu_place(place);
+  if (use_cpu && HasFP16Var(subgraph)) {
+    return false;
+  }
+  fusion_group::CodeGenerator code_generator(use_cpu);
   std::string code_str = code_generator.Generate(subgraph);
   VLOG(4) << code_str;
 
-  // TODO(liuyiqun): supported different places
-  platform::CUDAPlace place = platform::CUDAPlace(0);
-  std::unique_ptr<platform::CUDADeviceCode> device_code(
-      new platform::CUDADeviceCode(place, subgraph->GetFuncName(), code_str));
+  std::unique_ptr<platform::DeviceCode> device_code;
+  if (use_cpu) {
+    std::unique_ptr<platform::CPUDeviceCode> cpu_device_code(
+        new platform::CPUDeviceCode(place, subgraph->GetFuncName(), code_str));
+    // An element is loaded, computed and stored by a few cycles of each op.
+    cpu_device_code->SetCostPerElement(4.0 * subgraph->GetNumOperations());
+    device_code = std::move(cpu_device_code);
+  } else {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+    device_code.reset(
+        new platform::CUDADeviceCode(place, subgraph->GetFuncName(), code_str));
+#else
+    return false;
+#endif
+  }
   bool is_compiled = device_code->Compile();
   if (is_compiled) {
     platform::DeviceCodePool& pool = platform::DeviceCodePool::Init({place});
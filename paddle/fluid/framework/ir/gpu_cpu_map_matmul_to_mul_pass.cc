@@ -302,6 +302,11 @@ void GpuCpuMapMatmul2MulPass::ApplyImpl(ir::Graph* graph) const {
         desc.SetAttr("out_threshold",
                      matmul_op->Op()->GetAttr("out_threshold"));
       }
+      // set by delete_quant_dequant_linear_op_pass
+      const std::string x_scale = "Input_scale_" + matmul_in_x->Name();
+      if (matmul_op->Op()->HasAttr(x_scale)) {
+        desc.SetAttr(x_scale, matmul_op->Op()->GetAttr(x_scale));
+      }
       auto mul_node = g->CreateOpNode(&desc);
       IR_NODE_LINK_TO(matmul_in_x, mul_node);
       IR_NODE_LINK_TO(matmul_in_y, mul_node);
@@ -375,6 +380,11 @@ void GpuCpuMapMatmulV2ToMulPass::ApplyImpl(ir::Graph* graph) const {
         desc.SetAttr("out_threshold",
                      matmul_v2_op->Op()->GetAttr("out_threshold"));
       }
+      // set by delete_quant_dequant_linear_op_pass
+      const std::string x_scale = "Input_scale_" + matmul_v2_in_x->Name();
+      if (matmul_v2_op->Op()->HasAttr(x_scale)) {
+        desc.SetAttr(x_scale, matmul_v2_op->Op()->GetAttr(x_scale));
+      }
       auto mul_node = g->CreateOpNode(&desc);
       IR_NODE_LINK_TO(matmul_v2_in_x, mul_node);
       IR_NODE_LINK_TO(matmul_v2_in_y, mul_node);
@@ -452,6 +462,11 @@ void GpuCpuMapMatmulV2ToMatmulPass::ApplyImpl(ir::Graph* graph) const {
       desc.SetAttr("out_threshold",
                    matmul_v2_op->Op()->GetAttr("out_threshold"));
     }
+    // set by delete_quant_dequant_linear_op_pass
+    const std::string x_scale = "Input_scale_" + matmul_v2_in_x->Name();
+    if (matmul_v2_op->Op()->HasAttr(x_scale)) {
+      desc.SetAttr(x_scale, matmul_v2_op->Op()->GetAttr(x_scale));
+    }
     auto matmul_node = g->CreateOpNode(&desc);
     IR_NODE_LINK_TO(matmul_v2_in_x, matmul_node);
     IR_NODE_LINK_TO(matmul_v2_in_y, matmul_node);
@@ -96,15 +96,71 @@ void GraphPatternDetector::operator()(Graph *graph,
   }
 }
 
+// The nodes which might be told by a PDNode with the op type hint, found in
+// the op nodes of the graph indexed by type.
+static std::vector<Node *> HintedNodes(
+    const PDNode::OpTypeHint &hint,
+    const std::unordered_map<std::string, std::vector<Node *>> &ops_by_type) {
+  std::vector<Node *> nodes;
+  for (auto &op_type : hint.op_types) {
+    auto it = ops_by_type.find(op_type);
+    if (it == ops_by_type.end()) continue;
+    for (auto *op : it->second) {
+      switch (hint.link) {
+        case PDNode::OpLink::kIsOp:
+          nodes.push_back(op);
+          break;
+        case PDNode::OpLink::kInputOf:
+          nodes.insert(nodes.end(), op->inputs.begin(), op->inputs.end());
+          break;
+        case PDNode::OpLink::kOutputOf:
+          nodes.insert(nodes.end(), op->outputs.begin(), op->outputs.end());
+          break;
+      }
+    }
+  }
+  return nodes;
+}
+
 bool GraphPatternDetector::MarkPDNodesInGraph(const ir::Graph &graph) {
   VLOG(3) << "mark pdnodes in graph";
   if (graph.Nodes().empty()) return false;
 
-  for (auto &node : GraphTraits::DFS(graph)) {
-    for (const auto &pdnode : pattern_.nodes()) {
-      if (pdnode->Tell(&node)) {
-        VLOG(4) << "Node " << node.Name() << " marked as " << pdnode->name();
-        pdnodes2nodes_[pdnode.get()].insert(&node);
+  // Most PDNodes are asserted to be linked to the ops of some types, so only
+  // the nodes linked to these ops are told, which are found in the ops of the
+  // graph indexed by type. The index is built in one pass over the nodes
+  // here, since the passes rewrite the op descs and links of the graph in
+  // place.
+  std::unordered_map<std::string, std::vector<Node *>> ops_by_type;
+  for (auto *node : graph.Nodes()) {
+    if (node->IsOp() && node->Op()) {
+      ops_by_type[node->Op()->Type()].push_back(node);
+    }
+  }
+
+  for (const auto &pdnode : pattern_.nodes()) {
+    const auto &hints = pdnode->op_type_hints();
+    std::vector<Node *> candidates;
+    if (hints.empty()) {
+      candidates.assign(graph.Nodes().begin(), graph.Nodes().end());
+    } else {
+      // All the hints hold for a matched node, use the most selective one.
+      candidates = HintedNodes(hints.front(), ops_by_type);
+      for (size_t i = 1; i < hints.size() && !candidates.empty(); ++i) {
+        auto nodes = HintedNodes(hints[i], ops_by_type);
+        if (nodes.size() < candidates.size()) {
+          candidates.swap(nodes);
+        }
+      }
+    }
+    std::set<Node *> *marked = nullptr;
+    for (auto *node : candidates) {
+      if (pdnode->Tell(node)) {
+        VLOG(4) << "Node " << node->Name() << " marked as " << pdnode->name();
+        if (marked == nullptr) {
+          marked = &pdnodes2nodes_[pdnode.get()];
+        }
+        marked->insert(node);
       }
     }
   }
@@ -188,53 +244,137 @@ bool IsNodesLink(Node *a, Node *b) {
   return false;
 }
 
+std::vector<std::pair<PDNode *, PDNode *>>
+GraphPatternDetector::SortEdgesBySelectivity() {
+  auto num_candidates = [&](PDNode *pdnode) -> size_t {
+    auto it = pdnodes2nodes_.find(pdnode);
+    return it == pdnodes2nodes_.end() ? 0UL : it->second.size();
+  };
+  std::vector<std::pair<PDNode *, PDNode *>> edges(pattern_.edges().begin(),
+                                                   pattern_.edges().end());
+  std::vector<std::pair<PDNode *, PDNode *>> sorted;
+  std::vector<bool> added(edges.size(), false);
+  std::unordered_set<PDNode *> bound;
+  while (sorted.size() < edges.size()) {
+    // the first edge linked to the bound PDNodes, preferring the edges of two
+    // bound ones, which only filter the records
+    int next = -1;
+    int rank = 0;
+    for (size_t i = 0; i < edges.size() && rank < 2; ++i) {
+      if (added[i]) continue;
+      int r = static_cast<int>(bound.count(edges[i].first)) +
+              static_cast<int>(bound.count(edges[i].second));
+      if (r > rank) {
+        next = i;
+        rank = r;
+      }
+    }
+    if (next < 0) {
+      // a new component of the pattern, anchored at its most selective node
+      size_t fewest = 0;
+      for (size_t i = 0; i < edges.size(); ++i) {
+        if (added[i]) continue;
+        size_t n = std::min(num_candidates(edges[i].first),
+                            num_candidates(edges[i].second));
+        if (next < 0 || n < fewest) {
+          next = i;
+          fewest = n;
+        }
+      }
+    }
+    added[next] = true;
+    bound.insert(edges[next].first);
+    bound.insert(edges[next].second);
+    sorted.push_back(edges[next]);
+  }
+  return sorted;
+}
+
+// The unique nodes of a list of links.
+static std::vector<Node *> UniqueLinks(const std::vector<Node *> &links) {
+  std::vector<Node *> nodes(links);
+  std::sort(nodes.begin(), nodes.end(), std::less<Node *>());
+  nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+  return nodes;
+}
+
 std::vector<GraphPatternDetector::subgraph_t>
 GraphPatternDetector::DetectPatterns() {
   // Init empty subgraphs.
   std::vector<GraphPatternDetector::subgraph_t> result;
-  std::vector<HitGroup> init_groups;
   std::array<std::vector<HitGroup>, 2> bi_records;
-  auto *first_pnode = pattern_.edges().empty() ? pattern().nodes().front().get()
-                                               : pattern_.edges().front().first;
-  if (!pdnodes2nodes_.count(first_pnode)) return result;
-  for (auto *node : pdnodes2nodes_[first_pnode]) {
-    HitGroup group;
-    group.roles[first_pnode] = node;
-    init_groups.emplace_back(group);
+  if (pattern_.edges().empty()) {
+    auto *first_pnode = pattern().nodes().front().get();
+    if (!pdnodes2nodes_.count(first_pnode)) return result;
+    for (auto *node : pdnodes2nodes_[first_pnode]) {
+      GraphPatternDetector::subgraph_t subgraph;
+      subgraph.emplace(first_pnode, node);
+      result.emplace_back(subgraph);
+    }
+    return result;
+  }
+  for (const auto &edge : pattern_.edges()) {
+    if (!pdnodes2nodes_.count(edge.first) ||
+        !pdnodes2nodes_.count(edge.second)) {
+      return result;
+    }
   }
 
   int step = 0;
-  bi_records[0] = std::move(init_groups);
+  bi_records[0].emplace_back();
 
-  // Extend a PDNode to subgraphs by deducing the connection relations defined
-  // in edges of PDNodes.
-  for (const auto &edge : pattern_.edges()) {
+  // Extend the hit records by the edges of PDNodes. Once a PDNode of an edge
+  // is matched in a record, the other one can only be matched by the nodes
+  // linked to it, so the candidates are only enumerated for the first edge
+  // of each component of the pattern.
+  for (const auto &edge : SortEdgesBySelectivity()) {
     VLOG(4) << "check " << edge.first->name() << " -> " << edge.second->name();
-    // TODO(Superjomn) Fix bug here, the groups might be duplicate here.
-    // Each role has two PDNodes, which indicates two roles.
-    // Detect two Nodes that can match these two roles and they are connected.
     auto &pre_groups = bi_records[step % 2];
     auto &cur_groups = bi_records[1 - (step++ % 2)];
     cur_groups.clear();
     if (pre_groups.empty()) break;
-    // source -> target
-    for (Node *source : pdnodes2nodes_[edge.first]) {
-      for (Node *target : pdnodes2nodes_[edge.second]) {
-        VLOG(8) << "check " << source->id() << " -- " << target->id();
-        // TODO(Superjomn) add some prune strategies.
-        for (const auto &group : pre_groups) {
-          if (IsNodesLink(source, target)) {
-            HitGroup new_group = group;
-            bool flag = new_group.Match(source, edge.first) &&
-                        new_group.Match(target, edge.second);
-            if (flag) {
-              new_group.Register(source, edge.first);
-              new_group.Register(target, edge.second);
-              cur_groups.push_back(new_group);
-              // TODO(Superjomn) need to unique
+    const auto &sources = pdnodes2nodes_[edge.first];
+    const auto &targets = pdnodes2nodes_[edge.second];
+    auto extend = [&](const HitGroup &group, Node *source, Node *target) {
+      VLOG(8) << "check " << source->id() << " -- " << target->id();
+      HitGroup new_group = group;
+      bool flag = new_group.Match(source, edge.first) &&
+                  new_group.Match(target, edge.second);
+      if (flag) {
+        new_group.Register(source, edge.first);
+        new_group.Register(target, edge.second);
+        cur_groups.push_back(std::move(new_group));
+      }
+    };
+    for (const auto &group : pre_groups) {
+      auto source_it = group.roles.find(edge.first);
+      auto target_it = group.roles.find(edge.second);
+      if (source_it != group.roles.end()) {
+        Node *source = source_it->second;
+        for (auto *target : UniqueLinks(source->outputs)) {
+          if (targets.count(target)) extend(group, source, target);
+        }
+      } else if (target_it != group.roles.end()) {
+        Node *target = target_it->second;
+        for (auto *source : UniqueLinks(target->inputs)) {
+          if (sources.count(source) && IsNodesLink(source, target)) {
+            extend(group, source, target);
+          }
+        }
+      } else if (targets.size() < sources.size()) {
+        for (auto *target : targets) {
+          for (auto *source : UniqueLinks(target->inputs)) {
+            if (sources.count(source) && IsNodesLink(source, target)) {
+              extend(group, source, target);
             }
           }
         }
+      } else {
+        for (auto *source : sources) {
+          for (auto *target : UniqueLinks(source->outputs)) {
+            if (targets.count(target)) extend(group, source, target);
+          }
+        }
       }
     }
     VLOG(3) << "step " << step << " get records: " << cur_groups.size();
@@ -246,9 +386,28 @@ GraphPatternDetector::DetectPatterns() {
     }
   }
 
-  for (auto &group : bi_records[step % 2]) {
+  // The records are sorted as if the edges were matched in the order they
+  // are defined with all the candidates of each PDNode, which decides the
+  // records kept by RemoveOverlappedMatch.
+  auto &groups = bi_records[step % 2];
+  std::vector<std::vector<Node *>> keys(groups.size());
+  for (size_t i = 0; i < groups.size(); ++i) {
+    for (auto it = pattern_.edges().rbegin(); it != pattern_.edges().rend();
+         ++it) {
+      keys[i].push_back(groups[i].roles.at(it->first));
+      keys[i].push_back(groups[i].roles.at(it->second));
+    }
+  }
+  std::vector<size_t> order(groups.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return std::lexicographical_compare(keys[a].begin(), keys[a].end(),
+                                        keys[b].begin(), keys[b].end(),
+                                        std::less<Node *>());
+  });
+  for (auto i : order) {
     GraphPatternDetector::subgraph_t subgraph;
-    for (auto &role : group.roles) {
+    for (auto &role : groups[i].roles) {
       subgraph.emplace(role.first, role.second);
     }
     result.emplace_back(subgraph);
@@ -402,6 +561,7 @@ PDNode *PDNode::assert_is_op() {
 }
 
 PDNode *PDNode::assert_is_op(const std::string &op_type) {
+  AddOpTypeHint(OpLink::kIsOp, {op_type});
   asserts_.emplace_back([op_type](Node *x) {
     return x && x->IsOp() && x->Op()->Type() == op_type;
   });
@@ -454,6 +614,7 @@ PDNode *PDNode::assert_is_op_nth_input(const std::string &op_type,
 
 PDNode *PDNode::assert_is_op_nth_output(const std::string &op_type,
                                         const std::string &argument, int nth) {
+  AddOpTypeHint(OpLink::kOutputOf, {op_type});
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -467,6 +628,7 @@ PDNode *PDNode::assert_is_op_nth_output(const std::string &op_type,
 }
 
 PDNode *PDNode::assert_is_only_input_of_op(const std::string &op_type) {
+  AddOpTypeHint(OpLink::kInputOf, {op_type});
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
@@ -481,6 +643,7 @@ PDNode *PDNode::assert_is_only_input_of_op(const std::string &op_type) {
 }
 
 PDNode *PDNode::assert_is_only_output_of_op(const std::string &op_type) {
+  AddOpTypeHint(OpLink::kOutputOf, {op_type});
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -495,6 +658,7 @@ PDNode *PDNode::assert_is_only_output_of_op(const std::string &op_type) {
 }
 
 PDNode *PDNode::assert_is_op_output(const std::string &op_type) {
+  AddOpTypeHint(OpLink::kOutputOf, {op_type});
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -515,6 +679,7 @@ PDNode *PDNode::assert_is_op_output(const std::string &op_type,
 }
 
 PDNode *PDNode::assert_is_op_input(const std::string &op_type) {
+  AddOpTypeHint(OpLink::kInputOf, {op_type});
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
@@ -572,6 +737,7 @@ PDNode *PDNode::assert_more(PDNode::teller_t &&teller) {
 }
 
 PDNode *PDNode::assert_is_ops(const std::unordered_set<std::string> &op_types) {
+  AddOpTypeHint(OpLink::kIsOp, op_types);
   asserts_.emplace_back([op_types](Node *x) {
     return x && x->IsOp() && op_types.count(x->Op()->Type());
   });
@@ -597,6 +763,7 @@ PDNode *PDNode::assert_is_ops_nth_input(
 PDNode *PDNode::assert_is_ops_nth_output(
     const std::unordered_set<std::string> &op_types,
     const std::string &argument, int nth) {
+  AddOpTypeHint(OpLink::kOutputOf, op_types);
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -610,6 +777,7 @@ PDNode *PDNode::assert_is_ops_nth_output(
 }
 PDNode *PDNode::assert_is_ops_output(
     const std::unordered_set<std::string> &op_types) {
+  AddOpTypeHint(OpLink::kOutputOf, op_types);
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -632,6 +800,7 @@ PDNode *PDNode::assert_is_ops_output(
 
 PDNode *PDNode::assert_is_ops_input(
     const std::unordered_set<std::string> &op_types) {
+  AddOpTypeHint(OpLink::kInputOf, op_types);
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
@@ -654,6 +823,7 @@ PDNode *PDNode::assert_is_ops_input(
 
 PDNode *PDNode::assert_is_only_input_of_ops(
     const std::unordered_set<std::string> &op_types) {
+  AddOpTypeHint(OpLink::kInputOf, op_types);
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
@@ -669,6 +839,7 @@ PDNode *PDNode::assert_is_only_input_of_ops(
 
 PDNode *PDNode::assert_is_only_output_of_ops(
     const std::unordered_set<std::string> &op_types) {
+  AddOpTypeHint(OpLink::kOutputOf, op_types);
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -82,6 +82,21 @@ struct PDNode {
 
   const std::string& name() const { return name_; }
 
+  // The op types which the assertions link the node to: it is an op of one
+  // of the types, or an input or output of such an op. GraphPatternDetector
+  // only tells the nodes linked to these ops, which it finds in an index of
+  // the ops by type, instead of all the nodes of the graph.
+  enum class OpLink { kIsOp, kInputOf, kOutputOf };
+  struct OpTypeHint {
+    OpLink link;
+    std::unordered_set<std::string> op_types;
+  };
+  // Empty if the node is told by a teller, which might accept any node.
+  const std::vector<OpTypeHint>& op_type_hints() const {
+    static const std::vector<OpTypeHint> no_hints;
+    return teller_ ? no_hints : op_type_hints_;
+  }
+
   PDNode& operator=(const PDNode&) = delete;
   PDNode(const PDNode&) = delete;
 
@@ -179,11 +194,17 @@ struct PDNode {
 
   PDNode(PDNode&& other) = default;
 
+  void AddOpTypeHint(OpLink link,
+                     const std::unordered_set<std::string>& op_types) {
+    op_type_hints_.push_back(OpTypeHint{link, op_types});
+  }
+
   friend class PDPattern;
 
   // Will removed latter.
   teller_t teller_;
   std::vector<teller_t> asserts_;
+  std::vector<OpTypeHint> op_type_hints_;
   PDPattern* pattern_;
   std::string name_;
   Type type_;
@@ -295,6 +316,11 @@ class GraphPatternDetector {
   // Detect all the pattern and output the hit records.
   std::vector<subgraph_t> DetectPatterns();
 
+  // The order of the edges to extend the hit records: from the edge of the
+  // PDNode with the fewest candidates, each edge is linked to a PDNode of the
+  // previous ones if possible, so it is matched along the links of the nodes.
+  std::vector<std::pair<PDNode*, PDNode*>> SortEdgesBySelectivity();
+
   // Remove duplicate patterns.
   void UniquePatterns(std::vector<subgraph_t>* subgraphs);
 
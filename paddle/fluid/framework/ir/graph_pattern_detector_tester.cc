@@ -13,8 +13,12 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+#include <functional>
+#include <set>
+#include <string>
 
 #include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
 
 namespace paddle {
 namespace framework {
@@ -203,6 +207,159 @@ TEST(GraphPatternDetector, IntermediateCheck) {
   ASSERT_EQ(count, 1);
 }
 
+// A chain of num_layers fc layers, each of mul, elementwise_add and relu.
+ProgramDesc BuildFCChain(int num_layers) {
+  Layers layers;
+  auto* x = layers.data("x", {1, 8});
+  for (int i = 0; i < num_layers; ++i) {
+    auto* w = layers.data("w" + std::to_string(i), {8, 8}, true);
+    auto* b = layers.data("b" + std::to_string(i), {8}, true);
+    x = layers.relu(layers.elementwise_add(layers.mul(x, w), b));
+  }
+  return layers.main_program();
+}
+
+// Runs the pattern of fc_fuse_pass, and returns the matched mul ops.
+std::vector<Node*> DetectFC(Graph* graph) {
+  GraphPatternDetector detector;
+  auto* x = detector.mutable_pattern()
+                ->NewNode("fc/x")
+                ->AsInput()
+                ->assert_is_op_input("mul", "X");
+  patterns::FC fc_pattern(detector.mutable_pattern(), "fc");
+  fc_pattern(x, true /*with bias*/, true /*with relu*/);
+  std::vector<Node*> muls;
+  detector(graph, [&](const GraphPatternDetector::subgraph_t& subgraph,
+                      Graph* g) {
+    GET_IR_NODE_FROM_SUBGRAPH(mul, mul, fc_pattern);
+    muls.push_back(mul);
+  });
+  return muls;
+}
+
+TEST(GraphPatternDetector, OpTypeHints) {
+  ProgramDesc program = BuildFCChain(3);
+  Graph graph(program);
+  auto muls = DetectFC(&graph);
+  ASSERT_EQ(muls.size(), 3UL);
+  EXPECT_EQ(std::set<Node*>(muls.begin(), muls.end()).size(), 3UL);
+
+  GraphPatternDetector detector;
+  auto* relu =
+      detector.mutable_pattern()->NewNode("relu")->assert_is_op("relu");
+  ASSERT_EQ(relu->op_type_hints().size(), 1UL);
+  EXPECT_EQ(relu->op_type_hints()[0].link, PDNode::OpLink::kIsOp);
+  auto* out = detector.mutable_pattern()
+                  ->NewNode("out")
+                  ->assert_is_ops_output({"relu", "sigmoid"});
+  ASSERT_EQ(out->op_type_hints().size(), 1UL);
+  EXPECT_EQ(out->op_type_hints()[0].link, PDNode::OpLink::kOutputOf);
+  EXPECT_EQ(out->op_type_hints()[0].op_types.size(), 2UL);
+  // A teller might accept any node.
+  auto* any = detector.mutable_pattern()->NewNode(
+      [](Node* x) { return x && x->IsOp(); }, "any");
+  any->assert_is_op("relu");
+  EXPECT_TRUE(any->op_type_hints().empty());
+}
+
+// Returns the names of the nodes matched by the PDNode which build returns,
+// one for each subgraph found.
+std::multiset<std::string> DetectNames(
+    Graph* graph, const std::function<PDNode*(PDPattern*)>& build) {
+  GraphPatternDetector detector;
+  PDNode* pdnode = build(detector.mutable_pattern());
+  std::multiset<std::string> names;
+  detector(graph, [&](const GraphPatternDetector::subgraph_t& subgraph,
+                      Graph* g) { names.insert(subgraph.at(pdnode)->Name()); });
+  return names;
+}
+
+TEST(GraphPatternDetector, MixedPatterns) {
+  // fc with bias and relu, fc with bias, mul followed by relu and an
+  // elementwise_add, a conv2d with a bias and one without
+  Layers layers;
+  auto* x = layers.data("x", {1, 8});
+  auto* w1 = layers.data("w1", {8, 8}, true);
+  auto* b1 = layers.data("b1", {8}, true);
+  auto* m1 = layers.mul(x, w1);
+  auto* a1 = layers.elementwise_add(m1, b1);
+  auto* h1 = layers.relu(a1);
+  auto* w2 = layers.data("w2", {8, 8}, true);
+  auto* b2 = layers.data("b2", {8}, true);
+  auto* m2 = layers.mul(h1, w2);
+  auto* h2 = layers.elementwise_add(m2, b2);
+  auto* w3 = layers.data("w3", {8, 8}, true);
+  auto* h3 = layers.mul(h2, w3);
+  auto* h4 = layers.relu(h3);
+  auto* s = layers.elementwise_add(h4, h2);
+
+  auto* img = layers.data("img", {1, 3, 8, 8});
+  auto* f1 = layers.data("f1", {3, 3, 1, 1}, true);
+  auto* cb1 = layers.data("cb1", {3}, true);
+  auto* eb1 = layers.data("eb1", {3}, true);
+  auto* c1 = layers.elementwise_add(layers.conv2d(img, f1, cb1), eb1);
+  auto* f2 = layers.data("f2", {3, 3, 1, 1}, true);
+  auto* cb2 = layers.data("cb2", {3}, true);
+  auto* noise = layers.data("noise", {1, 3, 8, 8});
+  layers.elementwise_add(layers.conv2d(c1, f2, cb2), noise);
+
+  Graph graph(layers.main_program());
+
+  auto fc = [](bool with_bias, bool with_relu) {
+    return [=](PDPattern* pattern) {
+      auto* input = pattern->NewNode("fc/x")->AsInput()->assert_is_op_input(
+          "mul", "X");
+      patterns::FC fc_pattern(pattern, "fc");
+      return fc_pattern(input, with_bias, with_relu);
+    };
+  };
+  EXPECT_EQ(DetectNames(&graph, fc(true, true)),
+            std::multiset<std::string>({h1->Name()}));
+  EXPECT_EQ(DetectNames(&graph, fc(true, false)),
+            std::multiset<std::string>({a1->Name(), h2->Name()}));
+  EXPECT_EQ(DetectNames(&graph, fc(false, false)),
+            std::multiset<std::string>({m1->Name(), m2->Name(), h3->Name()}));
+
+  EXPECT_EQ(DetectNames(&graph,
+                        [](PDPattern* pattern) {
+                          auto* input =
+                              pattern->NewNode("conv_bias/x")->AsInput();
+                          patterns::ConvBias conv_bias(pattern, "conv_bias");
+                          return conv_bias(input);
+                        }),
+            std::multiset<std::string>({c1->Name()}));
+
+  EXPECT_EQ(DetectNames(&graph,
+                        [](PDPattern* pattern) {
+                          auto* input = pattern->NewNode("act_add/x")
+                                            ->AsInput()
+                                            ->assert_is_var();
+                          patterns::ActElewiseAdd act_add(pattern, "act_add");
+                          return act_add(input, {"relu"});
+                        }),
+            std::multiset<std::string>({s->Name()}));
+
+  // A pattern with a custom teller, which has no op type hint, finds the
+  // same subgraphs as with the hints.
+  EXPECT_EQ(DetectNames(&graph,
+                        [](PDPattern* pattern) {
+                          auto* mul = pattern->NewNode(
+                              [](Node* n) {
+                                return n->IsOp() && n->Op()->Type() == "mul";
+                              },
+                              "mul");
+                          auto* out = pattern->NewNode(
+                              [](Node* n) {
+                                return n->IsVar() && !n->inputs.empty() &&
+                                       n->inputs[0]->Op()->Type() == "mul";
+                              },
+                              "out");
+                          mul->LinksTo({out});
+                          return out;
+                        }),
+            std::multiset<std::string>({m1->Name(), m2->Name(), h3->Name()}));
+}
+
 }  // namespace ir
 }  // namespace framework
 }  // namespace paddle
@@ -14,6 +14,9 @@
 
 #include "paddle/fluid/imperative/prepared_operator.h"
 
+#include <cstring>
+#include <unordered_map>
+
 #include "paddle/fluid/eager/eager_tensor.h"
 #include "paddle/fluid/framework/data_type_transform.h"
 #include "paddle/fluid/framework/details/nan_inf_utils.h"
@@ -32,6 +35,7 @@
 DECLARE_bool(check_nan_inf);
 DECLARE_bool(benchmark);
 DECLARE_bool(run_kp_kernel);
+DECLARE_bool(dygraph_kernel_context_cache);
 
 namespace paddle {
 namespace imperative {
@@ -507,6 +511,101 @@ static void PreparedOpRunImpl(
   }
 }
 
+static bool SameArgNames(const paddle::small_vector<const char*>& lhs,
+                         const paddle::small_vector<const char*>& rhs) {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < lhs.size(); ++i) {
+    if (lhs[i] != rhs[i] && std::strcmp(lhs[i], rhs[i]) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+DygraphPhiKernelArgs::DygraphPhiKernelArgs(
+    const phi::KernelSignature& kernel_signature, const phi::Kernel& phi_kernel)
+    : kernel(&phi_kernel),
+      signature_input_names(kernel_signature.input_names),
+      signature_attr_names(kernel_signature.attr_names),
+      signature_output_names(kernel_signature.output_names) {
+  auto& input_defs = phi_kernel.args_def().input_defs();
+  for (size_t i = 0; i < kernel_signature.input_names.size(); ++i) {
+    input_names.emplace_back(kernel_signature.input_names[i]);
+    auto kind = kRequired;
+    if (i < input_defs.size()) {
+      if (input_defs[i].type_index ==
+          std::type_index(typeid(paddle::optional<const phi::DenseTensor&>))) {
+        kind = kOptional;
+      } else if (input_defs[i].type_index ==
+                 std::type_index(
+                     typeid(paddle::optional<
+                            const std::vector<const phi::DenseTensor*>>))) {
+        kind = kOptionalVector;
+      }
+    }
+    input_kinds.emplace_back(kind);
+  }
+  for (auto* name : kernel_signature.attr_names) {
+    attr_names.emplace_back(name);
+  }
+  for (auto* name : kernel_signature.output_names) {
+    output_names.emplace_back(name);
+  }
+}
+
+bool DygraphPhiKernelArgs::Match(const phi::KernelSignature& kernel_signature,
+                                 const phi::Kernel& phi_kernel) const {
+  return kernel == &phi_kernel &&
+         SameArgNames(signature_input_names, kernel_signature.input_names) &&
+         SameArgNames(signature_attr_names, kernel_signature.attr_names) &&
+         SameArgNames(signature_output_names, kernel_signature.output_names);
+}
+
+const DygraphPhiKernelArgs& DygraphPhiKernelArgs::Get(
+    const std::string& op_type, const phi::KernelKey& kernel_key,
+    const phi::KernelSignature& kernel_signature,
+    const phi::Kernel& phi_kernel) {
+  // An op type maps to another signature when the arguments it is run with
+  // change, e.g. with or without a shape tensor, so the entry is checked.
+  static thread_local std::unordered_map<
+      std::string,
+      std::unordered_map<phi::KernelKey, std::unique_ptr<DygraphPhiKernelArgs>,
+                         phi::KernelKey::Hash>>
+      cache;
+  auto& args = cache[op_type][kernel_key];
+  if (args == nullptr || !args->Match(kernel_signature, phi_kernel)) {
+    args.reset(new DygraphPhiKernelArgs(kernel_signature, phi_kernel));
+  }
+  return *args;
+}
+
+ThreadKernelContext::ThreadKernelContext() {
+  auto& contexts = Contexts();
+  if (Depth() == contexts.size()) {
+    contexts.emplace_back(new phi::KernelContext());
+  }
+  ctx_ = contexts[Depth()++].get();
+}
+
+ThreadKernelContext::~ThreadKernelContext() {
+  ctx_->Clear();
+  --Depth();
+}
+
+std::vector<std::unique_ptr<phi::KernelContext>>&
+ThreadKernelContext::Contexts() {
+  static thread_local std::vector<std::unique_ptr<phi::KernelContext>>
+      contexts;
+  return contexts;
+}
+
+size_t& ThreadKernelContext::Depth() {
+  static thread_local size_t depth = 0;
+  return depth;
+}
+
 template <typename VarType>
 static void PreparedOpRunPtImpl(
     const framework::OperatorBase& op,
@@ -534,12 +633,25 @@ static void PreparedOpRunPtImpl(
 
     PreparePhiData<VarType>(phi_kernel, kernel_signature, ins);
 
-    phi::KernelContext pt_kernel_context;
-    BuildDygraphPhiKernelContext<VarType>(kernel_signature, phi_kernel, ins,
-                                          outs, attrs, default_attrs, dev_ctx,
-                                          &pt_kernel_context);
+    if (FLAGS_dygraph_kernel_context_cache) {
+      const auto& kernel_args = DygraphPhiKernelArgs::Get(
+          op.Type(), framework::TransOpKernelTypeToPhiKernelKey(kernel_type),
+          kernel_signature, phi_kernel);
+      ThreadKernelContext pt_kernel_context;
+      BuildDygraphPhiKernelContext<VarType>(
+          kernel_signature, kernel_args, phi_kernel, ins, outs, attrs,
+          default_attrs, dev_ctx, pt_kernel_context.get());
 
-    phi_kernel(&pt_kernel_context);
+      phi_kernel(pt_kernel_context.get());
+    } else {
+      DygraphPhiKernelArgs kernel_args(kernel_signature, phi_kernel);
+      phi::KernelContext pt_kernel_context;
+      BuildDygraphPhiKernelContext<VarType>(
+          kernel_signature, kernel_args, phi_kernel, ins, outs, attrs,
+          default_attrs, dev_ctx, &pt_kernel_context);
+
+      phi_kernel(&pt_kernel_context);
+    }
   }
 
   if (FLAGS_check_nan_inf) {
@@ -235,8 +235,62 @@ const inline framework::Attribute* GetAttr(
   return nullptr;
 }
 
+// The arguments of a phi kernel signature in the form the dygraph op maps
+// are searched with, so that filling a KernelContext neither builds a
+// std::string for every argument nor compares the types of the inputs again.
+struct DygraphPhiKernelArgs {
+  enum InputKind { kRequired, kOptional, kOptionalVector };
+
+  DygraphPhiKernelArgs(const phi::KernelSignature& kernel_signature,
+                       const phi::Kernel& phi_kernel);
+
+  // Whether these are the arguments of kernel_signature and phi_kernel.
+  bool Match(const phi::KernelSignature& kernel_signature,
+             const phi::Kernel& phi_kernel) const;
+
+  // Returns the arguments of kernel_signature and phi_kernel, which are kept
+  // for op_type and kernel_key on the current thread.
+  static const DygraphPhiKernelArgs& Get(
+      const std::string& op_type, const phi::KernelKey& kernel_key,
+      const phi::KernelSignature& kernel_signature,
+      const phi::Kernel& phi_kernel);
+
+  const phi::Kernel* kernel;
+  paddle::small_vector<const char*> signature_input_names;
+  paddle::small_vector<const char*> signature_attr_names;
+  paddle::small_vector<const char*> signature_output_names;
+
+  paddle::small_vector<std::string> input_names;
+  paddle::small_vector<InputKind> input_kinds;
+  paddle::small_vector<std::string> attr_names;
+  paddle::small_vector<std::string> output_names;
+};
+
+// Lends the phi::KernelContext of the current thread to an op run. There is
+// one context for each level of nested runs, and it is cleared after the
+// kernel without freeing its buffers, so that small ops, which spend more on
+// building the context than on the kernel, fill it without allocations.
+class ThreadKernelContext {
+ public:
+  ThreadKernelContext();
+
+  ~ThreadKernelContext();
+
+  phi::KernelContext* get() const { return ctx_; }
+
+ private:
+  static std::vector<std::unique_ptr<phi::KernelContext>>& Contexts();
+
+  static size_t& Depth();
+
+  phi::KernelContext* ctx_;
+
+  DISABLE_COPY_AND_ASSIGN(ThreadKernelContext);
+};
+
 template <typename VarType>
 void BuildDygraphPhiKernelContext(const phi::KernelSignature& kernel_signature,
+                                  const DygraphPhiKernelArgs& kernel_args,
                                   const phi::Kernel& phi_kernel,
                                   const NameVarMap<VarType>& ins,
                                   const NameVarMap<VarType>& outs,
@@ -246,9 +300,9 @@ void BuildDygraphPhiKernelContext(const phi::KernelSignature& kernel_signature,
                                   phi::KernelContext* kernel_ctx) {
   kernel_ctx->SetDeviceContext(dev_ctx);
 
-  const auto& input_names = kernel_signature.input_names;
-  const auto& attr_names = kernel_signature.attr_names;
-  const auto& output_names = kernel_signature.output_names;
+  const auto& input_names = kernel_args.input_names;
+  const auto& attr_names = kernel_args.attr_names;
+  const auto& output_names = kernel_args.output_names;
 
   auto& input_defs = phi_kernel.args_def().input_defs();
   auto& output_defs = phi_kernel.args_def().output_defs();
@@ -278,17 +332,14 @@ void BuildDygraphPhiKernelContext(const phi::KernelSignature& kernel_signature,
     size_t start_idx = (i == 0 ? 0 : kernel_ctx->InputRangeAt(i - 1).second);
 
     if (it == ins.end()) {
-      if (LIKELY(input_defs[i].type_index ==
-                 std::type_index(
-                     typeid(paddle::optional<const phi::DenseTensor&>)))) {
+      if (LIKELY(kernel_args.input_kinds[i] ==
+                 DygraphPhiKernelArgs::kOptional)) {
         kernel_ctx->EmplaceBackInputWithoutSetRange(nullptr);
         auto end_idx = start_idx + 1;
         kernel_ctx->AssignInputRange(std::make_pair(start_idx, end_idx), i);
         continue;
-      } else if (input_defs[i].type_index ==
-                 std::type_index(
-                     typeid(paddle::optional<
-                            const std::vector<const phi::DenseTensor*>>))) {
+      } else if (kernel_args.input_kinds[i] ==
+                 DygraphPhiKernelArgs::kOptionalVector) {
         kernel_ctx->EmplaceBackInputWithoutSetRange(nullptr);
         auto end_idx = start_idx + 1;
         kernel_ctx->AssignInputRange(std::make_pair(start_idx, end_idx), i);
@@ -229,6 +229,74 @@ TEST(test_prepare_op, test_prepare_data_cpu_mkldnn) {
   TestPrepareDataSamePlace({{"use_mkldnn", true}});
 }
 #endif
+
+TEST(test_prepare_op, test_thread_kernel_context_nested) {
+  ThreadKernelContext outer;
+  phi::KernelContext* inner_ctx = nullptr;
+  {
+    ThreadKernelContext inner;
+    ASSERT_NE(inner.get(), outer.get());
+    inner_ctx = inner.get();
+  }
+  // An op run by another op at the same depth gets the same context again.
+  ThreadKernelContext inner;
+  ASSERT_EQ(inner.get(), inner_ctx);
+}
+
+TEST(test_prepare_op, test_thread_kernel_context_clear) {
+  // More attributes than the small vector holds inline, so that they live in
+  // a buffer on the heap.
+  const int attrs_size = 32;
+  phi::KernelContext* ctx = nullptr;
+  const int* first_attr = nullptr;
+  {
+    ThreadKernelContext kernel_ctx;
+    ctx = kernel_ctx.get();
+    ctx->EmplaceBackInput(nullptr);
+    for (int i = 0; i < attrs_size; ++i) {
+      ctx->EmplaceBackAttr(phi::Attribute(i));
+    }
+    first_attr = &ctx->AttrAt<int>(0);
+  }
+  ThreadKernelContext kernel_ctx;
+  ASSERT_EQ(kernel_ctx.get(), ctx);
+  ASSERT_EQ(ctx->InputsSize(), 0UL);
+  ASSERT_EQ(ctx->AttrsSize(), 0UL);
+  for (int i = 0; i < attrs_size; ++i) {
+    ctx->EmplaceBackAttr(phi::Attribute(i));
+  }
+  // The attributes are filled into the buffer kept by Clear.
+  ASSERT_EQ(&ctx->AttrAt<int>(0), first_attr);
+  ASSERT_EQ(ctx->AttrAt<int>(attrs_size - 1), attrs_size - 1);
+}
+
+TEST(test_prepare_op, test_dygraph_phi_kernel_args) {
+  phi::KernelKey kernel_key(phi::Backend::CPU, phi::DataLayout::ALL_LAYOUT,
+                            phi::DataType::FLOAT32);
+  const auto& relu_kernel =
+      phi::KernelFactory::Instance().SelectKernel("relu", kernel_key);
+  ASSERT_TRUE(relu_kernel.IsValid());
+  phi::KernelSignature relu_signature("relu", {"X"}, {}, {"Out"});
+
+  const auto& args = DygraphPhiKernelArgs::Get("relu", kernel_key,
+                                               relu_signature, relu_kernel);
+  ASSERT_EQ(args.input_names.size(), 1UL);
+  ASSERT_EQ(args.input_names[0], "X");
+  ASSERT_EQ(args.input_kinds[0], DygraphPhiKernelArgs::kRequired);
+  ASSERT_EQ(args.output_names[0], "Out");
+  ASSERT_TRUE(args.attr_names.empty());
+  ASSERT_EQ(&DygraphPhiKernelArgs::Get("relu", kernel_key, relu_signature,
+                                       relu_kernel),
+            &args);
+
+  // The kept arguments are replaced when the op maps to another signature.
+  phi::KernelSignature other_signature("relu", {"Y"}, {}, {"Out"});
+  ASSERT_FALSE(args.Match(other_signature, relu_kernel));
+  const auto& other_args = DygraphPhiKernelArgs::Get(
+      "relu", kernel_key, other_signature, relu_kernel);
+  ASSERT_TRUE(other_args.Match(other_signature, relu_kernel));
+  ASSERT_EQ(other_args.input_names[0], "Y");
+}
 }  // namespace imperative
 }  // namespace paddle
 
@@ -219,10 +219,12 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
                                   // params_file_ fields.
 
   CP_MEMBER(opt_cache_dir_);
+  CP_MEMBER(enable_optim_program_cache_);
   CP_MEMBER(prog_file_);
   CP_MEMBER(params_file_);
 
   CP_MEMBER(use_fc_padding_);
+  CP_MEMBER(use_fc_weight_packing_);
   // GPU related.
   CP_MEMBER(use_gpu_);
   CP_MEMBER(use_cudnn_);
@@ -249,6 +251,8 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(trt_allow_build_at_runtime_);
   CP_MEMBER(collect_shape_range_info_);
   CP_MEMBER(shape_range_info_path_);
+  CP_MEMBER(shape_bucketing_);
+  CP_MEMBER(shape_bucket_pad_values_);
   CP_MEMBER(trt_use_inspector_);
   // Dlnne related
   CP_MEMBER(use_dlnne_);
@@ -1025,10 +1029,14 @@ std::string AnalysisConfig::Summary() {
   os.InsertRow({"ir_optim", enable_ir_optim_ ? "true" : "false"});
   os.InsertRow({"ir_debug", ir_debug_ ? "true" : "false"});
   os.InsertRow({"memory_optim", enable_memory_optim_ ? "true" : "false"});
+  os.InsertRow({"optim_program_cache",
+                enable_optim_program_cache_ ? "true" : "false"});
   os.InsertRow({"enable_profile", with_profile_ ? "true" : "false"});
   os.InsertRow({"enable_log", with_glog_info_ ? "true" : "false"});
   os.InsertRow({"collect_shape_range_info",
                 collect_shape_range_info_ ? shape_range_info_path_ : "false"});
+  os.InsertRow({"shape_bucketing",
+                shape_bucketing_ ? shape_range_info_path_ : "false"});
 
   return os.PrintTable();
 }
@@ -1110,6 +1118,18 @@ bool AnalysisConfig::shape_range_info_collected() {
   return collect_shape_range_info_;
 }
 
+void AnalysisConfig::EnableShapeBucketing(
+    const std::string &shape_range_info_path,
+    const std::map<std::string, float> &pad_values) {
+  PADDLE_ENFORCE_EQ(shape_range_info_path.empty(), false,
+                    platform::errors::InvalidArgument(
+                        "The shape_range_info_path should not be empty, please "
+                        "re-check the argument."));
+  shape_range_info_path_ = shape_range_info_path;
+  shape_bucket_pad_values_ = pad_values;
+  shape_bucketing_ = true;
+}
+
 void AnalysisConfig::EnableTunedTensorRtDynamicShape(
     const std::string &shape_range_info_path, bool allow_build_at_runtime) {
   shape_range_info_path_ = shape_range_info_path;
@@ -17,14 +17,23 @@
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <functional>
 #include <memory>
 #include <set>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
+#ifdef _WIN32
+#include <process.h>
+#endif
 
 #include "paddle/fluid//platform/device/gpu/gpu_types.h"
+#include "paddle/fluid/framework/convert_utils.h"
+#include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/feed_fetch_method.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
 #include "paddle/fluid/framework/ir/fuse_pass_base.h"
@@ -42,6 +51,7 @@
 #include "paddle/fluid/inference/utils/io_utils.h"
 #include "paddle/fluid/inference/utils/singleton.h"
 #include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/operators/fc_op.h"
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/device/gpu/gpu_info.h"
 #include "paddle/fluid/platform/device_context.h"
@@ -100,6 +110,49 @@ bool IsPersistable(const framework::VarDesc *var) {
   }
   return false;
 }
+
+void HashCombine(size_t value, size_t *seed) {
+  *seed ^= value + 0x9e3779b9 + (*seed << 6) + (*seed >> 2);
+}
+
+// Mixes the content of the file into seed a chunk at a time, so a large
+// params file is never read into memory at once.
+void HashFileContent(const std::string &path, size_t *seed) {
+  std::ifstream fin(path, std::ios::in | std::ios::binary);
+  PADDLE_ENFORCE_EQ(
+      static_cast<bool>(fin.is_open()), true,
+      platform::errors::NotFound(
+          "Cannot open file %s, please confirm whether the file is normal.",
+          path));
+  std::string chunk(1 << 20, '\0');
+  while (fin) {
+    fin.read(&chunk[0], chunk.size());
+    if (static_cast<size_t>(fin.gcount()) < chunk.size()) {
+      chunk.resize(fin.gcount());
+    }
+    HashCombine(std::hash<std::string>()(chunk), seed);
+  }
+}
+
+// Declares the persistable variables of the program in block, and returns
+// their sorted names, which is the order of load_combine and save_combine.
+std::vector<std::string> DeclarePersistables(
+    const framework::ProgramDesc &program, framework::BlockDesc *block) {
+  std::vector<std::string> names;
+  for (auto *var : program.Block(0).AllVars()) {
+    if (IsPersistable(var)) {
+      framework::VarDesc *new_var = block->Var(var->Name());
+      new_var->SetShape(var->GetShape());
+      new_var->SetDataType(var->GetDataType());
+      new_var->SetType(var->GetType());
+      new_var->SetLoDLevel(var->GetLoDLevel());
+      new_var->SetPersistable(true);
+      names.push_back(var->Name());
+    }
+  }
+  std::sort(names.begin(), names.end());
+  return names;
+}
 }  // namespace
 
 bool PaddleTensorToLoDTensor(const PaddleTensor &pt, framework::LoDTensor *t,
@@ -204,6 +257,13 @@ bool AnalysisPredictor::Init(
   if (!PrepareProgram(program)) {
     return false;
   }
+  // The clones share the packed weights with the scope.
+  if (!program && config_.use_fc_weight_packing() &&
+      platform::is_cpu_place(place_)) {
+    int num_packed =
+        operators::PackFCWeights(*inference_program_, scope_.get());
+    VLOG(3) << "Packed the weights of " << num_packed << " fc ops.";
+  }
 
   // Get the feed_target_names and fetch_target_names
   PrepareFeedFetch();
@@ -213,6 +273,10 @@ bool AnalysisPredictor::Init(
     return true;
   }
 
+  if (config_.shape_bucketing_enabled()) {
+    PrepareShapeBuckets();
+  }
+
   return true;
 }
 
@@ -239,6 +303,15 @@ bool AnalysisPredictor::PrepareProgram(
     const std::shared_ptr<framework::ProgramDesc> &program) {
   if (!program) {
     if (!LoadProgramDesc()) return false;
+    // The optimized program of the same model and config may be cached by an
+    // earlier predictor, with its parameters already transformed. The key is
+    // computed from the loaded program, before the analysis changes it.
+    optim_program_cache_dir_ = OptimProgramCacheDir();
+    const std::string &cache_dir = optim_program_cache_dir_;
+    if (!cache_dir.empty() && LoadOptimProgramCache(cache_dir)) {
+      executor_->CreateVariables(*inference_program_, 0, false, sub_scope_);
+      return true;
+    }
     // If not cloned, the parameters should be loaded.
     // If config_.ir_optim() is True, parameters is loaded in
     // OptimizeInferenceProgram(), but other persistable variables
@@ -252,6 +325,9 @@ bool AnalysisPredictor::PrepareProgram(
     // the analysis pass(op fuse, graph analysis, trt subgraph, mkldnn etc) will
     // not be executed.
     OptimizeInferenceProgram();
+    if (!cache_dir.empty()) {
+      SaveOptimProgramCache(cache_dir);
+    }
   } else {
     // If the program is passed from external, no need to optimize it, this
     // logic is used in the clone scenario.
@@ -1309,6 +1385,9 @@ bool AnalysisPredictor::ZeroCopyRun() {
     return true;
   }
 #endif
+  if (!shape_buckets_.empty()) {
+    PadInputsToBuckets();
+  }
   paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
 #ifdef PADDLE_WITH_MKLDNN
   if (config_.use_mkldnn_) {
@@ -1390,6 +1469,76 @@ void AnalysisPredictor::CollectShapeRangeInfo() {
   }
 }
 
+void AnalysisPredictor::PrepareShapeBuckets() {
+  if (config_.use_feed_fetch_ops_enabled() || !platform::is_cpu_place(place_)) {
+    LOG(WARNING) << "The shape bucketing only works in ZeroCopyRun on CPU, "
+                    "so it is disabled.";
+    return;
+  }
+  auto input_names = GetInputNames();
+  shape_buckets_.Init(config_.shape_range_info_path(), input_names);
+  if (shape_buckets_.empty()) {
+    LOG(WARNING) << "No input has a shape range in "
+                 << config_.shape_range_info_path()
+                 << ", so the shape bucketing is disabled.";
+    return;
+  }
+
+  // The largest shapes are warmed first, so the smaller ones reuse their
+  // allocations.
+  framework::Scope *scope = executor_->scope();
+  for (int level = shape_buckets_.num_levels() - 1; level >= 0; --level) {
+    auto shapes = shape_buckets_.LevelShapes(level);
+    for (auto &name : input_names) {
+      if (!shapes.count(name)) {
+        LOG(WARNING) << "The input " << name << " has no shape range in "
+                     << config_.shape_range_info_path()
+                     << ", so the shape buckets are not warmed.";
+        return;
+      }
+      auto *var_desc = inference_program_->Block(0).FindVar(name);
+      auto *tensor = scope->Var(name)->GetMutable<framework::LoDTensor>();
+      tensor->Resize(phi::make_ddim(shapes[name]));
+      void *data = tensor->mutable_data(
+          place_, framework::TransToPhiDataType(var_desc->GetDataType()));
+      std::memset(data, 0,
+                  tensor->numel() *
+                      framework::SizeOfType(var_desc->GetDataType()));
+    }
+    try {
+      ZeroCopyRun();
+    } catch (const std::exception &e) {
+      LOG(WARNING) << "Failed to warm the shape buckets with zero inputs: "
+                   << e.what();
+      return;
+    }
+  }
+  VLOG(3) << "Warmed " << shape_buckets_.num_levels() << " shape buckets.";
+}
+
+void AnalysisPredictor::PadInputsToBuckets() {
+  framework::Scope *scope = executor_->scope();
+  std::vector<int64_t> bucket;
+  for (auto &it : config_.shape_bucket_pad_values()) {
+    auto *var = scope->FindVar(it.first);
+    if (var == nullptr || !var->IsType<framework::LoDTensor>()) {
+      continue;
+    }
+    auto *tensor = var->GetMutable<framework::LoDTensor>();
+    if (!tensor->IsInitialized() || !tensor->lod().empty()) {
+      continue;
+    }
+    auto shape = phi::vectorize(tensor->dims());
+    if (!shape_buckets_.BucketShape(it.first, shape, &bucket) ||
+        bucket == shape) {
+      continue;
+    }
+    framework::LoDTensor padded;
+    inference::PadTensor(*tensor, phi::make_ddim(bucket), it.second, &padded);
+    tensor->ShareDataWith(padded);
+  }
+}
+
 void AnalysisPredictor::StatisticShapeRangeInfo() {
   std::map<std::string, std::vector<int32_t>> min_shapes;
   std::map<std::string, std::vector<int32_t>> max_shapes;
@@ -1537,6 +1686,177 @@ bool AnalysisPredictor::LoadParameters() {
   return true;
 }
 
+std::string AnalysisPredictor::OptimProgramCacheDir() {
+  if (!config_.optim_program_cache_enabled()) return "";
+  // The subgraph engines keep their engines out of the program, and the
+  // quantizer changes the program after the analysis.
+  if (config_.model_from_memory() || config_.tensorrt_engine_enabled() ||
+      config_.lite_engine_enabled() || config_.dlnne_enabled() ||
+      config_.mkldnn_quantizer_enabled() || config_.use_ipu()) {
+    LOG(WARNING) << "The optimized program cache is not used with a model in "
+                    "memory, the subgraph engines or the quantizer.";
+    return "";
+  }
+  // fusion_group ops keep only the names of the kernels that the pass
+  // compiles into the DeviceCodePool of this process.
+  auto passes = config_.pass_builder()->AllPasses();
+  if (config_.ir_optim() &&
+      std::find(passes.begin(), passes.end(), "fusion_group_pass") !=
+          passes.end()) {
+    LOG(WARNING) << "The optimized program cache is not used with "
+                    "fusion_group_pass.";
+    return "";
+  }
+
+  // The key is the content of the model files, the config, the passes and
+  // the version of Paddle which runs the passes.
+  size_t seed = 0;
+  std::string model_root;
+  if (!config_.model_dir().empty()) {
+    model_root = config_.model_dir();
+    HashFileContent(model_root + "/__model__", &seed);
+    if (config_.params_file().empty()) {
+      framework::ProgramDesc params_program;
+      for (auto &name : DeclarePersistables(*inference_program_,
+                                            params_program.MutableBlock(0))) {
+        HashCombine(std::hash<std::string>()(name), &seed);
+        HashFileContent(model_root + "/" + name, &seed);
+      }
+    }
+  } else {
+    model_root = inference::analysis::GetDirRoot(config_.prog_file());
+    HashFileContent(config_.prog_file(), &seed);
+  }
+  if (!config_.params_file().empty()) {
+    HashFileContent(config_.params_file(), &seed);
+  }
+
+  std::stringstream info;
+  info << seed << ";" << config_.SerializeInfoCache() << ";"
+       << paddle::get_version() << ";";
+  for (auto &pass : config_.pass_builder()->AllPasses()) info << pass << ";";
+  for (auto &pass : config_.pass_builder()->AnalysisPasses()) {
+    info << pass << ";";
+  }
+
+  std::string cache_root = config_.opt_cache_dir_;
+  if (cache_root.empty()) {
+    cache_root = inference::analysis::GetOrCreateModelOptCacheDir(model_root);
+  } else {
+    inference::analysis::MakeDirIfNotExists(cache_root);
+  }
+  return cache_root + "/optim_program_" +
+         std::to_string(std::hash<std::string>()(info.str()));
+}
+
+// Removes the files of the cached program in dir and dir itself.
+static void RemoveOptimProgramCache(const std::string &dir) {
+  std::remove((dir + "/model").c_str());
+  std::remove((dir + "/params").c_str());
+  std::remove(dir.c_str());
+}
+
+bool AnalysisPredictor::LoadOptimProgramCache(const std::string &dir) {
+  const std::string model_path = dir + "/model";
+  const std::string params_path = dir + "/params";
+  if (!inference::analysis::PathExists(dir)) {
+    return false;
+  }
+  // A cache that cannot be loaded is removed, so SaveOptimProgramCache
+  // replaces it instead of every later predictor failing to load it again.
+  if (!inference::analysis::FileExists(model_path) ||
+      !inference::analysis::FileExists(params_path)) {
+    LOG(WARNING) << "The cached optimized program " << dir
+                 << " is incomplete, the program will be optimized again.";
+    RemoveOptimProgramCache(dir);
+    return false;
+  }
+
+  std::ifstream fin(model_path, std::ios::in | std::ios::binary);
+  std::stringstream buffer;
+  buffer << fin.rdbuf();
+  framework::proto::ProgramDesc proto;
+  if (!fin || !proto.ParseFromString(buffer.str())) {
+    LOG(WARNING) << "Cannot parse the cached optimized program " << model_path
+                 << ", the program will be optimized again.";
+    RemoveOptimProgramCache(dir);
+    return false;
+  }
+  auto program = std::make_shared<framework::ProgramDesc>(proto);
+  executor_->CreateVariables(*program, 0, true, sub_scope_);
+
+  // The cached params are loaded to place_ as they are, since they have been
+  // synchronized among the devices before they are saved.
+  framework::ProgramDesc load_program;
+  auto *load_block = load_program.MutableBlock(0);
+  auto params = DeclarePersistables(*program, load_block);
+  try {
+    framework::OpDesc *op = load_block->AppendOp();
+    op->SetType("load_combine");
+    op->SetOutput("Out", params);
+    op->SetAttr("file_path", {params_path});
+    op->CheckAttrs();
+    framework::NaiveExecutor e(place_);
+    e.Prepare(scope_.get(), load_program, 0, false);
+    e.Run();
+  } catch (const std::exception &e) {
+    LOG(WARNING) << "Cannot load the cached parameters " << params_path
+                 << ", the program will be optimized again: " << e.what();
+    scope_->EraseVars(params);
+    RemoveOptimProgramCache(dir);
+    return false;
+  }
+  inference_program_ = program;
+
+  config_.PartiallyRelease();
+  LOG(INFO) << "Load the optimized program from " << dir;
+  return true;
+}
+
+void AnalysisPredictor::SaveOptimProgramCache(const std::string &dir) {
+  framework::ProgramDesc save_program;
+  auto *save_block = save_program.MutableBlock(0);
+  auto params = DeclarePersistables(*inference_program_, save_block);
+  for (auto &name : params) {
+    auto *var = scope_->FindVar(name);
+    if (var == nullptr || !var->IsType<framework::LoDTensor>() ||
+        !var->Get<framework::LoDTensor>().IsInitialized()) {
+      LOG(WARNING) << "The optimized program is not cached, because its "
+                      "persistable variable "
+                   << name << " is not an initialized LoDTensor.";
+      return;
+    }
+  }
+
+  // Write to a directory of this process and rename it, so no predictor
+  // ever sees a partially written cache.
+#ifdef _WIN32
+  const std::string tmp_dir = dir + ".tmp" + std::to_string(_getpid());
+#else
+  const std::string tmp_dir = dir + ".tmp" + std::to_string(getpid());
+#endif
+  inference::analysis::MakeDirIfNotExists(tmp_dir);
+  {
+    std::ofstream fout(tmp_dir + "/model", std::ios::out | std::ios::binary);
+    fout << GetSerializedProgram();
+  }
+  framework::OpDesc *op = save_block->AppendOp();
+  op->SetType("save_combine");
+  op->SetInput("X", params);
+  op->SetAttr("file_path", tmp_dir + "/params");
+  op->CheckAttrs();
+  framework::NaiveExecutor e(place_);
+  e.Prepare(scope_.get(), save_program, 0, false);
+  e.Run();
+
+  if (std::rename(tmp_dir.c_str(), dir.c_str()) != 0) {
+    // Another predictor has saved the same program first.
+    RemoveOptimProgramCache(tmp_dir);
+    return;
+  }
+  LOG(INFO) << "Save the optimized program to " << dir;
+}
+
 uint64_t AnalysisPredictor::TryShrinkMemory() {
   ClearIntermediateTensor();
   return paddle::memory::Release(place_);
@@ -28,6 +28,7 @@
 #include "paddle/fluid/inference/api/details/reset_tensor_array.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/inference/utils/shape_bucket.h"
 #include "paddle/fluid/platform/device/gpu/gpu_types.h"
 #include "paddle/fluid/platform/float16.h"
 #include "paddle/fluid/string/printf.h"
@@ -311,6 +312,29 @@ class AnalysisPredictor : public PaddlePredictor {
   /// \return Whether the function executed successfully
   ///
   bool LoadParameters();
+  ///
+  /// \brief Get the directory of the optimized program of the model and the
+  /// config in the optimization cache. It depends on the loaded program, so
+  /// it is computed once by PrepareProgram, see optim_program_cache_dir_.
+  ///
+  /// \return The directory, or "" if the cache is not used, such as with
+  /// fusion_group_pass, whose kernels are compiled by the pass
+  ///
+  std::string OptimProgramCacheDir();
+  ///
+  /// \brief Load the optimized program and its parameters from the cache.
+  /// A cache which cannot be loaded is removed, to be saved again.
+  ///
+  /// \param[in] dir the directory of the program in the cache
+  /// \return Whether the program and its parameters are loaded from the cache
+  ///
+  bool LoadOptimProgramCache(const std::string &dir);
+  ///
+  /// \brief Save the optimized program and its parameters to the cache.
+  ///
+  /// \param[in] dir the directory of the program in the cache
+  ///
+  void SaveOptimProgramCache(const std::string &dir);
 
   ///
   /// \brief Prepare input data, only used in Run()
@@ -391,11 +415,21 @@ class AnalysisPredictor : public PaddlePredictor {
   FRIEND_TEST(AnalysisPredictor, analysis_off);
   FRIEND_TEST(AnalysisPredictor, analysis_on);
   FRIEND_TEST(AnalysisPredictor, with_gpu);
+  FRIEND_TEST(AnalysisPredictor, optim_program_cache);
 #endif
 
  private:
   void StatisticShapeRangeInfo();
   void CollectShapeRangeInfo();
+  ///
+  /// \brief Make the shape buckets of the inputs and run the predictor once
+  /// at every bucket level, in shape bucketing mode.
+  ///
+  void PrepareShapeBuckets();
+  ///
+  /// \brief Pad the inputs with pad values to their bucket shape.
+  ///
+  void PadInputsToBuckets();
 
 #if defined(PADDLE_WITH_DISTRIBUTE) && defined(PADDLE_WITH_PSCORE)
   // fleet exe related
@@ -485,8 +519,11 @@ class AnalysisPredictor : public PaddlePredictor {
  private:
   // Some status here that help to determine the status inside the predictor.
   bool status_is_cloned_{false};
+  // The directory of the optimized program in the cache, "" if not used.
+  std::string optim_program_cache_dir_;
 
   std::map<std::string, std::vector<std::vector<int32_t>>> shape_info_;
+  inference::ShapeBuckets shape_buckets_;
   static int clone_num_;
 
 #if defined(PADDLE_WITH_DISTRIBUTE) && defined(PADDLE_WITH_PSCORE)
@@ -18,9 +18,21 @@
 #endif
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#ifdef _WIN32
+#include <io.h>
+#include <process.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
+#endif
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <numeric>
 #include <thread>  // NOLINT
 #include "paddle/fluid/framework/ir/pass.h"
 #include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/inference/analysis/helper.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_api.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
@@ -210,6 +222,57 @@ TEST(AnalysisPredictor, CollectShapeRangeInfo) {
   // ASSERT_EQ(min_shape.size(), 14u);
 }
 
+TEST(AnalysisPredictor, shape_bucketing) {
+  const std::vector<std::string> names = {"firstw", "secondw", "thirdw",
+                                          "forthw"};
+  const std::string path = "./shape_bucketing.pbtxt";
+  std::map<std::string, std::vector<int32_t>> min_shape, max_shape, opt_shape;
+  std::map<std::string, float> pad_values;
+  for (auto& name : names) {
+    min_shape[name] = {1, 1};
+    max_shape[name] = {8, 1};
+    opt_shape[name] = {4, 1};
+    pad_values[name] = 0.f;
+  }
+  inference::SerializeShapeRangeInfo(path, min_shape, max_shape, opt_shape);
+
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  config.SwitchUseFeedFetchOps(false);
+  AnalysisConfig bucket_config(config);
+  bucket_config.EnableShapeBucketing(path, pad_values);
+  ASSERT_TRUE(bucket_config.shape_bucketing_enabled());
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  auto bucket_predictor = CreatePaddlePredictor<AnalysisConfig>(bucket_config);
+
+  // A batch of 3 runs in the bucket of 4.
+  auto run = [&](PaddlePredictor* p, std::vector<int>* shape) {
+    for (auto& name : names) {
+      auto input = p->GetInputTensor(name);
+      input->Reshape({3, 1});
+      auto* data = input->mutable_data<int64_t>(PaddlePlace::kCPU);
+      for (int i = 0; i < 3; ++i) data[i] = i + 1;
+    }
+    EXPECT_TRUE(p->ZeroCopyRun());
+    auto out = p->GetOutputTensor("fc_1.tmp_2");
+    *shape = out->shape();
+    std::vector<float> out_data(std::accumulate(
+        shape->begin(), shape->end(), 1, std::multiplies<int>()));
+    out->copy_to_cpu(out_data.data());
+    return out_data;
+  };
+  std::vector<int> shape, bucket_shape;
+  auto out = run(predictor.get(), &shape);
+  auto bucket_out = run(bucket_predictor.get(), &bucket_shape);
+  ASSERT_EQ(shape[0], 3);
+  ASSERT_EQ(bucket_shape[0], 4);
+  ASSERT_EQ(shape[1], bucket_shape[1]);
+  for (size_t i = 0; i < out.size(); ++i) {
+    EXPECT_NEAR(out[i], bucket_out[i], 1e-5);
+  }
+}
+
 TEST(AnalysisPredictor, Clone) {
   AnalysisConfig config;
   config.SetModel(FLAGS_dirname);
@@ -267,6 +330,150 @@ TEST(AnalysisPredictor, Clone) {
   }
 }
 
+// A cache directory of this process, and the removal of the cached programs
+// in it, which are directories of a model and a params file.
+static std::string OptimProgramCacheRoot() {
+#ifdef _WIN32
+  return "./optim_program_cache_" + std::to_string(_getpid());
+#else
+  return "./optim_program_cache_" + std::to_string(getpid());
+#endif
+}
+
+static void RemoveOptimProgramCacheRoot(const std::string& root) {
+  std::vector<std::string> dirs;
+#ifdef _WIN32
+  _finddata_t entry;
+  intptr_t handle = _findfirst((root + "/*").c_str(), &entry);
+  if (handle != -1) {
+    do {
+      dirs.emplace_back(entry.name);
+    } while (_findnext(handle, &entry) == 0);
+    _findclose(handle);
+  }
+#else
+  DIR* dir = opendir(root.c_str());
+  if (dir != nullptr) {
+    while (struct dirent* entry = readdir(dir)) {
+      dirs.emplace_back(entry->d_name);
+    }
+    closedir(dir);
+  }
+#endif
+  for (auto& name : dirs) {
+    if (name == "." || name == "..") continue;
+    std::remove((root + "/" + name + "/model").c_str());
+    std::remove((root + "/" + name + "/params").c_str());
+    std::remove((root + "/" + name).c_str());
+  }
+  std::remove(root.c_str());
+}
+
+TEST(AnalysisPredictor, optim_program_cache) {
+  const std::string cache_root = OptimProgramCacheRoot();
+  RemoveOptimProgramCacheRoot(cache_root);
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  config.SwitchIrOptim(true);
+  config.EnableMemoryOptim();
+  config.SetOptimCacheDir(cache_root);
+  config.EnableOptimProgramCache();
+  AnalysisConfig config1(config);
+  AnalysisConfig config2(config);
+  AnalysisConfig config3(config);
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+
+  // The first predictor runs the analysis and saves the program.
+  auto _predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  auto* predictor = static_cast<AnalysisPredictor*>(_predictor.get());
+  const std::string cache_dir = predictor->optim_program_cache_dir_;
+  ASSERT_FALSE(cache_dir.empty());
+  ASSERT_TRUE(inference::analysis::FileExists(cache_dir + "/model"));
+  ASSERT_TRUE(inference::analysis::FileExists(cache_dir + "/params"));
+  std::vector<PaddleTensor> outputs;
+  ASSERT_TRUE(predictor->Run(inputs, &outputs));
+
+  // The second one loads the program and its parameters from the cache.
+  auto _predictor1 = CreatePaddlePredictor<AnalysisConfig>(config1);
+  auto* predictor1 = static_cast<AnalysisPredictor*>(_predictor1.get());
+  ASSERT_EQ(predictor1->argument_.analysis_passes_valid(), false);
+  ASSERT_EQ(predictor1->GetSerializedProgram(),
+            predictor->GetSerializedProgram());
+  std::vector<PaddleTensor> outputs1;
+  ASSERT_TRUE(predictor1->Run(inputs, &outputs1));
+  ASSERT_EQ(outputs1.size(), outputs.size());
+  inference::CompareTensor(outputs.front(), outputs1.front());
+
+  // The third one optimizes the program again when the cached parameters
+  // can not be loaded.
+  {
+    std::ofstream fout(cache_dir + "/params",
+                       std::ios::out | std::ios::binary | std::ios::trunc);
+    fout << "broken";
+  }
+  auto _predictor2 = CreatePaddlePredictor<AnalysisConfig>(config2);
+  auto* predictor2 = static_cast<AnalysisPredictor*>(_predictor2.get());
+  ASSERT_EQ(predictor2->optim_program_cache_dir_, cache_dir);
+  ASSERT_EQ(predictor2->argument_.analysis_passes_valid(), true);
+  std::vector<PaddleTensor> outputs2;
+  ASSERT_TRUE(predictor2->Run(inputs, &outputs2));
+  ASSERT_EQ(outputs2.size(), outputs.size());
+  inference::CompareTensor(outputs.front(), outputs2.front());
+
+  // and replaces the broken cache, which the fourth one loads.
+  auto _predictor3 = CreatePaddlePredictor<AnalysisConfig>(config3);
+  auto* predictor3 = static_cast<AnalysisPredictor*>(_predictor3.get());
+  ASSERT_EQ(predictor3->argument_.analysis_passes_valid(), false);
+  std::vector<PaddleTensor> outputs3;
+  ASSERT_TRUE(predictor3->Run(inputs, &outputs3));
+  ASSERT_EQ(outputs3.size(), outputs.size());
+  inference::CompareTensor(outputs.front(), outputs3.front());
+
+  RemoveOptimProgramCacheRoot(cache_root);
+}
+
+TEST(AnalysisPredictor, optim_program_cache_fusion_group) {
+  if (!framework::ir::PassRegistry::Instance().Has("fusion_group_pass")) {
+    return;
+  }
+  const std::string cache_root = OptimProgramCacheRoot();
+  RemoveOptimProgramCacheRoot(cache_root);
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  config.SwitchIrOptim(true);
+  config.pass_builder()->AppendPass("fusion_group_pass");
+  config.SetOptimCacheDir(cache_root);
+  config.EnableOptimProgramCache();
+  AnalysisConfig config1(config);
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+
+  // The kernels of the fusion_group ops are compiled by the pass, so both
+  // predictors run the analysis and neither uses the cache.
+  for (auto* c : {&config, &config1}) {
+    auto _predictor = CreatePaddlePredictor<AnalysisConfig>(*c);
+    auto* predictor = static_cast<AnalysisPredictor*>(_predictor.get());
+    ASSERT_TRUE(predictor->optim_program_cache_dir_.empty());
+    ASSERT_EQ(predictor->argument_.analysis_passes_valid(), true);
+    std::vector<PaddleTensor> outputs;
+    ASSERT_TRUE(predictor->Run(inputs, &outputs));
+  }
+  RemoveOptimProgramCacheRoot(cache_root);
+}
+
 // This function is not released yet, will fail on some machine.
 // TODO(Superjomn) Turn on it latter.
 /*
@@ -207,6 +207,27 @@ struct PD_INFER_DECL AnalysisConfig {
     opt_cache_dir_ = opt_cache_dir;
   }
   ///
+  /// \brief Turn on the cache of the optimized program. The first predictor
+  /// of a model saves the program and the parameters produced by the analysis
+  /// to the optimization cache directory, and the later predictors of the
+  /// same model files and config load them instead of running the analysis.
+  /// The cache is not used with the subgraph engines or a model in memory.
+  ///
+  /// \param x Whether the cache of the optimized program is enabled.
+  ///
+  void EnableOptimProgramCache(bool x = true) {
+    enable_optim_program_cache_ = x;
+  }
+  ///
+  /// \brief A boolean state telling whether the cache of the optimized
+  /// program is enabled.
+  ///
+  /// \return bool Whether the cache of the optimized program is enabled.
+  ///
+  bool optim_program_cache_enabled() const {
+    return enable_optim_program_cache_;
+  }
+  ///
   /// \brief Get the model directory path.
   ///
   /// \return const std::string& The model directory path.
@@ -238,6 +259,18 @@ struct PD_INFER_DECL AnalysisConfig {
   /// \return bool Whether fc padding is used.
   ///
   bool use_fc_padding() const { return use_fc_padding_; }
+  ///
+  /// \brief Turn on the packing of the fc weights. The weights of the fc ops
+  /// on CPU are packed into the layout of the GEMM backend once the predictor
+  /// is created, which takes the memory of another copy of these weights.
+  ///
+  void EnableFCWeightPacking() { use_fc_weight_packing_ = true; }
+  ///
+  /// \brief A boolean state telling whether the fc weights are packed.
+  ///
+  /// \return bool Whether the fc weights are packed.
+  ///
+  bool use_fc_weight_packing() const { return use_fc_weight_packing_; }
 
   // GPU related.
 
@@ -582,6 +615,39 @@ struct PD_INFER_DECL AnalysisConfig {
   ///
   bool shape_range_info_collected();
 
+  ///
+  /// \brief Round the input shapes of a CPU predictor up to shape buckets.
+  ///
+  /// The dynamic dims of the inputs are bucketed by the ranges collected in
+  /// CollectShapeInfo mode, and the predictor runs one shape of every bucket
+  /// level with zero inputs when it is created, so the allocations, the
+  /// InferShape and the oneDNN primitives of the buckets are ready before the
+  /// first request. The inputs in pad_values, such as the ids and the mask of
+  /// a sequence, are padded to their bucket shape with the value in
+  /// ZeroCopyRun, so the varying lengths run with the warmed shapes. The
+  /// outputs then have the padded shape, so only pad the inputs the model
+  /// masks. Needs the feed and fetch ops to be switched off.
+  ///
+  /// \param shape_range_info_path the path to shape_info file got in
+  /// CollectShapeInfo mode.
+  /// \param pad_values the inputs to be padded and their pad values.
+  ///
+  void EnableShapeBucketing(
+      const std::string& shape_range_info_path,
+      const std::map<std::string, float>& pad_values = {});
+  ///
+  /// \brief A boolean state telling whether the shape bucketing is enabled.
+  ///
+  /// \return bool Whether the shape bucketing is enabled.
+  ///
+  bool shape_bucketing_enabled() const { return shape_bucketing_; }
+  ///
+  /// \brief The inputs padded to their bucket shape and their pad values.
+  ///
+  const std::map<std::string, float>& shape_bucket_pad_values() const {
+    return shape_bucket_pad_values_;
+  }
+
   ///
   /// \brief Prevent ops running in Paddle-TRT
   /// NOTE: just experimental, not an official stable API, easy to be broken.
@@ -906,6 +972,7 @@ struct PD_INFER_DECL AnalysisConfig {
 
   // Padding related
   bool use_fc_padding_{true};
+  bool use_fc_weight_packing_{false};
 
   // TensorRT related.
   bool use_tensorrt_{false};
@@ -944,6 +1011,10 @@ struct PD_INFER_DECL AnalysisConfig {
   // min_shape, max_shape and opt_shape and save in shape_range_info_path_;
   bool collect_shape_range_info_{false};
   std::string shape_range_info_path_;
+  // In shape bucketing mode, the input shapes are rounded up to the buckets
+  // of the ranges in shape_range_info_path_.
+  bool shape_bucketing_{false};
+  std::map<std::string, float> shape_bucket_pad_values_;
 
   // dlnne related.
   bool use_dlnne_{false};
@@ -1038,6 +1109,7 @@ struct PD_INFER_DECL AnalysisConfig {
   // So we release the memory when the predictor is set up.
   mutable bool is_valid_{true};
   std::string opt_cache_dir_;
+  bool enable_optim_program_cache_{false};
   friend class paddle_infer::experimental::InternalUtils;
 
   // fleet exe related
@@ -235,11 +235,13 @@ CpuPassStrategy::CpuPassStrategy() : PassStrategy({}) {
   // NOTE the large fusions should be located in the front, so that they will
   // not be damaged by smaller ones.
   passes_.assign({"simplify_with_basic_ops_pass",  //
+                  "constant_folding_pass",         //
                   "layer_norm_fuse_pass",
                   "attention_lstm_fuse_pass",       //
                   "seqconv_eltadd_relu_fuse_pass",  //
                   // "seqpool_concat_fuse_pass",    //
                   "seqpool_cvm_concat_fuse_pass",  //
+                  "embedding_seqpool_cvm_concat_fuse_pass",  //
                   // "embedding_fc_lstm_fuse_pass", //
                   // TODO(wilber): fix correctness problem.
                   // "fc_lstm_fuse_pass",                    //
@@ -247,6 +249,7 @@ CpuPassStrategy::CpuPassStrategy() : PassStrategy({}) {
                   "fc_gru_fuse_pass",                        //
                   "mul_gru_fuse_pass",                       //
                   "seq_concat_fc_fuse_pass",                 //
+                  "multihead_matmul_fuse_pass_v2",           //
                   "gpu_cpu_squeeze2_matmul_fuse_pass",       //
                   "gpu_cpu_reshape2_matmul_fuse_pass",       //
                   "gpu_cpu_flatten2_matmul_fuse_pass",       //
@@ -330,6 +333,8 @@ void CpuPassStrategy::EnableMKLDNN() {
 void CpuPassStrategy::EnableMkldnnQuantizer() {
 #ifdef PADDLE_WITH_MKLDNN
   if (!use_mkldnn_quantizer_) {
+    // keep the matmuls of the attention to be quantized
+    DeletePass("multihead_matmul_fuse_pass_v2");
     passes_.push_back("cpu_quantize_placement_pass");
   }
   use_mkldnn_quantizer_ = true;
@@ -0,0 +1,61 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/tests/api/tester_helper.h"
+
+namespace paddle {
+namespace inference {
+namespace analysis {
+
+// The average time of creating a predictor of FLAGS_infer_model, which runs
+// the passes of the CpuPassStrategy if ir_optim is on.
+double CreatePredictorTime(bool ir_optim, int *num_ops) {
+  double total_ms = 0;
+  for (int i = 0; i < FLAGS_repeat; ++i) {
+    AnalysisConfig cfg;
+    cfg.SetModel(FLAGS_infer_model);
+    cfg.DisableGpu();
+    cfg.SwitchIrOptim(ir_optim);
+    cfg.SwitchSpecifyInputNames();
+    cfg.SetCpuMathLibraryNumThreads(FLAGS_cpu_num_threads);
+    Timer timer;
+    timer.tic();
+    auto predictor = CreatePaddlePredictor<AnalysisConfig>(cfg);
+    total_ms += timer.toc();
+    *num_ops = static_cast<AnalysisPredictor *>(predictor.get())
+                   ->program()
+                   .Block(0)
+                   .OpSize();
+  }
+  return total_ms / FLAGS_repeat;
+}
+
+// Times the analysis of a large model, which is dominated by the pattern
+// detection of the fuse passes.
+TEST(Analyzer, ir_optim_time) {
+  int num_ops = 0;
+  double optim_ms = CreatePredictorTime(true, &num_ops);
+  int num_ops_without_optim = 0;
+  double no_optim_ms = CreatePredictorTime(false, &num_ops_without_optim);
+  EXPECT_LE(num_ops, num_ops_without_optim);
+  LOG(INFO) << "Creating the predictor of " << num_ops_without_optim
+            << " ops costs " << optim_ms << " ms with the CpuPassStrategy ("
+            << num_ops << " ops after), " << no_optim_ms
+            << " ms without ir_optim, so the passes cost "
+            << optim_ms - no_optim_ms << " ms.";
+}
+
+}  // namespace analysis
+}  // namespace inference
+}  // namespace paddle
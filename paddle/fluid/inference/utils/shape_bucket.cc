@@ -0,0 +1,183 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/shape_bucket.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "paddle/fluid/framework/convert_utils.h"
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/inference/utils/io_utils.h"
+
+namespace paddle {
+namespace inference {
+
+namespace {
+
+std::vector<int64_t> DimBounds(int32_t min, int32_t max, int32_t opt) {
+  std::vector<int64_t> bounds = {max};
+  if (min >= max) {
+    return bounds;
+  }
+  bounds.push_back(min);
+  for (int64_t p = 1; p < max; p *= 2) {
+    if (p > min) bounds.push_back(p);
+  }
+  if (opt > min && opt < max) bounds.push_back(opt);
+  std::sort(bounds.begin(), bounds.end());
+  bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+  return bounds;
+}
+
+struct FillFunctor {
+  FillFunctor(void* data, int64_t numel, float value)
+      : data_(data), numel_(numel), value_(value) {}
+
+  template <typename T>
+  void apply() {
+    T* data = static_cast<T*>(data_);
+    std::fill(data, data + numel_, static_cast<T>(value_));
+  }
+
+  void* data_;
+  int64_t numel_;
+  float value_;
+};
+
+}  // namespace
+
+void ShapeBuckets::Init(const std::string& shape_range_info_path,
+                        const std::vector<std::string>& input_names) {
+  std::map<std::string, std::vector<int32_t>> min_shape;
+  std::map<std::string, std::vector<int32_t>> max_shape;
+  std::map<std::string, std::vector<int32_t>> opt_shape;
+  DeserializeShapeRangeInfo(shape_range_info_path, &min_shape, &max_shape,
+                            &opt_shape);
+  Init(min_shape, max_shape, opt_shape, input_names);
+}
+
+void ShapeBuckets::Init(
+    const std::map<std::string, std::vector<int32_t>>& min_shape,
+    const std::map<std::string, std::vector<int32_t>>& max_shape,
+    const std::map<std::string, std::vector<int32_t>>& opt_shape,
+    const std::vector<std::string>& input_names) {
+  bounds_.clear();
+  num_levels_ = 0;
+  for (auto& name : input_names) {
+    if (!min_shape.count(name) || !max_shape.count(name) ||
+        !opt_shape.count(name)) {
+      continue;
+    }
+    auto& min = min_shape.at(name);
+    auto& max = max_shape.at(name);
+    auto& opt = opt_shape.at(name);
+    if (min.size() != max.size() || min.size() != opt.size()) {
+      continue;
+    }
+    auto& bounds = bounds_[name];
+    for (size_t d = 0; d < min.size(); ++d) {
+      bounds.push_back(DimBounds(min[d], max[d], opt[d]));
+      num_levels_ =
+          std::max(num_levels_, static_cast<int>(bounds.back().size()));
+    }
+  }
+}
+
+std::map<std::string, std::vector<int64_t>> ShapeBuckets::LevelShapes(
+    int level) const {
+  std::map<std::string, std::vector<int64_t>> shapes;
+  for (auto& it : bounds_) {
+    auto& shape = shapes[it.first];
+    for (auto& bounds : it.second) {
+      shape.push_back(
+          bounds[std::min(static_cast<size_t>(level), bounds.size() - 1)]);
+    }
+  }
+  return shapes;
+}
+
+bool ShapeBuckets::BucketShape(const std::string& name,
+                               const std::vector<int64_t>& shape,
+                               std::vector<int64_t>* bucket) const {
+  auto it = bounds_.find(name);
+  if (it == bounds_.end() || it->second.size() != shape.size()) {
+    return false;
+  }
+  bucket->resize(shape.size());
+  for (size_t d = 0; d < shape.size(); ++d) {
+    auto& bounds = it->second[d];
+    auto b = std::lower_bound(bounds.begin(), bounds.end(), shape[d]);
+    if (b == bounds.end()) {
+      return false;
+    }
+    (*bucket)[d] = *b;
+  }
+  return true;
+}
+
+void PadTensor(const framework::LoDTensor& src, const framework::DDim& dims,
+               float value, framework::LoDTensor* dst) {
+  const auto& src_dims = src.dims();
+  PADDLE_ENFORCE_EQ(
+      src_dims.size(), dims.size(),
+      platform::errors::InvalidArgument(
+          "The tensor of rank %d can not be padded to rank %d.",
+          src_dims.size(), dims.size()));
+  for (int d = 0; d < dims.size(); ++d) {
+    PADDLE_ENFORCE_LE(src_dims[d], dims[d],
+                      platform::errors::InvalidArgument(
+                          "The tensor of shape [%s] can not be padded to "
+                          "shape [%s].",
+                          src_dims, dims));
+  }
+  PADDLE_ENFORCE_EQ(platform::is_cpu_place(src.place()), true,
+                    platform::errors::Unimplemented(
+                        "Only the tensor on CPU can be padded."));
+
+  auto type = framework::TransToProtoVarType(src.dtype());
+  const size_t size = framework::SizeOfType(type);
+  dst->Resize(dims);
+  auto* dst_data =
+      static_cast<char*>(dst->mutable_data(platform::CPUPlace(), src.dtype()));
+  framework::VisitDataType(type, FillFunctor(dst_data, dst->numel(), value));
+  if (src.numel() == 0) {
+    return;
+  }
+  const auto* src_data = static_cast<const char*>(src.data());
+  const int rank = dims.size();
+  if (rank == 0) {
+    std::memcpy(dst_data, src_data, size);
+    return;
+  }
+
+  // Copy src row by row of its last dim.
+  const int64_t row = src_dims[rank - 1];
+  const int64_t num_rows = src.numel() / row;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    int64_t offset = 0;
+    int64_t stride = dims[rank - 1];
+    int64_t index = i;
+    for (int d = rank - 2; d >= 0; --d) {
+      offset += index % src_dims[d] * stride;
+      index /= src_dims[d];
+      stride *= dims[d];
+    }
+    std::memcpy(dst_data + offset * size, src_data + i * row * size,
+                row * size);
+  }
+}
+
+}  // namespace inference
+}  // namespace paddle
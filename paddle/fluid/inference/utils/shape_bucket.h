@@ -0,0 +1,74 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace inference {
+
+// The buckets of the input shapes of a predictor, made from the min, max
+// and opt shapes of the inputs in a CollectShapeRangeInfo file. A dim whose
+// min and max differ is bucketed by the powers of two between them, its opt
+// and its max, so a shape is rounded up to at most twice its size.
+class ShapeBuckets {
+ public:
+  ShapeBuckets() = default;
+
+  // Makes the buckets of the named inputs, and ignores the other tensors of
+  // the file. An input missing from the file has no buckets.
+  void Init(const std::string& shape_range_info_path,
+            const std::vector<std::string>& input_names);
+  void Init(const std::map<std::string, std::vector<int32_t>>& min_shape,
+            const std::map<std::string, std::vector<int32_t>>& max_shape,
+            const std::map<std::string, std::vector<int32_t>>& opt_shape,
+            const std::vector<std::string>& input_names);
+
+  bool empty() const { return bounds_.empty(); }
+
+  // The number of the shapes returned by LevelShapes, which is the largest
+  // number of buckets of a dim.
+  int num_levels() const { return num_levels_; }
+
+  // The shapes of the inputs at level, in [0, num_levels()), where every
+  // bucketed dim takes its level-th bucket, or its last one. The inputs
+  // sharing a dim, such as the ids and the mask of a sequence, have the
+  // same range and so the same shape at every level.
+  std::map<std::string, std::vector<int64_t>> LevelShapes(int level) const;
+
+  // The smallest bucket of the input holding shape. Returns false if the
+  // input has no buckets, or shape is of another rank or exceeds the max.
+  bool BucketShape(const std::string& name, const std::vector<int64_t>& shape,
+                   std::vector<int64_t>* bucket) const;
+
+ private:
+  // input name -> the ascending bucket bounds of each dim, a single bound
+  // for a static dim
+  std::map<std::string, std::vector<std::vector<int64_t>>> bounds_;
+  int num_levels_{0};
+};
+
+// Copies src into the leading corner of dst of dims, which is not smaller
+// than src in any dim, and fills the rest of dst with value. src should be
+// a dense tensor on CPU.
+void PadTensor(const framework::LoDTensor& src, const framework::DDim& dims,
+               float value, framework::LoDTensor* dst);
+
+}  // namespace inference
+}  // namespace paddle
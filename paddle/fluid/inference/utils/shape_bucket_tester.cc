@@ -0,0 +1,95 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/shape_bucket.h"
+#include <gtest/gtest.h>
+#include "paddle/fluid/inference/utils/io_utils.h"
+
+namespace paddle {
+namespace inference {
+
+TEST(shape_bucket, bucket_shape) {
+  const std::string path = "test_shape_bucket_info";
+  std::map<std::string, std::vector<int32_t>> min_shape, max_shape, opt_shape;
+  for (auto name : {"ids", "mask", "other"}) {
+    min_shape[name] = {1, 5};
+    max_shape[name] = {8, 100};
+    opt_shape[name] = {4, 32};
+  }
+  min_shape["weight"] = {16, 16};
+  max_shape["weight"] = {16, 16};
+  opt_shape["weight"] = {16, 16};
+  SerializeShapeRangeInfo(path, min_shape, max_shape, opt_shape);
+
+  ShapeBuckets buckets;
+  buckets.Init(path, {"ids", "mask", "weight", "no_info"});
+  ASSERT_FALSE(buckets.empty());
+  // 5, 8, 16, 32, 64 and 100 of the second dim
+  ASSERT_EQ(buckets.num_levels(), 6);
+
+  std::vector<int64_t> bucket;
+  ASSERT_TRUE(buckets.BucketShape("ids", {3, 20}, &bucket));
+  ASSERT_EQ(bucket, (std::vector<int64_t>{4, 32}));
+  ASSERT_TRUE(buckets.BucketShape("mask", {8, 100}, &bucket));
+  ASSERT_EQ(bucket, (std::vector<int64_t>{8, 100}));
+  ASSERT_TRUE(buckets.BucketShape("weight", {16, 16}, &bucket));
+  ASSERT_EQ(bucket, (std::vector<int64_t>{16, 16}));
+  ASSERT_FALSE(buckets.BucketShape("ids", {9, 10}, &bucket));
+  ASSERT_FALSE(buckets.BucketShape("ids", {1, 10, 1}, &bucket));
+  ASSERT_FALSE(buckets.BucketShape("other", {1, 10}, &bucket));
+  ASSERT_FALSE(buckets.BucketShape("no_info", {1, 10}, &bucket));
+
+  auto first = buckets.LevelShapes(0);
+  ASSERT_EQ(first.size(), 3UL);
+  ASSERT_EQ(first["ids"], (std::vector<int64_t>{1, 5}));
+  ASSERT_EQ(first["ids"], first["mask"]);
+  ASSERT_EQ(first["weight"], (std::vector<int64_t>{16, 16}));
+  ASSERT_EQ(buckets.LevelShapes(2)["ids"], (std::vector<int64_t>{4, 16}));
+  ASSERT_EQ(buckets.LevelShapes(5)["mask"], (std::vector<int64_t>{8, 100}));
+}
+
+TEST(shape_bucket, pad_tensor) {
+  framework::LoDTensor src;
+  src.Resize({2, 3});
+  float* src_data = src.mutable_data<float>(platform::CPUPlace());
+  for (int i = 0; i < 6; ++i) src_data[i] = i;
+
+  framework::LoDTensor dst;
+  PadTensor(src, phi::make_ddim({3, 4}), -1.f, &dst);
+  ASSERT_EQ(dst.dims(), phi::make_ddim({3, 4}));
+  const float* dst_data = dst.data<float>();
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      float expected = (r < 2 && c < 3) ? r * 3 + c : -1.f;
+      ASSERT_EQ(dst_data[r * 4 + c], expected);
+    }
+  }
+
+  framework::LoDTensor mask;
+  mask.Resize({1, 2});
+  int64_t* mask_data = mask.mutable_data<int64_t>(platform::CPUPlace());
+  mask_data[0] = mask_data[1] = 1;
+  framework::LoDTensor padded_mask;
+  PadTensor(mask, phi::make_ddim({2, 4}), 0.f, &padded_mask);
+  std::vector<int64_t> expected_mask = {1, 1, 0, 0, 0, 0, 0, 0};
+  ASSERT_EQ(std::vector<int64_t>(padded_mask.data<int64_t>(),
+                                 padded_mask.data<int64_t>() + 8),
+            expected_mask);
+
+  ASSERT_THROW(PadTensor(src, phi::make_ddim({1, 4}), 0.f, &dst),
+               paddle::platform::EnforceNotMet);
+}
+
+}  // namespace inference
+}  // namespace paddle
@@ -19,6 +19,7 @@
 #include "paddle/fluid/memory/allocation/allocator.h"
 #include "paddle/fluid/memory/allocation/allocator_strategy.h"
 #include "paddle/fluid/memory/allocation/auto_growth_best_fit_allocator.h"
+#include "paddle/fluid/memory/allocation/bucketed_allocator.h"
 #include "paddle/fluid/memory/allocation/cpu_allocator.h"
 #include "paddle/fluid/memory/allocation/naive_best_fit_allocator.h"
 #include "paddle/fluid/memory/allocation/retry_allocator.h"
@@ -79,6 +80,19 @@ PADDLE_DEFINE_EXPORTED_bool(
     "Whether to use system allocator to allocate CPU and GPU memory. "
     "Only used for unittests.");
 
+PADDLE_DEFINE_EXPORTED_uint64(
+    cpu_allocation_cache_mb, 0,
+    "The MB of the freed CPU allocations which are kept in buckets of size "
+    "classes and reused by the next allocations of the same class, such as "
+    "the short-lived tensors of dygraph. 0 means no cache.");
+
+PADDLE_DEFINE_EXPORTED_bool(
+    enable_host_memory_stats, false,
+    "Whether to count the CPU allocations in the memory stats and record them "
+    "in the memory events of the profiler. It takes effect when the "
+    "allocators are created, i.e. it should be set before the first "
+    "allocation.");
+
 PADDLE_DEFINE_EXPORTED_bool(use_virtual_memory_auto_growth, false,
                             "Use VirtualMemoryAutoGrowthBestFitAllocator.");
 
@@ -316,6 +330,10 @@ class AllocatorFacadePrivate {
       WrapCUDARetryAllocator(FLAGS_gpu_allocator_retry_time);
     }
 
+    if (FLAGS_cpu_allocation_cache_mb > 0) {
+      WrapCPUBucketedAllocator(FLAGS_cpu_allocation_cache_mb << 20);
+    }
+
     WrapStatAllocator();
 
     CheckAllocThreadSafe();
@@ -929,10 +947,19 @@ class AllocatorFacadePrivate {
     }
   }
 
+  void WrapCPUBucketedAllocator(size_t max_cached_bytes) {
+    auto& allocator = allocators_[platform::CPUPlace()];
+    allocator =
+        std::make_shared<BucketedAllocator>(allocator, max_cached_bytes);
+  }
+
   void WrapStatAllocator() {
     for (auto& pair : allocators_) {
-      // Now memory stats is only supported for GPU
-      if (platform::is_gpu_place(pair.first)) {
+      // Now memory stats is only supported for GPU, and for CPU on demand,
+      // since every small host allocation pays for the stats.
+      if ((FLAGS_enable_host_memory_stats &&
+           platform::is_cpu_place(pair.first)) ||
+          platform::is_gpu_place(pair.first)) {
         pair.second = std::make_shared<StatAllocator>(pair.second);
       }
     }
@@ -0,0 +1,113 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/bucketed_allocator.h"
+
+#include <mutex>  // NOLINT
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+static constexpr size_t kMinBucketSize = 256;
+static constexpr size_t kClassesPerPowerOfTwo = 4;
+
+BucketedAllocator::BucketedAllocator(std::shared_ptr<Allocator> allocator,
+                                     size_t max_cached_bytes)
+    : underlying_allocator_(std::move(allocator)),
+      max_cached_bytes_(max_cached_bytes) {
+  PADDLE_ENFORCE_NOT_NULL(
+      underlying_allocator_,
+      platform::errors::InvalidArgument(
+          "Underlying allocator of BucketedAllocator is NULL"));
+  PADDLE_ENFORCE_EQ(
+      underlying_allocator_->IsAllocThreadSafe(), true,
+      platform::errors::PreconditionNotMet(
+          "Underlying allocator of BucketedAllocator is not thread-safe"));
+}
+
+BucketedAllocator::~BucketedAllocator() { FreeCache(); }
+
+size_t BucketedAllocator::BucketSize(size_t size) {
+  if (size <= kMinBucketSize) return kMinBucketSize;
+  // the largest power of two below size, split into the classes
+  size_t power = 1;
+  while (power * 2 < size) power *= 2;
+  size_t step = power / kClassesPerPowerOfTwo;
+  return (size + step - 1) / step * step;
+}
+
+size_t BucketedAllocator::CachedBytes() {
+  std::lock_guard<SpinLock> guard(spinlock_);
+  return cached_bytes_;
+}
+
+phi::Allocation* BucketedAllocator::AllocateImpl(size_t size) {
+  if (size > max_cached_bytes_) {
+    return underlying_allocator_->Allocate(size).release();
+  }
+  size_t bucket_size = BucketSize(size);
+  {
+    std::lock_guard<SpinLock> guard(spinlock_);
+    auto it = buckets_.find(bucket_size);
+    if (it != buckets_.end() && !it->second.empty()) {
+      AllocationPtr allocation = std::move(it->second.back());
+      it->second.pop_back();
+      cached_bytes_ -= bucket_size;
+      return allocation.release();
+    }
+  }
+
+  try {
+    return underlying_allocator_->Allocate(bucket_size).release();
+  } catch (BadAlloc&) {
+    FreeCache();
+    return underlying_allocator_->Allocate(bucket_size).release();
+  }
+}
+
+void BucketedAllocator::FreeImpl(phi::Allocation* allocation) {
+  AllocationPtr ptr(allocation, Allocator::AllocationDeleter);
+  size_t size = allocation->size();
+  // Only the allocations of a class come back with the size of the class.
+  if (size <= max_cached_bytes_ && BucketSize(size) == size) {
+    std::lock_guard<SpinLock> guard(spinlock_);
+    if (cached_bytes_ + size <= max_cached_bytes_) {
+      buckets_[size].emplace_back(std::move(ptr));
+      cached_bytes_ += size;
+      return;
+    }
+  }
+  // ptr frees the allocation by the underlying allocator here
+}
+
+uint64_t BucketedAllocator::ReleaseImpl(const platform::Place& place) {
+  return FreeCache() + underlying_allocator_->Release(place);
+}
+
+uint64_t BucketedAllocator::FreeCache() {
+  std::unordered_map<size_t, std::vector<AllocationPtr>> buckets;
+  uint64_t freed_bytes = 0;
+  {
+    std::lock_guard<SpinLock> guard(spinlock_);
+    buckets.swap(buckets_);
+    freed_bytes = cached_bytes_;
+    cached_bytes_ = 0;
+  }
+  return freed_bytes;
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,66 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/memory/allocation/spin_lock.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// BucketedAllocator keeps the freed allocations in buckets of size classes,
+// 4 classes for each power of two, and hands them out again to the requests
+// of the same class without calling the underlying allocator. It is meant
+// for the many short-lived tensors of dygraph, whose sizes repeat from one
+// step to the next. A request is rounded up to its class, which wastes less
+// than a quarter of it, and at most max_cached_bytes are kept in the buckets.
+// Requests larger than max_cached_bytes go to the underlying allocator.
+class BucketedAllocator : public Allocator {
+ public:
+  BucketedAllocator(std::shared_ptr<Allocator> allocator,
+                    size_t max_cached_bytes);
+
+  ~BucketedAllocator();
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // The size class of size, which is its own class.
+  static size_t BucketSize(size_t size);
+
+  size_t CachedBytes();
+
+ protected:
+  phi::Allocation* AllocateImpl(size_t size) override;
+  void FreeImpl(phi::Allocation* allocation) override;
+  uint64_t ReleaseImpl(const platform::Place& place) override;
+
+ private:
+  uint64_t FreeCache();
+
+  std::shared_ptr<Allocator> underlying_allocator_;
+  const size_t max_cached_bytes_;
+  std::unordered_map<size_t, std::vector<AllocationPtr>> buckets_;
+  size_t cached_bytes_{0};
+  SpinLock spinlock_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,123 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/bucketed_allocator.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "paddle/fluid/memory/allocation/cpu_allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+class CountedAllocator : public Allocator {
+ public:
+  bool IsAllocThreadSafe() const override { return true; }
+
+  size_t alloc_count() const { return alloc_count_; }
+  size_t free_count() const { return free_count_; }
+
+ protected:
+  phi::Allocation *AllocateImpl(size_t size) override {
+    ++alloc_count_;
+    return underlying_.Allocate(size).release();
+  }
+
+  void FreeImpl(phi::Allocation *allocation) override {
+    ++free_count_;
+    AllocationPtr(allocation, Allocator::AllocationDeleter);
+  }
+
+ private:
+  CPUAllocator underlying_;
+  std::atomic<size_t> alloc_count_{0};
+  std::atomic<size_t> free_count_{0};
+};
+
+TEST(bucketed_allocator, bucket_size) {
+  EXPECT_EQ(BucketedAllocator::BucketSize(1), 256UL);
+  EXPECT_EQ(BucketedAllocator::BucketSize(256), 256UL);
+  EXPECT_EQ(BucketedAllocator::BucketSize(257), 320UL);
+  EXPECT_EQ(BucketedAllocator::BucketSize(512), 512UL);
+  EXPECT_EQ(BucketedAllocator::BucketSize(513), 640UL);
+  for (size_t size = 1; size < (1 << 16); size += 7) {
+    size_t bucket_size = BucketedAllocator::BucketSize(size);
+    ASSERT_GE(bucket_size, size);
+    ASSERT_LT(bucket_size - size, std::max<size_t>(size / 4, 256));
+    ASSERT_EQ(BucketedAllocator::BucketSize(bucket_size), bucket_size);
+  }
+}
+
+TEST(bucketed_allocator, reuse) {
+  auto counted = std::make_shared<CountedAllocator>();
+  BucketedAllocator allocator(counted, 1 << 20);
+
+  // the tensors of a step, freed and allocated again by the next step
+  for (int step = 0; step < 3; ++step) {
+    std::vector<AllocationPtr> allocations;
+    for (size_t size : {100, 1000, 4000, 4000, 70000}) {
+      allocations.emplace_back(allocator.Allocate(size));
+      ASSERT_GE(allocations.back()->size(), size);
+    }
+  }
+  EXPECT_EQ(counted->alloc_count(), 5UL);
+  EXPECT_EQ(counted->free_count(), 0UL);
+  EXPECT_GT(allocator.CachedBytes(), 0UL);
+
+  allocator.Release(platform::CPUPlace());
+  EXPECT_EQ(allocator.CachedBytes(), 0UL);
+  EXPECT_EQ(counted->free_count(), 5UL);
+}
+
+TEST(bucketed_allocator, limit) {
+  auto counted = std::make_shared<CountedAllocator>();
+  BucketedAllocator allocator(counted, 4096);
+
+  // larger than the limit
+  allocator.Allocate(8192);
+  EXPECT_EQ(counted->free_count(), 1UL);
+
+  auto x = allocator.Allocate(4096);
+  auto y = allocator.Allocate(4096);
+  x = nullptr;
+  y = nullptr;
+  EXPECT_EQ(allocator.CachedBytes(), 4096UL);
+  EXPECT_EQ(counted->free_count(), 2UL);
+}
+
+TEST(bucketed_allocator, multi_thread) {
+  auto counted = std::make_shared<CountedAllocator>();
+  BucketedAllocator allocator(counted, 1 << 20);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&allocator, i]() {
+      for (int j = 0; j < 1000; ++j) {
+        auto allocation = allocator.Allocate(64 * (i + j % 16 + 1));
+        static_cast<char *>(allocation->ptr())[0] = static_cast<char>(i);
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+  EXPECT_LE(counted->alloc_count(), 8UL * 24);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
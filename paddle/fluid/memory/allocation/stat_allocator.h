@@ -16,6 +16,7 @@
 
 #include "paddle/fluid/memory/allocation/allocator.h"
 #include "paddle/fluid/memory/stats.h"
+#include "paddle/fluid/platform/profiler/event_tracing.h"
 
 namespace paddle {
 namespace memory {
@@ -30,16 +31,28 @@ class StatAllocator : public Allocator {
 
  protected:
   void FreeImpl(phi::Allocation* allocation) override {
-    MEMORY_STAT_UPDATE(Allocated, allocation->place().GetDeviceId(),
-                       -allocation->size());
+    const platform::Place& place = allocation->place();
+    if (platform::is_cpu_place(place)) {
+      MEMORY_STAT_UPDATE(HostAllocated, 0, -allocation->size());
+    } else {
+      MEMORY_STAT_UPDATE(Allocated, place.GetDeviceId(), -allocation->size());
+    }
+    platform::RecordMemEvent(allocation->ptr(), place, allocation->size(),
+                             platform::TracerMemEventType::Free);
     underlying_allocator_->Free(allocation);
   }
 
   phi::Allocation* AllocateImpl(size_t size) override {
     phi::Allocator::AllocationPtr allocation =
         underlying_allocator_->Allocate(size);
-    MEMORY_STAT_UPDATE(Allocated, allocation->place().GetDeviceId(),
-                       allocation->size());
+    const platform::Place& place = allocation->place();
+    if (platform::is_cpu_place(place)) {
+      MEMORY_STAT_UPDATE(HostAllocated, 0, allocation->size());
+    } else {
+      MEMORY_STAT_UPDATE(Allocated, place.GetDeviceId(), allocation->size());
+    }
+    platform::RecordMemEvent(allocation->ptr(), place, allocation->size(),
+                             platform::TracerMemEventType::Allocate);
     return allocation.release();
   }
 
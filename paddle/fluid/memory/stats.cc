@@ -109,6 +109,7 @@ void StatUpdate(const std::string& stat_type, int dev_id, int64_t increment) {
 int RegisterAllStats() {
   MEMORY_STAT_REGISTER(Allocated);
   MEMORY_STAT_REGISTER(Reserved);
+  MEMORY_STAT_REGISTER(HostAllocated);
   return 0;
 }
 
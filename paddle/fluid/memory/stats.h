@@ -167,6 +167,8 @@ void StatUpdate(const std::string& stat_type, int dev_id, int64_t increment);
 // To add a new STAT type, declare here and register in stats.cc
 MEMORY_STAT_DECLARE(Allocated);
 MEMORY_STAT_DECLARE(Reserved);
+// Host memory allocated through AllocatorFacade, only device id 0 is used
+MEMORY_STAT_DECLARE(HostAllocated);
 
 }  // namespace memory
 }  // namespace paddle
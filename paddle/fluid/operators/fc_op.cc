@@ -13,8 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/fc_op.h"
+#include <string>
 #include <vector>
 
+#include "paddle/phi/kernels/quant_linear_kernel.h"
+
 namespace paddle {
 namespace operators {
 
@@ -129,6 +132,113 @@ class FCOp : public framework::OperatorWithKernel {
   }
 };
 
+bool FCInt8Compute<platform::CPUDeviceContext, float>::operator()(
+    const framework::ExecutionContext& ctx) const {
+  // delete_quant_dequant_linear_op_pass leaves the step of the quantization,
+  // quant_conv2d_dequant_fuse_pass the maximum absolute value.
+  float scale_in = 0.f;
+  const std::string linear_scale = "Input_scale_" + ctx.InputName("Input");
+  if (ctx.HasAttr(linear_scale)) {
+    scale_in = ctx.Attr<float>(linear_scale);
+  } else if (ctx.HasAttr("enable_int8") && ctx.Attr<bool>("enable_int8") &&
+             ctx.HasAttr("Input_scale")) {
+    const int bit_length =
+        ctx.HasAttr("bit_length") ? ctx.Attr<int>("bit_length") : 8;
+    if (bit_length != 8) {
+      return false;
+    }
+    scale_in = ctx.Attr<float>("Input_scale") / 127.f;
+  }
+  if (scale_in <= 0.f || ctx.Attr<bool>("use_mkldnn")) {
+    return false;
+  }
+
+  auto* input = ctx.Input<framework::LoDTensor>("Input");
+  auto* w = ctx.Input<Tensor>("W");
+  auto* bias = ctx.Input<Tensor>("Bias");
+  auto* output = ctx.Output<framework::LoDTensor>("Out");
+  paddle::optional<const Tensor&> bias_opt = paddle::none;
+  if (bias != nullptr) {
+    bias_opt = *bias;
+  }
+  auto& dev_ctx = ctx.template device_context<platform::CPUDeviceContext>();
+  phi::QuantLinearKernel<float>(dev_ctx, *input, *w, bias_opt,
+                                ctx.Attr<int>("in_num_col_dims"), false,
+                                ctx.Attr<bool>("padding_weights"),
+                                ctx.Attr<std::string>("activation_type"),
+                                scale_in, {}, output);
+  output->set_lod(input->lod());
+  return true;
+}
+
+namespace {
+
+// The fc ops run by FCInt8Compute, which never use the packed weight.
+bool IsInt8FC(const framework::OpDesc& op) {
+  for (auto& name : op.Input("Input")) {
+    if (op.HasAttr("Input_scale_" + name)) {
+      return true;
+    }
+  }
+  return op.HasAttr("enable_int8") &&
+         BOOST_GET_CONST(bool, op.GetAttr("enable_int8"));
+}
+
+bool GetBoolAttr(const framework::OpDesc& op, const std::string& name) {
+  return op.HasAttr(name) && BOOST_GET_CONST(bool, op.GetAttr(name));
+}
+
+}  // namespace
+
+int PackFCWeights(const framework::ProgramDesc& program,
+                  framework::Scope* scope) {
+#ifdef PADDLE_WITH_MKLML
+  auto& dev_ctx = *static_cast<platform::CPUDeviceContext*>(
+      platform::DeviceContextPool::Instance().Get(platform::CPUPlace()));
+  int count = 0;
+  for (auto* op : program.Block(0).AllOps()) {
+    if (op->Type() != "fc" || GetBoolAttr(*op, "use_mkldnn") ||
+        IsInt8FC(*op)) {
+      continue;
+    }
+    const std::string& w_name = op->Input("W").front();
+    const std::string packed_name = w_name + kFCPackedWeightSuffix;
+    auto* w_var = scope->FindVar(w_name);
+    if (scope->FindVar(packed_name) != nullptr || w_var == nullptr ||
+        !w_var->IsType<framework::LoDTensor>()) {
+      continue;
+    }
+    auto& w = w_var->Get<framework::LoDTensor>();
+    if (!w.IsInitialized() || w.dims().size() != 2 ||
+        !platform::is_cpu_place(w.place())) {
+      continue;
+    }
+
+    const bool padding_weights = GetBoolAttr(*op, "padding_weights");
+    const int K = padding_weights ? w.dims()[0] - 4 : w.dims()[0];
+    const int N = padding_weights ? w.dims()[1] - 4 : w.dims()[1];
+    const int ldw = w.dims()[1];
+    auto* packed = scope->Var(packed_name)->GetMutable<framework::LoDTensor>();
+    bool is_packed = false;
+    if (w.dtype() == phi::DataType::FLOAT32) {
+      is_packed = phi::funcs::PackFCWeight<float>(dev_ctx, N, K,
+                                                  w.data<float>(), ldw, packed);
+    } else if (w.dtype() == phi::DataType::FLOAT64) {
+      is_packed = phi::funcs::PackFCWeight<double>(
+          dev_ctx, N, K, w.data<double>(), ldw, packed);
+    }
+    if (is_packed) {
+      ++count;
+    } else {
+      scope->EraseVars({packed_name});
+    }
+  }
+  return count;
+#else
+  return 0;
+#endif
+}
+
 class FCOpMaker : public framework::OpProtoAndCheckerMaker {
  public:
   void Make() override {
@@ -17,6 +17,8 @@ limitations under the License. */
 #include <string>
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
 #include "paddle/phi/kernels/funcs/fc_functor.h"
 
 namespace paddle {
@@ -25,6 +27,16 @@ enum { kFCMKLDNNFP32 = 1, kFCMKLDNNINT8 = 2 };
 
 using Tensor = framework::Tensor;
 
+// The packed weight of the fc ops on CPU, see PackFCWeights.
+constexpr char kFCPackedWeightSuffix[] = "@GEMM_PACKED";
+
+// Packs the weights of the float fc ops of the program once into the layout
+// of the GEMM backend, as the vars named W + kFCPackedWeightSuffix in scope,
+// which the fc kernel uses instead of W. The weights are kept, since the
+// program still holds them. Returns the number of packed weights.
+int PackFCWeights(const framework::ProgramDesc& program,
+                  framework::Scope* scope);
+
 inline void FCOutputSize(const framework::DDim& in_dims,
                          const framework::DDim& w_dims,
                          std::vector<int64_t>& out_dims,  // NOLINT
@@ -49,10 +61,29 @@ inline void FCOutputSize(const framework::DDim& in_dims,
   out_dims.push_back(w_dims1);
 }
 
+// Runs the fc of an int8 inference program with phi::QuantLinearKernel
+// when the quantization passes left the scale of the input on the op.
+// Returns false to run the float fc, which is what the other devices and
+// types always do.
+template <typename DeviceContext, typename T>
+struct FCInt8Compute {
+  bool operator()(const framework::ExecutionContext& ctx) const {
+    return false;
+  }
+};
+
+template <>
+struct FCInt8Compute<platform::CPUDeviceContext, float> {
+  bool operator()(const framework::ExecutionContext& ctx) const;
+};
+
 template <typename DeviceContext, typename T>
 class FCOpKernel : public framework::OpKernel<T> {
  public:
   void Compute(const paddle::framework::ExecutionContext& ctx) const override {
+    if (FCInt8Compute<DeviceContext, T>()(ctx)) {
+      return;
+    }
     auto* input = ctx.Input<framework::LoDTensor>("Input");
     auto* w = ctx.Input<Tensor>("W");
     auto* bias = ctx.Input<Tensor>("Bias");
@@ -79,10 +110,20 @@ class FCOpKernel : public framework::OpKernel<T> {
     const T* w_data = w->data<T>();
     T* output_data = output->mutable_data<T>(ctx.GetPlace());
 
+    const T* packed_w_data = nullptr;
+    if (platform::is_cpu_place(ctx.GetPlace())) {
+      auto* packed_w =
+          ctx.scope().FindVar(ctx.InputName("W") + kFCPackedWeightSuffix);
+      if (packed_w != nullptr) {
+        packed_w_data = packed_w->Get<framework::LoDTensor>().data<T>();
+      }
+    }
+
     auto& dev_ctx = ctx.template device_context<DeviceContext>();
     phi::funcs::FCFunctor<DeviceContext, T> fc;
     fc(dev_ctx, M, w_dims1, w_dims0, input_data, w_data, output_data,
-       bias ? bias->data<T>() : NULL, with_relu, padding_weights);
+       bias ? bias->data<T>() : NULL, with_relu, padding_weights,
+       packed_w_data);
   }
 };
 
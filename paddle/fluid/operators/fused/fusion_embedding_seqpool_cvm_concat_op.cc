@@ -0,0 +1,204 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/operators/fused/fusion_embedding_seqpool_cvm_concat_op.h"
+#include <string>
+#include <vector>
+#include "paddle/fluid/operators/jit/kernels.h"
+
+namespace paddle {
+namespace operators {
+
+void FusionEmbeddingSeqPoolCVMConcatOp::InferShape(
+    framework::InferShapeContext* ctx) const {
+  const size_t n = ctx->Inputs("Ids").size();
+  PADDLE_ENFORCE_GE(n, 1UL,
+                    paddle::platform::errors::InvalidArgument(
+                        "Inputs(Ids) of FusionEmbeddingSeqPoolCVMConcatOp "
+                        "should not be empty."));
+  const size_t num_tables = ctx->Inputs("W").size();
+  PADDLE_ENFORCE_EQ(
+      num_tables == 1UL || num_tables == n, true,
+      paddle::platform::errors::InvalidArgument(
+          "Inputs(W) of FusionEmbeddingSeqPoolCVMConcatOp should be one "
+          "table shared by all Ids or one table for each Ids, but received "
+          "%d tables for %d Ids.",
+          num_tables, n));
+  PADDLE_ENFORCE(
+      ctx->HasOutput("Out"),
+      paddle::platform::errors::InvalidArgument(
+          "Output(Out) of FusionEmbeddingSeqPoolCVMConcatOp should not be "
+          "null."));
+  int axis = ctx->Attrs().Get<int>("axis");
+  PADDLE_ENFORCE_EQ(axis, 1, paddle::platform::errors::InvalidArgument(
+                                 "FusionEmbeddingSeqPoolCVMConcatOp only "
+                                 "supports concat axis=1 yet, but received "
+                                 "%d.",
+                                 axis));
+
+  auto tables_dims = ctx->GetInputsDim("W");
+  for (auto& dims : tables_dims) {
+    PADDLE_ENFORCE_EQ(dims.size(), 2,
+                      paddle::platform::errors::InvalidArgument(
+                          "The dims size of W should be 2, but received %d.",
+                          dims.size()));
+    PADDLE_ENFORCE_EQ(dims[1], tables_dims[0][1],
+                      paddle::platform::errors::InvalidArgument(
+                          "Width of all tables should be equal."));
+  }
+  int64_t w = tables_dims[0][1];
+  PADDLE_ENFORCE_GE(w, 2, paddle::platform::errors::InvalidArgument(
+                              "Width of W should be at least 2 for show and "
+                              "click, but received %d.",
+                              w));
+  bool use_cvm = ctx->Attrs().Get<bool>("use_cvm");
+  int64_t out_w = use_cvm ? w : w - 2;
+
+  // The output height should be confirmed in Compute,
+  // since input lod is not accessible here.
+  ctx->SetOutputDim("Out", {-1, out_w * static_cast<int64_t>(n)});
+}
+
+framework::OpKernelType
+FusionEmbeddingSeqPoolCVMConcatOp::GetExpectedKernelType(
+    const framework::ExecutionContext& ctx) const {
+  return framework::OpKernelType(
+      OperatorWithKernel::IndicateVarDataType(ctx, "W"), ctx.GetPlace());
+}
+
+void FusionEmbeddingSeqPoolCVMConcatOpMaker::Make() {
+  AddInput("Ids",
+           "(LoDTensor) Ids of each slot, int64 with shape [N, 1] or [N] "
+           "and one level LoD.")
+      .AsDuplicable();
+  AddInput("W",
+           "(Tensor) Embedding tables with shape [H, W], one table shared by "
+           "all Ids or one table for each Ids.")
+      .AsDuplicable();
+  AddInput("CVM",
+           "(Tensor),  a 2-D Tensor with shape [N x 2], where N is the batch "
+           "size, 2 is show and click.");
+  AddOutput("Out", "(LoDTensor) Output tensor of concat operator.");
+  AddAttr<std::string>("pooltype",
+                       "(string, default 'SUM') some of the pooling "
+                       "pooltype of SequencePoolOp.")
+      .SetDefault("SUM")
+      .InEnum({"AVERAGE", "SUM", "SQRT"});
+  AddAttr<bool>("use_cvm",
+                "bool, use cvm or not. Without cvm the first two columns "
+                "of each slot are dropped.")
+      .SetDefault(true);
+  AddAttr<int>("axis",
+               "The axis along which the input tensors will be concatenated. "
+               "Only supports concat axis=1 yet.")
+      .SetDefault(1);
+  AddComment(R"DOC(
+Fusion Embedding Lookup, Sequence Pool of pooltype(sum, average and sqrt),
+CVM and Concat Operator.
+
+The embedding rows of each sequence are gathered and pooled in registers, then
+the cvm transform is applied and the result is written to its place in the
+concatenated output directly.
+)DOC");
+}
+
+template <typename T>
+class FusionEmbeddingSeqPoolCVMConcatKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto ids = ctx.MultiInput<LoDTensor>("Ids");
+    auto tables = ctx.MultiInput<Tensor>("W");
+    auto* out = ctx.Output<LoDTensor>("Out");
+    std::string pooltype = ctx.Attr<std::string>("pooltype");
+    bool use_cvm = ctx.Attr<bool>("use_cvm");
+    auto ids0_lod = ids[0]->lod();
+    PADDLE_ENFORCE_EQ(ids0_lod.empty(), false,
+                      paddle::platform::errors::InvalidArgument(
+                          "Input(Ids) should have LoD."));
+    size_t bs = ids0_lod[0].size() - 1;
+    auto y_dims = out->dims();
+    out->Resize({static_cast<int64_t>(bs), y_dims[1]});
+    framework::LoD y_lod(1);
+    y_lod[0].resize(bs + 1);
+    for (size_t i = 0; i <= bs; ++i) {
+      y_lod[0][i] = i;
+    }
+    out->set_lod(y_lod);
+    T* y_data = out->mutable_data<T>(ctx.GetPlace());
+
+    int64_t w = tables[0]->dims()[1];
+    int64_t out_w = use_cvm ? w : w - 2;
+    jit::emb_seq_pool_cvm_attr_t attr(tables[0]->dims()[0], w, 0,
+                                      jit::SeqPoolType::kSum, use_cvm);
+    if (pooltype == "AVERAGE") {
+      attr.pool_type = jit::SeqPoolType::kAvg;
+    } else if (pooltype == "SQRT") {
+      attr.pool_type = jit::SeqPoolType::kSqrt;
+    }
+    auto emb_seqpool_cvm = jit::KernelFuncs<jit::EmbSeqPoolCVMTuple<T>,
+                                            platform::CPUPlace>::Cache()
+                               .At(attr);
+    size_t n = ids.size();
+    size_t dst_step_size = n * out_w;
+    for (size_t i = 0; i < n; ++i) {
+      const Tensor* table = tables.size() == 1 ? tables[0] : tables[i];
+      auto ids_lod = ids[i]->lod()[0];
+      PADDLE_ENFORCE_EQ(ids_lod.size(), bs + 1,
+                        paddle::platform::errors::InvalidArgument(
+                            "Batchsize of all inputs should be equal."));
+      PADDLE_ENFORCE_EQ(static_cast<size_t>(ids[i]->numel()), ids_lod.back(),
+                        paddle::platform::errors::InvalidArgument(
+                            "Ids should have one id in each row."));
+      attr.table_height = table->dims()[0];
+      const T* table_data = table->data<T>();
+      const int64_t* ids_data = ids[i]->data<int64_t>();
+      // The jitcode reads the rows of the ids without checking them.
+      for (int64_t k = 0; k < ids[i]->numel(); ++k) {
+        PADDLE_ENFORCE_LT(
+            ids_data[k], attr.table_height,
+            platform::errors::InvalidArgument(
+                "The id should be lower than the height of W. But %dth id of "
+                "Ids[%d] is %d and the height is %d.",
+                k, i, ids_data[k], attr.table_height));
+        PADDLE_ENFORCE_GE(
+            ids_data[k], 0,
+            platform::errors::InvalidArgument(
+                "The id should be equal to or larger than 0. But %dth id of "
+                "Ids[%d] is %d.",
+                k, i, ids_data[k]));
+      }
+      T* dst = y_data + i * out_w;
+      for (size_t j = 0; j < bs; ++j) {
+        attr.index_height = static_cast<int64_t>(ids_lod[j + 1] - ids_lod[j]);
+        emb_seqpool_cvm(table_data, ids_data + ids_lod[j], dst, &attr);
+        dst += dst_step_size;
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(
+    fusion_embedding_seqpool_cvm_concat,
+    ops::FusionEmbeddingSeqPoolCVMConcatOp,
+    ops::FusionEmbeddingSeqPoolCVMConcatOpMaker,
+    paddle::framework::EmptyGradOpMaker<paddle::framework::OpDesc>,
+    paddle::framework::EmptyGradOpMaker<paddle::imperative::OpBase>);
+
+REGISTER_OP_CPU_KERNEL(fusion_embedding_seqpool_cvm_concat,
+                       ops::FusionEmbeddingSeqPoolCVMConcatKernel<float>,
+                       ops::FusionEmbeddingSeqPoolCVMConcatKernel<double>);
@@ -12,9 +12,12 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <algorithm>
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/platform/errors.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/multihead_attention.h"
 
 namespace paddle {
 namespace operators {
@@ -111,9 +114,73 @@ Example of matrix multiplication with head_number of B
   }
 };
 
+template <typename T>
+class MultiHeadMatMulV2CPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    using Tensor = framework::Tensor;
+    auto *input = context.Input<framework::Tensor>("Input");
+    auto *w = context.Input<framework::Tensor>("W");
+    auto *bias = context.Input<framework::Tensor>("Bias");
+    auto &bias_qk = GET_DATA_SAFELY(context.Input<framework::Tensor>("BiasQK"),
+                                    "Input", "BiasQK", "MultiHeadMatMulV2");
+    float scale = context.Attr<float>("alpha");
+    int head_number = context.Attr<int>("head_number");
+    auto &dev_ctx = context.template device_context<phi::CPUContext>();
+
+    // should be (B * S * hidden)
+    auto input_dims = input->dims();
+    // shouble be (hidden * 3 * all_head_size)
+    auto w_dims = w->dims();
+    int batch = input_dims[0];
+    int seq_len = input_dims[1];
+    int hidden = input_dims[2];
+    int all_head_size = w_dims[2];
+    int head_size = all_head_size / head_number;
+    PADDLE_ENFORCE_EQ(
+        head_size * head_number, all_head_size,
+        platform::errors::InvalidArgument(
+            "The size of the heads (%d) should be divisible by head_number "
+            "(%d).",
+            all_head_size, head_number));
+
+    auto *out = context.Output<framework::Tensor>("Out");
+    out->Resize({batch, seq_len, all_head_size});
+    auto *output_d = out->mutable_data<T>(context.GetPlace());
+
+    // (B * S, hidden) * (hidden, 3 * N * H) + Bias -> (B * S * 3 * N * H),
+    // the bias is copied to every row and accumulated by the gemm.
+    Tensor qkv_tensor;
+    qkv_tensor.Resize({batch * seq_len, 3 * all_head_size});
+    auto *qkv_d = qkv_tensor.mutable_data<T>(context.GetPlace());
+    const T *bias_d = bias->data<T>();
+    for (int i = 0; i < batch * seq_len; ++i) {
+      std::copy(bias_d, bias_d + 3 * all_head_size,
+                qkv_d + i * 3 * all_head_size);
+    }
+    auto blas = phi::funcs::GetBlas<phi::CPUContext, T>(dev_ctx);
+    blas.GEMM(false, false, batch * seq_len, 3 * all_head_size, hidden,
+              static_cast<T>(1), input->data<T>(), hidden, w->data<T>(),
+              3 * all_head_size, static_cast<T>(1), qkv_d,
+              3 * all_head_size);
+
+    // if bias_qk is [batch, 1, 1, seq_len], it is broadcast to the heads and
+    // the queries by the attention.
+    auto bias_qk_dims = bias_qk.dims();
+    if (bias_qk.numel() == batch * seq_len) {
+      bias_qk_dims = phi::make_ddim({batch, 1, 1, seq_len});
+    }
+    phi::funcs::MultiHeadAttention(dev_ctx, batch, seq_len, head_number,
+                                   head_size, qkv_d, bias_qk.data<T>(),
+                                   bias_qk_dims, scale, output_d);
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
 namespace ops = paddle::operators;
 REGISTER_OP_WITHOUT_GRADIENT(multihead_matmul, ops::MultiHeadMatMulV2Op,
                              ops::MultiHeadMatMulV2OpMaker);
+REGISTER_OP_CPU_KERNEL(multihead_matmul,
+                       ops::MultiHeadMatMulV2CPUKernel<float>);
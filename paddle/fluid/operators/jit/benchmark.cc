@@ -311,6 +311,37 @@ void BenchKernelEmbSeqPool() {
   }
 }
 
+template <typename KernelTuple, typename PlaceType>
+void BenchKernelEmbSeqPoolCVM() {
+  using T = typename KernelTuple::data_type;
+  std::vector<jit::SeqPoolType> pool_types = {jit::SeqPoolType::kSum,
+                                              jit::SeqPoolType::kAvg};
+  int64_t tbl_h = 1e4;
+  for (int tbl_w : {10, 16, 256}) {
+    Tensor table;
+    table.Resize({tbl_h, tbl_w});
+    RandomVec<T>(tbl_h * tbl_w, table.mutable_data<T>(PlaceType()), 0.f, 2.f);
+    const T* table_data = table.data<T>();
+    for (auto type : pool_types) {
+      for (bool use_cvm : {true, false}) {
+        for (int idx_h : {1, 2, 9, 13, 16, 64}) {
+          jit::emb_seq_pool_cvm_attr_t attr(tbl_h, tbl_w, idx_h, type,
+                                            use_cvm);
+          Tensor idx, out;
+          idx.Resize({idx_h});
+          out.Resize({tbl_w});
+          RandomVec<int64_t>(idx_h, idx.mutable_data<int64_t>(PlaceType()), 0,
+                             tbl_h - 1);
+          const int64_t* idx_data = idx.data<int64_t>();
+          T* o_data = out.mutable_data<T>(PlaceType());
+          BenchAllImpls<KernelTuple, PlaceType>(attr, table_data, idx_data,
+                                                o_data, &attr);
+        }
+      }
+    }
+  }
+}
+
 template <typename KernelTuple, typename PlaceType>
 void BenchKernelSgd() {
   using T = typename KernelTuple::data_type;
@@ -364,7 +395,7 @@ void BenchKernelSgd() {
 template <typename KernelTuple, typename PlaceType>
 void BenchKernelMatMul() {
   using T = typename KernelTuple::data_type;
-  for (int m : {1, 2, 3, 4}) {
+  for (int m : {1, 2, 3, 4, 8, 16}) {
     for (int n : TestSizes()) {
       for (int k : TestSizes()) {
         Tensor a, b, c;
@@ -555,6 +586,7 @@ BENCH_FP32_CPU(CRFDecoding);
 
 BENCH_FP32_CPU(SeqPool);
 BENCH_FP32_CPU(EmbSeqPool);
+BENCH_FP32_CPU(EmbSeqPoolCVM);
 BENCH_FP32_CPU(MatMul);
 BENCH_FP32_CPU(Softmax);
 BENCH_FP32_CPU(Sgd);
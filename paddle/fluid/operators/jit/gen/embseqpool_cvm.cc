@@ -0,0 +1,154 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/operators/jit/gen/embseqpool_cvm.h"
+
+#include <stddef.h>  // offsetof
+
+#include <algorithm>
+
+#include "paddle/fluid/operators/jit/refer/refer.h"
+#include "paddle/fluid/operators/jit/registry.h"
+#include "paddle/fluid/platform/cpu_info.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace gen {
+
+void EmbSeqPoolCVMJitCode::genScale() {
+  Label l_done;
+  vxorps(xmm_scale, xmm_scale, xmm_scale);
+  test(reg_idx_height, reg_idx_height);
+  jle(l_done, T_NEAR);
+  vcvtsi2ss(xmm_scale, xmm_scale, reg_idx_height);
+  if (type_ == SeqPoolType::kSqrt) {
+    vsqrtss(xmm_scale, xmm_scale, xmm_scale);
+  }
+  mov(reg_tmp.cvt32(), 0x3f800000);  // 1.f
+  vmovd(xmm_tmp, reg_tmp.cvt32());
+  vdivss(xmm_scale, xmm_tmp, xmm_scale);
+  L(l_done);
+  // vbroadcastss from a register requires avx2
+  vshufps(xmm_scale, xmm_scale, xmm_scale, 0);
+  vinsertf128(ymm_scale, ymm_scale, xmm_scale, 1);
+}
+
+void EmbSeqPoolCVMJitCode::storeGroup(int num_regs, int first_block) {
+  // without cvm the show and click columns are dropped
+  const int skip = use_cvm_ ? 0 : 2;
+  for (int reg_i = 0; reg_i < num_regs; ++reg_i) {
+    ymm_t ymm_acc(reg_i);
+    if (type_ != SeqPoolType::kSum) {
+      vmulps(ymm_acc, ymm_acc, ymm_scale);
+    }
+    const int col = (first_block + reg_i) * YMM_FLOAT_BLOCK;
+    if (col == 0 && skip > 0) {
+      // do not write ahead of dst, it may be the tail of the previous slot
+      vmovhps(ptr[param_dst], xmm_t(reg_i));
+      vextractf128(xmm_tmp, ymm_acc, 1);
+      vmovups(ptr[param_dst + 2 * sizeof(float)], xmm_tmp);
+    } else {
+      vmovups(ptr[param_dst + (col - skip) * sizeof(float)], ymm_acc);
+    }
+  }
+}
+
+void EmbSeqPoolCVMJitCode::genCode() {
+  preCode();
+  const int num_block = tbl_w_ / YMM_FLOAT_BLOCK;
+  const size_t block_size = sizeof(float) * YMM_FLOAT_BLOCK;
+  const int tbl_width_in_byte = sizeof(float) * tbl_w_;
+
+  mov(reg_idx_height,
+      qword[param_attr + offsetof(emb_seq_pool_cvm_attr_t, index_height)]);
+  if (type_ != SeqPoolType::kSum) {
+    genScale();
+  }
+
+  for (int first = 0; first < num_block; first += max_num_regs) {
+    const int num_regs = std::min(max_num_regs, num_block - first);
+    Label l_next_idx_h, l_save_now;
+    for (int reg_i = 0; reg_i < num_regs; ++reg_i) {
+      vxorps(ymm_t(reg_i), ymm_t(reg_i), ymm_t(reg_i));
+    }
+    mov(reg_ptr_idx_i, param_idx);
+    mov(reg_idx_h_i, reg_idx_height);
+    test(reg_idx_h_i, reg_idx_h_i);
+    jle(l_save_now, T_NEAR);
+    L(l_next_idx_h);
+    {
+      // use imul instead of mul to keep rdx, which holds param_dst
+      imul(reg_ptr_tbl_i, qword[reg_ptr_idx_i], tbl_width_in_byte);
+      add(reg_ptr_tbl_i, param_tbl);
+      for (int reg_i = 0; reg_i < num_regs; ++reg_i) {
+        vaddps(ymm_t(reg_i), ymm_t(reg_i),
+               ptr[reg_ptr_tbl_i + (first + reg_i) * block_size]);
+      }
+      add(reg_ptr_idx_i, sizeof(int64_t));
+      dec(reg_idx_h_i);
+      jnz(l_next_idx_h, T_NEAR);
+    }
+    L(l_save_now);
+    storeGroup(num_regs, first);
+  }
+
+  if (!use_cvm_) {
+    postCode();
+    return;
+  }
+  // log is not generated, tail call the cvm transform of the first two
+  // columns after restoring the registers
+  for (int i = 0; i < num_g_abi_regs; ++i) {
+    pop(Xbyak::Reg64(g_abi_regs[num_g_abi_regs - 1 - i]));
+  }
+  vzeroupper();
+  mov(param1, param_dst);  // the only argument of CVMTransform
+  mov(reg_tmp, reinterpret_cast<size_t>(&refer::CVMTransform<float>));
+  jmp(reg_tmp);
+}
+
+class EmbSeqPoolCVMCreator : public JitCodeCreator<emb_seq_pool_cvm_attr_t> {
+ public:
+  bool CanBeUsed(const emb_seq_pool_cvm_attr_t& attr) const override {
+    return platform::MayIUse(platform::avx) && attr.table_width > 0 &&
+           attr.table_width % YMM_FLOAT_BLOCK == 0;
+  }
+  size_t CodeSize(const emb_seq_pool_cvm_attr_t& attr) const override {
+    return 96 + (attr.table_width / YMM_FLOAT_BLOCK) * 32 * 8;
+  }
+  std::unique_ptr<GenBase> CreateJitCode(
+      const emb_seq_pool_cvm_attr_t& attr) const override {
+    PADDLE_ENFORCE_GT(attr.table_height, 0,
+                      platform::errors::InvalidArgument(
+                          "The attribute table_height of EmbSeqPoolCVM "
+                          "should be larger than 0. But it is %d.",
+                          attr.table_height));
+    PADDLE_ENFORCE_GE(attr.table_width, 2,
+                      platform::errors::InvalidArgument(
+                          "The attribute table_width of EmbSeqPoolCVM "
+                          "should be at least 2. But it is %d.",
+                          attr.table_width));
+    return make_unique<EmbSeqPoolCVMJitCode>(attr, CodeSize(attr));
+  }
+};
+
+}  // namespace gen
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
+
+namespace gen = paddle::operators::jit::gen;
+
+REGISTER_JITKERNEL_GEN(kEmbSeqPoolCVM, gen::EmbSeqPoolCVMCreator);
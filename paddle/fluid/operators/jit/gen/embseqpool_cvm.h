@@ -0,0 +1,93 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#pragma once
+
+#include <string>
+
+#include "glog/logging.h"
+#include "paddle/fluid/operators/jit/gen/jitcode.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace gen {
+
+// Gather the embedding rows of one sequence, pool them and apply the cvm
+// transform in one pass. The pooled row is kept in registers and written to
+// the output once.
+class EmbSeqPoolCVMJitCode : public JitCode {
+ public:
+  explicit EmbSeqPoolCVMJitCode(const emb_seq_pool_cvm_attr_t& attr,
+                                size_t code_size = 256 * 1024,
+                                void* code_ptr = nullptr)
+      : JitCode(code_size, code_ptr),
+        tbl_w_(attr.table_width),
+        type_(attr.pool_type),
+        use_cvm_(attr.use_cvm) {
+    if (!(type_ == SeqPoolType::kSum || type_ == SeqPoolType::kAvg ||
+          type_ == SeqPoolType::kSqrt)) {
+      PADDLE_THROW(platform::errors::Unimplemented(
+          "Only supported pool type: sum, avg and sqrt."));
+    }
+    this->genCode();
+  }
+
+  std::string name() const override {
+    std::string base = "EmbSeqPoolCVMJitCode";
+    if (type_ == SeqPoolType::kSum) {
+      base += "_Sum";
+    } else if (type_ == SeqPoolType::kAvg) {
+      base += "_Avg";
+    } else if (type_ == SeqPoolType::kSqrt) {
+      base += "_Sqrt";
+    }
+    base += use_cvm_ ? "_CVM" : "_NoCVM";
+    base += ("_W" + std::to_string(tbl_w_));
+    return base;
+  }
+  void genCode() override;
+
+ private:
+  // broadcast 1 / h or 1 / sqrt(h) to ymm_scale, 0 when h is 0
+  void genScale();
+  void storeGroup(int num_regs, int first_block);
+
+ private:
+  int tbl_w_;
+  SeqPoolType type_;
+  bool use_cvm_;
+  reg64_t param_tbl{abi_param1};
+  reg64_t param_idx{abi_param2};
+  reg64_t param_dst{abi_param3};
+  reg64_t param_attr{abi_param4};
+
+  reg64_t reg_idx_height{r8};
+  reg64_t reg_ptr_idx_i{r9};
+  reg64_t reg_idx_h_i{r10};
+  reg64_t reg_ptr_tbl_i{r11};
+  reg64_t reg_tmp{rax};
+
+  // ymm0 ~ ymm(max_num_regs - 1) accumulate the pooled row
+  static constexpr int max_num_regs = 12;
+  ymm_t ymm_scale{ymm15};
+  xmm_t xmm_scale{xmm15};
+  xmm_t xmm_tmp{xmm14};
+};
+
+}  // namespace gen
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
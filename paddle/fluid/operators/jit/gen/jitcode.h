@@ -100,6 +100,61 @@ class JitCode : public GenBase, public Xbyak::CodeGenerator {
   }
   void L(const char* label) { Xbyak::CodeGenerator::L(label); }
   void L(Xbyak::Label& label) { Xbyak::CodeGenerator::L(label); }  // NOLINT
+
+  // zero a ymm or zmm, vxorps of zmm requires avx512dq
+  template <typename JMM>
+  void zero_jmm(const JMM& dst) {
+    if (dst.isZMM()) {
+      vpxord(dst, dst, dst);
+    } else {
+      vxorps(dst, dst, dst);
+    }
+  }
+
+  // horizontally reduce all lanes of src to every lane of xmm_t(src),
+  // only MAX and ADD are supported. src and tmp should be lower than 16.
+  template <typename JMM>
+  void reduce_jmm(const JMM& src, const JMM& tmp, operand_type type) {
+    auto process = [&](const Xbyak::Xmm& dst, const Xbyak::Xmm& src1,
+                       const Xbyak::Xmm& src2) {
+      if (type == operand_type::MAX) {
+        vmaxps(dst, src1, src2);
+      } else {
+        vaddps(dst, src1, src2);
+      }
+    };
+    ymm_t ymm_src(src.getIdx()), ymm_tmp(tmp.getIdx());
+    xmm_t xmm_src(src.getIdx()), xmm_tmp(tmp.getIdx());
+    if (src.isZMM()) {
+      vextractf64x4(ymm_tmp, zmm_t(src.getIdx()), 1);
+      process(ymm_src, ymm_src, ymm_tmp);
+    }
+    if (!src.isXMM()) {
+      vextractf128(xmm_tmp, ymm_src, 1);
+      process(xmm_src, xmm_src, xmm_tmp);
+    }
+    vpermilps(xmm_tmp, xmm_src, 0x4E);  // swap 64 bits
+    process(xmm_src, xmm_src, xmm_tmp);
+    vpermilps(xmm_tmp, xmm_src, 0xB1);  // swap 32 bits
+    process(xmm_src, xmm_src, xmm_tmp);
+  }
+
+  // run body with reg_offset = 0, step, ..., (num - 1) * step
+  template <typename Body>
+  void loop_offset(const Xbyak::Reg64& reg_offset, int num, int step,
+                   Body body) {
+    if (num <= 0) {
+      return;
+    }
+    Xbyak::Label loop;
+    xor_(reg_offset, reg_offset);
+    L(loop);
+    body();
+    add(reg_offset, step);
+    cmp(reg_offset, num * step);
+    jl(loop, T_NEAR);
+  }
+
   // Enhanced vector extension
   Xbyak::Address EVEX_compress_addr(Xbyak::Reg64 base, int offt,
                                     bool bcast = false) {
@@ -0,0 +1,216 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/operators/jit/gen/layer_norm.h"
+
+#include <cstring>
+
+#include "paddle/fluid/operators/jit/registry.h"
+#include "paddle/fluid/platform/cpu_info.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace gen {
+
+template <typename JMM>
+void LayerNormJitCode::normalize(int block, bool with_scale, bool with_bias) {
+  const int num_blocks = num_ / block;
+  const int rest = num_ % block;
+  const int step = block * sizeof(float);
+  const size_t rest_offset = num_blocks * step;
+  const bool use_mask = JMM(0).isZMM();
+
+  JMM jmm_mean(mean_idx_), jmm_inv_std(inv_std_idx_), jmm_src(src_idx_);
+  xmm_t xmm_mean(mean_idx_), xmm_inv_std(inv_std_idx_), xmm_src(src_idx_);
+
+  loop_offset(reg_offset, num_blocks, step, [&]() {
+    vmovups(jmm_src, ptr[param_x + reg_offset]);
+    vsubps(jmm_src, jmm_src, jmm_mean);
+    vmulps(jmm_src, jmm_src, jmm_inv_std);
+    if (with_scale) {
+      vmulps(jmm_src, jmm_src, ptr[param_scale + reg_offset]);
+    }
+    if (with_bias) {
+      vaddps(jmm_src, jmm_src, ptr[param_bias + reg_offset]);
+    }
+    vmovups(ptr[param_out + reg_offset], jmm_src);
+  });
+  if (use_mask && rest > 0) {
+    vmovups(jmm_src | k1 | T_z, ptr[param_x + rest_offset]);
+    vsubps(jmm_src, jmm_src, jmm_mean);
+    vmulps(jmm_src, jmm_src, jmm_inv_std);
+    if (with_scale) {
+      vmulps(jmm_src | k1, jmm_src, ptr[param_scale + rest_offset]);
+    }
+    if (with_bias) {
+      vaddps(jmm_src | k1, jmm_src, ptr[param_bias + rest_offset]);
+    }
+    vmovups(ptr[param_out + rest_offset] | k1, jmm_src);
+  }
+  for (int i = 0; !use_mask && i < rest; ++i) {
+    const size_t offset = rest_offset + i * sizeof(float);
+    vmovss(xmm_src, ptr[param_x + offset]);
+    vsubss(xmm_src, xmm_src, xmm_mean);
+    vmulss(xmm_src, xmm_src, xmm_inv_std);
+    if (with_scale) {
+      vmulss(xmm_src, xmm_src, ptr[param_scale + offset]);
+    }
+    if (with_bias) {
+      vaddss(xmm_src, xmm_src, ptr[param_bias + offset]);
+    }
+    vmovss(ptr[param_out + offset], xmm_src);
+  }
+}
+
+template <typename JMM>
+void LayerNormJitCode::genRow(int block) {
+  const int num_blocks = num_ / block;
+  const int rest = num_ % block;
+  const int step = block * sizeof(float);
+  const size_t rest_offset = num_blocks * step;
+  // zmm handles the rest with opmask k1, ymm handles it one by one
+  const bool use_mask = JMM(0).isZMM();
+
+  JMM jmm_acc(acc_idx_), jmm_mean(mean_idx_), jmm_inv_std(inv_std_idx_),
+      jmm_src(src_idx_), jmm_tmp(tmp_idx_);
+  xmm_t xmm_eps(eps_idx_), xmm_num(num_idx_), xmm_acc(acc_idx_),
+      xmm_mean(mean_idx_), xmm_inv_std(inv_std_idx_), xmm_src(src_idx_),
+      xmm_tmp(tmp_idx_);
+
+  // mean
+  zero_jmm(jmm_acc);
+  loop_offset(reg_offset, num_blocks, step, [&]() {
+    vaddps(jmm_acc, jmm_acc, ptr[param_x + reg_offset]);
+  });
+  if (use_mask && rest > 0) {
+    vaddps(jmm_acc | k1, jmm_acc, ptr[param_x + rest_offset]);
+  }
+  reduce_jmm(jmm_acc, jmm_tmp, operand_type::ADD);
+  for (int i = 0; !use_mask && i < rest; ++i) {
+    vaddss(xmm_acc, xmm_acc, ptr[param_x + rest_offset + i * sizeof(float)]);
+  }
+  vdivss(xmm_acc, xmm_acc, xmm_num);
+  vmovss(ptr[param_mean], xmm_acc);
+  vbroadcastss(jmm_mean, xmm_acc);
+
+  // variance
+  zero_jmm(jmm_acc);
+  loop_offset(reg_offset, num_blocks, step, [&]() {
+    vsubps(jmm_src, jmm_mean, ptr[param_x + reg_offset]);
+    vfmadd231ps(jmm_acc, jmm_src, jmm_src);
+  });
+  if (use_mask && rest > 0) {
+    vsubps(jmm_src | k1 | T_z, jmm_mean, ptr[param_x + rest_offset]);
+    vfmadd231ps(jmm_acc, jmm_src, jmm_src);
+  }
+  reduce_jmm(jmm_acc, jmm_tmp, operand_type::ADD);
+  for (int i = 0; !use_mask && i < rest; ++i) {
+    vsubss(xmm_src, xmm_mean, ptr[param_x + rest_offset + i * sizeof(float)]);
+    vfmadd231ss(xmm_acc, xmm_src, xmm_src);
+  }
+  vdivss(xmm_acc, xmm_acc, xmm_num);
+  vmovss(ptr[param_var], xmm_acc);
+
+  // 1 / sqrt(var + epsilon)
+  vaddss(xmm_acc, xmm_acc, xmm_eps);
+  vsqrtss(xmm_acc, xmm_acc, xmm_acc);
+  mov(reg_tmp.cvt32(), 0x3f800000);  // 1.f
+  vmovd(xmm_tmp, reg_tmp.cvt32());
+  vdivss(xmm_inv_std, xmm_tmp, xmm_acc);
+  vbroadcastss(jmm_inv_std, xmm_inv_std);
+
+  // scale and bias are optional
+  Label l_no_scale, l_scale_only, l_none, l_done;
+  test(param_scale, param_scale);
+  jz(l_no_scale, T_NEAR);
+  test(param_bias, param_bias);
+  jz(l_scale_only, T_NEAR);
+  normalize<JMM>(block, true, true);
+  jmp(l_done, T_NEAR);
+  L(l_scale_only);
+  normalize<JMM>(block, true, false);
+  jmp(l_done, T_NEAR);
+  L(l_no_scale);
+  test(param_bias, param_bias);
+  jz(l_none, T_NEAR);
+  normalize<JMM>(block, false, true);
+  jmp(l_done, T_NEAR);
+  L(l_none);
+  normalize<JMM>(block, false, false);
+  L(l_done);
+}
+
+void LayerNormJitCode::genCode() {
+  Label l_next_row, l_end;
+  preCode();
+  // height is the 7th argument, above the return address and pushed registers
+  mov(reg_height.cvt32(), dword[rsp + (num_g_abi_regs + 1) * 8]);
+  test(reg_height.cvt32(), reg_height.cvt32());
+  jle(l_end, T_NEAR);
+
+  const float num = static_cast<float>(num_);
+  uint32_t num_bits;
+  std::memcpy(&num_bits, &num, sizeof(num));
+  mov(reg_tmp.cvt32(), num_bits);
+  vmovd(xmm_t(num_idx_), reg_tmp.cvt32());
+
+  const bool use_zmm = platform::MayIUse(platform::avx512f);
+  const int block = use_zmm ? ZMM_FLOAT_BLOCK : YMM_FLOAT_BLOCK;
+  if (use_zmm && num_ % block != 0) {
+    mov(reg_tmp.cvt32(), (1 << (num_ % block)) - 1);
+    kmovw(k1, reg_tmp.cvt32());
+  }
+  L(l_next_row);
+  {
+    if (use_zmm) {
+      genRow<zmm_t>(block);
+    } else {
+      genRow<ymm_t>(block);
+    }
+    add(param_x, num_ * sizeof(float));
+    add(param_out, num_ * sizeof(float));
+    add(param_mean, sizeof(float));
+    add(param_var, sizeof(float));
+    dec(reg_height.cvt32());
+    jnz(l_next_row, T_NEAR);
+  }
+  L(l_end);
+  postCode();
+}
+
+class LayerNormCreator : public JitCodeCreator<int> {
+ public:
+  bool CanBeUsed(const int& d) const override {
+    // the avx2 path uses fma
+    return d > 0 && (platform::MayIUse(platform::avx512f) ||
+                     platform::MayIUse(platform::avx2));
+  }
+  size_t CodeSize(const int& d) const override {
+    // ymm handles the rest one by one, normalize is generated four times
+    return 96 + (d % YMM_FLOAT_BLOCK + 4) * 48 * 8;
+  }
+  std::unique_ptr<GenBase> CreateJitCode(const int& d) const override {
+    return make_unique<LayerNormJitCode>(d, CodeSize(d));
+  }
+};
+
+}  // namespace gen
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
+
+namespace gen = paddle::operators::jit::gen;
+
+REGISTER_JITKERNEL_GEN(kLayerNorm, gen::LayerNormCreator);
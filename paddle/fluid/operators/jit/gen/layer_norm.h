@@ -0,0 +1,84 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#pragma once
+
+#include <string>
+
+#include "glog/logging.h"
+#include "paddle/fluid/operators/jit/gen/jitcode.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace gen {
+
+// Fused layer norm of each row: mean, variance, normalize with the optional
+// scale and bias.
+class LayerNormJitCode : public JitCode {
+ public:
+  explicit LayerNormJitCode(int d, size_t code_size = 256 * 1024,
+                            void* code_ptr = nullptr)
+      : JitCode(code_size, code_ptr), num_(d) {
+    this->genCode();
+  }
+
+  std::string name() const override {
+    std::string base = "LayerNormJitCode";
+    if (platform::MayIUse(platform::avx512f)) {
+      base += "_AVX512";
+    } else {
+      base += "_AVX2";
+    }
+    return base;
+  }
+  void genCode() override;
+
+ private:
+  template <typename JMM>
+  void genRow(int block);
+
+  // out = (x - mean) / sqrt(var + epsilon) * scale + bias
+  template <typename JMM>
+  void normalize(int block, bool with_scale, bool with_bias);
+
+ private:
+  int num_;
+  reg64_t param_x{abi_param1};
+  reg64_t param_out{abi_param2};
+  reg64_t param_mean{abi_param3};
+  reg64_t param_var{abi_param4};
+  reg64_t param_scale{abi_param5};
+  reg64_t param_bias{abi_param6};
+  // epsilon is passed by xmm0, height and right are on the stack
+
+  reg64_t reg_height{r12};
+  reg64_t reg_offset{r11};
+  reg64_t reg_tmp{rax};
+
+  // keep all lower than 16 for reduce_jmm
+  int eps_idx_ = 0;
+  int num_idx_ = 1;
+  int acc_idx_ = 2;
+  int mean_idx_ = 3;
+  int inv_std_idx_ = 4;
+  int src_idx_ = 5;
+  int tmp_idx_ = 6;
+};
+
+}  // namespace gen
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
@@ -15,6 +15,7 @@
 #include "paddle/fluid/operators/jit/gen/matmul.h"
 
 #include <stddef.h>  // offsetof
+#include <algorithm>
 
 #include "paddle/fluid/operators/jit/registry.h"
 #include "paddle/fluid/platform/cpu_info.h"
@@ -24,100 +25,122 @@ namespace operators {
 namespace jit {
 namespace gen {
 
+// Registers used by one tile: rows * vecs accumulators, vecs for B and one
+// for the broadcast element of A. AVX512 has 32 vector registers and AVX2
+// has 16.
+constexpr int kZmmTileRows = 6;
+constexpr int kZmmTileVecs = 4;
+constexpr int kYmmTileRows = 4;
+constexpr int kYmmTileVecs = 3;
+
+int MatMulJitCode::NumTiles(const matmul_attr_t& attr) {
+  int block = YMM_FLOAT_BLOCK, tile_rows = kYmmTileRows,
+      tile_vecs = kYmmTileVecs;
+  if (platform::MayIUse(platform::avx512f)) {
+    block = ZMM_FLOAT_BLOCK;
+    tile_rows = kZmmTileRows;
+    tile_vecs = kZmmTileVecs;
+  }
+  const int vecs = (attr.n + block - 1) / block;
+  return ((attr.m + tile_rows - 1) / tile_rows) *
+         ((vecs + tile_vecs - 1) / tile_vecs);
+}
+
 void MatMulJitCode::genCode() {
   preCode();
-  int block, rest;
-  const auto groups = packed_groups(n_, k_, &block, &rest);
-  PADDLE_ENFORCE_GT(
-      groups.front(), 0,
-      platform::errors::InvalidArgument("The number of rest registers should "
-                                        "be larger than 0. But it is %d.",
-                                        groups.front()));
+  if (platform::MayIUse(platform::avx512f)) {
+    const int rest = n_ % ZMM_FLOAT_BLOCK;
+    if (rest != 0) {
+      // the last vector of each row only handles the rest
+      mov(reg_tmp.cvt32(), (1 << rest) - 1);
+      kmovw(k1, reg_tmp.cvt32());
+    }
+    genTiles<zmm_t>(ZMM_FLOAT_BLOCK, kZmmTileRows, kZmmTileVecs);
+  } else {
+    genTiles<ymm_t>(YMM_FLOAT_BLOCK, kYmmTileRows, kYmmTileVecs);
+  }
+  postCode();
+}
 
-  const int block_len = sizeof(float) * block;
-  const int x_reg_idx = (block == ZMM_FLOAT_BLOCK ? 32 : 16) - 1;
-  const int w_reg_idx = x_reg_idx - 1;
-  // from packed mov(reg_ptr_wgt, ptr[param_attr + offsetof(matmul_attr_t,
-  // packed_weight)]);
-  mov(reg_ptr_wgt, param_y);
-  size_t z_offset = 0;
-  size_t wgt_offset = 0;
-  for (size_t g = 0; g < groups.size(); ++g) {
-    size_t x_offset = 0;
-    size_t wgt_offset_tmp = 0;
-    for (size_t i = 0; i < g; ++i) {
-      wgt_offset_tmp += groups[i] * block_len;
+template <typename JMM>
+void MatMulJitCode::genTiles(int block, int tile_rows, int tile_vecs) {
+  const int num_vecs = (n_ + block - 1) / block;
+  for (int row = 0; row < m_; row += tile_rows) {
+    const int rows = std::min(tile_rows, m_ - row);
+    for (int vec = 0; vec < num_vecs; vec += tile_vecs) {
+      const int vecs = std::min(tile_vecs, num_vecs - vec);
+      genTile<JMM>(row, rows, vec * block, vecs, block, tile_rows, tile_vecs);
     }
-    for (int k = 0; k < k_; ++k) {
-      wgt_offset = wgt_offset_tmp;
-      vbroadcastss(zmm_t(x_reg_idx), ptr[param_x + x_offset]);
-      // clean
-      if (k == 0) {
-        for (int i = 0; i < groups[g]; ++i) {
-          vxorps(zmm_t(i), zmm_t(i), zmm_t(i));
-        }
-      }
-      for (int i = 0; i < groups[g]; ++i) {
-        vmovups(zmm_t(w_reg_idx),
-                ptr[reg_ptr_wgt + wgt_offset + k * n_ * sizeof(float)]);
-        vfmadd231ps(zmm_t(i), zmm_t(w_reg_idx), zmm_t(x_reg_idx));
-        wgt_offset += block_len;
+  }
+}
+
+template <typename JMM>
+void MatMulJitCode::genTile(int row, int rows, int col, int vecs, int block,
+                            int tile_rows, int tile_vecs) {
+  const bool has_rest = col + vecs * block > n_;
+  auto acc = [&](int i, int j) { return JMM(i * tile_vecs + j); };
+  auto wgt = [&](int j) { return JMM(tile_rows * tile_vecs + j); };
+  JMM jmm_x = JMM(tile_rows * tile_vecs + tile_vecs);
+
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < vecs; ++j) {
+      zero_jmm(acc(i, j));
+    }
+  }
+  lea(reg_ptr_x, ptr[param_x + row * k_ * sizeof(float)]);
+  lea(reg_ptr_y, ptr[param_y + col * sizeof(float)]);
+  mov(reg_tmp, k_);
+  Label loop_k;
+  L(loop_k);
+  {
+    for (int j = 0; j < vecs; ++j) {
+      if (has_rest && j == vecs - 1) {
+        vmovups(wgt(j) | k1 | T_z,
+                ptr[reg_ptr_y + j * block * sizeof(float)]);
+      } else {
+        vmovups(wgt(j), ptr[reg_ptr_y + j * block * sizeof(float)]);
       }
-      // last one, save
-      if (k == k_ - 1) {
-        for (int i = 0; i < groups[g]; ++i) {
-          // only rest save should be careful
-          if (rest != 0 && g == groups.size() - 1 && i == groups[g] - 1) {
-            break;
-          }
-          vmovups(ptr[param_z + z_offset + i * block_len], zmm_t(i));
-        }
+    }
+    for (int i = 0; i < rows; ++i) {
+      vbroadcastss(jmm_x, ptr[reg_ptr_x + i * k_ * sizeof(float)]);
+      for (int j = 0; j < vecs; ++j) {
+        vfmadd231ps(acc(i, j), wgt(j), jmm_x);
       }
-      x_offset += sizeof(float);
     }
-    z_offset += block_len * groups[g];
+    add(reg_ptr_x, sizeof(float));
+    add(reg_ptr_y, n_ * sizeof(float));
+    dec(reg_tmp);
+    jnz(loop_k, T_NEAR);
   }
-
-  if (rest != 0) {
-    // below should refine with mask
-    int reg_idx = groups.back() - 1;
-    z_offset = (n_ - rest) * sizeof(float);
-    int inner_block = 8;
-    while (rest > 0) {
-      if (rest >= 8) {
-        inner_block = 8;
-        vmovups(ptr[param_z + z_offset], ymm_t(reg_idx));
-        // shift zmm of inner_block, change reg_idx if update
-      } else if (rest >= 4) {
-        inner_block = 4;
-        vmovups(ptr[param_z + z_offset], xmm_t(reg_idx));
-      } else if (rest >= 2) {
-        inner_block = 2;
-        vmovq(ptr[param_z + z_offset], xmm_t(reg_idx));
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < vecs; ++j) {
+      size_t offset = ((row + i) * n_ + col + j * block) * sizeof(float);
+      if (has_rest && j == vecs - 1) {
+        vmovups(ptr[param_z + offset] | k1, acc(i, j));
       } else {
-        inner_block = 1;
-        vmovss(ptr[param_z + z_offset], xmm_t(reg_idx));
+        vmovups(ptr[param_z + offset], acc(i, j));
       }
-      z_offset += inner_block * sizeof(float);
-      rest -= inner_block;
     }
   }
-
-  postCode();
 }
 
 class MatMulCreator : public JitCodeCreator<matmul_attr_t> {
  public:
   bool CanBeUsed(const matmul_attr_t& attr) const override {
-    return attr.m == 1 && platform::MayIUse(platform::avx512f) &&
-           attr.n % ZMM_FLOAT_BLOCK == 0 && attr.k < 512;
-  }
-  size_t CodeSize(const matmul_attr_t& attr) const override {
-    int block = YMM_FLOAT_BLOCK;
+    // larger problems are left to blas, which packs the matrices
+    if (attr.k >= 512 || MatMulJitCode::NumTiles(attr) > 128) {
+      return false;
+    }
     if (platform::MayIUse(platform::avx512f)) {
-      block = ZMM_FLOAT_BLOCK;
+      return true;
     }
-    return 96 + 4 * attr.k * (attr.n / block + 1) * 8;
+    // the avx2 path uses fma and has no mask for the rest of n
+    return platform::MayIUse(platform::avx2) &&
+           attr.n % YMM_FLOAT_BLOCK == 0;
+  }
+  size_t CodeSize(const matmul_attr_t& attr) const override {
+    // about 700 bytes for the largest avx512 tile
+    return 96 + MatMulJitCode::NumTiles(attr) * 1024;
   }
   std::unique_ptr<GenBase> CreateJitCode(
       const matmul_attr_t& attr) const override {
@@ -27,16 +27,15 @@ namespace operators {
 namespace jit {
 namespace gen {
 
+// Register blocked microkernel of C(M,N) = A(M,K) * B(K,N). C is split into
+// tiles of several rows and vectors, each tile keeps its accumulators in
+// registers while looping over K.
 class MatMulJitCode : public JitCode {
  public:
   explicit MatMulJitCode(const matmul_attr_t& attr,
                          size_t code_size = 256 * 1024,
                          void* code_ptr = nullptr)
       : JitCode(code_size, code_ptr), m_(attr.m), n_(attr.n), k_(attr.k) {
-    PADDLE_ENFORCE_EQ(m_, 1, platform::errors::Unimplemented(
-                                 "Jitcode of matmul only support m==1 (first "
-                                 "matrix's row) now. But m is %d.",
-                                 m_));
     this->genCode();
   }
 
@@ -44,10 +43,26 @@ class MatMulJitCode : public JitCode {
     std::string base = "MatMulJitCode";
     base = base + "_M" + std::to_string(m_) + "_N" + std::to_string(n_) + "_K" +
            std::to_string(k_);
+    if (platform::MayIUse(platform::avx512f)) {
+      base += "_AVX512";
+    } else {
+      base += "_AVX2";
+    }
     return base;
   }
   void genCode() override;
 
+  // the number of tiles of C, which decides the code size
+  static int NumTiles(const matmul_attr_t& attr);
+
+ private:
+  template <typename JMM>
+  void genTiles(int block, int tile_rows, int tile_vecs);
+
+  template <typename JMM>
+  void genTile(int row, int rows, int col, int vecs, int block, int tile_rows,
+               int tile_vecs);
+
  private:
   int m_, n_, k_;
 
@@ -57,7 +72,8 @@ class MatMulJitCode : public JitCode {
   reg64_t param_attr{abi_param4};
   reg64_t reg_tmp{rax};
 
-  reg64_t reg_ptr_wgt{r10};
+  reg64_t reg_ptr_x{r10};
+  reg64_t reg_ptr_y{r11};
 };
 
 }  // namespace gen
@@ -0,0 +1,190 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/operators/jit/gen/softmax.h"
+
+#include "paddle/fluid/operators/jit/gen/act.h"
+#include "paddle/fluid/operators/jit/refer/refer.h"
+#include "paddle/fluid/operators/jit/registry.h"
+#include "paddle/fluid/platform/cpu_info.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace gen {
+
+template <typename JMM>
+void SoftmaxJitCode::exp_jmm(const JMM& dst, const JMM& src, const JMM& fx,
+                             const JMM& fy) {
+  vmaxps(src, src, constant(src, reg_ptr_global, OFFSET_EXP_LOW));
+  // express exp(x) as exp(g + n*log(2)), n = floor(x * log2(e) + 0.5)
+  vbroadcastss(fx, ptr[reg_ptr_global + OFFSET_EXP_0P5]);
+  vfmadd231ps(fx, src, constant(src, reg_ptr_global, OFFSET_EXP_LOG2EF));
+  if (fx.isZMM()) {
+    vrndscaleps(fx, fx, 0x01);
+  } else {
+    vroundps(fx, fx, 0x01);
+  }
+  vfnmadd231ps(src, fx, constant(src, reg_ptr_global, OFFSET_EXP_C1));
+  vfnmadd231ps(src, fx, constant(src, reg_ptr_global, OFFSET_EXP_C2));
+  vmulps(fy, src, src);
+  vbroadcastss(dst, ptr[reg_ptr_global + OFFSET_EXP_P0]);
+  for (size_t offset = OFFSET_EXP_P1; offset <= OFFSET_EXP_P5;
+       offset += YMM_FLOAT_BLOCK * sizeof(float)) {
+    vfmadd213ps(dst, src, constant(src, reg_ptr_global, offset));  // P1~P5
+  }
+  vfmadd213ps(dst, fy, src);
+  vaddps(dst, dst, constant(src, reg_ptr_global, OFFSET_EXP_ONE));
+  // build 2^n
+  vcvttps2dq(fx, fx);
+  vpaddd(fx, fx, constant(fx, reg_ptr_int));
+  vpslld(fx, fx, 23);
+  vmulps(dst, dst, fx);
+}
+
+template <typename JMM>
+void SoftmaxJitCode::genRow(int block) {
+  const int num_blocks = num_ / block;
+  const int rest = num_ % block;
+  const int step = block * sizeof(float);
+  const size_t rest_offset = num_blocks * step;
+  // zmm handles the rest with opmask k1, ymm handles it one by one
+  const bool use_mask = JMM(0).isZMM();
+
+  JMM jmm_max(max_idx_), jmm_sum(sum_idx_), jmm_src(src_idx_),
+      jmm_dst(dst_idx_), jmm_fx(fx_idx_), jmm_fy(fy_idx_), jmm_tmp(tmp_idx_);
+  xmm_t xmm_max(max_idx_), xmm_sum(sum_idx_), xmm_src(src_idx_),
+      xmm_dst(dst_idx_), xmm_fx(fx_idx_), xmm_fy(fy_idx_), xmm_tmp(tmp_idx_);
+
+  // max
+  vbroadcastss(jmm_max, ptr[param_x]);
+  loop_offset(reg_offset, num_blocks, step, [&]() {
+    vmaxps(jmm_max, jmm_max, ptr[param_x + reg_offset]);
+  });
+  if (use_mask && rest > 0) {
+    vmaxps(jmm_max | k1, jmm_max, ptr[param_x + rest_offset]);
+  }
+  reduce_jmm(jmm_max, jmm_tmp, operand_type::MAX);
+  for (int i = 0; !use_mask && i < rest; ++i) {
+    vmaxss(xmm_max, xmm_max, ptr[param_x + rest_offset + i * sizeof(float)]);
+  }
+  vbroadcastss(jmm_max, xmm_max);
+
+  // y = exp(x - max) and its sum
+  zero_jmm(jmm_sum);
+  loop_offset(reg_offset, num_blocks, step, [&]() {
+    vmovups(jmm_src, ptr[param_x + reg_offset]);
+    vsubps(jmm_src, jmm_src, jmm_max);
+    exp_jmm(jmm_dst, jmm_src, jmm_fx, jmm_fy);
+    vmovups(ptr[param_y + reg_offset], jmm_dst);
+    vaddps(jmm_sum, jmm_sum, jmm_dst);
+  });
+  if (use_mask && rest > 0) {
+    vmovups(jmm_src | k1 | T_z, ptr[param_x + rest_offset]);
+    vsubps(jmm_src, jmm_src, jmm_max);
+    exp_jmm(jmm_dst, jmm_src, jmm_fx, jmm_fy);
+    vmovups(ptr[param_y + rest_offset] | k1, jmm_dst);
+    vaddps(jmm_sum | k1, jmm_sum, jmm_dst);
+  }
+  reduce_jmm(jmm_sum, jmm_tmp, operand_type::ADD);
+  for (int i = 0; !use_mask && i < rest; ++i) {
+    const size_t offset = rest_offset + i * sizeof(float);
+    vmovss(xmm_src, ptr[param_x + offset]);
+    vsubss(xmm_src, xmm_src, xmm_max);
+    exp_jmm(xmm_dst, xmm_src, xmm_fx, xmm_fy);
+    vmovss(ptr[param_y + offset], xmm_dst);
+    vaddss(xmm_sum, xmm_sum, xmm_dst);
+  }
+
+  // y = y / sum
+  vmovss(xmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_ONE]);
+  vdivss(xmm_sum, xmm_tmp, xmm_sum);
+  vbroadcastss(jmm_sum, xmm_sum);
+  loop_offset(reg_offset, num_blocks, step, [&]() {
+    vmulps(jmm_dst, jmm_sum, ptr[param_y + reg_offset]);
+    vmovups(ptr[param_y + reg_offset], jmm_dst);
+  });
+  if (use_mask && rest > 0) {
+    vmulps(jmm_dst | k1 | T_z, jmm_sum, ptr[param_y + rest_offset]);
+    vmovups(ptr[param_y + rest_offset] | k1, jmm_dst);
+  }
+  for (int i = 0; !use_mask && i < rest; ++i) {
+    const size_t offset = rest_offset + i * sizeof(float);
+    vmulss(xmm_dst, xmm_sum, ptr[param_y + offset]);
+    vmovss(ptr[param_y + offset], xmm_dst);
+  }
+}
+
+void SoftmaxJitCode::genCode() {
+  Label l_refer, l_next_row, l_end;
+  // softmax along an axis which is not the last one
+  cmp(param_remain.cvt32(), 1);
+  jne(l_refer, T_NEAR);
+
+  preCode();
+  test(param_bs.cvt32(), param_bs.cvt32());
+  jle(l_end, T_NEAR);
+  mov(reg_ptr_global, reinterpret_cast<size_t>(exp_float_consts));
+  mov(reg_ptr_int, reinterpret_cast<size_t>(exp_int_0x7f));
+  const bool use_zmm = platform::MayIUse(platform::avx512f);
+  const int block = use_zmm ? ZMM_FLOAT_BLOCK : YMM_FLOAT_BLOCK;
+  if (use_zmm && num_ % block != 0) {
+    mov(reg_tmp.cvt32(), (1 << (num_ % block)) - 1);
+    kmovw(k1, reg_tmp.cvt32());
+  }
+  L(l_next_row);
+  {
+    if (use_zmm) {
+      genRow<zmm_t>(block);
+    } else {
+      genRow<ymm_t>(block);
+    }
+    add(param_x, num_ * sizeof(float));
+    add(param_y, num_ * sizeof(float));
+    dec(param_bs.cvt32());
+    jnz(l_next_row, T_NEAR);
+  }
+  L(l_end);
+  postCode();
+
+  // tail call with the untouched arguments
+  L(l_refer);
+  mov(reg_tmp, reinterpret_cast<size_t>(&refer::Softmax<float>));
+  jmp(reg_tmp);
+}
+
+class SoftmaxCreator : public JitCodeCreator<int> {
+ public:
+  bool CanBeUsed(const int& d) const override {
+    // the avx2 path uses fma
+    return d > 0 && (platform::MayIUse(platform::avx512f) ||
+                     platform::MayIUse(platform::avx2));
+  }
+  size_t CodeSize(const int& d) const override {
+    // ymm computes exp of the rest one by one
+    return 96 + (d % YMM_FLOAT_BLOCK + 4) * 32 * 8;
+  }
+  std::unique_ptr<GenBase> CreateJitCode(const int& d) const override {
+    return make_unique<SoftmaxJitCode>(d, CodeSize(d));
+  }
+};
+
+}  // namespace gen
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
+
+namespace gen = paddle::operators::jit::gen;
+
+REGISTER_JITKERNEL_GEN(kSoftmax, gen::SoftmaxCreator);
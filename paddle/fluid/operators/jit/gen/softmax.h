@@ -0,0 +1,94 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#pragma once
+
+#include <string>
+
+#include "glog/logging.h"
+#include "paddle/fluid/operators/jit/gen/jitcode.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace gen {
+
+// Fused softmax of each row: max, exp and sum, scale, without calling other
+// kernels. Only remain == 1 is generated, other cases go to refer.
+class SoftmaxJitCode : public JitCode {
+ public:
+  explicit SoftmaxJitCode(int d, size_t code_size = 256 * 1024,
+                          void* code_ptr = nullptr)
+      : JitCode(code_size, code_ptr), num_(d) {
+    this->genCode();
+  }
+
+  std::string name() const override {
+    std::string base = "SoftmaxJitCode";
+    if (platform::MayIUse(platform::avx512f)) {
+      base += "_AVX512";
+    } else {
+      base += "_AVX2";
+    }
+    return base;
+  }
+  void genCode() override;
+
+ private:
+  template <typename JMM>
+  void genRow(int block);
+
+  // dst = exp(src), src should not be larger than 0. src, fx and fy are
+  // clobbered.
+  template <typename JMM>
+  void exp_jmm(const JMM& dst, const JMM& src, const JMM& fx, const JMM& fy);
+
+  // constants are broadcast from memory for zmm
+  template <typename JMM>
+  Xbyak::Address constant(const JMM& jmm, const Xbyak::Reg64& base,
+                          size_t offset = 0) {
+    if (jmm.isZMM()) {
+      return ptr_b[base + offset];
+    }
+    return ptr[base + offset];
+  }
+
+ private:
+  int num_;
+  reg64_t param_x{abi_param1};
+  reg64_t param_y{abi_param2};
+  reg64_t param_n{abi_param3};
+  reg64_t param_bs{abi_param4};
+  reg64_t param_remain{abi_param5};
+
+  reg64_t reg_ptr_global{r10};
+  reg64_t reg_ptr_int{r9};
+  reg64_t reg_offset{r11};
+  reg64_t reg_tmp{rax};
+
+  // keep all lower than 16 for reduce_jmm
+  int max_idx_ = 0;
+  int sum_idx_ = 1;
+  int src_idx_ = 2;
+  int dst_idx_ = 3;
+  int fx_idx_ = 4;
+  int fy_idx_ = 5;
+  int tmp_idx_ = 6;
+};
+
+}  // namespace gen
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
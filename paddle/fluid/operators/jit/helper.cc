@@ -63,6 +63,7 @@ const char* to_string(KernelType kt) {
     ONE_CASE(kStrideASum);
     ONE_CASE(kSoftmax);
     ONE_CASE(kEmbSeqPool);
+    ONE_CASE(kEmbSeqPoolCVM);
     ONE_CASE(kSgd);
     default:
       PADDLE_THROW(platform::errors::Unimplemented(
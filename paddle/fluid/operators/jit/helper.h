@@ -275,6 +275,15 @@ inline std::ostream& operator<<(std::ostream& os,
   return os;
 }
 
+inline std::ostream& operator<<(std::ostream& os,
+                                const emb_seq_pool_cvm_attr_t& attr) {
+  os << "table_height[" << attr.table_height << "],table_width["
+     << attr.table_width << "],index_height[" << attr.index_height
+     << "],pool_type[" << to_string(attr.pool_type) << "],use_cvm["
+     << (attr.use_cvm ? "True" : "False") << "]";
+  return os;
+}
+
 inline std::ostream& operator<<(std::ostream& os, const adam_attr_t& attr) {
   os << "beta1[" << attr.beta1 << "],beta2[" << attr.beta2 << "]";
   return os;
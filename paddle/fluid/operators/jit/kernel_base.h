@@ -27,6 +27,7 @@ typedef enum {
   kAdam = 1,
   kCRFDecoding,
   kEmbSeqPool,
+  kEmbSeqPoolCVM,
   kGRUH1,
   kGRUHtPart1,
   kGRUHtPart2,
@@ -247,6 +248,35 @@ struct EmbSeqPoolTuple {
                             const emb_seq_pool_attr_t*);
 };
 
+// embedding seq pool of one sequence followed by the cvm transform, the
+// output has table_width columns with use_cvm, otherwise the first two
+// columns are dropped
+typedef struct emb_seq_pool_cvm_attr_s {
+  int64_t table_height, table_width;
+  int64_t index_height;  // number of ids in the sequence
+  SeqPoolType pool_type;
+  bool use_cvm;
+  emb_seq_pool_cvm_attr_s() = default;
+  explicit emb_seq_pool_cvm_attr_s(int64_t tbl_height, int64_t tbl_width,
+                                   int64_t idx_height,
+                                   SeqPoolType seqpool_type = SeqPoolType::kSum,
+                                   bool cvm = true)
+      : table_height(tbl_height),
+        table_width(tbl_width),
+        index_height(idx_height),
+        pool_type(seqpool_type),
+        use_cvm(cvm) {}
+} emb_seq_pool_cvm_attr_t;
+
+template <typename T>
+struct EmbSeqPoolCVMTuple {
+  static constexpr KernelType kernel_type = kEmbSeqPoolCVM;
+  typedef T data_type;
+  typedef emb_seq_pool_cvm_attr_t attr_type;
+  typedef void (*func_type)(const T*, const int64_t*, T*,
+                            const emb_seq_pool_cvm_attr_t*);
+};
+
 typedef struct sgd_attr_s {
   int64_t param_height, param_width;
   int64_t grad_height, grad_width;
@@ -58,6 +58,15 @@ int64_t JitCodeKey<emb_seq_pool_attr_t>(const emb_seq_pool_attr_t& attr) {
   return attr.table_width;
 }
 
+template <>
+int64_t JitCodeKey<emb_seq_pool_cvm_attr_t>(
+    const emb_seq_pool_cvm_attr_t& attr) {
+  // index_height is only known at runtime
+  int64_t keys[3] = {attr.table_width, static_cast<int64_t>(attr.pool_type),
+                     static_cast<int64_t>(attr.use_cvm)};
+  return XXH64(keys, sizeof(int64_t) * 3, 0);
+}
+
 template <>
 int64_t JitCodeKey<sgd_attr_t>(const sgd_attr_t& attr) {
   return attr.grad_width;
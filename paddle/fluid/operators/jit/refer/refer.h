@@ -503,6 +503,53 @@ void EmbSeqPool(const T* table, const int64_t* idx, T* out,
   }
 }
 
+// the cvm transform of the show and click columns
+template <typename T>
+void CVMTransform(T* x) {
+  x[0] = std::log(x[0] + static_cast<T>(1));
+  x[1] = std::log(x[1] + static_cast<T>(1)) - x[0];
+}
+
+// embedding seq pool of one sequence with cvm
+// table is a matrix with (tbl_h, tbl_w)
+// idx is a vector with length idx_h
+// output is a vector with length tbl_w with use_cvm, otherwise tbl_w - 2
+template <typename T>
+void EmbSeqPoolCVM(const T* table, const int64_t* idx, T* out,
+                   const emb_seq_pool_cvm_attr_t* attr) {
+  const int64_t skip = attr->use_cvm ? 0 : 2;
+  const int64_t out_w = attr->table_width - skip;
+  for (int64_t w = 0; w < out_w; ++w) {
+    out[w] = static_cast<T>(0);
+  }
+  for (int64_t h = 0; h < attr->index_height; ++h) {
+    PADDLE_ENFORCE_LT(
+        idx[h], attr->table_height,
+        platform::errors::InvalidArgument(
+            "The idx shoud be lower than the attribute table_height of "
+            "EmbSeqPoolCVM. But %dth of idx is %d and table_height is %d.",
+            h, idx[h], attr->table_height));
+    PADDLE_ENFORCE_GE(idx[h], 0, platform::errors::InvalidArgument(
+                                     "The idx shoud be equal to or larger than "
+                                     "the 0. But %dth of idx is %d.",
+                                     h, idx[h]));
+    VAdd(table + idx[h] * attr->table_width + skip, out, out, out_w);
+  }
+  if (attr->index_height > 0 && (attr->pool_type == SeqPoolType::kAvg ||
+                                 attr->pool_type == SeqPoolType::kSqrt)) {
+    T scalar = static_cast<T>(1);
+    if (attr->pool_type == SeqPoolType::kAvg) {
+      scalar = scalar / static_cast<T>(attr->index_height);
+    } else {
+      scalar = scalar / std::sqrt(static_cast<T>(attr->index_height));
+    }
+    VScal<T>(&scalar, out, out, out_w);
+  }
+  if (attr->use_cvm) {
+    CVMTransform(out);
+  }
+}
+
 // SGD algorithm:
 // lr is pointor of learning rate scalar
 // param is an input matrix with (param_h, param_w)
@@ -616,6 +663,7 @@ DECLARE_REFER_KERNEL(SeqPool);
 DECLARE_REFER_KERNEL(MatMul);
 DECLARE_REFER_KERNEL(Softmax);
 DECLARE_REFER_KERNEL(EmbSeqPool);
+DECLARE_REFER_KERNEL(EmbSeqPoolCVM);
 DECLARE_REFER_KERNEL(Adam);
 DECLARE_REFER_KERNEL(Sgd);
 DECLARE_REFER_KERNEL(VBroadcast);
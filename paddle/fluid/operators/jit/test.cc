@@ -671,6 +671,64 @@ void TestKernelEmbSeqPool() {
   }
 }
 
+template <typename KernelTuple, typename PlaceType>
+void TestKernelEmbSeqPoolCVM() {
+  using T = typename KernelTuple::data_type;
+  VLOG(10) << "Test JITKernel: " << jit::to_string(KernelTuple::kernel_type);
+  int64_t tbl_h = 1e4;
+  std::vector<jit::SeqPoolType> pool_types = {
+      jit::SeqPoolType::kSum, jit::SeqPoolType::kAvg, jit::SeqPoolType::kSqrt};
+  auto test_sizes = TestSizes();
+  test_sizes.erase(std::remove(test_sizes.begin(), test_sizes.end(), 1000));
+  for (int tbl_w : test_sizes) {
+    if (tbl_w < 2) {
+      continue;
+    }
+    std::vector<T> table(tbl_h * tbl_w);
+    RandomVec<T>(tbl_h * tbl_w, table.data());
+    // show and click are not negative
+    for (int64_t i = 0; i < tbl_h; ++i) {
+      table[i * tbl_w] = std::abs(table[i * tbl_w]);
+      table[i * tbl_w + 1] = std::abs(table[i * tbl_w + 1]);
+    }
+    const T* table_data = table.data();
+    for (auto type : pool_types) {
+      for (bool use_cvm : {true, false}) {
+        for (int idx_h : {0, 1, 2, 9, 13, 16}) {
+          auto ref = jit::GetReferFunc<KernelTuple>();
+          EXPECT_TRUE(ref != nullptr);
+          std::vector<int64_t> idx(idx_h);
+          RandomVec<int64_t>(idx_h, idx.data(), 0, tbl_h - 1);
+          int64_t out_w = use_cvm ? tbl_w : tbl_w - 2;
+          std::vector<T> oref(out_w);
+          jit::emb_seq_pool_cvm_attr_t attr(tbl_h, tbl_w, idx_h, type,
+                                            use_cvm);
+          ref(table_data, idx.data(), oref.data(), &attr);
+
+          auto verifier = [](const typename KernelTuple::func_type tgt,
+                             const std::vector<T>& table,
+                             const std::vector<int64_t>& idx,
+                             const std::vector<T>& oref,
+                             const typename KernelTuple::attr_type& attr) {
+            EXPECT_TRUE(tgt != nullptr);
+            EXPECT_EQ(idx.size(), static_cast<size_t>(attr.index_height));
+            // guard the columns around the output
+            int o_w = oref.size();
+            std::vector<T> out(o_w + 2, static_cast<T>(-1));
+            T* o_data = out.data() + 1;
+            tgt(table.data(), idx.data(), o_data, &attr);
+            ExpectEQ<T>(o_data, oref.data(), o_w);
+            EXPECT_EQ(out.front(), static_cast<T>(-1));
+            EXPECT_EQ(out.back(), static_cast<T>(-1));
+          };
+          TestAllImpls<KernelTuple, PlaceType>(attr, verifier, table, idx, oref,
+                                               attr);
+        }
+      }
+    }
+  }
+}
+
 template <typename KernelTuple, typename PlaceType>
 void TestKernelMatMul() {
   using T = typename KernelTuple::data_type;
@@ -679,8 +737,9 @@ void TestKernelMatMul() {
   // export MKL_CBWR=AVX would make MKL force to use AVX
   // export KMP_DETERMINISTIC_REDUCTION=yes would make the result deterministic
   FLAGS_acc = 1e-3;
-  for (int m : {1, 2, 3, 4}) {
-    for (int n : {1, 2, 3, 4}) {
+  // m and n larger than one tile of the jitcode
+  for (int m : {1, 2, 3, 4, 7}) {
+    for (int n : {1, 2, 3, 4, 16, 17, 72}) {
       for (int k : TestSizes()) {
         auto ref = jit::GetReferFunc<KernelTuple>();
         EXPECT_TRUE(ref != nullptr);
@@ -1201,8 +1260,9 @@ TEST(JITKernel_helper, attr) {
   std::ostringstream out;
   // KernelTypes
   out << jit::to_string(jit::kNone) << jit::to_string(jit::kCRFDecoding)
-      << jit::to_string(jit::kEmbSeqPool) << jit::to_string(jit::kGRUH1)
-      << jit::to_string(jit::kGRUHtPart1) << jit::to_string(jit::kGRUHtPart2)
+      << jit::to_string(jit::kEmbSeqPool) << jit::to_string(jit::kEmbSeqPoolCVM)
+      << jit::to_string(jit::kGRUH1) << jit::to_string(jit::kGRUHtPart1)
+      << jit::to_string(jit::kGRUHtPart2)
       << jit::to_string(jit::kHSum) << jit::to_string(jit::kHMax)
       << jit::to_string(jit::kLSTMCtHt) << jit::to_string(jit::kLSTMC1H1)
       << jit::to_string(jit::kLayerNorm) << jit::to_string(jit::kMatMul)
@@ -1216,7 +1276,7 @@ TEST(JITKernel_helper, attr) {
       << jit::to_string(jit::kAdam) << jit::to_string(jit::kVSigmoid)
       << jit::to_string(jit::kVSquare) << jit::to_string(jit::kVSub)
       << jit::to_string(jit::kVTanh);
-  EXPECT_EQ(out.str().size(), 239UL);
+  EXPECT_EQ(out.str().size(), 253UL);
 
   // SeqPoolTypes
   out.str("");
@@ -1246,6 +1306,10 @@ TEST(JITKernel_helper, attr) {
   out << jit::emb_seq_pool_attr_t(1, 2, 3, 4, 5, jit::SeqPoolType::kAvg);
   EXPECT_EQ(out.str().size(), 93UL);
 
+  out.str("");
+  out << jit::emb_seq_pool_cvm_attr_t(1, 2, 3, jit::SeqPoolType::kAvg, false);
+  EXPECT_EQ(out.str().size(), 77UL);
+
   out.str("");
   out << jit::sgd_attr_t(1, 2, 3, 4, 5);
   EXPECT_EQ(out.str().size(), 81UL);
@@ -1363,6 +1427,26 @@ TEST(JITKernel_key, emb_seq_pool) {
   EXPECT_TRUE(key4 != key5);
 }
 
+TEST(JITKernel_key, emb_seq_pool_cvm) {
+  jit::emb_seq_pool_cvm_attr_t attr1(1, 8, 3, jit::SeqPoolType::kSum, true);
+  jit::emb_seq_pool_cvm_attr_t attr2(10, 8, 9, jit::SeqPoolType::kSum, true);
+  jit::emb_seq_pool_cvm_attr_t attr3(1, 8, 3, jit::SeqPoolType::kAvg, true);
+  jit::emb_seq_pool_cvm_attr_t attr4(1, 8, 3, jit::SeqPoolType::kSum, false);
+  jit::emb_seq_pool_cvm_attr_t attr5(1, 16, 3, jit::SeqPoolType::kSum, true);
+
+  auto key1 = jit::JitCodeKey<jit::emb_seq_pool_cvm_attr_t>(attr1);
+  auto key2 = jit::JitCodeKey<jit::emb_seq_pool_cvm_attr_t>(attr2);
+  auto key3 = jit::JitCodeKey<jit::emb_seq_pool_cvm_attr_t>(attr3);
+  auto key4 = jit::JitCodeKey<jit::emb_seq_pool_cvm_attr_t>(attr4);
+  auto key5 = jit::JitCodeKey<jit::emb_seq_pool_cvm_attr_t>(attr5);
+
+  EXPECT_TRUE(key1 == key2);
+  EXPECT_TRUE(key1 != key3);
+  EXPECT_TRUE(key1 != key4);
+  EXPECT_TRUE(key1 != key5);
+  EXPECT_TRUE(key3 != key4);
+}
+
 TEST(JITKernel_key, adam) {
   jit::adam_attr_t attr1(0.4f, 0.9f);
   jit::adam_attr_t attr2(0.4f, 0.9f);
@@ -1461,6 +1545,7 @@ TEST_CPU_KERNEL(CRFDecoding);
 
 TEST_CPU_KERNEL(SeqPool);
 TEST_CPU_KERNEL(EmbSeqPool);
+TEST_CPU_KERNEL(EmbSeqPoolCVM);
 TEST_CPU_KERNEL(MatMul);
 TEST_CPU_KERNEL(Softmax);
 TEST_CPU_KERNEL(Adam);
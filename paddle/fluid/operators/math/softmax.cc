@@ -31,6 +31,7 @@ template class SoftmaxFunctor<phi::CPUContext, float, true>;
 template class SoftmaxFunctor<phi::CPUContext, float, false>;
 template class SoftmaxFunctor<phi::CPUContext, double, true>;
 template class SoftmaxFunctor<phi::CPUContext, double, false>;
+template class SoftmaxFunctor<phi::CPUContext, platform::bfloat16, false>;
 template class SoftmaxGradFunctor<phi::CPUContext, float>;
 template class SoftmaxGradFunctor<phi::CPUContext, double>;
 
@@ -13,12 +13,15 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <algorithm>
 #include <vector>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/cpu_vec.h"
 #include "paddle/fluid/platform/cpu_info.h"
+#include "paddle/phi/kernels/funcs/cpu_bf16.h"
+#include "paddle/phi/kernels/funcs/parallel_for.h"
 
 namespace paddle {
 namespace operators {
@@ -283,6 +286,48 @@ class SoftmaxFunctor<DeviceContext, float, true, enable_if_CPU<DeviceContext>> {
   }
 };
 
+// bfloat16 of phi CPU runs the float kernel of jit on chunks of rows
+// converted to float by the intra-op threads.
+template <bool is_test>
+class SoftmaxFunctor<phi::CPUContext, platform::bfloat16, is_test> {
+ public:
+  void operator()(const phi::CPUContext& context, const int axis_dim,
+                  const framework::Tensor* X, framework::Tensor* Y) {
+    auto in_dims = X->dims();
+    const int kBatchDim = 0;
+    const int kClassDim = 1;
+    const int batch_size = in_dims[kBatchDim];
+    const int num_classes = in_dims[kClassDim];
+    const int num_remain = num_classes / axis_dim;
+    const auto* in_data = X->data<platform::bfloat16>();
+    auto* out_data = Y->data<platform::bfloat16>();
+    auto compute_softmax =
+        jit::KernelFuncs<jit::SoftmaxTuple<float>, platform::CPUPlace>::Cache()
+            .At(num_classes);
+    // rows converted at once, at least one
+    const int chunk_rows = std::max<int>(
+        1, static_cast<int>(phi::funcs::kBF16ChunkSize / num_classes));
+    const int chunks = (batch_size + chunk_rows - 1) / chunk_rows;
+    phi::funcs::ParallelFor(
+        context, chunks, 8.0 * chunk_rows * num_classes,
+        [&](int64_t begin, int64_t end) {
+          std::vector<float> in_fp32(static_cast<size_t>(chunk_rows) *
+                                     num_classes);
+          std::vector<float> out_fp32(in_fp32.size());
+          for (int64_t c = begin; c < end; ++c) {
+            const int row0 = static_cast<int>(c) * chunk_rows;
+            const int rows = std::min(chunk_rows, batch_size - row0);
+            const int64_t offset = static_cast<int64_t>(row0) * num_classes;
+            const int64_t len = static_cast<int64_t>(rows) * num_classes;
+            phi::funcs::BF16ToFloat(in_data + offset, in_fp32.data(), len);
+            compute_softmax(in_fp32.data(), out_fp32.data(), num_classes,
+                            rows, num_remain);
+            phi::funcs::FloatToBF16(out_fp32.data(), out_data + offset, len);
+          }
+        });
+  }
+};
+
 template <typename DeviceContext, typename T>
 class SoftmaxGradEigen {
  public:
@@ -194,9 +194,19 @@ bool MayIUse(const cpu_isa_t cpu_isa) {
         unsigned int avx512vl_mask = (1 << 31);
         return ((reg[1] & avx512f_mask) && (reg[1] & avx512dq_mask) &&
                 (reg[1] & avx512bw_mask) && (reg[1] & avx512vl_mask));
+      } else if (cpu_isa == avx512_core_vnni) {
+        unsigned int avx512f_mask = (1 << 16);
+        unsigned int avx512dq_mask = (1 << 17);
+        unsigned int avx512bw_mask = (1 << 30);
+        unsigned int avx512vl_mask = (1 << 31);
+        // AVX512_VNNI: ECX Bit 11
+        unsigned int avx512vnni_mask = (1 << 11);
+        return ((reg[1] & avx512f_mask) && (reg[1] & avx512dq_mask) &&
+                (reg[1] & avx512bw_mask) && (reg[1] & avx512vl_mask) &&
+                (reg[2] & avx512vnni_mask));
       }
       // EAX = 7, ECX = 1
-      cpuid(reg, 0x00010007);
+      cpuid_count(reg, 0x00000007, 1);
       if (cpu_isa == avx512_bf16) {
         // AVX512BF16: EAX Bit 5
         int avx512bf16_mask = (1 << 5);
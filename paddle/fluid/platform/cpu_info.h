@@ -39,6 +39,7 @@ limitations under the License. */
 #ifndef PADDLE_WITH_XBYAK
 #ifdef _WIN32
 #define cpuid(reg, x) __cpuidex(reg, x, 0)
+#define cpuid_count(reg, x, sub) __cpuidex(reg, x, sub)
 #else
 #if !defined(WITH_NV_JETSON) && !defined(PADDLE_WITH_ARM) && \
     !defined(PADDLE_WITH_SW) && !defined(PADDLE_WITH_MIPS)
@@ -46,6 +47,9 @@ limitations under the License. */
 inline void cpuid(int reg[4], int x) {
   __cpuid_count(x, 0, reg[0], reg[1], reg[2], reg[3]);
 }
+inline void cpuid_count(int reg[4], int x, int sub) {
+  __cpuid_count(x, sub, reg[0], reg[1], reg[2], reg[3]);
+}
 #endif
 #endif
 #endif
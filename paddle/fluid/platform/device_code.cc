@@ -12,15 +12,25 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <dlfcn.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
 #include <set>
+#include <sstream>
 #include <utility>
 
 #include "paddle/fluid/platform/device_code.h"
 #include "paddle/fluid/platform/enforce.h"
 
 DECLARE_string(cuda_dir);
+DECLARE_string(fusion_group_cpu_compiler);
+DECLARE_string(fusion_group_cpu_cache_dir);
 
 namespace paddle {
 namespace platform {
@@ -71,20 +81,221 @@ DeviceCodePool::DeviceCodePool(const std::vector<platform::Place>& places) {
     set.insert(p);
   }
   for (auto& p : set) {
-    if (is_gpu_place(p)) {
+    AddPlace(p);
+  }
+}
+
+void DeviceCodePool::AddPlace(const platform::Place& place) {
+  if (device_codes_.find(place) != device_codes_.end()) {
+    return;
+  }
+  if (is_gpu_place(place)) {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
-      device_codes_.emplace(p, DeviceCodeMap());
+    device_codes_.emplace(place, DeviceCodeMap());
+    CUDADeviceCode::CheckAvailableStatus();
 #else
-      PADDLE_THROW(platform::errors::PreconditionNotMet(
-          "CUDAPlace or HIPPlace is not supported, please re-compile with "
-          "WITH_GPU=ON or WITH_ROCM=ON."));
+    PADDLE_THROW(platform::errors::PreconditionNotMet(
+        "CUDAPlace or HIPPlace is not supported, please re-compile with "
+        "WITH_GPU=ON or WITH_ROCM=ON."));
 #endif
+  } else if (is_cpu_place(place)) {
+    device_codes_.emplace(place, DeviceCodeMap());
+    CPUDeviceCode::CheckAvailableStatus();
+  }
+}
+
+bool CPUDeviceCode::available_ = false;
+void CPUDeviceCode::CheckAvailableStatus() {
+  std::string command =
+      FLAGS_fusion_group_cpu_compiler + " --version > /dev/null 2>&1";
+  available_ = std::system(command.c_str()) == 0;
+  if (!available_) {
+    LOG_FIRST_N(WARNING, 1) << "The C++ compiler "
+                            << FLAGS_fusion_group_cpu_compiler
+                            << " is needed for JIT compiling of CPU code, "
+                               "please set FLAGS_fusion_group_cpu_compiler.";
+  }
+}
+
+// Whether dir is a directory owned by the user and not writable by the
+// others, so no one else can put a library in it.
+static bool IsPrivateDir(const std::string& dir) {
+  struct stat st;
+  if (stat(dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+    return false;
+  }
+  return st.st_uid == getuid() && (st.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
+// The directory of the compiled libraries: FLAGS_fusion_group_cpu_cache_dir,
+// ~/.cache/paddle/fusion_group by default, or a new temporary directory of
+// this process if it cannot be created or is not private to the user, since
+// the libraries in it are loaded into the process.
+static std::string CPUCodeCacheDir() {
+  static std::string cache_dir = []() -> std::string {
+    std::string dir = FLAGS_fusion_group_cpu_cache_dir;
+    const char* home = std::getenv("HOME");
+    if (dir.empty() && home != nullptr && home[0] != '\0') {
+      dir = std::string(home) + "/.cache/paddle/fusion_group";
+    }
+    bool created = !dir.empty();
+    for (size_t pos = dir.find('/', 1); created; pos = dir.find('/', pos + 1)) {
+      std::string sub_dir = dir.substr(0, pos);
+      if (mkdir(sub_dir.c_str(), 0700) != 0 && errno != EEXIST) {
+        created = false;
+      }
+      if (pos == std::string::npos) {
+        break;
+      }
+    }
+    if (created && IsPrivateDir(dir)) {
+      return dir;
+    }
+    char tmp_dir[] = "/tmp/paddle_fusion_group_XXXXXX";
+    if (mkdtemp(tmp_dir) == nullptr) {
+      return "";
+    }
+    LOG(WARNING) << "Cannot create the directory " << dir
+                 << " for the compiled CPU code, or it is not owned by the "
+                    "user or is writable by the others, use "
+                 << tmp_dir << " instead.";
+    return tmp_dir;
+  }();
+  return cache_dir;
+}
+
+// Quotes path as one word of the shell.
+static std::string ShellQuote(const std::string& path) {
+  std::string quoted = "'";
+  for (char c : path) {
+    if (c == '\'') {
+      quoted += "'\\''";
+    } else {
+      quoted += c;
     }
   }
+  return quoted + "'";
+}
 
-#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
-  CUDADeviceCode::CheckAvailableStatus();
-#endif
+CPUDeviceCode::CPUDeviceCode(const Place& place, const std::string& name,
+                             const std::string& kernel) {
+  if (!is_cpu_place(place)) {
+    PADDLE_THROW(platform::errors::PermissionDenied(
+        "CPUDeviceCode can only launch on CPU place."));
+  }
+
+  place_ = place;
+  name_ = name;
+  kernel_ = kernel;
+}
+
+CPUDeviceCode::~CPUDeviceCode() {
+  if (handle_ != nullptr) {
+    dlclose(handle_);
+  }
+}
+
+bool CPUDeviceCode::Compile(bool include_path) {
+  is_compiled_ = false;
+  if (handle_ != nullptr) {
+    dlclose(handle_);
+    handle_ = nullptr;
+    function_ = nullptr;
+  }
+  std::string cache_dir = CPUCodeCacheDir();
+  if (cache_dir.empty()) {
+    LOG_FIRST_N(WARNING, 1) << "No directory to write the compiled CPU code.";
+    return false;
+  }
+
+  // The code is compiled for the CPU of this machine, so the host is hashed
+  // with the compiler and the code in case the directory is shared.
+  const std::string options = "-std=c++11 -O3 -march=native -fPIC -shared";
+  char host[256] = {0};
+  gethostname(host, sizeof(host) - 1);
+  std::ostringstream lib_path;
+  lib_path << cache_dir << "/" << name_ << "_" << std::hex
+           << std::hash<std::string>()(FLAGS_fusion_group_cpu_compiler + " " +
+                                       options + "\n" + host + "\n" +
+                                       kernel_)
+           << ".so";
+  std::string lib = lib_path.str();
+
+  struct stat st;
+  if (stat(lib.c_str(), &st) != 0) {
+    // Compile into files of this process and rename the library, so the
+    // other processes never load a partial one.
+    std::string suffix = "." + std::to_string(getpid());
+    std::string src = lib + suffix + ".cc";
+    std::string tmp_lib = lib + suffix;
+    {
+      std::ofstream fout(src);
+      fout << kernel_;
+      if (!fout) {
+        LOG(WARNING) << "Cannot write the CPU code to " << src;
+        return false;
+      }
+    }
+    std::string command = FLAGS_fusion_group_cpu_compiler + " " + options +
+                          " -o " + ShellQuote(tmp_lib) + " " +
+                          ShellQuote(src) + " 2>&1";
+    std::string log;
+    FILE* pipe = popen(command.c_str(), "r");
+    int status = -1;
+    if (pipe != nullptr) {
+      char buffer[256];
+      while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
+        log += buffer;
+      }
+      status = pclose(pipe);
+    }
+    std::remove(src.c_str());
+    if (status != 0) {
+      LOG(WARNING) << "JIT compiling of CPU code failed:"
+                   << "\n  Kernel name: " << name_ << "\n  Kernel body:\n"
+                   << kernel_ << "\n  Compiling command: " << command
+                   << "\n  Compiling log: " << log;
+      std::remove(tmp_lib.c_str());
+      return false;
+    }
+    if (std::rename(tmp_lib.c_str(), lib.c_str()) != 0) {
+      LOG(WARNING) << "Cannot rename " << tmp_lib << " to " << lib;
+      std::remove(tmp_lib.c_str());
+      return false;
+    }
+  }
+
+  handle_ = dlopen(lib.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle_ == nullptr) {
+    LOG(WARNING) << "Cannot load " << lib << ": " << dlerror();
+    return false;
+  }
+  function_ = reinterpret_cast<FuncType>(dlsym(handle_, name_.c_str()));
+  if (function_ == nullptr) {
+    LOG(WARNING) << "Cannot find " << name_ << " in " << lib << ": "
+                 << dlerror();
+    return false;
+  }
+  VLOG(3) << "Load the CPU code of " << name_ << " from " << lib;
+  is_compiled_ = true;
+  return true;
+}
+
+void CPUDeviceCode::Launch(const size_t n, std::vector<void*>* args) const {
+  PADDLE_ENFORCE_EQ(
+      is_compiled_, true,
+      errors::PreconditionNotMet(
+          "Please compile the code before launching the kernel."));
+
+  auto* dev_ctx = static_cast<phi::CPUContext*>(
+      DeviceContextPool::Instance().Get(place_));
+  void** data = args->data();
+  FuncType function = function_;
+  dev_ctx->ParallelFor(
+      static_cast<int64_t>(n), cost_per_element_,
+      [function, data](int64_t begin, int64_t end) {
+        function(begin, end, data);
+      });
 }
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
@@ -48,6 +48,38 @@ class DeviceCode {
   std::string kernel_;
 };
 
+// The code runs on CPU as
+//   extern "C" void name(int64_t begin, int64_t end, void** args);
+// which computes the elements [begin, end) of the n given to Launch, and
+// args is the arguments given to Launch. The code is compiled by the system
+// C++ compiler into a shared library, which is cached on disk by the hash of
+// the code, so the processes running the same program compile it once.
+class CPUDeviceCode : public DeviceCode {
+ public:
+  using FuncType = void (*)(int64_t, int64_t, void**);
+
+  explicit CPUDeviceCode(const Place& place, const std::string& name,
+                         const std::string& kernel);
+  ~CPUDeviceCode();
+  bool Compile(bool include_path = false) override;
+  void Launch(const size_t n, std::vector<void*>* args) const override;
+
+  // The cost of an element in cycles, used to split the elements among the
+  // intra-op threads.
+  void SetCostPerElement(double cost) { cost_per_element_ = cost; }
+
+  static void CheckAvailableStatus();
+  static bool IsAvailable() { return available_; }
+
+ private:
+  static bool available_;
+
+  bool is_compiled_{false};
+  double cost_per_element_{8.0};
+  void* handle_{nullptr};
+  FuncType function_{nullptr};
+};
+
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 class CUDADeviceCode : public DeviceCode {
  public:
@@ -106,6 +138,11 @@ class DeviceCodePool {
   static DeviceCodePool& Init(const std::vector<platform::Place>& places) {
     if (pool == nullptr) {
       pool = new DeviceCodePool(places);
+    } else {
+      // e.g. the CPU place of an inference pass after the GPU place
+      for (auto& p : places) {
+        pool->AddPlace(p);
+      }
     }
     return *pool;
   }
@@ -124,6 +161,8 @@ class DeviceCodePool {
   }
 
  private:
+  void AddPlace(const platform::Place& place);
+
   static DeviceCodePool* pool;
   std::map<Place, DeviceCodeMap> device_codes_;
   DISABLE_COPY_AND_ASSIGN(DeviceCodePool);
@@ -43,6 +43,75 @@ void saxpy_kernel(float a, float *x, float* y, float* z, size_t n) {
 )";
 #endif
 
+constexpr auto cpu_saxpy_code = R"(
+#include <cstddef>
+#include <cstdint>
+extern "C" void saxpy_kernel(int64_t begin, int64_t end, void** args) {
+  float a = *reinterpret_cast<float*>(args[0]);
+  const float* x = *reinterpret_cast<float**>(args[1]);
+  const float* y = *reinterpret_cast<float**>(args[2]);
+  float* z = *reinterpret_cast<float**>(args[3]);
+  for (int64_t i = begin; i < end; ++i) {
+    z[i] = a * x[i] + y[i];
+  }
+}
+)";
+
+TEST(DeviceCode, cpu) {
+  paddle::framework::InitDevices();
+  paddle::platform::CPUDeviceCode::CheckAvailableStatus();
+  if (!paddle::platform::CPUDeviceCode::IsAvailable()) {
+    return;
+  }
+
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceCode code(place, "saxpy_kernel", cpu_saxpy_code);
+
+  paddle::framework::Tensor x;
+  paddle::framework::Tensor y;
+  paddle::framework::Tensor z;
+
+  float scale = 2;
+  auto dims =
+      phi::make_ddim({static_cast<int64_t>(256), static_cast<int64_t>(1024)});
+  float* x_data = x.mutable_data<float>(dims, place);
+  float* y_data = y.mutable_data<float>(dims, place);
+  float* z_data = z.mutable_data<float>(dims, place);
+
+  size_t n = x.numel();
+  for (size_t i = 0; i < n; ++i) {
+    x_data[i] = static_cast<float>(i);
+    y_data[i] = static_cast<float>(0.5);
+  }
+
+  // The second compiling loads the library cached by the first one.
+  EXPECT_EQ(code.Compile(), true);
+  EXPECT_EQ(code.Compile(), true);
+
+  std::vector<void*> args = {&scale, &x_data, &y_data, &z_data};
+  code.SetCostPerElement(2);
+  code.Launch(n, &args);
+
+  for (size_t i = 0; i < n; i++) {
+    EXPECT_EQ(z_data[i], static_cast<float>(i) * scale + 0.5);
+  }
+}
+
+TEST(DeviceCodePool, cpu) {
+  paddle::framework::InitDevices();
+  paddle::platform::CPUPlace place;
+  paddle::platform::DeviceCodePool& pool =
+      paddle::platform::DeviceCodePool::Init({place});
+  size_t num_device_codes_before = pool.size(place);
+
+  std::unique_ptr<paddle::platform::DeviceCode> code(
+      new paddle::platform::CPUDeviceCode(place, "saxpy_kernel",
+                                          cpu_saxpy_code));
+  pool.Set(std::move(code));
+  EXPECT_EQ(pool.size(place), num_device_codes_before + 1);
+  EXPECT_NE(pool.Get(place, "saxpy_kernel"), nullptr);
+}
+
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 TEST(DeviceCode, cuda) {
   if (!paddle::platform::dynload::HasNVRTC() ||
@@ -28,6 +28,7 @@ limitations under the License. */
 #include "paddle/fluid/platform/device/mlu/device_context.h"
 #include "paddle/fluid/platform/device/mlu/device_context_allocator.h"
 #endif
+#include "gflags/gflags.h"
 #include "glog/logging.h"
 #include "paddle/fluid/framework/expect.h"
 #include "paddle/fluid/framework/generator.h"
@@ -36,6 +37,8 @@ limitations under the License. */
 #include "paddle/fluid/platform/profiler.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
 
+DECLARE_int32(inner_op_parallelism);
+
 namespace paddle {
 namespace memory {
 
@@ -280,10 +283,12 @@ DeviceContextPool::DeviceContextPool(
 
 CPUDeviceContext::CPUDeviceContext() : phi::CPUContext() {
   phi::CPUContext::Init();
+  phi::CPUContext::SetNumThreads(FLAGS_inner_op_parallelism);
 }
 
 CPUDeviceContext::CPUDeviceContext(CPUPlace place) : phi::CPUContext(place) {
   phi::CPUContext::Init();
+  phi::CPUContext::SetNumThreads(FLAGS_inner_op_parallelism);
 }
 
 #ifdef PADDLE_WITH_IPU
@@ -65,6 +65,38 @@ PADDLE_DEFINE_EXPORTED_bool(
     "Checking whether operator produce NAN/INF or not. It will be "
     "extremely slow so please use this flag wisely.");
 
+/**
+ * Operator related FLAG
+ * Name: FLAGS_conv_cpu_fast_algo
+ * Since Version: 2.3.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_conv_cpu_fast_algo=true lets the CPU conv kernels use the
+ *          Winograd algorithm, whose results differ from im2col + gemm in
+ *          the order of the additions.
+ * Note: Whether the CPU conv kernels choose the Winograd or direct algorithms
+ *       by the shape of the convolution. If false, im2col + gemm is always
+ *       used.
+ */
+PADDLE_DEFINE_EXPORTED_bool(
+    conv_cpu_fast_algo, false,
+    "Whether the CPU conv kernels choose the Winograd or direct algorithms "
+    "by the shape, otherwise im2col + gemm is always used.");
+
+/**
+ * Operator related FLAG
+ * Name: FLAGS_sparse_conv_rulebook_cache_size
+ * Since Version: 2.3.0
+ * Value Range: int32, default=4
+ * Example:
+ * Note: The number of rulebooks kept by the CPU sparse conv kernels. A sparse
+ *       conv whose input has the same indices and geometry as a cached one
+ *       reuses its rulebook, 0 disables the cache.
+ */
+PADDLE_DEFINE_EXPORTED_int32(
+    sparse_conv_rulebook_cache_size, 4,
+    "The number of rulebooks kept by the CPU sparse conv kernels, 0 disables "
+    "the cache.");
+
 // NOTE(zhiqiu): better to share the flags, otherwise we will have too many
 // flags.
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP) || \
@@ -833,3 +865,74 @@ PADDLE_DEFINE_EXPORTED_bool(nccl_blocking_wait, false, "nccl blocking wait");
  * Example:
  */
 PADDLE_DEFINE_EXPORTED_bool(use_autotune, false, "Whether enable autotune.");
+
+/**
+ * Autotune related FLAG
+ * Name: FLAGS_autotune_cache_file
+ * Since Version: 2.3.0
+ * Value Range: string, default=""
+ * Example: FLAGS_autotune_cache_file=/tmp/paddle_autotune.cache
+ * Note: The file of the autotune cache. The tuned algorithms of the current
+ *       device are loaded from it at start and merged into it at the end of
+ *       the tuning steps, so that the processes sharing the file skip the
+ *       tuning. Empty means the cache is kept in memory only.
+ */
+PADDLE_DEFINE_EXPORTED_string(autotune_cache_file, "",
+                              "The file which keeps the autotune cache across "
+                              "processes, empty means no file.");
+
+/**
+ * Autotune related FLAG
+ * Name: FLAGS_autotune_cache_max_entries
+ * Since Version: 2.3.0
+ * Value Range: int64, default=100000
+ * Example:
+ * Note: The max number of the entries kept in FLAGS_autotune_cache_file.
+ */
+PADDLE_DEFINE_EXPORTED_int64(autotune_cache_max_entries, 100000,
+                             "The max number of the entries kept in the "
+                             "autotune cache file.");
+
+/**
+ * Fusion group related FLAG
+ * Name: FLAGS_fusion_group_cpu_compiler
+ * Since Version: 2.3.0
+ * Value Range: string, default="c++"
+ * Example: FLAGS_fusion_group_cpu_compiler=/usr/bin/g++
+ * Note: The C++ compiler which compiles the CPU code generated by the
+ *       fusion_group pass. The fusion_group pass is skipped on CPU if it
+ *       cannot be run.
+ */
+PADDLE_DEFINE_EXPORTED_string(fusion_group_cpu_compiler, "c++",
+                              "The C++ compiler of the CPU code generated by "
+                              "the fusion_group pass.");
+
+/**
+ * Fusion group related FLAG
+ * Name: FLAGS_fusion_group_cpu_cache_dir
+ * Since Version: 2.3.0
+ * Value Range: string, default=""
+ * Example: FLAGS_fusion_group_cpu_cache_dir=/home/work/.cache/fusion_group
+ * Note: The directory of the compiled CPU code of the fusion_group pass,
+ *       which is reused by the processes running the same program. Empty
+ *       means ~/.cache/paddle/fusion_group. It must be owned by the user and
+ *       not writable by the others, or a temporary directory is used.
+ */
+PADDLE_DEFINE_EXPORTED_string(fusion_group_cpu_cache_dir, "",
+                              "The directory of the compiled CPU code of the "
+                              "fusion_group pass, empty means "
+                              "~/.cache/paddle/fusion_group.");
+
+/**
+ * Dygraph related FLAG
+ * Name: FLAGS_dygraph_kernel_context_cache
+ * Since Version: 2.3.0
+ * Value Range: bool, default=true
+ * Example: FLAGS_dygraph_kernel_context_cache=false
+ * Note: Whether dygraph runs phi kernels with the KernelContext of the
+ *       thread and the arguments kept for the op type and kernel key, or
+ *       builds both for every op. Used to measure the dispatch overhead.
+ */
+PADDLE_DEFINE_EXPORTED_bool(dygraph_kernel_context_cache, true,
+                            "Whether dygraph reuses the phi KernelContext and "
+                            "the kernel arguments of the ops.");
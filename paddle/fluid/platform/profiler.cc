@@ -22,6 +22,7 @@ limitations under the License. */
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/profiler.h"
 #include "paddle/fluid/platform/profiler/common_event.h"
+#include "paddle/fluid/platform/profiler/cpu_perf_tracer.h"
 #include "paddle/fluid/platform/profiler/host_event_recorder.h"
 #include "paddle/fluid/platform/profiler/host_tracer.h"
 #include "paddle/fluid/platform/profiler/profiler.h"
@@ -97,6 +98,7 @@ RecordEvent::RecordEvent(const char *name, const TracerEventType type,
   role_ = role;
   type_ = type;
   start_ns_ = PosixInNsec();
+  BeginPerfCounting();
 }
 
 RecordEvent::RecordEvent(const std::string &name, const TracerEventType type,
@@ -127,6 +129,7 @@ RecordEvent::RecordEvent(const std::string &name, const TracerEventType type,
   role_ = role;
   type_ = type;
   start_ns_ = PosixInNsec();
+  BeginPerfCounting();
 }
 
 RecordEvent::RecordEvent(const std::string &name, const std::string &attr,
@@ -159,6 +162,7 @@ RecordEvent::RecordEvent(const std::string &name, const std::string &attr,
   name_ = new std::string(name);
   start_ns_ = PosixInNsec();
   attr_ = new std::string(attr);
+  BeginPerfCounting();
 }
 
 void RecordEvent::OriginalConstruct(const std::string &name,
@@ -179,6 +183,12 @@ void RecordEvent::OriginalConstruct(const std::string &name,
   *name_ = e->name();
 }
 
+void RecordEvent::BeginPerfCounting() {
+  if (UNLIKELY(CpuPerfTracer::IsEnabled())) {
+    perf_counting_ = CpuPerfTracer::GetInstance().BeginEvent();
+  }
+}
+
 void RecordEvent::End() {
 #ifndef _WIN32
 #ifdef PADDLE_WITH_CUDA
@@ -190,6 +200,10 @@ void RecordEvent::End() {
 #endif
   if (LIKELY(FLAGS_enable_host_event_recorder_hook && is_enabled_)) {
     uint64_t end_ns = PosixInNsec();
+    if (UNLIKELY(perf_counting_)) {
+      CpuPerfTracer::GetInstance().EndEvent(start_ns_, end_ns);
+      perf_counting_ = false;
+    }
     if (LIKELY(shallow_copy_name_ != nullptr)) {
       HostEventRecorder::GetInstance().RecordEvent(
           shallow_copy_name_, start_ns_, end_ns, role_, type_);
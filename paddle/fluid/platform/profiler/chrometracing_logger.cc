@@ -45,6 +45,9 @@ const char* ChromeTracingLogger::categary_name_[] = {
     "Communication", "PythonOp",    "PythonUserDefined",
     "MluRuntime"};
 
+const char* ChromeTracingLogger::mem_tracer_type_name_[] = {"Allocate",
+                                                            "Free"};
+
 void ChromeTracingLogger::OpenFile() {
   output_file_stream_.open(filename_,
                            std::ofstream::out | std::ofstream::trunc);
@@ -105,6 +108,10 @@ void ChromeTracingLogger::LogNodeTrees(const NodeTrees& node_trees) {
       if (hostnode != it->second.begin()) {  // skip root node
         (*hostnode)->LogMe(this);
       }
+      for (auto memnode = (*hostnode)->GetMemTraceEventNodes().begin();
+           memnode != (*hostnode)->GetMemTraceEventNodes().end(); ++memnode) {
+        (*memnode)->LogMe(this);
+      }
       for (auto runtimenode = (*hostnode)->GetRuntimeTraceEventNodes().begin();
            runtimenode != (*hostnode)->GetRuntimeTraceEventNodes().end();
            ++runtimenode) {
@@ -120,6 +127,48 @@ void ChromeTracingLogger::LogNodeTrees(const NodeTrees& node_trees) {
   }
 }
 
+void ChromeTracingLogger::LogMemTraceEventNode(
+    const MemTraceEventNode& mem_node) {
+  if (!output_file_stream_) {
+    return;
+  }
+  // instant event on the thread which allocates or frees the memory
+  output_file_stream_ << string_format(
+      std::string(
+          R"JSON(
+  { 
+    "name": "[memory]", "pid": %lld, "tid": "%lld(C++)",
+    "ts": %lld, "s": "t", "ph": "i", "cat": "%s",
+    "args": {
+      "place": "%s",
+      "addr": "%llu",
+      "increase_bytes": %lld,
+      "current_allocated": %llu,
+      "peak_allocated": %llu
+    }
+  },
+  )JSON"),
+      mem_node.ProcessId(), mem_node.ThreadId(),
+      nsToUs(mem_node.TimeStampNs()),
+      mem_tracer_type_name_[static_cast<int>(mem_node.Type())],
+      mem_node.Place().c_str(), mem_node.Addr(), mem_node.IncreaseBytes(),
+      mem_node.CurrentAllocated(), mem_node.PeakAllocated());
+  // counter event, draws the memory timeline of the place
+  output_file_stream_ << string_format(
+      std::string(
+          R"JSON(
+  { 
+    "name": "Memory Allocated(%s)", "pid": %lld,
+    "ts": %lld, "ph": "C",
+    "args": {
+      "allocated": %llu
+    }
+  },
+  )JSON"),
+      mem_node.Place().c_str(), mem_node.ProcessId(),
+      nsToUs(mem_node.TimeStampNs()), mem_node.CurrentAllocated());
+}
+
 void ChromeTracingLogger::LogHostTraceEventNode(
     const HostTraceEventNode& host_node) {
   if (!output_file_stream_) {
@@ -132,6 +181,17 @@ void ChromeTracingLogger::LogHostTraceEventNode(
   } else {
     dur_display = string_format(std::string("%.3f us"), dur * 1000);
   }
+  // hardware counters recorded by CpuPerfTracer
+  std::string perf_args;
+  if (host_node.HasPerfCounters()) {
+    const PerfCounterInfo& counters = host_node.PerfCounters();
+    for (size_t i = 0; i < kNumPerfCounters; ++i) {
+      if (counters.IsValid(static_cast<PerfCounterType>(i))) {
+        perf_args += string_format(std::string(",\n      \"%s\": %llu"),
+                                   kPerfCounterNames[i], counters.values[i]);
+      }
+    }
+  }
   switch (host_node.Type()) {
     case TracerEventType::ProfileStep:
     case TracerEventType::Forward:
@@ -152,7 +212,7 @@ void ChromeTracingLogger::LogHostTraceEventNode(
     "cname": "thread_state_runnable",
     "args": {
       "start_time": "%.3f us",
-      "end_time": "%.3f us"
+      "end_time": "%.3f us"%s
     }
   },
   )JSON"),
@@ -161,7 +221,7 @@ void ChromeTracingLogger::LogHostTraceEventNode(
           nsToUsFloat(host_node.Duration()),
           categary_name_[static_cast<int>(host_node.Type())],
           nsToUsFloat(host_node.StartNs(), start_time_),
-          nsToUsFloat(host_node.EndNs(), start_time_));
+          nsToUsFloat(host_node.EndNs(), start_time_), perf_args.c_str());
       break;
     default:
       output_file_stream_ << string_format(
@@ -174,7 +234,7 @@ void ChromeTracingLogger::LogHostTraceEventNode(
     "cname": "thread_state_runnable",
     "args": {
       "start_time": "%.3f us",
-      "end_time": "%.3f us"
+      "end_time": "%.3f us"%s
     }
   },
   )JSON"),
@@ -183,7 +243,7 @@ void ChromeTracingLogger::LogHostTraceEventNode(
           nsToUsFloat(host_node.Duration()),
           categary_name_[static_cast<int>(host_node.Type())],
           nsToUsFloat(host_node.StartNs(), start_time_),
-          nsToUsFloat(host_node.EndNs(), start_time_));
+          nsToUsFloat(host_node.EndNs(), start_time_), perf_args.c_str());
       break;
   }
 
@@ -34,6 +34,7 @@ class ChromeTracingLogger : public BaseLogger {
   void LogDeviceTraceEventNode(const DeviceTraceEventNode&) override;
   void LogHostTraceEventNode(const HostTraceEventNode&) override;
   void LogRuntimeTraceEventNode(const CudaRuntimeTraceEventNode&) override;
+  void LogMemTraceEventNode(const MemTraceEventNode&) override;
   void LogNodeTrees(const NodeTrees&) override;
   void LogMetaInfo(const std::unordered_map<std::string, std::string>);
 
@@ -48,6 +49,7 @@ class ChromeTracingLogger : public BaseLogger {
   std::string filename_;
   std::ofstream output_file_stream_;
   static const char* categary_name_[];
+  static const char* mem_tracer_type_name_[];
   std::set<std::pair<uint64_t, uint64_t>> pid_tid_set_;
   std::set<std::pair<uint64_t, uint64_t>> deviceid_streamid_set_;
   uint64_t start_time_;
@@ -19,6 +19,7 @@
 #include <string>
 #include "paddle/fluid/platform/event.h"  // import EventRole, TODO(TIEXING): remove later
 #include "paddle/fluid/platform/profiler/trace_event.h"
+#include "paddle/phi/common/place.h"
 
 namespace paddle {
 namespace platform {
@@ -62,5 +63,27 @@ struct CommonEvent {
   const char *attr = nullptr;  // not owned, designed for performance
 };
 
+struct CommonMemEvent {
+ public:
+  CommonMemEvent(uint64_t timestamp_ns, uint64_t addr, TracerMemEventType type,
+                 int64_t increase_bytes, const phi::Place &place,
+                 uint64_t current_allocated, uint64_t peak_allocated)
+      : timestamp_ns(timestamp_ns),
+        addr(addr),
+        type(type),
+        increase_bytes(increase_bytes),
+        place(place),
+        current_allocated(current_allocated),
+        peak_allocated(peak_allocated) {}
+
+  uint64_t timestamp_ns = 0;
+  uint64_t addr = 0;
+  TracerMemEventType type = TracerMemEventType::Allocate;
+  int64_t increase_bytes = 0;
+  phi::Place place;
+  uint64_t current_allocated = 0;
+  uint64_t peak_allocated = 0;
+};
+
 }  // namespace platform
 }  // namespace paddle
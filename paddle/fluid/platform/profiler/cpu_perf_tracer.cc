@@ -0,0 +1,272 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/profiler/cpu_perf_tracer.h"
+
+#include <array>
+#include <cstring>
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "glog/logging.h"
+#include "paddle/fluid/framework/new_executor/workqueue/thread_data_registry.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/os_info.h"
+
+namespace paddle {
+namespace platform {
+
+std::atomic<bool> CpuPerfTracer::enabled_{false};
+
+namespace {
+
+using PerfCounterValues = std::array<uint64_t, kNumPerfCounters>;
+
+#ifdef __linux__
+struct PerfCounterConfig {
+  uint32_t type;
+  uint64_t config;
+};
+
+// Indexed by PerfCounterType
+constexpr PerfCounterConfig kPerfCounterConfigs[kNumPerfCounters] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}};
+
+int OpenPerfCounter(const PerfCounterConfig& config, int group_fd) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = config.type;
+  attr.config = config.config;
+  // the group leader starts disabled, the whole group is enabled at once
+  attr.disabled = group_fd == -1 ? 1 : 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP;
+  // count current thread on any cpu
+  return static_cast<int>(
+      syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+#endif
+
+// Per-thread counter group and the events recorded by the thread.
+class ThreadPerfCounterRecorder {
+ public:
+  ThreadPerfCounterRecorder() { thread_id_ = GetCurrentThreadSysId(); }
+
+  ~ThreadPerfCounterRecorder() { Close(); }
+
+  DISABLE_COPY_AND_ASSIGN(ThreadPerfCounterRecorder);
+
+ public:
+  bool Begin() {
+    PerfCounterValues values;
+    if (!Read(&values)) {
+      return false;
+    }
+    snapshots_.push_back(values);
+    return true;
+  }
+
+  void End(uint64_t start_ns, uint64_t end_ns, bool record) {
+    if (snapshots_.empty()) {
+      return;
+    }
+    PerfCounterValues begin_values = snapshots_.back();
+    snapshots_.pop_back();
+    PerfCounterValues end_values;
+    if (!record || !Read(&end_values)) {
+      return;
+    }
+    PerfCounterInfo info;
+    info.valid_mask = valid_mask_;
+    for (size_t i = 0; i < kNumPerfCounters; ++i) {
+      info.values[i] = end_values[i] - begin_values[i];
+    }
+    events_.emplace_back(start_ns, end_ns, thread_id_, info);
+  }
+
+  std::vector<PerfCounterEvent> GatherEvents() {
+    std::vector<PerfCounterEvent> events;
+    events.swap(events_);
+    return events;
+  }
+
+ private:
+  bool Open() {
+    opened_ = true;
+#ifdef __linux__
+    for (size_t i = 0; i < kNumPerfCounters; ++i) {
+      int fd = OpenPerfCounter(kPerfCounterConfigs[i], leader_fd_);
+      if (fd < 0) {
+        // cycles is the group leader, others are optional
+        if (i == 0) {
+          break;
+        }
+        continue;
+      }
+      if (leader_fd_ == -1) {
+        leader_fd_ = fd;
+      }
+      fds_.push_back(fd);
+      counter_ids_.push_back(i);
+      valid_mask_ |= 1u << i;
+    }
+    if (leader_fd_ == -1) {
+      LOG_FIRST_N(WARNING, 1)
+          << "CpuPerfTracer: perf_event_open failed, hardware counters are "
+             "unavailable. Check /proc/sys/kernel/perf_event_paranoid.";
+      return false;
+    }
+    ioctl(leader_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  void Close() {
+#ifdef __linux__
+    for (int fd : fds_) {
+      close(fd);
+    }
+#endif
+    fds_.clear();
+    counter_ids_.clear();
+    leader_fd_ = -1;
+    valid_mask_ = 0;
+  }
+
+  bool Read(PerfCounterValues* values) {
+    if (!opened_) {
+      Open();
+    }
+    if (leader_fd_ == -1) {
+      return false;
+    }
+#ifdef __linux__
+    // PERF_FORMAT_GROUP layout: { u64 nr; u64 values[nr]; }
+    uint64_t buf[kNumPerfCounters + 1];
+    size_t expected = sizeof(uint64_t) * (fds_.size() + 1);
+    if (read(leader_fd_, buf, sizeof(buf)) !=
+        static_cast<ssize_t>(expected)) {
+      return false;
+    }
+    values->fill(0);
+    for (size_t i = 0; i < counter_ids_.size(); ++i) {
+      (*values)[counter_ids_[i]] = buf[i + 1];
+    }
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  uint64_t thread_id_;
+  bool opened_ = false;
+  int leader_fd_ = -1;
+  std::vector<int> fds_;
+  // fds_[i] counts PerfCounterType(counter_ids_[i])
+  std::vector<size_t> counter_ids_;
+  uint32_t valid_mask_ = 0;
+  std::vector<PerfCounterValues> snapshots_;
+  std::vector<PerfCounterEvent> events_;
+};
+
+using ThreadPerfCounterRecorderRegistry =
+    framework::ThreadDataRegistry<ThreadPerfCounterRecorder>;
+
+ThreadPerfCounterRecorder* GetThreadLocalRecorder() {
+  return ThreadPerfCounterRecorderRegistry::GetInstance()
+      .GetMutableCurrentThreadData();
+}
+
+}  // namespace
+
+bool CpuPerfTracer::IsSupported() {
+#ifdef __linux__
+  static bool supported = []() {
+    int fd = OpenPerfCounter(kPerfCounterConfigs[0], -1);
+    if (fd < 0) {
+      return false;
+    }
+    close(fd);
+    return true;
+  }();
+  return supported;
+#else
+  return false;
+#endif
+}
+
+void CpuPerfTracer::PrepareTracing() {
+  if (!IsSupported()) {
+    LOG(WARNING) << "CpuPerfTracer: hardware performance counters are not "
+                    "supported, host events will carry no counters.";
+  }
+  state_ = TracerState::READY;
+}
+
+void CpuPerfTracer::StartTracing() {
+  PADDLE_ENFORCE_EQ(
+      state_ == TracerState::READY || state_ == TracerState::STOPED, true,
+      platform::errors::PreconditionNotMet("TracerState must be READY"));
+  // drop the events of last round
+  auto thr_recorders =
+      ThreadPerfCounterRecorderRegistry::GetInstance().GetAllThreadDataByRef();
+  for (auto& kv : thr_recorders) {
+    kv.second.get().GatherEvents();
+  }
+  enabled_.store(IsSupported());
+  state_ = TracerState::STARTED;
+}
+
+void CpuPerfTracer::StopTracing() {
+  PADDLE_ENFORCE_EQ(
+      state_, TracerState::STARTED,
+      platform::errors::PreconditionNotMet("TracerState must be STARTED"));
+  enabled_.store(false);
+  state_ = TracerState::STOPED;
+}
+
+void CpuPerfTracer::CollectTraceData(TraceEventCollector* collector) {
+  PADDLE_ENFORCE_EQ(
+      state_, TracerState::STOPED,
+      platform::errors::PreconditionNotMet("TracerState must be STOPED"));
+  auto thr_recorders =
+      ThreadPerfCounterRecorderRegistry::GetInstance().GetAllThreadDataByRef();
+  for (auto& kv : thr_recorders) {
+    for (auto& evt : kv.second.get().GatherEvents()) {
+      collector->AddPerfCounterEvent(std::move(evt));
+    }
+  }
+}
+
+bool CpuPerfTracer::BeginEvent() { return GetThreadLocalRecorder()->Begin(); }
+
+void CpuPerfTracer::EndEvent(uint64_t start_ns, uint64_t end_ns) {
+  GetThreadLocalRecorder()->End(start_ns, end_ns, IsEnabled());
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,70 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include "paddle/fluid/platform/macros.h"
+#include "paddle/fluid/platform/profiler/tracer_base.h"
+
+namespace paddle {
+namespace platform {
+
+// Reads hardware performance counters (cycles, instructions, llc misses and
+// branch misses) around each host RecordEvent, based on Linux perf_event_open.
+// Counters are opened lazily per thread. If they can not be opened (non-Linux
+// system, virtual machine without PMU, perf_event_paranoid restriction, etc),
+// the events of that thread just carry no counters.
+class CpuPerfTracer : public TracerBase {
+ public:
+  // Singleton. RecordEvent needs to find the tracer without a handle.
+  static CpuPerfTracer& GetInstance() {
+    static CpuPerfTracer instance;
+    return instance;
+  }
+
+  // Whether hardware counters can be opened in current process.
+  static bool IsSupported();
+
+  // Used by RecordEvent, cheap enough to be called for every event.
+  static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  void PrepareTracing() override;
+
+  void StartTracing() override;
+
+  void StopTracing() override;
+
+  void CollectTraceData(TraceEventCollector* collector) override;
+
+  // Snapshot the counters of current thread at the beginning of an event.
+  // Returns false if counters are not available, then EndEvent should not be
+  // called for this event.
+  bool BeginEvent();
+
+  // Pop the snapshot pushed by the paired BeginEvent and record the deltas for
+  // the host event [start_ns, end_ns].
+  void EndEvent(uint64_t start_ns, uint64_t end_ns);
+
+ private:
+  CpuPerfTracer() {}
+
+  DISABLE_COPY_AND_ASSIGN(CpuPerfTracer);
+
+  static std::atomic<bool> enabled_;
+};
+
+}  // namespace platform
+}  // namespace paddle
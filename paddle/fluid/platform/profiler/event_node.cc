@@ -16,6 +16,7 @@ limitations under the License. */
 #include <deque>
 #include <set>
 #include <stack>
+#include <utility>
 
 namespace paddle {
 namespace platform {
@@ -26,6 +27,9 @@ HostTraceEventNode::~HostTraceEventNode() {
        ++it) {
     delete *it;
   }
+  for (auto it = mem_node_ptrs_.begin(); it != mem_node_ptrs_.end(); ++it) {
+    delete *it;
+  }
   for (auto it = children_.begin(); it != children_.end(); ++it) {
     delete *it;
   }
@@ -272,6 +276,76 @@ std::map<uint64_t, std::vector<HostTraceEventNode*>> NodeTrees::Traverse(
   return thread2host_event_nodes;
 }
 
+void NodeTrees::AttachPerfCounters(
+    const std::list<PerfCounterEvent>& perf_events) {
+  if (perf_events.empty()) {
+    return;
+  }
+  // counters are read by the same RecordEvent which records the host event,
+  // so (thread_id, start_ns, end_ns) identifies the owner node exactly
+  std::map<uint64_t, std::map<std::pair<uint64_t, uint64_t>,
+                              const PerfCounterEvent*>>
+      thread2perf_events;
+  for (auto it = perf_events.begin(); it != perf_events.end(); ++it) {
+    thread2perf_events[it->thread_id][std::make_pair(it->start_ns,
+                                                     it->end_ns)] = &(*it);
+  }
+  const std::map<uint64_t, std::vector<HostTraceEventNode*>>
+      thread2host_event_nodes = Traverse(true);
+  for (auto it = thread2host_event_nodes.begin();
+       it != thread2host_event_nodes.end(); ++it) {
+    auto thread_iter = thread2perf_events.find(it->first);
+    if (thread_iter == thread2perf_events.end()) {
+      continue;
+    }
+    for (auto hostnode = it->second.begin(); hostnode != it->second.end();
+         ++hostnode) {
+      auto event_iter = thread_iter->second.find(
+          std::make_pair((*hostnode)->StartNs(), (*hostnode)->EndNs()));
+      if (event_iter != thread_iter->second.end()) {
+        (*hostnode)->SetPerfCounters(event_iter->second->counters);
+      }
+    }
+  }
+}
+
+void NodeTrees::AttachMemEvents(const std::list<MemTraceEvent>& mem_events) {
+  for (auto it = mem_events.begin(); it != mem_events.end(); ++it) {
+    auto tree_iter = thread_event_trees_map_.find(it->thread_id);
+    if (tree_iter == thread_event_trees_map_.end()) {
+      // thread only allocates memory without any host event
+      tree_iter =
+          thread_event_trees_map_
+              .emplace(it->thread_id,
+                       new HostTraceEventNode(HostTraceEvent(
+                           std::string("root node"),
+                           TracerEventType::UserDefined, 0, ULLONG_MAX, 0, 0)))
+              .first;
+    }
+    // children are sorted by start_ns and have no intersection, so descend
+    // into the last child starting before the timestamp if it encloses it
+    HostTraceEventNode* current_node = tree_iter->second;
+    while (true) {
+      const std::vector<HostTraceEventNode*>& children =
+          current_node->GetChildren();
+      auto child = std::upper_bound(
+          children.begin(), children.end(), it->timestamp_ns,
+          [](uint64_t timestamp_ns, HostTraceEventNode* node) {
+            return timestamp_ns < node->StartNs();
+          });
+      if (child == children.begin()) {
+        break;
+      }
+      --child;
+      if (it->timestamp_ns > (*child)->EndNs()) {
+        break;
+      }
+      current_node = *child;
+    }
+    current_node->AddMemNode(new MemTraceEventNode(*it));
+  }
+}
+
 void NodeTrees::LogMe(BaseLogger* logger) { logger->LogNodeTrees(*this); }
 
 void NodeTrees::HandleTrees(
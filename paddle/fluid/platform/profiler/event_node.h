@@ -27,6 +27,34 @@ limitations under the License. */
 namespace paddle {
 namespace platform {
 
+class MemTraceEventNode {
+ public:
+  // constructor
+  explicit MemTraceEventNode(const MemTraceEvent& mem_event)
+      : mem_event_(mem_event) {}
+
+  // destructor
+  ~MemTraceEventNode() {}
+
+  // getter
+  TracerMemEventType Type() const { return mem_event_.type; }
+  uint64_t Addr() const { return mem_event_.addr; }
+  uint64_t TimeStampNs() const { return mem_event_.timestamp_ns; }
+  uint64_t ProcessId() const { return mem_event_.process_id; }
+  uint64_t ThreadId() const { return mem_event_.thread_id; }
+  int64_t IncreaseBytes() const { return mem_event_.increase_bytes; }
+  std::string Place() const { return mem_event_.place; }
+  uint64_t CurrentAllocated() const { return mem_event_.current_allocated; }
+  uint64_t PeakAllocated() const { return mem_event_.peak_allocated; }
+
+  // member function
+  void LogMe(BaseLogger* logger) { logger->LogMemTraceEventNode(*this); }
+
+ private:
+  // data
+  MemTraceEvent mem_event_;
+};
+
 class DeviceTraceEventNode {
  public:
   // constructor
@@ -133,12 +161,18 @@ class HostTraceEventNode {
   uint64_t Duration() const {
     return host_event_.end_ns - host_event_.start_ns;
   }
+  const PerfCounterInfo& PerfCounters() const { return perf_counters_; }
+  bool HasPerfCounters() const { return perf_counters_.valid_mask != 0; }
 
   // member function
+  void SetPerfCounters(const PerfCounterInfo& counters) {
+    perf_counters_ = counters;
+  }
   void AddChild(HostTraceEventNode* node) { children_.push_back(node); }
   void AddCudaRuntimeNode(CudaRuntimeTraceEventNode* node) {
     runtime_node_ptrs_.push_back(node);
   }
+  void AddMemNode(MemTraceEventNode* node) { mem_node_ptrs_.push_back(node); }
   const std::vector<HostTraceEventNode*>& GetChildren() const {
     return children_;
   }
@@ -146,13 +180,20 @@ class HostTraceEventNode {
       const {
     return runtime_node_ptrs_;
   }
+  const std::vector<MemTraceEventNode*>& GetMemTraceEventNodes() const {
+    return mem_node_ptrs_;
+  }
   void LogMe(BaseLogger* logger) { logger->LogHostTraceEventNode(*this); }
 
  private:
   // data
   HostTraceEvent host_event_;
+  // hardware counters read around this event, see CpuPerfTracer
+  PerfCounterInfo perf_counters_;
   // cuda runtime events called by this
   std::vector<CudaRuntimeTraceEventNode*> runtime_node_ptrs_;
+  // memory events happened within this, excluding the ones of children
+  std::vector<MemTraceEventNode*> mem_node_ptrs_;
   // host events called by this
   std::vector<HostTraceEventNode*> children_;
 };
@@ -195,6 +236,12 @@ class NodeTrees {
     return thread_event_trees_map_;
   }
   std::map<uint64_t, std::vector<HostTraceEventNode*>> Traverse(bool bfs) const;
+  // Attach hardware counters to the host event nodes recorded with the same
+  // thread id and time range.
+  void AttachPerfCounters(const std::list<PerfCounterEvent>& perf_events);
+  // Attach memory events to the innermost host event node which encloses
+  // the event's timestamp on the same thread.
+  void AttachMemEvents(const std::list<MemTraceEvent>& mem_events);
 
  private:
   std::map<uint64_t, HostTraceEventNode*> thread_event_trees_map_;
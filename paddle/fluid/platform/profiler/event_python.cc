@@ -31,6 +31,9 @@ HostPythonNode::~HostPythonNode() {
   for (auto it = device_node_ptrs.begin(); it != device_node_ptrs.end(); ++it) {
     delete *it;
   }
+  for (auto it = mem_node_ptrs.begin(); it != mem_node_ptrs.end(); ++it) {
+    delete *it;
+  }
 }
 
 HostPythonNode* ProfilerResult::CopyTree(HostTraceEventNode* root) {
@@ -46,10 +49,34 @@ HostPythonNode* ProfilerResult::CopyTree(HostTraceEventNode* root) {
   host_python_node->end_ns = root->EndNs();
   host_python_node->process_id = root->ProcessId();
   host_python_node->thread_id = root->ThreadId();
+  if (root->HasPerfCounters()) {
+    const PerfCounterInfo& counters = root->PerfCounters();
+    for (size_t i = 0; i < kNumPerfCounters; ++i) {
+      if (counters.IsValid(static_cast<PerfCounterType>(i))) {
+        host_python_node->perf_counters[kPerfCounterNames[i]] =
+            counters.values[i];
+      }
+    }
+  }
   for (auto it = root->GetChildren().begin(); it != root->GetChildren().end();
        ++it) {
     host_python_node->children_node_ptrs.push_back(CopyTree(*it));
   }
+  // copy its MemTraceEventNode
+  for (auto memnode = root->GetMemTraceEventNodes().begin();
+       memnode != root->GetMemTraceEventNodes().end(); ++memnode) {
+    MemPythonNode* mem_python_node = new MemPythonNode();
+    mem_python_node->timestamp_ns = (*memnode)->TimeStampNs();
+    mem_python_node->addr = (*memnode)->Addr();
+    mem_python_node->type = (*memnode)->Type();
+    mem_python_node->process_id = (*memnode)->ProcessId();
+    mem_python_node->thread_id = (*memnode)->ThreadId();
+    mem_python_node->increase_bytes = (*memnode)->IncreaseBytes();
+    mem_python_node->place = (*memnode)->Place();
+    mem_python_node->current_allocated = (*memnode)->CurrentAllocated();
+    mem_python_node->peak_allocated = (*memnode)->PeakAllocated();
+    host_python_node->mem_node_ptrs.push_back(mem_python_node);
+  }
   // copy its CudaRuntimeTraceEventNode
   for (auto runtimenode = root->GetRuntimeTraceEventNodes().begin();
        runtimenode != root->GetRuntimeTraceEventNodes().end(); ++runtimenode) {
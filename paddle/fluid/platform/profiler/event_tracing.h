@@ -17,6 +17,7 @@ limitations under the License. */
 #include <string>
 #include "paddle/fluid/platform/event.h"
 #include "paddle/fluid/platform/profiler/trace_event.h"
+#include "paddle/phi/common/place.h"
 
 namespace paddle {
 namespace platform {
@@ -90,6 +91,8 @@ class RecordEvent {
   void OriginalConstruct(const std::string& name, const EventRole role,
                          const std::string& attr);
 
+  void BeginPerfCounting();
+
   bool is_enabled_{false};
   bool is_pushed_{false};
   // Event name
@@ -103,6 +106,23 @@ class RecordEvent {
   TracerEventType type_{TracerEventType::UserDefined};
   std::string* attr_{nullptr};
   bool finished_{false};
+  // Whether CpuPerfTracer has snapshotted the counters for this event
+  bool perf_counting_{false};
+};
+
+// Memory event tracing. A trace marks memory manipulation such as allocation
+// and free. Works if the profiler is started with memory tracing enabled.
+// Chrome Trace Viewer Format: Instant Event and Counter Event
+struct RecordMemEvent {
+  /**
+   * @param ptr: Pointer address allocated or freed.
+   * @param place: Device the memory belongs to.
+   * @param size: Memory size allocated or freed.
+   * @param type: Denote manipulation type for this memory event.
+   */
+  explicit RecordMemEvent(
+      const void* ptr, const phi::Place& place, size_t size,
+      const TracerMemEventType type = TracerMemEventType::Allocate);
 };
 
 }  // namespace platform
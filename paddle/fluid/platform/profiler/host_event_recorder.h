@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -185,6 +186,7 @@ struct ThreadEventSection {
   std::string thread_name;
   uint64_t thread_id;
   std::vector<CommonEvent> events;
+  std::vector<CommonMemEvent> mem_events;
 };
 
 class ThreadEventRecorder {
@@ -203,11 +205,25 @@ class ThreadEventRecorder {
     base_evt_cntr_.Record(std::forward<Args>(args)...);
   }
 
+  // Forward call to EventContainer::Record
+  template <typename... Args>
+  void RecordMemEvent(Args &&... args) {
+    // Most threads never allocate memory while tracing, avoid paying for
+    // the event blocks of an unused container.
+    if (mem_evt_cntr_ == nullptr) {
+      mem_evt_cntr_.reset(new EventContainer<CommonMemEvent>);
+    }
+    mem_evt_cntr_->Record(std::forward<Args>(args)...);
+  }
+
   ThreadEventSection GatherEvents() {
     ThreadEventSection thr_sec;
     thr_sec.thread_name = thread_name_;
     thr_sec.thread_id = thread_id_;
     thr_sec.events = std::move(base_evt_cntr_.Reduce());
+    if (mem_evt_cntr_ != nullptr) {
+      thr_sec.mem_events = std::move(mem_evt_cntr_->Reduce());
+    }
     return thr_sec;
   }
 
@@ -215,6 +231,7 @@ class ThreadEventRecorder {
   uint64_t thread_id_;
   std::string thread_name_;
   EventContainer<CommonEvent> base_evt_cntr_;
+  std::unique_ptr<EventContainer<CommonMemEvent>> mem_evt_cntr_;
 };
 
 struct HostEventSection {
@@ -241,6 +258,12 @@ class HostEventRecorder {
     GetThreadLocalRecorder()->RecordEvent(std::forward<Args>(args)...);
   }
 
+  // thread-safe
+  template <typename... Args>
+  void RecordMemEvent(Args &&... args) {
+    GetThreadLocalRecorder()->RecordMemEvent(std::forward<Args>(args)...);
+  }
+
   // thread-unsafe, make sure make sure there is no running tracing.
   // Poor performance, call it at the ending
   HostEventSection GatherEvents() {
@@ -46,6 +46,19 @@ void ProcessHostEvents(const HostEventSection& host_events,
       event.thread_id = tid;
       collector->AddHostEvent(std::move(event));
     }
+    for (const auto& evt : thr_sec.mem_events) {
+      MemTraceEvent event;
+      event.timestamp_ns = evt.timestamp_ns;
+      event.addr = evt.addr;
+      event.type = evt.type;
+      event.process_id = host_events.process_id;
+      event.thread_id = tid;
+      event.increase_bytes = evt.increase_bytes;
+      event.place = evt.place.DebugString();
+      event.current_allocated = evt.current_allocated;
+      event.peak_allocated = evt.peak_allocated;
+      collector->AddMemEvent(std::move(event));
+    }
   }
 }
 
@@ -63,6 +76,7 @@ void HostTracer::StartTracing() {
       platform::errors::PreconditionNotMet("TracerState must be READY"));
   HostEventRecorder::GetInstance().GatherEvents();
   HostTraceLevel::GetInstance().SetLevel(options_.trace_level);
+  HostTraceLevel::GetInstance().SetTraceMemory(options_.trace_memory);
   state_ = TracerState::STARTED;
 }
 
@@ -71,6 +85,7 @@ void HostTracer::StopTracing() {
       state_, TracerState::STARTED,
       platform::errors::PreconditionNotMet("TracerState must be STARTED"));
   HostTraceLevel::GetInstance().SetLevel(HostTraceLevel::kDisabled);
+  HostTraceLevel::GetInstance().SetTraceMemory(false);
   state_ = TracerState::STOPED;
 }
 
@@ -34,13 +34,20 @@ class HostTraceLevel {
 
   void SetLevel(int64_t trace_level) { trace_level_ = trace_level; }
 
+  bool NeedTraceMemory() { return trace_memory_; }
+
+  void SetTraceMemory(bool trace_memory) { trace_memory_ = trace_memory; }
+
  private:
   // Verbose trace level, works like VLOG(level)
   int trace_level_ = kDisabled;
+  // Whether to record allocation and free events of allocators
+  bool trace_memory_ = false;
 };
 
 struct HostTracerOptions {
   uint32_t trace_level = 0;
+  bool trace_memory = false;
 };
 
 class HostTracer : public TracerBase {
@@ -0,0 +1,48 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/stats.h"
+#include "paddle/fluid/platform/os_info.h"
+#include "paddle/fluid/platform/profiler/event_tracing.h"
+#include "paddle/fluid/platform/profiler/host_event_recorder.h"
+#include "paddle/fluid/platform/profiler/host_tracer.h"
+
+namespace paddle {
+namespace platform {
+
+RecordMemEvent::RecordMemEvent(const void *ptr, const phi::Place &place,
+                               size_t size, const TracerMemEventType type) {
+  if (LIKELY(HostTraceLevel::GetInstance().NeedTraceMemory() == false)) {
+    return;
+  }
+  uint64_t current_allocated = 0;
+  uint64_t peak_allocated = 0;
+  int dev_id = place.GetDeviceId();
+  if (place.GetType() == phi::AllocationType::CPU) {
+    current_allocated = MEMORY_STAT_CURRENT_VALUE(HostAllocated, 0);
+    peak_allocated = MEMORY_STAT_PEAK_VALUE(HostAllocated, 0);
+  } else if (place.GetType() == phi::AllocationType::GPU) {
+    current_allocated = MEMORY_STAT_CURRENT_VALUE(Allocated, dev_id);
+    peak_allocated = MEMORY_STAT_PEAK_VALUE(Allocated, dev_id);
+  }
+  int64_t increase_bytes = type == TracerMemEventType::Allocate
+                               ? static_cast<int64_t>(size)
+                               : -static_cast<int64_t>(size);
+  HostEventRecorder::GetInstance().RecordMemEvent(
+      PosixInNsec(), reinterpret_cast<uint64_t>(ptr), type, increase_bytes,
+      place, current_allocated, peak_allocated);
+}
+
+}  // namespace platform
+}  // namespace paddle
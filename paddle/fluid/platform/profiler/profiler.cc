@@ -24,6 +24,7 @@
 #include "paddle/fluid/platform/device/gpu/gpu_info.h"
 #endif
 #include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/profiler/cpu_perf_tracer.h"
 #include "paddle/fluid/platform/profiler/cuda_tracer.h"
 #include "paddle/fluid/platform/profiler/extra_info.h"
 #include "paddle/fluid/platform/profiler/host_tracer.h"
@@ -61,12 +62,17 @@ bool Profiler::IsCnpapiSupported() {
   return supported;
 }
 
+bool Profiler::IsPerfCounterSupported() {
+  return CpuPerfTracer::IsSupported();
+}
+
 Profiler::Profiler(const ProfilerOptions& options) {
   options_ = options;
   std::bitset<32> trace_switch(options_.trace_switch);
   if (trace_switch.test(kProfileCPUOptionBit)) {
     HostTracerOptions host_tracer_options;
     host_tracer_options.trace_level = options_.trace_level;
+    host_tracer_options.trace_memory = options_.trace_memory;
     tracers_.emplace_back(new HostTracer(host_tracer_options), true);
   }
   if (trace_switch.test(kProfileGPUOptionBit)) {
@@ -75,6 +81,9 @@ Profiler::Profiler(const ProfilerOptions& options) {
   if (trace_switch.test(kProfileMLUOptionBit)) {
     tracers_.emplace_back(&MluTracer::GetInstance(), false);
   }
+  if (trace_switch.test(kProfileCPUPerfCounterOptionBit)) {
+    tracers_.emplace_back(&CpuPerfTracer::GetInstance(), false);
+  }
 }
 
 Profiler::~Profiler() { alive_.store(false); }
@@ -103,6 +112,8 @@ std::unique_ptr<ProfilerResult> Profiler::Stop() {
   std::unique_ptr<NodeTrees> tree(new NodeTrees(collector.HostEvents(),
                                                 collector.RuntimeEvents(),
                                                 collector.DeviceEvents()));
+  tree->AttachPerfCounters(collector.PerfCounterEvents());
+  tree->AttachMemEvents(collector.MemEvents());
   cpu_utilization_.RecordEndTimeInfo();
   ExtraInfo extrainfo;
   extrainfo.AddExtraInfo(std::string("System Cpu Utilization"),
@@ -34,10 +34,14 @@ namespace platform {
 static constexpr uint32_t kProfileCPUOptionBit = 0;
 static constexpr uint32_t kProfileGPUOptionBit = 1;
 static constexpr uint32_t kProfileMLUOptionBit = 2;
+static constexpr uint32_t kProfileCPUPerfCounterOptionBit = 3;
 
 struct ProfilerOptions {
-  uint32_t trace_switch = 0;  // bit 0: cpu, bit 1: gpu, bit 2: mlu
+  // bit 0: cpu, bit 1: gpu, bit 2: mlu, bit 3: cpu hardware counters
+  uint32_t trace_switch = 0;
   uint32_t trace_level = FLAGS_host_trace_level;
+  // record allocation and free events of allocators
+  bool trace_memory = false;
 };
 
 class Profiler {
@@ -48,6 +52,8 @@ class Profiler {
 
   static bool IsCnpapiSupported();
 
+  static bool IsPerfCounterSupported();
+
   void Prepare();
 
   void Start();
@@ -29,6 +29,9 @@ using paddle::platform::TracerEventType;
 using paddle::platform::KernelEventInfo;
 using paddle::platform::MemcpyEventInfo;
 using paddle::platform::MemsetEventInfo;
+using paddle::platform::PerfCounterEvent;
+using paddle::platform::PerfCounterInfo;
+using paddle::platform::PerfCounterType;
 TEST(NodeTreesTest, LogMe_case0) {
   std::list<HostTraceEvent> host_events;
   std::list<RuntimeTraceEvent> runtime_events;
@@ -201,3 +204,111 @@ TEST(NodeTreesTest, HandleTrees_case0) {
   tree.HandleTrees(host_event_node_handle, runtime_event_node_handle,
                    device_event_node_handle);
 }
+
+TEST(NodeTreesTest, AttachPerfCounters_case0) {
+  std::list<HostTraceEvent> host_events;
+  std::list<RuntimeTraceEvent> runtime_events;
+  std::list<DeviceTraceEvent> device_events;
+  std::list<PerfCounterEvent> perf_events;
+  host_events.push_back(HostTraceEvent(
+      std::string("op1"), TracerEventType::Operator, 11000, 20000, 10, 10));
+  host_events.push_back(HostTraceEvent(std::string("op1::compute"),
+                                       TracerEventType::OperatorInner, 12000,
+                                       19000, 10, 10));
+  host_events.push_back(HostTraceEvent(
+      std::string("op2"), TracerEventType::Operator, 21000, 30000, 10, 11));
+  PerfCounterInfo op1_counters;
+  op1_counters.valid_mask = 0x3;
+  op1_counters.values[0] = 4000;
+  op1_counters.values[1] = 8000;
+  perf_events.push_back(PerfCounterEvent(11000, 20000, 10, op1_counters));
+  PerfCounterInfo compute_counters;
+  compute_counters.valid_mask = 0xf;
+  compute_counters.values[0] = 3000;
+  compute_counters.values[1] = 7000;
+  compute_counters.values[2] = 30;
+  compute_counters.values[3] = 5;
+  perf_events.push_back(PerfCounterEvent(12000, 19000, 10, compute_counters));
+  // same time range but on another thread, should not be attached
+  perf_events.push_back(PerfCounterEvent(21000, 30000, 10, compute_counters));
+  ChromeTracingLogger logger("test_nodetrees_attach_perf_counters_case0.json");
+  NodeTrees tree(host_events, runtime_events, device_events);
+  tree.AttachPerfCounters(perf_events);
+  std::map<uint64_t, std::vector<HostTraceEventNode*>> nodes =
+      tree.Traverse(true);
+  for (auto it = nodes[10].begin(); it != nodes[10].end(); it++) {
+    if ((*it)->Name() == "op1") {
+      EXPECT_TRUE((*it)->HasPerfCounters());
+      EXPECT_TRUE((*it)->PerfCounters().IsValid(PerfCounterType::Cycles));
+      EXPECT_FALSE((*it)->PerfCounters().IsValid(PerfCounterType::LLCMisses));
+      EXPECT_EQ((*it)->PerfCounters().Value(PerfCounterType::Instructions),
+                8000u);
+    }
+    if ((*it)->Name() == "op1::compute") {
+      EXPECT_TRUE((*it)->HasPerfCounters());
+      EXPECT_EQ((*it)->PerfCounters().Value(PerfCounterType::BranchMisses),
+                5u);
+    }
+  }
+  for (auto it = nodes[11].begin(); it != nodes[11].end(); it++) {
+    EXPECT_FALSE((*it)->HasPerfCounters());
+  }
+  tree.LogMe(&logger);
+}
+
+TEST(NodeTreesTest, AttachMemEvents_case0) {
+  std::list<HostTraceEvent> host_events;
+  std::list<RuntimeTraceEvent> runtime_events;
+  std::list<DeviceTraceEvent> device_events;
+  std::list<MemTraceEvent> mem_events;
+  host_events.push_back(HostTraceEvent(
+      std::string("op1"), TracerEventType::Operator, 11000, 20000, 10, 10));
+  host_events.push_back(HostTraceEvent(std::string("op1::compute"),
+                                       TracerEventType::OperatorInner, 12000,
+                                       19000, 10, 10));
+  host_events.push_back(HostTraceEvent(
+      std::string("op2"), TracerEventType::Operator, 21000, 30000, 10, 10));
+  mem_events.push_back(MemTraceEvent(11500, 0x1000,
+                                     TracerMemEventType::Allocate, 10, 10, 50,
+                                     "Place(cpu)", 50, 50));
+  mem_events.push_back(MemTraceEvent(15000, 0x2000,
+                                     TracerMemEventType::Allocate, 10, 10, 50,
+                                     "Place(cpu)", 100, 100));
+  mem_events.push_back(MemTraceEvent(25000, 0x2000, TracerMemEventType::Free,
+                                     10, 10, -50, "Place(cpu)", 50, 100));
+  // between op1 and op2
+  mem_events.push_back(MemTraceEvent(20500, 0x1000, TracerMemEventType::Free,
+                                     10, 10, -50, "Place(cpu)", 0, 100));
+  // thread without host events
+  mem_events.push_back(MemTraceEvent(16000, 0x3000,
+                                     TracerMemEventType::Allocate, 10, 12, 50,
+                                     "Place(cpu)", 50, 100));
+  ChromeTracingLogger logger("test_nodetrees_attach_mem_events_case0.json");
+  NodeTrees tree(host_events, runtime_events, device_events);
+  tree.AttachMemEvents(mem_events);
+  std::map<uint64_t, std::vector<HostTraceEventNode*>> nodes =
+      tree.Traverse(true);
+  EXPECT_EQ(nodes.size(), 2u);
+  for (auto it = nodes[10].begin(); it != nodes[10].end(); it++) {
+    if ((*it)->Name() == "root node") {
+      EXPECT_EQ((*it)->GetMemTraceEventNodes().size(), 1u);
+      EXPECT_EQ((*it)->GetMemTraceEventNodes()[0]->Type(),
+                TracerMemEventType::Free);
+    }
+    if ((*it)->Name() == "op1") {
+      EXPECT_EQ((*it)->GetMemTraceEventNodes().size(), 1u);
+      EXPECT_EQ((*it)->GetMemTraceEventNodes()[0]->Addr(), 0x1000u);
+    }
+    if ((*it)->Name() == "op1::compute") {
+      EXPECT_EQ((*it)->GetMemTraceEventNodes().size(), 1u);
+      EXPECT_EQ((*it)->GetMemTraceEventNodes()[0]->CurrentAllocated(), 100u);
+    }
+    if ((*it)->Name() == "op2") {
+      EXPECT_EQ((*it)->GetMemTraceEventNodes().size(), 1u);
+      EXPECT_EQ((*it)->GetMemTraceEventNodes()[0]->IncreaseBytes(), -50);
+    }
+  }
+  EXPECT_EQ(nodes[12].size(), 1u);
+  EXPECT_EQ(nodes[12][0]->GetMemTraceEventNodes().size(), 1u);
+  tree.LogMe(&logger);
+}
@@ -56,6 +56,15 @@ enum class TracerEventType {
   NumTypes
 };
 
+enum class TracerMemEventType {
+  // Used to mark memory allocation
+  Allocate = 0,
+  // Used to mark memory free
+  Free = 1,
+  // A flag to denote the number of current types
+  NumTypes
+};
+
 struct KernelEventInfo {
   // The X-dimension block size for the kernel.
   uint32_t block_x;
@@ -118,6 +127,57 @@ struct MemsetEventInfo {
   uint32_t value;
 };
 
+enum class PerfCounterType {
+  // Cpu cycles spent in user space
+  Cycles = 0,
+  // Retired instructions
+  Instructions = 1,
+  // Last level cache misses
+  LLCMisses = 2,
+  // Mispredicted branch instructions
+  BranchMisses = 3,
+  // A flag to denote the number of current types
+  NumTypes
+};
+
+static constexpr size_t kNumPerfCounters =
+    static_cast<size_t>(PerfCounterType::NumTypes);
+
+static constexpr const char* kPerfCounterNames[kNumPerfCounters] = {
+    "cycles", "instructions", "llc_misses", "branch_misses"};
+
+struct PerfCounterInfo {
+  // Bit i is set if counter PerfCounterType(i) is available.
+  uint32_t valid_mask = 0;
+  // Counter deltas accumulated between the start and end of a host event.
+  uint64_t values[kNumPerfCounters] = {0};
+
+  bool IsValid(PerfCounterType type) const {
+    return (valid_mask >> static_cast<uint32_t>(type)) & 1u;
+  }
+  uint64_t Value(PerfCounterType type) const {
+    return values[static_cast<size_t>(type)];
+  }
+};
+
+struct PerfCounterEvent {
+  PerfCounterEvent() = default;
+  PerfCounterEvent(uint64_t start_ns, uint64_t end_ns, uint64_t thread_id,
+                   const PerfCounterInfo& counters)
+      : start_ns(start_ns),
+        end_ns(end_ns),
+        thread_id(thread_id),
+        counters(counters) {}
+  // start timestamp of the host event which the counters belong to
+  uint64_t start_ns;
+  // end timestamp of the host event which the counters belong to
+  uint64_t end_ns;
+  // thread id of the host event which the counters belong to
+  uint64_t thread_id;
+  // hardware counter values
+  PerfCounterInfo counters;
+};
+
 struct HostTraceEvent {
   HostTraceEvent() = default;
   HostTraceEvent(const std::string& name, TracerEventType type,
@@ -143,6 +203,43 @@ struct HostTraceEvent {
   uint64_t thread_id;
 };
 
+struct MemTraceEvent {
+  MemTraceEvent() = default;
+  MemTraceEvent(uint64_t timestamp_ns, uint64_t addr, TracerMemEventType type,
+                uint64_t process_id, uint64_t thread_id,
+                int64_t increase_bytes, const std::string& place,
+                uint64_t current_allocated, uint64_t peak_allocated)
+      : timestamp_ns(timestamp_ns),
+        addr(addr),
+        type(type),
+        process_id(process_id),
+        thread_id(thread_id),
+        increase_bytes(increase_bytes),
+        place(place),
+        current_allocated(current_allocated),
+        peak_allocated(peak_allocated) {}
+
+  // timestamp of the record
+  uint64_t timestamp_ns;
+  // memory addr of allocation or free
+  uint64_t addr;
+  // memory manipulation type
+  TracerMemEventType type;
+  // process id of the record
+  uint64_t process_id;
+  // thread id of the record
+  uint64_t thread_id;
+  // increase bytes after this manipulation, allocation for sign +, free for
+  // sign -
+  int64_t increase_bytes;
+  // place
+  std::string place;
+  // current total allocated memory of the place after this manipulation
+  uint64_t current_allocated;
+  // peak allocated memory of the place so far
+  uint64_t peak_allocated;
+};
+
 struct RuntimeTraceEvent {
   RuntimeTraceEvent() = default;
   RuntimeTraceEvent(const std::string& name, uint64_t start_ns, uint64_t end_ns,
@@ -34,6 +34,12 @@ class TraceEventCollector {
     device_events_.push_back(event);
   }
 
+  void AddMemEvent(MemTraceEvent&& event) { mem_events_.push_back(event); }
+
+  void AddPerfCounterEvent(PerfCounterEvent&& event) {
+    perf_counter_events_.push_back(event);
+  }
+
   void AddThreadName(uint64_t tid, const std::string& name) {
     thread_names_[tid] = name;
   }
@@ -48,6 +54,12 @@ class TraceEventCollector {
     return device_events_;
   }
 
+  const std::list<MemTraceEvent>& MemEvents() const { return mem_events_; }
+
+  const std::list<PerfCounterEvent>& PerfCounterEvents() const {
+    return perf_counter_events_;
+  }
+
   const std::unordered_map<uint64_t, std::string>& ThreadNames() const {
     return thread_names_;
   }
@@ -57,6 +69,8 @@ class TraceEventCollector {
     host_events_.clear();
     runtime_events_.clear();
     device_events_.clear();
+    mem_events_.clear();
+    perf_counter_events_.clear();
   }
 
  private:
@@ -64,6 +78,8 @@ class TraceEventCollector {
   std::list<HostTraceEvent> host_events_;
   std::list<RuntimeTraceEvent> runtime_events_;
   std::list<DeviceTraceEvent> device_events_;
+  std::list<MemTraceEvent> mem_events_;
+  std::list<PerfCounterEvent> perf_counter_events_;
 };
 
 }  // namespace platform
@@ -30,7 +30,8 @@ void BindCostModel(py::module* m) {
   py::class_<CostData>(*m, "CostData")
       .def(py::init<>())
       .def("get_whole_time_ms", &CostData::GetWholeTimeMs)
-      .def("get_op_time_ms", &CostData::GetOpTimeMs);
+      .def("get_op_time_ms", &CostData::GetOpTimeMs)
+      .def("get_var_dims", &CostData::GetVarDims);
 
   py::class_<CostModel>(*m, "CostModel")
       .def(py::init<>())
@@ -49,7 +50,33 @@ void BindCostModel(py::module* m) {
              return self.ProfileMeasure(*main_program_desc,
                                         *startup_program_desc, device,
                                         fetch_cost_list);
-           });
+           })
+      .def("update_cost_table",
+           [](CostModel& self, py::object py_main_program,
+              const CostData& cost_data, const std::string& device) {
+             py::object py_main_program_desc = py_main_program.attr("desc");
+             ProgramDesc* main_program_desc =
+                 py_main_program_desc.cast<ProgramDesc*>();
+             self.UpdateCostTable(*main_program_desc, cost_data, device);
+           })
+      .def("predict_program_time_ms",
+           [](CostModel& self, py::object py_program,
+              const std::string& device, const CostData* cost_data) {
+             py::object py_program_desc = py_program.attr("desc");
+             ProgramDesc* program_desc = py_program_desc.cast<ProgramDesc*>();
+             return self.PredictProgramTimeMs(
+                 *program_desc, device,
+                 cost_data == nullptr ? nullptr : &cost_data->GetVarDims());
+           },
+           py::arg("program"), py::arg("device"),
+           py::arg("cost_data") = nullptr)
+      .def("save_cost_table",
+           [](CostModel& self, const std::string& path) {
+             self.GetCostTable().Save(path);
+           })
+      .def("load_cost_table", [](CostModel& self, const std::string& path) {
+        self.MutableCostTable()->Load(path);
+      });
 }
 
 }  // namespace pybind
@@ -17,6 +17,7 @@ typedef SSIZE_T ssize_t;
 
 #include <Python.h>
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -28,6 +29,7 @@ typedef SSIZE_T ssize_t;
 #include "paddle/fluid/eager/autograd_meta.h"
 #include "paddle/fluid/eager/backward.h"
 #include "paddle/fluid/eager/custom_operator/custom_operator_node.h"
+#include "paddle/fluid/eager/recompute/recompute_node.h"
 #include "paddle/fluid/eager/utils.h"
 #include "paddle/fluid/framework/convert_utils.h"
 #include "paddle/fluid/framework/custom_operator.h"
@@ -143,6 +145,49 @@ static PyObject* eager_api_run_partial_grad(PyObject* self, PyObject* args,
   EAGER_CATCH_AND_THROW_RETURN_NULL
 }
 
+static PyObject* eager_api_recompute(PyObject* self, PyObject* args,
+                                     PyObject* kwargs) {
+  EAGER_TRY
+  PyObject* py_func = PyTuple_GET_ITEM(args, 0);
+  PADDLE_ENFORCE_EQ(PyCallable_Check(py_func), 1,
+                    platform::errors::InvalidArgument(
+                        "The function of recompute should be callable."));
+  auto inputs = CastPyArg2VectorOfTensor(PyTuple_GET_ITEM(args, 1), 1);
+  bool preserve_rng_state = CastPyArg2AttrBoolean(PyTuple_GET_ITEM(args, 2), 2);
+
+  // The grad node keeps the function until its backward.
+  Py_INCREF(py_func);
+  std::shared_ptr<PyObject> func(py_func, [](PyObject* obj) {
+    py::gil_scoped_acquire gil;
+    Py_DECREF(obj);
+  });
+  egr::RecomputeFunction fn =
+      [func](const std::vector<paddle::experimental::Tensor>& fn_inputs) {
+        py::gil_scoped_acquire gil;
+        PyObject* py_inputs = ToPyObject(fn_inputs);
+        PyObject* res =
+            PyObject_CallFunctionObjArgs(func.get(), py_inputs, nullptr);
+        Py_DECREF(py_inputs);
+        if (res == nullptr) {
+          py::error_already_set error;
+          PADDLE_THROW(platform::errors::Unavailable(
+              "The function of recompute raises an exception: %s.",
+              error.what()));
+        }
+        std::vector<paddle::experimental::Tensor> outputs;
+        if (PyObject_IsInstance(res,
+                                reinterpret_cast<PyObject*>(p_tensor_type))) {
+          outputs.emplace_back(reinterpret_cast<TensorObject*>(res)->tensor);
+        } else {
+          outputs = CastPyArg2VectorOfTensor(res, 0);
+        }
+        Py_DECREF(res);
+        return outputs;
+      };
+  return ToPyObject(egr::Recompute(fn, inputs, preserve_rng_state));
+  EAGER_CATCH_AND_THROW_RETURN_NULL
+}
+
 static PyObject* eager_api_tensor_copy(PyObject* self, PyObject* args,
                                        PyObject* kwargs) {
   EAGER_TRY
@@ -830,6 +875,8 @@ PyMethodDef variable_functions[] = {
      METH_VARARGS | METH_KEYWORDS, NULL},
     {"_run_custom_op", (PyCFunction)(void (*)(void))eager_api_run_costum_op,
      METH_VARARGS | METH_KEYWORDS, NULL},
+    {"recompute", (PyCFunction)(void (*)(void))eager_api_recompute,
+     METH_VARARGS | METH_KEYWORDS, NULL},
     {"tensor_copy", (PyCFunction)(void (*)(void))eager_api_tensor_copy,
      METH_VARARGS | METH_KEYWORDS, NULL},
     {"read_next_tensor_list",
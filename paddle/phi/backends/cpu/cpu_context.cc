@@ -14,6 +14,11 @@
 
 #include "paddle/phi/backends/cpu/cpu_context.h"
 
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <mutex>
+
 #include "paddle/phi/api/ext/exception.h"
 #include "paddle/phi/common/place.h"
 
@@ -21,6 +26,7 @@
 // without eigen.
 #include "paddle/phi/core/device_context.h"
 #include "unsupported/Eigen/CXX11/Tensor"
+#include "unsupported/Eigen/CXX11/ThreadPool"
 
 namespace phi {
 
@@ -45,9 +51,78 @@ struct CPUContext::Impl {
     return eigen_device_;
   }
 
+  void SetNumThreads(int num_threads) {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    num_threads_ = std::max(num_threads, 1);
+    pool_.reset();
+  }
+
+  // The calling thread takes part in the work, so the pool holds
+  // num_threads_ - 1 workers. It is created by the first ParallelFor.
+  Eigen::ThreadPool* GetThreadPool() {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    if (pool_ == nullptr && num_threads_ > 1) {
+      pool_.reset(new Eigen::ThreadPool(num_threads_ - 1));
+    }
+    return pool_.get();
+  }
+
+  void ParallelFor(int64_t n,
+                   double cost_per_unit,
+                   const std::function<void(int64_t, int64_t)>& fn) {
+    if (n <= 0) {
+      return;
+    }
+    // a range should take about 10us to pay off the scheduling, and the
+    // ranges are a few times more than the threads to balance the load
+    constexpr double kMinCostPerRange = 20000;
+    constexpr int64_t kRangesPerThread = 4;
+    const int64_t min_units = static_cast<int64_t>(
+        std::ceil(kMinCostPerRange / std::max(cost_per_unit, 1e-3)));
+    int64_t num_ranges =
+        std::min((n + min_units - 1) / std::max<int64_t>(min_units, 1),
+                 kRangesPerThread * num_threads_);
+    Eigen::ThreadPool* pool = num_ranges > 1 ? GetThreadPool() : nullptr;
+    if (pool == nullptr || pool->CurrentThreadId() != -1) {
+      fn(0, n);
+      return;
+    }
+    const int64_t range_size = (n + num_ranges - 1) / num_ranges;
+    num_ranges = (n + range_size - 1) / range_size;
+
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    auto run_range = [&](int64_t i) {
+      try {
+        fn(i * range_size, std::min(n, (i + 1) * range_size));
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    };
+    Eigen::Barrier barrier(static_cast<unsigned int>(num_ranges - 1));
+    for (int64_t i = 1; i < num_ranges; ++i) {
+      pool->Schedule([&run_range, &barrier, i]() {
+        run_range(i);
+        barrier.Notify();
+      });
+    }
+    run_range(0);
+    barrier.Wait();
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
   bool owned_{false};
   Eigen::DefaultDevice* eigen_device_{nullptr};
   Place place_;
+
+  int num_threads_{1};
+  std::mutex pool_mutex_;
+  std::unique_ptr<Eigen::ThreadPool> pool_;
 };
 
 CPUContext::CPUContext()
@@ -70,6 +145,19 @@ Eigen::DefaultDevice* CPUContext::eigen_device() const {
 
 const Place& CPUContext::GetPlace() const { return impl_->place_; }
 
+void CPUContext::ParallelFor(
+    int64_t n,
+    double cost_per_unit,
+    const std::function<void(int64_t, int64_t)>& fn) const {
+  impl_->ParallelFor(n, cost_per_unit, fn);
+}
+
+void CPUContext::SetNumThreads(int num_threads) {
+  impl_->SetNumThreads(num_threads);
+}
+
+int CPUContext::GetNumThreads() const { return impl_->num_threads_; }
+
 void CPUContext::SetEigenDevice(Eigen::DefaultDevice* device) {
   impl_->eigen_device_ = device;
 }
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <functional>
 #include <memory>
 
 #include "paddle/phi/backends/cpu/forwards.h"
@@ -34,6 +35,22 @@ class PADDLE_API CPUContext : public DeviceContext {
   Eigen::DefaultDevice* eigen_device() const;
   const Place& GetPlace() const override;
 
+  // NOTE: Intra-op parallelism. fn(begin, end) is called on disjoint ranges
+  // which cover [0, n), the ranges are run on a work stealing thread pool
+  // owned by the context and on the calling thread. cost_per_unit is the
+  // rough number of cycles to process one unit, it decides how many units
+  // a range holds so that small problems stay on the calling thread. Nested
+  // calls from a worker thread are run serially.
+  void ParallelFor(int64_t n,
+                   double cost_per_unit,
+                   const std::function<void(int64_t, int64_t)>& fn) const;
+
+  // The number of threads used by ParallelFor including the calling thread,
+  // 1 by default which runs everything serially. The pool is rebuilt, so it
+  // should not be called when a ParallelFor is running.
+  void SetNumThreads(int num_threads);
+  int GetNumThreads() const;
+
  public:
   // NOTE: DeviceContext hold resources. Used in training scenarios.
   // The interface used by the training scene, DeviceContext will initialize
@@ -14,6 +14,11 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
 #include "paddle/phi/core/allocator.h"
 #include "paddle/phi/core/storage.h"
 #include "paddle/phi/core/stream.h"
@@ -182,8 +187,48 @@ class DenseTensor : public TensorBase,
     uint32_t CurrentVersion() const { return inplace_version_; }
     void SetInplaceVersionToZero() { inplace_version_ = 0; }
 
+    /* Adds a hook to run once before the next inplace write of the tensors
+    sharing this counter, such as the copy-on-write of a snapshot saved for
+    backward. The hook is skipped if its owner has released it. */
+    void AddPreWriteHook(const std::shared_ptr<std::function<void()>>& hook) {
+      // Drop the released hooks from time to time, so that a tensor saved
+      // many times but never written does not keep all of them.
+      if (pre_write_hooks_.size() >= prune_threshold_) {
+        pre_write_hooks_.erase(
+            std::remove_if(pre_write_hooks_.begin(),
+                           pre_write_hooks_.end(),
+                           [](const std::weak_ptr<std::function<void()>>& h) {
+                             return h.expired();
+                           }),
+            pre_write_hooks_.end());
+        size_t threshold = 2 * pre_write_hooks_.size();
+        prune_threshold_ =
+            threshold > kMinPruneThreshold ? threshold : kMinPruneThreshold;
+      }
+      pre_write_hooks_.emplace_back(hook);
+    }
+
+    /* Runs and removes the hooks, before the tensor is written inplace. */
+    void RunPreWriteHooks() {
+      if (pre_write_hooks_.empty()) {
+        return;
+      }
+      auto hooks = std::move(pre_write_hooks_);
+      pre_write_hooks_.clear();
+      prune_threshold_ = kMinPruneThreshold;
+      for (auto& weak_hook : hooks) {
+        if (auto hook = weak_hook.lock()) {
+          (*hook)();
+        }
+      }
+    }
+
    private:
+    static constexpr size_t kMinPruneThreshold = 16;
+
     uint32_t inplace_version_{0};
+    std::vector<std::weak_ptr<std::function<void()>>> pre_write_hooks_;
+    size_t prune_threshold_{kMinPruneThreshold};
   };
 
  protected:
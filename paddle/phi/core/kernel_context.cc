@@ -105,6 +105,15 @@ void KernelContext::AssignOutputRange(std::pair<int, int>&& range, size_t idx) {
   }
 }
 
+void KernelContext::Clear() {
+  dev_ctx_ = nullptr;
+  inputs_.clear();
+  outputs_.clear();
+  attrs_.clear();
+  input_range_.clear();
+  output_range_.clear();
+}
+
 const std::pair<int, int>& KernelContext::InputRangeAt(size_t idx) const {
   return input_range_.at(idx);
 }
@@ -131,6 +131,10 @@ class KernelContext {
   template <typename AttrType>
   const AttrType& AttrAt(size_t idx) const;
 
+  // Drops the inputs, outputs and attributes, but keeps the buffers, so that
+  // the context can be filled again for another kernel without allocations.
+  void Clear();
+
   size_t InputsSize() const { return inputs_.size(); }
   size_t OutputsSize() const { return outputs_.size(); }
   size_t AttrsSize() const { return attrs_.size(); }
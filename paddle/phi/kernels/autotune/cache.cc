@@ -13,12 +13,155 @@
 // limitations under the License.
 
 #include "paddle/phi/kernels/autotune/cache.h"
+
+#include <cstdio>
+#include <fstream>
 #include <iomanip>
+#include <sstream>
+#include <unordered_set>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+#include "gflags/gflags.h"
 #include "glog/logging.h"
+#include "paddle/fluid/platform/cpu_info.h"
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/phi/backends/gpu/gpu_info.h"
+#endif
+
+DECLARE_string(autotune_cache_file);
 
 namespace phi {
 namespace autotune {
 
+// The cache file is a text file, the first line is the magic and the version
+// of the format, each of the following lines is one config:
+//   paddle_autotune_cache 1
+//   <environment> <algorithm type> <key> <algorithm>
+// The keys are the hashes of the shapes (e.g. ConvKey), so the version must
+// be increased when the keys or the algorithm ids change. A file of another
+// version is ignored and overwritten by Save.
+static constexpr char kCacheFileMagic[] = "paddle_autotune_cache";
+static constexpr int kCacheFileVersion = 1;
+
+namespace {
+
+struct CacheFileEntry {
+  std::string env;
+  int64_t algo_type;
+  size_t key;
+  int64_t algo;
+};
+
+// Reads all the entries of a file, returns false if there is no valid file.
+bool ReadCacheFile(const std::string& path,
+                   std::vector<CacheFileEntry>* entries) {
+  std::ifstream ifs(path);
+  if (!ifs.is_open()) {
+    return false;
+  }
+  std::string magic;
+  int version = 0;
+  if (!(ifs >> magic >> version) || magic != kCacheFileMagic ||
+      version != kCacheFileVersion) {
+    LOG(WARNING) << "Ignore the autotune cache file " << path
+                 << " of another format or version.";
+    return false;
+  }
+  CacheFileEntry entry;
+  while (ifs >> entry.env >> entry.algo_type >> entry.key >> entry.algo) {
+    entries->push_back(entry);
+  }
+  return true;
+}
+
+// Exclusive lock of path + ".lock" held by the writers of the cache file.
+// The readers do not take it, since the file is replaced by rename.
+class CacheFileLock {
+ public:
+  explicit CacheFileLock(const std::string& path) {
+#ifndef _WIN32
+    fd_ = open((path + ".lock").c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ >= 0 && flock(fd_, LOCK_EX) != 0) {
+      close(fd_);
+      fd_ = -1;
+    }
+#endif
+  }
+
+  ~CacheFileLock() {
+#ifndef _WIN32
+    if (fd_ >= 0) {
+      flock(fd_, LOCK_UN);
+      close(fd_);
+    }
+#endif
+  }
+
+  bool Locked() const {
+#ifdef _WIN32
+    return true;
+#else
+    return fd_ >= 0;
+#endif
+  }
+
+ private:
+  int fd_{-1};
+};
+
+bool IsCPUAlgorithm(int64_t algo_type) {
+  return algo_type == static_cast<int64_t>(AlgorithmType::kConvForwardCPU) ||
+         algo_type == static_cast<int64_t>(AlgorithmType::kTransposeCPU);
+}
+
+}  // namespace
+
+std::string AutoTuneCacheFile() { return FLAGS_autotune_cache_file; }
+
+std::string AutoTuneEnvironment(int64_t algo_type) {
+  std::ostringstream os;
+  if (IsCPUAlgorithm(algo_type)) {
+    namespace platform = paddle::platform;
+    os << "cpu:";
+    if (platform::MayIUse(platform::avx512f)) {
+      os << "avx512f";
+    } else if (platform::MayIUse(platform::avx2)) {
+      os << "avx2";
+    } else if (platform::MayIUse(platform::avx)) {
+      os << "avx";
+    } else {
+      os << "sse";
+    }
+#ifdef PADDLE_WITH_MKLML
+    os << ":mklml";
+#else
+    os << ":openblas";
+#endif
+    return os.str();
+  }
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  const int id = phi::backends::gpu::GetCurrentDeviceId();
+  os << "gpu:sm" << phi::backends::gpu::GetGPUComputeCapability(id)
+#ifdef PADDLE_WITH_HIP
+     << ":rocm"
+#else
+     << ":cuda"
+#endif
+     << phi::backends::gpu::GetGPURuntimeVersion(id) << ":dnn"
+     << phi::backends::gpu::DnnVersion();
+#else
+  os << "gpu";
+#endif
+  return os.str();
+}
+
 // Define the cache key of operator
 size_t ConvKey(const std::vector<int64_t>& x_dims,
                const std::vector<int64_t>& w_dims,
@@ -43,6 +186,11 @@ std::string AlgorithmTypeString(int64_t algo_type) {
   } else if (algo_type ==
              static_cast<int64_t>(AlgorithmType::kConvBackwardFilter)) {
     return "conv_backward_filter";
+  } else if (algo_type ==
+             static_cast<int64_t>(AlgorithmType::kConvForwardCPU)) {
+    return "conv_forward_cpu";
+  } else if (algo_type == static_cast<int64_t>(AlgorithmType::kTransposeCPU)) {
+    return "transpose_cpu";
   }
   return std::to_string(algo_type);
 }
@@ -69,5 +217,104 @@ void AutoTuneCache::UpdateStatus() {
   total_cache_misses_ = cache_misses;
 }
 
+int64_t AutoTuneCache::Load(const std::string& path) {
+  std::vector<CacheFileEntry> entries;
+  if (!ReadCacheFile(path, &entries)) {
+    return 0;
+  }
+  std::unordered_map<int64_t, std::string> envs;
+  int64_t loaded = 0;
+  for (const auto& entry : entries) {
+    auto it = auto_tune_map_.find(entry.algo_type);
+    if (it == auto_tune_map_.end()) {
+      continue;
+    }
+    auto env = envs.find(entry.algo_type);
+    if (env == envs.end()) {
+      env = envs.emplace(entry.algo_type, AutoTuneEnvironment(entry.algo_type))
+                .first;
+    }
+    if (env->second == entry.env) {
+      it->second.Set(entry.key, entry.algo);
+      ++loaded;
+    }
+  }
+  VLOG(3) << "Load " << loaded << " autotune configs from " << path;
+  return loaded;
+}
+
+// Merges under the lock of the file: reads the file again, puts the configs
+// of this process first and then the other lines of the file which are not
+// replaced, writes them into a temporary file and renames it to path. The
+// readers always see a whole file, the configs of other processes and other
+// environments are kept until there are more than max_entries lines.
+void AutoTuneCache::Save(const std::string& path, int64_t max_entries) {
+  CacheFileLock lock(path);
+  if (!lock.Locked()) {
+    LOG(WARNING) << "Cannot lock the autotune cache file " << path
+                 << ", the cache is not saved.";
+    return;
+  }
+
+  std::vector<CacheFileEntry> entries;
+  std::unordered_set<std::string> saved;
+  auto entry_id = [](const CacheFileEntry& entry) {
+    return entry.env + " " + std::to_string(entry.algo_type) + " " +
+           std::to_string(entry.key);
+  };
+  for (auto& v : auto_tune_map_) {
+    const std::string env = AutoTuneEnvironment(v.first);
+    for (const auto& config : v.second.GetAll()) {
+      CacheFileEntry entry{env, v.first, config.first, config.second};
+      saved.insert(entry_id(entry));
+      entries.push_back(entry);
+    }
+  }
+  std::vector<CacheFileEntry> old_entries;
+  ReadCacheFile(path, &old_entries);
+  for (const auto& entry : old_entries) {
+    if (saved.insert(entry_id(entry)).second) {
+      entries.push_back(entry);
+    }
+  }
+  if (static_cast<int64_t>(entries.size()) > max_entries) {
+    entries.resize(std::max<int64_t>(max_entries, 0));
+  }
+
+#ifdef _WIN32
+  const std::string tmp_path = path + ".tmp" + std::to_string(_getpid());
+#else
+  const std::string tmp_path = path + ".tmp" + std::to_string(getpid());
+#endif
+  {
+    std::ofstream ofs(tmp_path, std::ios::trunc);
+    if (!ofs.is_open()) {
+      LOG(WARNING) << "Cannot write the autotune cache file " << tmp_path;
+      return;
+    }
+    ofs << kCacheFileMagic << " " << kCacheFileVersion << "\n";
+    for (const auto& entry : entries) {
+      ofs << entry.env << " " << entry.algo_type << " " << entry.key << " "
+          << entry.algo << "\n";
+    }
+    ofs.close();
+    if (!ofs) {
+      std::remove(tmp_path.c_str());
+      LOG(WARNING) << "Cannot write the autotune cache file " << tmp_path;
+      return;
+    }
+  }
+#ifdef _WIN32
+  // rename does not replace an existing file on Windows
+  std::remove(path.c_str());
+#endif
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    LOG(WARNING) << "Cannot replace the autotune cache file " << path;
+    return;
+  }
+  VLOG(3) << "Save " << entries.size() << " autotune configs into " << path;
+}
+
 }  // namespace autotune
 }  // namespace phi
@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <mutex>
 #include <numeric>
+#include <string>
 #include <unordered_map>
 #include <vector>
 #include "paddle/phi/common/data_type.h"
@@ -121,6 +122,12 @@ class AlgorithmsCache {
 
   int64_t Size() const { return hash_.size(); }
 
+  // A copy of the cached configs, used to save the cache into a file.
+  std::unordered_map<size_t, AlgorithmT> GetAll() {
+    std::lock_guard<std::mutex> lock(*cache_mutex_);
+    return hash_;
+  }
+
  private:
   std::unordered_map<size_t, AlgorithmT> hash_;
   std::shared_ptr<std::mutex> cache_mutex_;
@@ -133,7 +140,10 @@ enum class AlgorithmType {
   kConvForward = 1,
   kConvBackwardData = 2,
   kConvBackwardFilter = 3,
-  kAlgorithmCount = 4
+  // the algorithms of the CPU kernels, tuned by CpuAutoTuner
+  kConvForwardCPU = 4,
+  kTransposeCPU = 5,
+  kAlgorithmCount = 6
 };
 
 // AlgorithmsConfigKey -> AlgorithmsID
@@ -141,6 +151,13 @@ using AlgorithmsCacheMap = AlgorithmsCache<int64_t>;
 // AlgorithmType -> AlgorithmsCache
 using AlgorithmsTypeMap = std::unordered_map<int64_t, AlgorithmsCacheMap>;
 
+// The value of FLAGS_autotune_cache_file.
+std::string AutoTuneCacheFile();
+
+// The device and the library versions which the algorithms of algo_type are
+// tuned on, e.g. "gpu:sm80:cuda11020:cudnn8100" or "cpu:avx512f:mklml".
+std::string AutoTuneEnvironment(int64_t algo_type);
+
 class AutoTuneCache {
  public:
   static AutoTuneCache& Instance() {
@@ -172,6 +189,14 @@ class AutoTuneCache {
 
   void UpdateStatus();
 
+  // Loads the configs tuned on the same environment from the file written by
+  // Save, returns the number of them. See cache.cc for the format.
+  int64_t Load(const std::string& path);
+
+  // Merges the cached configs into the file, which may be shared by several
+  // processes. At most max_entries lines are kept.
+  void Save(const std::string& path, int64_t max_entries);
+
   // The number of total config cached
   int64_t Size() const { return total_size_; }
 
@@ -194,6 +219,10 @@ class AutoTuneCache {
     for (int i = 1; i < static_cast<int>(AlgorithmType::kAlgorithmCount); ++i) {
       Register(static_cast<AlgorithmType>(i));
     }
+    const std::string path = AutoTuneCacheFile();
+    if (!path.empty()) {
+      Load(path);
+    }
   }
 
   void Register(const AlgorithmType& algo_type) {
@@ -15,7 +15,10 @@
 #include "paddle/phi/kernels/autotune/cache.h"
 #include <gtest/gtest.h>
 #include <cmath>
+#include <cstdio>
+#include <fstream>
 #include <functional>
+#include <string>
 #include "glog/logging.h"
 
 enum ConvAlgos { GEMMKernel = 0, CuDNNKernel_1 = 1, CuDNNKernel_2 = 2 };
@@ -58,3 +61,65 @@ TEST(AlgosCache, AlgosCache) {
   EXPECT_EQ(autotune_cache.CacheMisses(), 2);
   EXPECT_LT(std::abs(cache_hit_rate - autotune_cache.CacheHitRate()), 1e-5);
 }
+
+int64_t CountLines(const std::string& path) {
+  std::ifstream ifs(path);
+  std::string line;
+  int64_t lines = 0;
+  while (std::getline(ifs, line)) {
+    ++lines;
+  }
+  return lines;
+}
+
+TEST(AlgosCache, SaveAndLoad) {
+  const std::string path = "autotune_cache_test.txt";
+  std::remove(path.c_str());
+  // a line of another machine is kept but not loaded
+  {
+    std::ofstream ofs(path);
+    ofs << "paddle_autotune_cache 1\n";
+    ofs << "gpu:sm0:other 1 7 1\n";
+  }
+
+  auto& autotune_cache = phi::autotune::AutoTuneCache::Instance();
+  autotune_cache.Clean();
+  autotune_cache.GetConvForward().Set(1, ConvAlgos::CuDNNKernel_2);
+  autotune_cache.Get(phi::autotune::AlgorithmType::kTransposeCPU).Set(2, 1);
+  autotune_cache.Save(path, 100);
+  EXPECT_EQ(CountLines(path), 4);
+
+  // another process saves its config, the file has the union
+  autotune_cache.Clean();
+  autotune_cache.GetConvBackwardData().Set(3, ConvAlgos::CuDNNKernel_1);
+  autotune_cache.Save(path, 100);
+  EXPECT_EQ(CountLines(path), 5);
+
+  autotune_cache.Clean();
+  EXPECT_EQ(autotune_cache.Load(path), 3);
+  EXPECT_EQ(autotune_cache.GetConvForward().Get(1), ConvAlgos::CuDNNKernel_2);
+  EXPECT_EQ(autotune_cache.GetConvBackwardData().Get(3),
+            ConvAlgos::CuDNNKernel_1);
+  EXPECT_EQ(
+      autotune_cache.Get(phi::autotune::AlgorithmType::kTransposeCPU).Get(2),
+      1);
+  EXPECT_FALSE(autotune_cache.GetConvForward().Find(7));
+
+  // the file is bounded, the configs of this process are kept first
+  autotune_cache.Save(path, 2);
+  EXPECT_EQ(CountLines(path), 3);
+  autotune_cache.Clean();
+  EXPECT_EQ(autotune_cache.Load(path), 2);
+
+  // a file of another version is ignored
+  {
+    std::ofstream ofs(path);
+    ofs << "paddle_autotune_cache 0\n";
+    ofs << "cpu 4 1 1\n";
+  }
+  autotune_cache.Clean();
+  EXPECT_EQ(autotune_cache.Load(path), 0);
+
+  std::remove(path.c_str());
+  std::remove((path + ".lock").c_str());
+}
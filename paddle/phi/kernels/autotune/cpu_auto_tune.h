@@ -0,0 +1,102 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/autotune/cache.h"
+#include "paddle/phi/kernels/autotune/cpu_timer.h"
+#include "paddle/phi/kernels/autotune/switch_autotune.h"
+
+namespace phi {
+namespace autotune {
+
+// Picks the fastest of the candidate algorithms of a CPU kernel. The kernel
+// adds its candidates, which write the same output, and calls Run with the
+// key of the shape:
+//   1. the algorithm cached for the key is run if there is one;
+//   2. in the steps set by SetAutoTuneRange, every candidate is timed by
+//      CpuTimer and the fastest one is cached;
+//   3. otherwise the first candidate, the default one, is run.
+class CpuAutoTuner {
+ public:
+  using Callback = std::function<void()>;
+
+  explicit CpuAutoTuner(AlgorithmType algo_type) : algo_type_(algo_type) {}
+
+  void AddCallBack(int64_t algo, Callback callback) {
+    algos_.push_back(algo);
+    callbacks_.push_back(std::move(callback));
+  }
+
+  // Returns the algorithm which has been run.
+  int64_t Run(size_t key) {
+    PADDLE_ENFORCE_GT(
+        callbacks_.size(),
+        0,
+        phi::errors::InvalidArgument(
+            "The number of the candidates must be greater than 0."));
+    auto& cache = AutoTuneCache::Instance().Get(algo_type_);
+    if (cache.Find(key)) {
+      const int64_t algo = cache.Get(key);
+      for (size_t i = 0; i < algos_.size(); ++i) {
+        if (algos_[i] == algo) {
+          callbacks_[i]();
+          return algo;
+        }
+      }
+    }
+    if (!AutoTuneStatus::Instance().UseAutoTune() || callbacks_.size() == 1) {
+      callbacks_[0]();
+      return algos_[0];
+    }
+
+    size_t best = 0;
+    float min_time = std::numeric_limits<float>::max();
+    CpuTimer timer;
+    for (size_t i = 0; i < callbacks_.size(); ++i) {
+      timer.Start();
+      callbacks_[i]();
+      timer.Stop();
+      const float time = timer.ElapsedTime();
+      VLOG(3) << "cpu algo[" << algos_[i] << "]: time cost is " << time;
+      if (time < min_time) {
+        min_time = time;
+        best = i;
+      }
+    }
+    // the output must be the one of the chosen algorithm
+    if (best + 1 != callbacks_.size()) {
+      callbacks_[best]();
+    }
+    VLOG(3) << "best cpu algo is " << algos_[best];
+    cache.Set(key, algos_[best]);
+    return algos_[best];
+  }
+
+ private:
+  AlgorithmType algo_type_;
+  std::vector<int64_t> algos_;
+  std::vector<Callback> callbacks_;
+};
+
+}  // namespace autotune
+}  // namespace phi
@@ -0,0 +1,82 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/autotune/cpu_auto_tune.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include "glog/logging.h"
+#include "paddle/phi/kernels/autotune/cpu_timer.h"
+
+enum CpuAlgos { SlowKernel = 0, FastKernel = 1 };
+
+void SleepFor(int milliseconds) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+TEST(CpuTimer, Sleep) {
+  phi::CpuTimer timer;
+  timer.Start();
+  SleepFor(10);
+  timer.Stop();
+  EXPECT_GE(timer.ElapsedTime(), 10.f);
+}
+
+TEST(CpuAutoTuner, PickFastest) {
+  auto& status = phi::autotune::AutoTuneStatus::Instance();
+  auto& cache = phi::autotune::AutoTuneCache::Instance().Get(
+      phi::autotune::AlgorithmType::kTransposeCPU);
+  // EnableAutoTune cleans the cache, the first step of the range is 1
+  status.EnableAutoTune();
+  status.SetAutoTuneRange(1, 3);
+
+  int slow_runs = 0;
+  int fast_runs = 0;
+  auto run = [&](size_t key) {
+    phi::autotune::CpuAutoTuner tuner(
+        phi::autotune::AlgorithmType::kTransposeCPU);
+    tuner.AddCallBack(CpuAlgos::SlowKernel, [&]() {
+      SleepFor(20);
+      slow_runs++;
+    });
+    tuner.AddCallBack(CpuAlgos::FastKernel, [&]() { fast_runs++; });
+    return tuner.Run(key);
+  };
+
+  // out of the range, the default one is run and nothing is cached
+  EXPECT_EQ(run(1), CpuAlgos::SlowKernel);
+  EXPECT_EQ(cache.Size(), 0);
+
+  // in the range, both are timed and the fast one is cached
+  status.Update();
+  EXPECT_TRUE(status.UseAutoTune());
+  slow_runs = fast_runs = 0;
+  EXPECT_EQ(run(1), CpuAlgos::FastKernel);
+  EXPECT_EQ(slow_runs, 1);
+  EXPECT_EQ(fast_runs, 1);
+  EXPECT_EQ(cache.Size(), 1);
+  EXPECT_EQ(cache.Get(1), CpuAlgos::FastKernel);
+
+  // after the range, the cached one is run for the tuned key only
+  status.Update();
+  status.Update();
+  EXPECT_FALSE(status.UseAutoTune());
+  slow_runs = fast_runs = 0;
+  EXPECT_EQ(run(1), CpuAlgos::FastKernel);
+  EXPECT_EQ(run(2), CpuAlgos::SlowKernel);
+  EXPECT_EQ(slow_runs, 1);
+  EXPECT_EQ(fast_runs, 1);
+
+  status.DisableAutoTune();
+}
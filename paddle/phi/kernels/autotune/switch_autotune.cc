@@ -18,6 +18,7 @@
 #include "glog/logging.h"
 
 DECLARE_bool(use_autotune);
+DECLARE_int64(autotune_cache_max_entries);
 
 namespace phi {
 namespace autotune {
@@ -54,6 +55,11 @@ void AutoTuneStatus::Update() {
             << static_cast<int>(StepHitRate() * 100) << "%";
   } else {
     use_autotune_ = false;
+    // the first step after the tuning, share the result with other processes
+    const std::string path = AutoTuneCacheFile();
+    if (current_steps_id_ + 1 == stop_step_id_ && !path.empty()) {
+      AutoTuneCache::Instance().Save(path, FLAGS_autotune_cache_max_entries);
+    }
     // Set a small tolerance to avoid performance degradation
     // due to large cache size under dynamic shape.
     // TODO(limingshu): Currently works for conv op only, this
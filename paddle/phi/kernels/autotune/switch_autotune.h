@@ -15,6 +15,7 @@
 #pragma once
 
 #include <cmath>
+#include <string>
 #include "paddle/phi/kernels/autotune/cache.h"
 
 namespace phi {
@@ -84,6 +85,11 @@ class AutoTuneStatus {
     previous_misses_ = 0;
     step_hit_rates_.clear();
     AutoTuneCache::Instance().Clean();
+    // keep the configs tuned by the former processes
+    const std::string path = AutoTuneCacheFile();
+    if (!path.empty()) {
+      AutoTuneCache::Instance().Load(path);
+    }
   }
 
   bool use_autotune_{false};
@@ -16,17 +16,57 @@ limitations under the License. */
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/funcs/activation_functor.h"
+#include "paddle/phi/kernels/funcs/cpu_bf16.h"
 #include "paddle/phi/kernels/impl/activation_impl.h"
 
 namespace phi {
 
+// Runs the functor of ComputeT on the tensors of T. bfloat16 runs the float
+// functor on chunks converted to float by funcs::BF16UnaryCompute.
+template <typename T>
+struct CPUActivation {
+  using ComputeT = T;
+
+  template <typename Context, typename Functor>
+  static void Run(const Context& dev_ctx,
+                  const DenseTensor& x,
+                  DenseTensor* out,
+                  const Functor& functor) {
+    ActivationImpl<T, Context, Functor>(dev_ctx, x, out, functor);
+  }
+};
+
+template <>
+struct CPUActivation<phi::dtype::bfloat16> {
+  using ComputeT = float;
+
+  template <typename Context, typename Functor>
+  static void Run(const Context& dev_ctx,
+                  const DenseTensor& x,
+                  DenseTensor* out,
+                  const Functor& functor) {
+    using bfloat16 = phi::dtype::bfloat16;
+    funcs::BF16UnaryCompute(
+        dev_ctx,
+        x.data<bfloat16>(),
+        dev_ctx.template Alloc<bfloat16>(out),
+        x.numel(),
+        4.0,
+        [&functor](const float* x_fp32, float* out_fp32, int64_t n) {
+          auto eigen_x = EigenVector<float>::ConstType(x_fp32, n);
+          auto eigen_out = EigenVector<float>::Type(out_fp32, n);
+          functor(Eigen::DefaultDevice(), eigen_x, eigen_out);
+        });
+  }
+};
+
 #define DEFINE_CPU_ACTIVATION_KERNEL(name, functor_class)               \
   template <typename T, typename Context>                               \
   void name##Kernel(                                                    \
       const Context& dev_ctx, const DenseTensor& x, DenseTensor* out) { \
-    funcs::functor_class<T> functor;                                    \
-    ActivationImpl<T, Context, funcs::functor_class<T>>(                \
-        dev_ctx, x, out, functor);                                      \
+    using ComputeT = typename CPUActivation<T>::ComputeT;               \
+    funcs::functor_class<ComputeT> functor;                             \
+    CPUActivation<T>::Run(dev_ctx, x, out, functor);                    \
   }
 
 #define DEFINE_CPU_ACT_KERNEL_WITH_ONE_ATTRS(name, functor_class, attr) \
@@ -35,27 +75,27 @@ namespace phi {
                     const DenseTensor& x,                               \
                     float attr,                                         \
                     DenseTensor* out) {                                 \
-    funcs::functor_class<T> functor;                                    \
+    using ComputeT = typename CPUActivation<T>::ComputeT;               \
+    funcs::functor_class<ComputeT> functor;                             \
     auto attrs = functor.GetAttrs();                                    \
     *(attrs[0].second) = attr;                                          \
-    ActivationImpl<T, Context, funcs::functor_class<T>>(                \
-        dev_ctx, x, out, functor);                                      \
+    CPUActivation<T>::Run(dev_ctx, x, out, functor);                    \
   }
 
-#define DEFINE_CPU_ACT_KERNEL_WITH_TWO_ATTRS(            \
-    name, functor_class, attr1, attr2)                   \
-  template <typename T, typename Context>                \
-  void name##Kernel(const Context& dev_ctx,              \
-                    const DenseTensor& x,                \
-                    float attr1,                         \
-                    float attr2,                         \
-                    DenseTensor* out) {                  \
-    funcs::functor_class<T> functor;                     \
-    auto attrs = functor.GetAttrs();                     \
-    *(attrs[0].second) = attr1;                          \
-    *(attrs[1].second) = attr2;                          \
-    ActivationImpl<T, Context, funcs::functor_class<T>>( \
-        dev_ctx, x, out, functor);                       \
+#define DEFINE_CPU_ACT_KERNEL_WITH_TWO_ATTRS(             \
+    name, functor_class, attr1, attr2)                    \
+  template <typename T, typename Context>                 \
+  void name##Kernel(const Context& dev_ctx,               \
+                    const DenseTensor& x,                 \
+                    float attr1,                          \
+                    float attr2,                          \
+                    DenseTensor* out) {                   \
+    using ComputeT = typename CPUActivation<T>::ComputeT; \
+    funcs::functor_class<ComputeT> functor;               \
+    auto attrs = functor.GetAttrs();                      \
+    *(attrs[0].second) = attr1;                           \
+    *(attrs[1].second) = attr2;                           \
+    CPUActivation<T>::Run(dev_ctx, x, out, functor);      \
   }
 
 DEFINE_CPU_ACTIVATION_KERNEL(Sin, SinFunctor)
@@ -115,20 +155,32 @@ void HardSwishKernel(const Context& dev_ctx,
                      float scale,
                      float offset,
                      DenseTensor* out) {
-  funcs::HardSwishFunctor<T> functor;
+  using ComputeT = typename CPUActivation<T>::ComputeT;
+  funcs::HardSwishFunctor<ComputeT> functor;
   auto attrs = functor.GetAttrs();
   *(attrs[0].second) = threshold;
   *(attrs[1].second) = scale;
   *(attrs[2].second) = offset;
-  ActivationImpl<T, Context, funcs::HardSwishFunctor<T>>(
-      dev_ctx, x, out, functor);
+  CPUActivation<T>::Run(dev_ctx, x, out, functor);
 }
 
 }  // namespace phi
-PD_REGISTER_KERNEL(relu, CPU, ALL_LAYOUT, phi::ReluKernel, float, double) {}
+PD_REGISTER_KERNEL(relu,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::ReluKernel,
+                   float,
+                   double,
+                   phi::dtype::bfloat16) {}
 
 #define PD_REGISTER_ACTIVATION_KERNEL(name, func) \
-  PD_REGISTER_KERNEL(name, CPU, ALL_LAYOUT, phi::func, float, double) {}
+  PD_REGISTER_KERNEL(name,                        \
+                     CPU,                         \
+                     ALL_LAYOUT,                  \
+                     phi::func,                   \
+                     float,                       \
+                     double,                      \
+                     phi::dtype::bfloat16) {}
 
 PD_REGISTER_ACTIVATION_KERNEL(sin, SinKernel)
 PD_REGISTER_ACTIVATION_KERNEL(cos, CosKernel)
@@ -157,8 +209,15 @@ PD_REGISTER_ACTIVATION_KERNEL(sqrt, SqrtKernel)
 PD_REGISTER_ACTIVATION_KERNEL(rsqrt, RsqrtKernel)
 PD_REGISTER_ACTIVATION_KERNEL(softplus, SoftplusKernel)
 
-PD_REGISTER_KERNEL(
-    exp, CPU, ALL_LAYOUT, phi::ExpKernel, float, double, int, int64_t) {}
+PD_REGISTER_KERNEL(exp,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::ExpKernel,
+                   float,
+                   double,
+                   int,
+                   int64_t,
+                   phi::dtype::bfloat16) {}
 PD_REGISTER_KERNEL(expm1,
                    CPU,
                    ALL_LAYOUT,
@@ -167,8 +226,15 @@ PD_REGISTER_KERNEL(expm1,
                    double,
                    phi::dtype::float16) {}
 PD_REGISTER_KERNEL(logit, CPU, ALL_LAYOUT, phi::LogitKernel, float, double) {}
-PD_REGISTER_KERNEL(
-    square, CPU, ALL_LAYOUT, phi::SquareKernel, float, double, int, int64_t) {}
+PD_REGISTER_KERNEL(square,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::SquareKernel,
+                   float,
+                   double,
+                   int,
+                   int64_t,
+                   phi::dtype::bfloat16) {}
 PD_REGISTER_ACTIVATION_KERNEL(sigmoid, SigmoidKernel)
 PD_REGISTER_ACTIVATION_KERNEL(logsigmoid, LogSigmoidKernel)
 PD_REGISTER_ACTIVATION_KERNEL(hard_sigmoid, HardSigmoidKernel)
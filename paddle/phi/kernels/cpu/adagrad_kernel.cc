@@ -13,10 +13,10 @@
 // limitations under the License.
 
 #include "paddle/phi/kernels/adagrad_kernel.h"
-#include "paddle/fluid/operators/math/selected_rows_functor.h"
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
+#include "paddle/phi/kernels/funcs/sparse_row_update.h"
 #include "paddle/phi/kernels/impl/adagrad_kernel_impl.h"
 
 namespace phi {
@@ -35,33 +35,35 @@ struct SparseAdagradFunctor<phi::CPUContext, T> {
                   T epsilon,
                   DenseTensor* moment,
                   DenseTensor* param) {
-    // 1. g_m.rows = set(g.rows)
-    auto grad_width = grad.value().dims()[1];
-    paddle::operators::math::scatter::MergeAdd<phi::CPUContext, T> merge_func;
-    auto grad_merge = merge_func(context, grad);
-    auto& merge_rows = grad_merge.rows();
-    auto* grad_merge_data = grad_merge.mutable_value()->template data<T>();
-
-    // 2. m += g_m * g_m
-    auto grad_square =
-        SquareSelectedRows<phi::CPUContext, T>(context, grad_merge);
-
-    paddle::operators::math::SelectedRowsAddToTensor<phi::CPUContext, T>
-        functor;
-    functor(context, grad_square, moment);
+    // The duplicated rows of the gradient are summed while their moment and
+    // parameter rows are updated in place, without a merged SelectedRows.
+    if (grad.rows().empty()) {
+      return;
+    }
+    const int64_t row_numel = grad.value().dims()[1];
+    funcs::SparseRowGroups groups;
+    funcs::GroupSparseRows(context,
+                           grad.rows().data(),
+                           grad.rows().size(),
+                           param->dims()[0],
+                           &groups);
 
-    // 3. update parameter
-    auto* lr = learning_rate.data<T>();
+    const T lr = learning_rate.data<T>()[0];
     auto* param_data = param->data<T>();
     auto* moment_data = moment->data<T>();
-
-    for (size_t i = 0; i < merge_rows.size(); i++) {
-      for (int64_t j = 0; j < grad_width; j++) {
-        param_data[merge_rows[i] * grad_width + j] -=
-            lr[0] * grad_merge_data[i * grad_width + j] /
-            (std::sqrt(moment_data[merge_rows[i] * grad_width + j]) + epsilon);
-      }
-    }
+    funcs::ForEachSparseRow(
+        context,
+        groups,
+        grad.value().data<T>(),
+        row_numel,
+        [&](int64_t row, const T* g) {
+          T* p = param_data + row * row_numel;
+          T* m = moment_data + row * row_numel;
+          for (int64_t j = 0; j < row_numel; ++j) {
+            m[j] += g[j] * g[j];
+            p[j] -= lr * g[j] / (std::sqrt(m[j]) + epsilon);
+          }
+        });
   }
 };
 
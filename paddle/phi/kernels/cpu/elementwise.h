@@ -20,6 +20,7 @@ limitations under the License. */
 #include "paddle/phi/kernels/funcs/common_shape.h"
 
 #include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/cpu_bf16.h"
 #include "paddle/phi/kernels/funcs/eigen/common.h"
 
 namespace phi {
@@ -54,7 +55,8 @@ template <typename DevCtx, typename T>
 struct SameDimsAddFunctor<
     DevCtx,
     T,
-    typename std::enable_if<!std::is_floating_point<T>::value>::type> {
+    typename std::enable_if<!std::is_floating_point<T>::value &&
+                            !std::is_same<T, dtype::bfloat16>::value>::type> {
   void operator()(const DevCtx& dev_ctx,
                   const DenseTensor& x,
                   const DenseTensor& y,
@@ -68,6 +70,30 @@ struct SameDimsAddFunctor<
   }
 };
 
+template <typename DevCtx, typename T>
+struct SameDimsAddFunctor<
+    DevCtx,
+    T,
+    typename std::enable_if<std::is_same<T, dtype::bfloat16>::value>::type> {
+  void operator()(const DevCtx& dev_ctx,
+                  const DenseTensor& x,
+                  const DenseTensor& y,
+                  DenseTensor* z) {
+    funcs::BF16BinaryCompute(
+        dev_ctx,
+        x.data<T>(),
+        y.data<T>(),
+        dev_ctx.template Alloc<T>(z),
+        x.numel(),
+        funcs::kElementwiseCostPerUnit,
+        [](const float* a, const float* b, float* c, int64_t n) {
+          for (int64_t i = 0; i < n; ++i) {
+            c[i] = a[i] + b[i];
+          }
+        });
+  }
+};
+
 // Subtract
 template <typename DevCtx, typename T, class Enable = void>
 struct SameDimsSubtractFunctor {
@@ -96,7 +122,8 @@ template <typename DevCtx, typename T>
 struct SameDimsSubtractFunctor<
     DevCtx,
     T,
-    typename std::enable_if<!std::is_floating_point<T>::value>::type> {
+    typename std::enable_if<!std::is_floating_point<T>::value &&
+                            !std::is_same<T, dtype::bfloat16>::value>::type> {
   void operator()(const DevCtx& dev_ctx,
                   const DenseTensor& x,
                   const DenseTensor& y,
@@ -109,6 +136,30 @@ struct SameDimsSubtractFunctor<
   }
 };
 
+template <typename DevCtx, typename T>
+struct SameDimsSubtractFunctor<
+    DevCtx,
+    T,
+    typename std::enable_if<std::is_same<T, dtype::bfloat16>::value>::type> {
+  void operator()(const DevCtx& dev_ctx,
+                  const DenseTensor& x,
+                  const DenseTensor& y,
+                  DenseTensor* z) {
+    funcs::BF16BinaryCompute(
+        dev_ctx,
+        x.data<T>(),
+        y.data<T>(),
+        dev_ctx.template Alloc<T>(z),
+        x.numel(),
+        funcs::kElementwiseCostPerUnit,
+        [](const float* a, const float* b, float* c, int64_t n) {
+          for (int64_t i = 0; i < n; ++i) {
+            c[i] = a[i] - b[i];
+          }
+        });
+  }
+};
+
 // Divide
 template <typename DevCtx, typename T, class Enable = void>
 struct SameDimsDivideFunctor {
@@ -176,7 +227,8 @@ template <typename DevCtx, typename T>
 struct SameDimsMultiplyFunctor<
     DevCtx,
     T,
-    typename std::enable_if<!std::is_floating_point<T>::value>::type> {
+    typename std::enable_if<!std::is_floating_point<T>::value &&
+                            !std::is_same<T, dtype::bfloat16>::value>::type> {
   void operator()(const DevCtx& dev_ctx,
                   const DenseTensor& x,
                   const DenseTensor& y,
@@ -189,6 +241,30 @@ struct SameDimsMultiplyFunctor<
   }
 };
 
+template <typename DevCtx, typename T>
+struct SameDimsMultiplyFunctor<
+    DevCtx,
+    T,
+    typename std::enable_if<std::is_same<T, dtype::bfloat16>::value>::type> {
+  void operator()(const DevCtx& dev_ctx,
+                  const DenseTensor& x,
+                  const DenseTensor& y,
+                  DenseTensor* z) {
+    funcs::BF16BinaryCompute(
+        dev_ctx,
+        x.data<T>(),
+        y.data<T>(),
+        dev_ctx.template Alloc<T>(z),
+        x.numel(),
+        funcs::kElementwiseCostPerUnit,
+        [](const float* a, const float* b, float* c, int64_t n) {
+          for (int64_t i = 0; i < n; ++i) {
+            c[i] = a[i] * b[i];
+          }
+        });
+  }
+};
+
 template <typename Functor>
 struct SameDimsElementwiseCompute {
   void operator()(const CPUContext& dev_ctx,
@@ -19,6 +19,7 @@
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
 #include "paddle/phi/kernels/funcs/blas/blas_impl.h"
+#include "paddle/phi/kernels/funcs/cpu_bf16.h"
 #include "paddle/phi/kernels/funcs/eigen/common.h"
 #include "paddle/phi/kernels/funcs/eigen/eigen_function.h"
 
@@ -83,20 +84,58 @@ struct GeluFunctor {
   }
 };
 
+template <typename T>
+struct GeluCPUFunctor {
+  void operator()(const CPUContext& dev_ctx,
+                  const DenseTensor& x,
+                  bool approximate,
+                  DenseTensor* out) const {
+    dev_ctx.template Alloc<T>(out);
+    auto eigen_out = EigenVector<T>::Flatten(*out);
+    auto eigen_x = EigenVector<T>::Flatten(x);
+    auto& dev = *dev_ctx.eigen_device();
+
+    GeluFunctor<T> functor;
+    functor(dev, eigen_x, eigen_out, approximate);
+  }
+};
+
+// bfloat16 runs the float gelu on chunks converted by funcs::BF16UnaryCompute
+template <>
+struct GeluCPUFunctor<dtype::bfloat16> {
+  void operator()(const CPUContext& dev_ctx,
+                  const DenseTensor& x,
+                  bool approximate,
+                  DenseTensor* out) const {
+    funcs::BF16UnaryCompute(
+        dev_ctx,
+        x.data<dtype::bfloat16>(),
+        dev_ctx.template Alloc<dtype::bfloat16>(out),
+        x.numel(),
+        16.0,
+        [approximate](const float* x_fp32, float* out_fp32, int64_t n) {
+          auto eigen_x = EigenVector<float>::ConstType(x_fp32, n);
+          auto eigen_out = EigenVector<float>::Type(out_fp32, n);
+          GeluFunctor<float>()(
+              Eigen::DefaultDevice(), eigen_x, eigen_out, approximate);
+        });
+  }
+};
+
 template <typename T, typename Context>
 void GeluKernel(const Context& dev_ctx,
                 const DenseTensor& x,
                 bool approximate,
                 DenseTensor* out) {
-  dev_ctx.template Alloc<T>(out);
-  auto eigen_out = EigenVector<T>::Flatten(*out);
-  auto eigen_x = EigenVector<T>::Flatten(x);
-  auto& dev = *dev_ctx.eigen_device();
-
-  GeluFunctor<T> functor;
-  functor(dev, eigen_x, eigen_out, approximate);
+  GeluCPUFunctor<T>()(dev_ctx, x, approximate, out);
 }
 
 }  // namespace phi
 
-PD_REGISTER_KERNEL(gelu, CPU, ALL_LAYOUT, phi::GeluKernel, float, double) {}
+PD_REGISTER_KERNEL(gelu,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::GeluKernel,
+                   float,
+                   double,
+                   phi::dtype::bfloat16) {}
@@ -13,6 +13,11 @@
 // limitations under the License.
 
 #include "paddle/phi/kernels/layer_norm_grad_kernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include "paddle/phi/kernels/cpu/elementwise.h"
 #include "paddle/phi/kernels/funcs/layer_norm_util.h"
 #if !defined(PADDLE_WITH_CUDA) && !defined(_WIN32) && !defined(__APPLE__) && \
@@ -23,6 +28,7 @@
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/copy_kernel.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/cpu_bf16.h"
 #include "paddle/phi/kernels/funcs/elementwise_base.h"
 #include "paddle/phi/kernels/funcs/elementwise_functor.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
@@ -179,8 +185,135 @@ void LayerNormGradKernel(const Context& dev_ctx,
   }
 }
 
-}  // namespace phi
+// bfloat16 computes the gradients in float, with the float mean and variance
+// of the bfloat16 LayerNormKernel. The gradients of scale and bias take the
+// dtypes of scale and bias, bfloat16 or float.
+template <>
+void LayerNormGradKernel<phi::dtype::bfloat16, CPUContext>(
+    const CPUContext& dev_ctx,
+    const DenseTensor& x,
+    paddle::optional<const DenseTensor&> scale_opt,
+    paddle::optional<const DenseTensor&> bias_opt,
+    const DenseTensor& mean,
+    const DenseTensor& variance,
+    const DenseTensor& out_grad,
+    float epsilon,
+    int begin_norm_axis,
+    bool is_test,
+    DenseTensor* x_grad,
+    DenseTensor* scale_grad,
+    DenseTensor* bias_grad) {
+  using bfloat16 = phi::dtype::bfloat16;
+  auto* scale = scale_opt.get_ptr();
+  auto* bias = bias_opt.get_ptr();
+
+  auto matrix_dim = phi::flatten_to_2d(x.dims(), begin_norm_axis);
+  const int64_t left = matrix_dim[0];
+  const int64_t right = matrix_dim[1];
+
+  std::vector<float> scale_fp32;
+  if (scale) {
+    scale_fp32.resize(right);
+    if (scale->dtype() == DataType::BFLOAT16) {
+      funcs::BF16ToFloat(scale->data<bfloat16>(), scale_fp32.data(), right);
+    } else {
+      std::copy(scale->data<float>(),
+                scale->data<float>() + right,
+                scale_fp32.begin());
+    }
+  }
+  // Writes the float gradient of the vector like ref
+  auto store = [&dev_ctx, right](const std::vector<float>& grad,
+                                 const DenseTensor* ref,
+                                 DenseTensor* out) {
+    if (ref != nullptr && ref->dtype() == DataType::FLOAT32) {
+      std::copy(grad.begin(), grad.end(), dev_ctx.template Alloc<float>(out));
+    } else {
+      funcs::FloatToBF16(
+          grad.data(), dev_ctx.template Alloc<bfloat16>(out), right);
+    }
+  };
 
-PD_REGISTER_KERNEL(
-    layer_norm_grad, CPU, ALL_LAYOUT, phi::LayerNormGradKernel, float, double) {
+  const bfloat16* x_data = x.data<bfloat16>();
+  const bfloat16* dy_data = out_grad.data<bfloat16>();
+  const float* mean_data = mean.data<float>();
+  const float* var_data = variance.data<float>();
+
+  if (scale_grad || bias_grad) {
+    // Each thread sums a range of the columns over all the rows.
+    std::vector<float> d_scale(right, 0.f);
+    std::vector<float> d_bias(right, 0.f);
+    funcs::ParallelFor(
+        dev_ctx,
+        right,
+        4.0 * left,
+        [&](int64_t begin, int64_t end) {
+          const int64_t n = end - begin;
+          std::vector<float> x_row(n);
+          std::vector<float> dy_row(n);
+          for (int64_t i = 0; i < left; ++i) {
+            const int64_t offset = i * right + begin;
+            funcs::BF16ToFloat(dy_data + offset, dy_row.data(), n);
+            funcs::BF16ToFloat(x_data + offset, x_row.data(), n);
+            const float inv_std = 1.f / std::sqrt(var_data[i] + epsilon);
+            for (int64_t j = 0; j < n; ++j) {
+              d_bias[begin + j] += dy_row[j];
+              d_scale[begin + j] +=
+                  dy_row[j] * (x_row[j] - mean_data[i]) * inv_std;
+            }
+          }
+        });
+    if (scale_grad) {
+      store(d_scale, scale, scale_grad);
+    }
+    if (bias_grad) {
+      store(d_bias, bias, bias_grad);
+    }
+  }
+
+  if (x_grad) {
+    bfloat16* dx_data = dev_ctx.template Alloc<bfloat16>(x_grad);
+    funcs::ParallelFor(
+        dev_ctx,
+        left,
+        12.0 * right,
+        [&](int64_t begin, int64_t end) {
+          std::vector<float> x_norm(right);
+          std::vector<float> dy_row(right);
+          for (int64_t i = begin; i < end; ++i) {
+            funcs::BF16ToFloat(x_data + i * right, x_norm.data(), right);
+            funcs::BF16ToFloat(dy_data + i * right, dy_row.data(), right);
+            const float inv_std = 1.f / std::sqrt(var_data[i] + epsilon);
+            // dx = (g - mean(g) - x_norm * mean(g * x_norm)) * inv_std,
+            // where g = dy * scale.
+            float g_sum = 0.f;
+            float g_norm_sum = 0.f;
+            for (int64_t j = 0; j < right; ++j) {
+              x_norm[j] = (x_norm[j] - mean_data[i]) * inv_std;
+              if (scale) {
+                dy_row[j] *= scale_fp32[j];
+              }
+              g_sum += dy_row[j];
+              g_norm_sum += dy_row[j] * x_norm[j];
+            }
+            const float g_mean = g_sum / right;
+            const float g_norm_mean = g_norm_sum / right;
+            for (int64_t j = 0; j < right; ++j) {
+              dy_row[j] =
+                  (dy_row[j] - g_mean - x_norm[j] * g_norm_mean) * inv_std;
+            }
+            funcs::FloatToBF16(dy_row.data(), dx_data + i * right, right);
+          }
+        });
+  }
 }
+
+}  // namespace phi
+
+PD_REGISTER_KERNEL(layer_norm_grad,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::LayerNormGradKernel,
+                   float,
+                   double,
+                   phi::dtype::bfloat16) {}
@@ -13,6 +13,11 @@
 // limitations under the License.
 
 #include "paddle/phi/kernels/layer_norm_kernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include "paddle/phi/kernels/cpu/elementwise.h"
 #include "paddle/phi/kernels/funcs/layer_norm_util.h"
 #if !defined(PADDLE_WITH_CUDA) && !defined(_WIN32) && !defined(__APPLE__) && \
@@ -21,6 +26,7 @@
 #endif
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/funcs/cpu_bf16.h"
 #include "paddle/phi/kernels/funcs/elementwise_base.h"
 #include "paddle/phi/kernels/funcs/elementwise_functor.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
@@ -139,7 +145,108 @@ void LayerNormKernel(const Context& dev_ctx,
 #endif
 }
 
+// bfloat16 normalizes the rows in float. Like the GPU kernel, mean and var
+// are float and scale and bias may be bfloat16 or float.
+template <>
+void LayerNormKernel<phi::dtype::bfloat16, CPUContext>(
+    const CPUContext& dev_ctx,
+    const DenseTensor& x,
+    paddle::optional<const DenseTensor&> scale_opt,
+    paddle::optional<const DenseTensor&> bias_opt,
+    float epsilon,
+    int begin_norm_axis,
+    bool is_test,
+    DenseTensor* y,
+    DenseTensor* mean,
+    DenseTensor* var) {
+  using bfloat16 = phi::dtype::bfloat16;
+  auto* scale = scale_opt.get_ptr();
+  auto* bias = bias_opt.get_ptr();
+
+  auto matrix_dim = phi::flatten_to_2d(x.dims(), begin_norm_axis);
+  const int64_t left = matrix_dim[0];
+  const int64_t right = matrix_dim[1];
+  if (scale) {
+    PADDLE_ENFORCE_EQ(
+        scale->numel(),
+        right,
+        phi::errors::InvalidArgument(
+            "scale's length (%d) is not equal with expected (%d).",
+            scale->numel(),
+            right));
+  }
+  if (bias) {
+    PADDLE_ENFORCE_EQ(bias->numel(),
+                      right,
+                      phi::errors::InvalidArgument(
+                          "bias's length (%d) is not equal with expected (%d).",
+                          bias->numel(),
+                          right));
+  }
+
+  auto to_float = [right](const DenseTensor* t, std::vector<float>* out) {
+    if (t == nullptr) {
+      return;
+    }
+    out->resize(right);
+    if (t->dtype() == DataType::BFLOAT16) {
+      funcs::BF16ToFloat(t->data<bfloat16>(), out->data(), right);
+    } else {
+      std::copy(t->data<float>(), t->data<float>() + right, out->begin());
+    }
+  };
+  std::vector<float> scale_fp32;
+  std::vector<float> bias_fp32;
+  to_float(scale, &scale_fp32);
+  to_float(bias, &bias_fp32);
+
+  const bfloat16* x_data = x.data<bfloat16>();
+  bfloat16* y_data = dev_ctx.template Alloc<bfloat16>(y);
+  float* mean_data = dev_ctx.template Alloc<float>(mean);
+  float* var_data = dev_ctx.template Alloc<float>(var);
+  funcs::ParallelFor(
+      dev_ctx,
+      left,
+      8.0 * right,
+      [&](int64_t begin, int64_t end) {
+        std::vector<float> row(right);
+        for (int64_t i = begin; i < end; ++i) {
+          funcs::BF16ToFloat(x_data + i * right, row.data(), right);
+          float sum = 0.f;
+          for (int64_t j = 0; j < right; ++j) {
+            sum += row[j];
+          }
+          const float row_mean = sum / right;
+          float square_sum = 0.f;
+          for (int64_t j = 0; j < right; ++j) {
+            const float d = row[j] - row_mean;
+            square_sum += d * d;
+          }
+          const float row_var = square_sum / right;
+          const float inv_std = 1.f / std::sqrt(row_var + epsilon);
+          for (int64_t j = 0; j < right; ++j) {
+            float v = (row[j] - row_mean) * inv_std;
+            if (scale) {
+              v *= scale_fp32[j];
+            }
+            if (bias) {
+              v += bias_fp32[j];
+            }
+            row[j] = v;
+          }
+          funcs::FloatToBF16(row.data(), y_data + i * right, right);
+          mean_data[i] = row_mean;
+          var_data[i] = row_var;
+        }
+      });
+}
+
 }  // namespace phi
 
-PD_REGISTER_KERNEL(
-    layer_norm, CPU, ALL_LAYOUT, phi::LayerNormKernel, float, double) {}
+PD_REGISTER_KERNEL(layer_norm,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::LayerNormKernel,
+                   float,
+                   double,
+                   phi::dtype::bfloat16) {}
@@ -17,15 +17,145 @@ limitations under the License. */
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/core/kernel_registry.h"
 
+#include "paddle/phi/common/bfloat16.h"
 #include "paddle/phi/common/complex.h"
+#include "paddle/phi/kernels/funcs/cpu_bf16.h"
 #include "paddle/phi/kernels/impl/matmul_kernel_impl.h"
 
+namespace phi {
+
+bool MatMulBF16Functor<CPUContext, phi::dtype::bfloat16>::operator()(
+    const CPUContext& dev_ctx,
+    const DenseTensor& X,
+    const DenseTensor& Y,
+    const std::vector<std::int64_t>& x_dims,
+    const std::vector<std::int64_t>& y_dims,
+    DenseTensor* Out,
+    bool trans_x,
+    bool trans_y,
+    bool flag) const {
+  using bfloat16 = phi::dtype::bfloat16;
+  const int x_ndim = x_dims.size();
+  const int y_ndim = y_dims.size();
+  const std::vector<std::int64_t> x_batch(
+      x_dims.begin(), x_dims.end() - std::min(x_ndim, 2));
+  const std::vector<std::int64_t> y_batch(
+      y_dims.begin(), y_dims.end() - std::min(y_ndim, 2));
+
+  // Matrices with the same batch dims, or with a 2-D one, run BF16Gemm
+  // directly, vectors and broadcast batches run the float matmul.
+  if (x_ndim >= 2 && y_ndim >= 2 &&
+      (x_batch == y_batch || x_batch.empty() || y_batch.empty())) {
+    const int M = trans_x ? x_dims[x_ndim - 1] : x_dims[x_ndim - 2];
+    const int K = trans_x ? x_dims[x_ndim - 2] : x_dims[x_ndim - 1];
+    const int K_y = trans_y ? y_dims[y_ndim - 1] : y_dims[y_ndim - 2];
+    const int N = trans_y ? y_dims[y_ndim - 2] : y_dims[y_ndim - 1];
+    PADDLE_ENFORCE_EQ(
+        K,
+        K_y,
+        phi::errors::InvalidArgument("Input X's width should be equal to the "
+                                     "Y's height, but received X's shape: "
+                                     "[%s], Y's shape: [%s].",
+                                     X.dims(),
+                                     Y.dims()));
+    std::vector<std::int64_t> out_dims = x_batch.empty() ? y_batch : x_batch;
+    int64_t batch_size = 1;
+    for (auto d : out_dims) {
+      batch_size *= d;
+    }
+    out_dims.push_back(M);
+    out_dims.push_back(N);
+    Out->ResizeAndAllocate(phi::make_ddim(out_dims));
+    const bfloat16* x_data = X.data<bfloat16>();
+    const bfloat16* y_data = Y.data<bfloat16>();
+    bfloat16* out_data = dev_ctx.template Alloc<bfloat16>(Out);
+    const int lda = trans_x ? M : K;
+    const int ldb = trans_y ? K : N;
+    const float beta = flag ? 1.f : 0.f;
+    if (!trans_x && y_batch.empty()) {
+      // the rows of all the batches of X times the same Y
+      VLOG(3) << "MatMul's bfloat16 case 1";
+      funcs::BF16Gemm(dev_ctx,
+                      false,
+                      trans_y,
+                      static_cast<int>(batch_size * M),
+                      N,
+                      K,
+                      1.f,
+                      x_data,
+                      lda,
+                      y_data,
+                      ldb,
+                      beta,
+                      out_data,
+                      N);
+      return true;
+    }
+    VLOG(3) << "MatMul's bfloat16 case 2";
+    const int64_t x_stride = x_batch.empty() ? 0 : static_cast<int64_t>(M) * K;
+    const int64_t y_stride = y_batch.empty() ? 0 : static_cast<int64_t>(K) * N;
+    for (int64_t i = 0; i < batch_size; ++i) {
+      funcs::BF16Gemm(dev_ctx,
+                      trans_x,
+                      trans_y,
+                      M,
+                      N,
+                      K,
+                      1.f,
+                      x_data + i * x_stride,
+                      lda,
+                      y_data + i * y_stride,
+                      ldb,
+                      beta,
+                      out_data + i * M * N,
+                      N);
+    }
+    return true;
+  }
+
+  VLOG(3) << "MatMul's bfloat16 case 3";
+  DenseTensor x_fp32;
+  x_fp32.Resize(X.dims());
+  funcs::BF16ToFloat(X.data<bfloat16>(),
+                     dev_ctx.template Alloc<float>(&x_fp32),
+                     X.numel());
+  DenseTensor y_fp32;
+  y_fp32.Resize(Y.dims());
+  funcs::BF16ToFloat(Y.data<bfloat16>(),
+                     dev_ctx.template Alloc<float>(&y_fp32),
+                     Y.numel());
+  DenseTensor out_fp32;
+  if (flag) {
+    out_fp32.Resize(Out->dims());
+    funcs::BF16ToFloat(Out->data<bfloat16>(),
+                       dev_ctx.template Alloc<float>(&out_fp32),
+                       Out->numel());
+  }
+  MatMulFunction<CPUContext, float>(dev_ctx,
+                                    x_fp32,
+                                    y_fp32,
+                                    x_dims,
+                                    y_dims,
+                                    &out_fp32,
+                                    trans_x,
+                                    trans_y,
+                                    flag);
+  Out->Resize(out_fp32.dims());
+  funcs::FloatToBF16(out_fp32.data<float>(),
+                     dev_ctx.template Alloc<bfloat16>(Out),
+                     out_fp32.numel());
+  return true;
+}
+
+}  // namespace phi
+
 PD_REGISTER_KERNEL(matmul,
                    CPU,
                    ALL_LAYOUT,
                    phi::MatmulKernel,
                    float,
                    double,
+                   phi::dtype::bfloat16,
                    phi::dtype::complex<float>,
                    phi::dtype::complex<double>) {}
 
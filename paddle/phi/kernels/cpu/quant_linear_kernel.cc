@@ -0,0 +1,113 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/phi/kernels/quant_linear_kernel.h"
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/funcs/int8_gemm.h"
+
+namespace phi {
+
+template <typename T, typename Context>
+void QuantLinearKernel(const Context& dev_ctx,
+                       const DenseTensor& x,
+                       const DenseTensor& w,
+                       paddle::optional<const DenseTensor&> bias,
+                       int in_num_col_dims,
+                       bool trans_w,
+                       bool padding_weights,
+                       const std::string& activation_type,
+                       float scale_in,
+                       const std::vector<float>& scale_weights,
+                       DenseTensor* out) {
+  const auto& w_dims = w.dims();
+  PADDLE_ENFORCE_EQ(
+      w_dims.size(),
+      2,
+      phi::errors::InvalidArgument("The weight of quant_linear should be a "
+                                   "2-D tensor, but received %d-D.",
+                                   w_dims.size()));
+  PADDLE_ENFORCE_GT(scale_in,
+                    0.f,
+                    phi::errors::InvalidArgument(
+                        "The input scale of quant_linear should be greater "
+                        "than 0, but received %f.",
+                        scale_in));
+  PADDLE_ENFORCE_EQ(
+      activation_type.empty() || activation_type == "relu",
+      true,
+      phi::errors::InvalidArgument("The activation of quant_linear should be "
+                                   "empty or relu, but received %s.",
+                                   activation_type));
+  const int pad = padding_weights ? 4 : 0;
+  const int ldw = static_cast<int>(w_dims[1]);
+  const int k = static_cast<int>(trans_w ? w_dims[1] : w_dims[0]) - pad;
+  const int n = static_cast<int>(trans_w ? w_dims[0] : w_dims[1]) - pad;
+
+  const auto x_mat_dims = phi::flatten_to_2d(x.dims(), in_num_col_dims);
+  PADDLE_ENFORCE_EQ(
+      x_mat_dims[1],
+      k,
+      phi::errors::InvalidArgument(
+          "The flattened input of quant_linear should have %d columns, as "
+          "the weight has, but received input's shape %s.",
+          k,
+          x.dims()));
+  const int m = static_cast<int>(x_mat_dims[0]);
+
+  const T* bias_data = nullptr;
+  if (bias) {
+    PADDLE_ENFORCE_EQ(bias->numel(),
+                      n,
+                      phi::errors::InvalidArgument(
+                          "The bias of quant_linear should have %d elements, "
+                          "but received %d.",
+                          n,
+                          bias->numel()));
+    bias_data = bias->data<T>();
+  }
+
+  std::vector<int64_t> out_dims;
+  for (int i = 0; i < in_num_col_dims; ++i) {
+    out_dims.push_back(x.dims()[i]);
+  }
+  out_dims.push_back(n);
+  out->Resize(phi::make_ddim(out_dims));
+  T* out_data = dev_ctx.template Alloc<T>(out);
+  if (m == 0) {
+    return;
+  }
+
+  auto packed = funcs::PackedInt8WeightCache::Instance().Get(
+      w, k, n, ldw, trans_w, scale_weights);
+
+  const int lda = funcs::Int8GemmPaddedK(k);
+  DenseTensor x_q;
+  x_q.Resize(phi::make_ddim({m, lda}));
+  uint8_t* x_q_data = dev_ctx.template Alloc<uint8_t>(&x_q);
+  funcs::QuantizeToUint8(
+      dev_ctx, x.data<T>(), m, k, k, scale_in, x_q_data, lda);
+
+  funcs::Int8GemmEpilogue epilogue;
+  epilogue.a_scale = scale_in;
+  epilogue.bias = bias_data;
+  epilogue.relu = activation_type == "relu";
+  funcs::Int8Gemm<T>(dev_ctx, m, x_q_data, lda, *packed, epilogue, out_data, n);
+}
+
+}  // namespace phi
+
+PD_REGISTER_KERNEL(
+    quant_linear, CPU, ALL_LAYOUT, phi::QuantLinearKernel, float) {}
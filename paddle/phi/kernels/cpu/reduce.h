@@ -14,7 +14,10 @@
 
 #pragma once
 
+#include <algorithm>
+#include <memory>
 #include <set>
+#include <type_traits>
 
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/core/visit_type.h"
@@ -24,6 +27,8 @@
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/kernels/funcs/eigen/common.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
+#include "paddle/phi/kernels/funcs/parallel_for.h"
+#include "paddle/phi/kernels/funcs/reduce_functor.h"
 // See Note [ Why still include the fluid headers? ]
 #include "paddle/fluid/operators/eigen/eigen_function.h"
 namespace phi {
@@ -66,10 +71,98 @@ void ReduceFunctor(const DeviceContext& context,
     functor(place, &x, &out, reduce_dim);
   } else {
     auto out = EigenTensor<T, (D - R_D)>::From(*output, out_dims);
-    functor(place, &x, &out, reduce_dim);
+    const int64_t rows = x.dimension(0);
+    const bool reduce_rows =
+        std::find(dims_ref.begin(), dims_ref.end(), 0) != dims_ref.end();
+    if (reduce_rows || rows <= 1) {
+      functor(place, &x, &out, reduce_dim);
+      return;
+    }
+    // The rows along dim 0 are reduced independently, so they are split
+    // among the intra-op threads, each range is a contiguous block of both
+    // the input and the output.
+    const int64_t x_row_size = x.size() / rows;
+    const int64_t out_row_size = out.size() / rows;
+    funcs::ParallelFor(
+        context,
+        rows,
+        static_cast<double>(x_row_size),
+        [&](int64_t begin, int64_t end) {
+          auto x_part_dims = x.dimensions();
+          x_part_dims[0] = end - begin;
+          auto out_part_dims = out.dimensions();
+          out_part_dims[0] = end - begin;
+          typename EigenTensor<T, D>::ConstType x_part(
+              x.data() + begin * x_row_size, x_part_dims);
+          typename EigenTensor<T, (D - R_D)>::Type out_part(
+              out.data() + begin * out_row_size, out_part_dims);
+          Functor part_functor;
+          part_functor(place, &x_part, &out_part, reduce_dim);
+        });
   }
 }
 
+// Whether reducing the partial results of blocks gives the result of the
+// whole tensor.
+template <typename Functor>
+struct IsBlockReducible : public std::false_type {};
+
+template <>
+struct IsBlockReducible<funcs::SumFunctor> : public std::true_type {};
+template <>
+struct IsBlockReducible<funcs::MaxFunctor> : public std::true_type {};
+template <>
+struct IsBlockReducible<funcs::MinFunctor> : public std::true_type {};
+template <>
+struct IsBlockReducible<funcs::ProdFunctor> : public std::true_type {};
+template <>
+struct IsBlockReducible<funcs::AllFunctor> : public std::true_type {};
+template <>
+struct IsBlockReducible<funcs::AnyFunctor> : public std::true_type {};
+
+// Reduce all the elements of input to the scalar output. With more than one
+// intra-op thread, reducible functors reduce blocks of the input on the
+// threads, then the partials. Otherwise the whole input is reduced by Eigen,
+// so the results on a single thread keep the original numerics.
+template <typename DeviceContext, typename OutT, typename Functor>
+void ReduceAll(const DeviceContext& dev_ctx,
+               const phi::DenseTensor& input,
+               phi::DenseTensor* output) {
+  auto x = EigenVector<OutT>::Flatten(input);
+  auto out = EigenScalar<OutT>::From(*output);
+  auto& dev = *dev_ctx.eigen_device();
+  auto reduce_dim = Eigen::array<int, 1>({{0}});
+
+  constexpr int64_t kBlockSize = 32768;
+  const int64_t numel = x.size();
+  const int64_t num_blocks = (numel + kBlockSize - 1) / kBlockSize;
+  if (!IsBlockReducible<Functor>::value || num_blocks <= 1 ||
+      funcs::NumThreads(dev_ctx) <= 1) {
+    Functor functor;
+    functor(dev, &x, &out, reduce_dim);
+    return;
+  }
+  std::unique_ptr<OutT[]> partials(new OutT[num_blocks]);
+  funcs::ParallelFor(
+      dev_ctx,
+      num_blocks,
+      static_cast<double>(kBlockSize),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          const int64_t offset = i * kBlockSize;
+          typename EigenVector<OutT>::ConstType x_block(
+              x.data() + offset, std::min(kBlockSize, numel - offset));
+          typename EigenScalar<OutT>::Type partial(partials.get() + i);
+          Functor functor;
+          functor(dev, &x_block, &partial, reduce_dim);
+        }
+      });
+  typename EigenVector<OutT>::ConstType x_partials(partials.get(),
+                                                    num_blocks);
+  Functor functor;
+  functor(dev, &x_partials, &out, reduce_dim);
+}
+
 #define HANDLE_REDUCE_DIM(NDIM, RDIM)                        \
   if (ndim == NDIM && rdim == RDIM) {                        \
     ReduceFunctor<DeviceContext, OutT, NDIM, RDIM, Functor>( \
@@ -162,13 +255,7 @@ void ReduceKernelImpl(const DeviceContext& dev_ctx,
 
   if (reduce_all) {
     // Flatten and reduce 1-D tensor
-    auto x = EigenVector<OutT>::Flatten(input);
-    auto out = EigenScalar<OutT>::From(*output);
-    auto& dev = *dev_ctx.eigen_device();
-    auto reduce_dim = Eigen::array<int, 1>({{0}});
-
-    Functor functor;
-    functor(dev, &x, &out, reduce_dim);
+    ReduceAll<DeviceContext, OutT, Functor>(dev_ctx, input, output);
   } else {
     int ndim = input.dims().size();
     int rdim = dims.size();
@@ -17,6 +17,7 @@
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/funcs/eigen/common.h"
+#include "paddle/phi/kernels/funcs/sparse_row_update.h"
 
 namespace phi {
 
@@ -54,35 +55,55 @@ void sgd_dense_param_dense_grad_impl<phi::dtype::bfloat16>(
   o = p - lr[0] * g;
 }
 
+// The duplicated rows of the gradient are summed while their parameter row
+// is updated, so the gradient of an embedding needs no MergeAdd.
 template <typename T>
-void sgd_dense_param_sparse_grad_impl(const DenseTensor& param,
+void sgd_dense_param_sparse_grad_impl(const CPUContext& dev_ctx,
+                                      const DenseTensor& param,
                                       const DenseTensor& learning_rate,
                                       const SelectedRows& grad,
                                       DenseTensor* param_out) {
   const auto& grad_value = grad.value();
   const auto& grad_rows = grad.rows();
+  if (grad_rows.empty()) {
+    return;
+  }
+  const int64_t param_height = param_out->dims()[0];
+  const int64_t row_numel = param_out->numel() / param_height;
+  PADDLE_ENFORCE_EQ(
+      grad_value.numel(),
+      static_cast<int64_t>(grad_rows.size()) * row_numel,
+      phi::errors::InvalidArgument(
+          "The rows of the sparse gradient should have %d elements as the "
+          "rows of the parameter, but the gradient has %d elements in %d "
+          "rows.",
+          row_numel,
+          grad_value.numel(),
+          grad_rows.size()));
+
+  funcs::SparseRowGroups groups;
+  funcs::GroupSparseRows(
+      dev_ctx, grad_rows.data(), grad_rows.size(), param_height, &groups);
   const T* param_data = param.data<T>();
-  const T* grad_data = grad_value.data<T>();
-  const T* lr = learning_rate.data<T>();
-  const int64_t* rows_data = grad_rows.data();
+  const T lr = learning_rate.data<T>()[0];
   T* out_data = param_out->data<T>();
-
-  paddle::operators::jit::sgd_attr_t attr;
-  attr.param_height = param_out->dims()[0];
-  attr.param_width = param_out->numel() / attr.param_height;
-  attr.grad_height = grad_rows.size();  // note: it is not grad->height()
-  attr.grad_width = grad_value.numel() / attr.grad_height;
-  attr.selected_rows_size = grad_rows.size();
-
-  auto sgd =
-      paddle::operators::jit::KernelFuncs<paddle::operators::jit::SgdTuple<T>,
-                                          phi::CPUPlace>::Cache()
-          .At(attr);
-  sgd(lr, param_data, grad_data, rows_data, out_data, &attr);
+  funcs::ForEachSparseRow(
+      dev_ctx,
+      groups,
+      grad_value.data<T>(),
+      row_numel,
+      [&](int64_t row, const T* g) {
+        const T* p = param_data + row * row_numel;
+        T* out = out_data + row * row_numel;
+        for (int64_t j = 0; j < row_numel; ++j) {
+          out[j] = p[j] - lr * g[j];
+        }
+      });
 }
 
 template <>
 void sgd_dense_param_sparse_grad_impl<phi::dtype::bfloat16>(
+    const CPUContext& dev_ctx,
     const DenseTensor& param,
     const DenseTensor& learning_rate,
     const SelectedRows& grad,
@@ -137,7 +158,8 @@ void SGDDenseParamSparseGradKernel(
     DenseTensor* param_out,
     DenseTensor* master_param_out) {
   dev_ctx.template Alloc<T>(param_out);
-  sgd_dense_param_sparse_grad_impl<T>(param, learning_rate, grad, param_out);
+  sgd_dense_param_sparse_grad_impl<T>(
+      dev_ctx, param, learning_rate, grad, param_out);
 }
 
 template <typename T, typename Context>
@@ -19,20 +19,22 @@
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/common/bfloat16.h"
 #include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/autotune/cpu_auto_tune.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
 #include "paddle/phi/kernels/impl/transpose_grad_kernel_impl.h"
 
 namespace phi {
 
+// Transposes of at least this many elements choose between the Eigen
+// shuffle and TransposeNormal by autotune, the smaller ones always use the
+// Eigen shuffle.
+constexpr int64_t kTransposeAutoTuneNumel = 1 << 16;
+
 template <typename T, typename Context>
-void TransposeKernel(const Context& ctx,
+void TransposeByRank(const Context& ctx,
                      const DenseTensor& x,
                      const std::vector<int>& axis,
                      DenseTensor* out) {
-  ctx.template Alloc<T>(out);
-  if (out->numel() == 0) {
-    return;
-  }
   int rank = axis.size();
   switch (rank) {
     case 1:
@@ -65,6 +67,33 @@ void TransposeKernel(const Context& ctx,
       trans_normal(ctx, x, out, axis);
   }
 }
+
+template <typename T, typename Context>
+void TransposeKernel(const Context& ctx,
+                     const DenseTensor& x,
+                     const std::vector<int>& axis,
+                     DenseTensor* out) {
+  ctx.template Alloc<T>(out);
+  if (out->numel() == 0) {
+    return;
+  }
+  if (axis.size() < 2 || axis.size() > 6 ||
+      out->numel() < kTransposeAutoTuneNumel) {
+    TransposeByRank<T, Context>(ctx, x, axis, out);
+    return;
+  }
+
+  autotune::CpuAutoTuner tuner(autotune::AlgorithmType::kTransposeCPU);
+  tuner.AddCallBack(
+      0, [&]() { TransposeByRank<T, Context>(ctx, x, axis, out); });
+  tuner.AddCallBack(1, [&]() {
+    funcs::TransposeNormal<Context, T> trans_normal;
+    trans_normal(ctx, x, out, axis);
+  });
+  tuner.Run(autotune::GetKey(
+      vectorize(x.dims()), axis, static_cast<int64_t>(x.dtype())));
+}
+
 }  // namespace phi
 
 PD_REGISTER_KERNEL(transpose,
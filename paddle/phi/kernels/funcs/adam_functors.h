@@ -363,36 +363,54 @@ class SparseAdamFunctor<T, CPUAdam, T> {
     param_out_[i] = p;
   }
 
-  inline void operator()(size_t numel) const {
-    // lr could be reuse
+  // Updates the row of the parameter with its gradient g of row_numel
+  // elements, the same as adam_update on each element.
+  inline void update_row(int64_t row, const T* g) const {
+    T lr = *lr_;
+    T beta1_pow = *beta1_pow_;
+    T beta2_pow = *beta2_pow_;
+    lr *= sqrt(1 - beta2_pow) / (1 - beta1_pow);
+    T epsilon = epsilon_ * sqrt(1 - beta2_pow);
+    const int64_t offset = row * row_numel_;
+
+    for (int64_t k = 0; k != row_numel_; ++k) {
+      T mom1 = beta1_ * moment1_[offset + k] + (1 - beta1_) * g[k];
+      T mom2 = beta2_ * moment2_[offset + k] + (1 - beta2_) * g[k] * g[k];
+      T p = param_[offset + k] - lr * (mom1 / (sqrt(mom2) + epsilon));
+      moment1_out_[offset + k] = mom1;
+      moment2_out_[offset + k] = mom2;
+      param_out_[offset + k] = p;
+    }
+  }
+
+  // Decays the moments of a row without gradient and updates the parameter
+  // with them.
+  inline void decay_row(int64_t row) const {
     T lr = *lr_;
     T beta1_pow = *beta1_pow_;
     T beta2_pow = *beta2_pow_;
     lr *= sqrt(1 - beta2_pow) / (1 - beta1_pow);
+    const int64_t offset = row * row_numel_;
+
+    for (int64_t k = 0; k != row_numel_; ++k) {
+      T mom1 = beta1_ * moment1_[offset + k];
+      T mom2 = beta2_ * moment2_[offset + k];
+      T p = param_[offset + k] - lr * (mom1 / (sqrt(mom2) + epsilon_));
+      moment1_out_[offset + k] = mom1;
+      moment2_out_[offset + k] = mom2;
+      param_out_[offset + k] = p;
+    }
+  }
+
+  inline void operator()(size_t numel) const {
     int64_t row_count = static_cast<int64_t>(numel / row_numel_);
 
     for (int64_t i = 0, j = 0; i != row_count; ++i) {
-      if (i == *(rows_ + j)) {
-        for (int64_t k = 0; k != row_numel_; ++k) {
-          T g = grad_[j * row_numel_ + k];
-          adam_update(i * row_numel_ + k, g);
-        }
+      if (j < row_count_ && i == rows_[j]) {
+        update_row(i, grad_ + j * row_numel_);
         ++j;
       } else {
-        for (int64_t k = 0; k != row_numel_; ++k) {
-          T mom1 = moment1_[i * row_numel_ + k];
-          T mom2 = moment2_[i * row_numel_ + k];
-          T p = param_[i * row_numel_ + k];
-
-          mom1 = beta1_ * mom1;
-          mom2 = beta2_ * mom2;
-
-          p -= lr * (mom1 / (sqrt(mom2) + epsilon_));
-          // Write back to global memory
-          moment1_out_[i * row_numel_ + k] = mom1;
-          moment2_out_[i * row_numel_ + k] = mom2;
-          param_out_[i * row_numel_ + k] = p;
-        }
+        decay_row(i);
       }
     }
   }
@@ -131,6 +131,13 @@ class Blas {
                 const int N,
                 const int K) const;
 
+  // The size in bytes of the matrix packed by GEMM_PACK.
+  template <typename T>
+  size_t GEMM_PACK_GET_SIZE(const CBLAS_IDENTIFIER id,
+                            const int M,
+                            const int N,
+                            const int K) const;
+
   template <typename T>
   void GEMM_PACK(const CBLAS_IDENTIFIER id,
                  const CBLAS_TRANSPOSE trans,
@@ -431,6 +438,11 @@ class BlasT : private Blas<DeviceContext> {
     Base()->template GEMM_PACK<T>(args...);
   }
 
+  template <typename... ARGS>
+  size_t GEMM_PACK_GET_SIZE(ARGS... args) const {
+    return Base()->template GEMM_PACK_GET_SIZE<T>(args...);
+  }
+
   template <typename... ARGS>
   void GEMM_COMPUTE(ARGS... args) const {
     Base()->template GEMM_COMPUTE<T>(args...);
@@ -24,6 +24,7 @@
 
 #include "paddle/phi/common/bfloat16.h"
 #include "paddle/phi/common/complex.h"
+#include "paddle/phi/kernels/funcs/blas/small_gemm.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
 
 namespace phi {
@@ -106,6 +107,24 @@ struct CBlas<phi::dtype::bfloat16> {
       z[i] = x[i] - y[i];
     }
   }
+
+  // bfloat16 matmul of CPU runs funcs::BF16Gemm, see MatMulBF16Functor
+  static void GEMM(...) {
+    PADDLE_THROW(phi::errors::Unimplemented(
+        "bfloat16 GEMM not supported on CPU, please check your code"));
+  }
+
+  static void GEMV(...) {
+    PADDLE_THROW(phi::errors::Unimplemented(
+        "bfloat16 GEMV not supported on CPU, please check your code"));
+  }
+
+#ifdef PADDLE_WITH_MKLML
+  static void GEMM_BATCH(...) {
+    PADDLE_THROW(phi::errors::Unimplemented(
+        "bfloat16 GEMM_BATCH not supported on CPU, please check your code"));
+  }
+#endif
 };
 
 #ifdef PADDLE_WITH_MKLML
@@ -126,6 +145,11 @@ struct CBlas<float> {
     paddle::platform::dynload::cblas_sgemm_pack(args...);
   }
 
+  template <typename... ARGS>
+  static size_t GEMM_PACK_GET_SIZE(ARGS... args) {
+    return paddle::platform::dynload::cblas_sgemm_pack_get_size(args...);
+  }
+
   template <typename... ARGS>
   static void GEMM_COMPUTE(ARGS... args) {
     paddle::platform::dynload::cblas_sgemm_compute(args...);
@@ -252,6 +276,11 @@ struct CBlas<double> {
     paddle::platform::dynload::cblas_dgemm_pack(args...);
   }
 
+  template <typename... ARGS>
+  static size_t GEMM_PACK_GET_SIZE(ARGS... args) {
+    return paddle::platform::dynload::cblas_dgemm_pack_get_size(args...);
+  }
+
   template <typename... ARGS>
   static void GEMM_COMPUTE(ARGS... args) {
     paddle::platform::dynload::cblas_dgemm_compute(args...);
@@ -1016,6 +1045,21 @@ T *Blas<phi::CPUContext>::GEMM_ALLOC(const CBLAS_IDENTIFIER id,
   return CBlas<T>::GEMM_ALLOC(id, M, N, K);
 }
 
+template <>
+template <typename T>
+size_t Blas<paddle::platform::CPUDeviceContext>::GEMM_PACK_GET_SIZE(
+    const CBLAS_IDENTIFIER id, const int M, const int N, const int K) const {
+  return CBlas<T>::GEMM_PACK_GET_SIZE(id, M, N, K);
+}
+template <>
+template <typename T>
+size_t Blas<phi::CPUContext>::GEMM_PACK_GET_SIZE(const CBLAS_IDENTIFIER id,
+                                                 const int M,
+                                                 const int N,
+                                                 const int K) const {
+  return CBlas<T>::GEMM_PACK_GET_SIZE(id, M, N, K);
+}
+
 template <>
 template <typename T>
 void Blas<paddle::platform::CPUDeviceContext>::GEMM_PACK(
@@ -1710,6 +1754,29 @@ void Blas<paddle::platform::CPUDeviceContext>::BatchedGEMM(
                        1 /* group_count */,
                        &batchCount);
 #else
+  if (UseSmallBatchedGEMM<T>(M, N, K)) {
+    std::vector<const T *> a_array(batchCount);
+    std::vector<const T *> b_array(batchCount);
+    std::vector<T *> c_array(batchCount);
+    for (int k = 0; k < batchCount; ++k) {
+      a_array[k] = &A[k * strideA];
+      b_array[k] = &B[k * strideB];
+      c_array[k] = &C[k * M * N];
+    }
+    SmallBatchedGEMM<T>(context_,
+                        transA == CblasTrans,
+                        transB == CblasTrans,
+                        M,
+                        N,
+                        K,
+                        alpha,
+                        a_array.data(),
+                        b_array.data(),
+                        beta,
+                        c_array.data(),
+                        batchCount);
+    return;
+  }
   for (int k = 0; k < batchCount; ++k) {
     auto *Ak = &A[k * strideA];
     auto *Bk = &B[k * strideB];
@@ -1769,6 +1836,29 @@ void Blas<phi::CPUContext>::BatchedGEMM(CBLAS_TRANSPOSE transA,
                        1 /* group_count */,
                        &batchCount);
 #else
+  if (UseSmallBatchedGEMM<T>(M, N, K)) {
+    std::vector<const T *> a_array(batchCount);
+    std::vector<const T *> b_array(batchCount);
+    std::vector<T *> c_array(batchCount);
+    for (int k = 0; k < batchCount; ++k) {
+      a_array[k] = &A[k * strideA];
+      b_array[k] = &B[k * strideB];
+      c_array[k] = &C[k * M * N];
+    }
+    SmallBatchedGEMM<T>(context_,
+                        transA == CblasTrans,
+                        transB == CblasTrans,
+                        M,
+                        N,
+                        K,
+                        alpha,
+                        a_array.data(),
+                        b_array.data(),
+                        beta,
+                        c_array.data(),
+                        batchCount);
+    return;
+  }
   for (int k = 0; k < batchCount; ++k) {
     auto *Ak = &A[k * strideA];
     auto *Bk = &B[k * strideB];
@@ -1813,6 +1903,21 @@ void Blas<paddle::platform::CPUDeviceContext>::BatchedGEMM(
                        1 /* group_count */,
                        &batchCount);
 #else
+  if (UseSmallBatchedGEMM<T>(M, N, K)) {
+    SmallBatchedGEMM<T>(context_,
+                        transA == CblasTrans,
+                        transB == CblasTrans,
+                        M,
+                        N,
+                        K,
+                        alpha,
+                        A,
+                        B,
+                        beta,
+                        C,
+                        batchCount);
+    return;
+  }
   for (int k = 0; k < batchCount; ++k) {
     this->template GEMM<T>(
         transA, transB, M, N, K, alpha, A[k], B[k], beta, C[k]);
@@ -1853,6 +1958,21 @@ void Blas<phi::CPUContext>::BatchedGEMM(CBLAS_TRANSPOSE transA,
                        1 /* group_count */,
                        &batchCount);
 #else
+  if (UseSmallBatchedGEMM<T>(M, N, K)) {
+    SmallBatchedGEMM<T>(context_,
+                        transA == CblasTrans,
+                        transB == CblasTrans,
+                        M,
+                        N,
+                        K,
+                        alpha,
+                        A,
+                        B,
+                        beta,
+                        C,
+                        batchCount);
+    return;
+  }
   for (int k = 0; k < batchCount; ++k) {
     this->template GEMM<T>(
         transA, transB, M, N, K, alpha, A[k], B[k], beta, C[k]);
@@ -0,0 +1,217 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/funcs/parallel_for.h"
+
+namespace phi {
+namespace funcs {
+
+// A batch of small matrices, such as the 16x64x64 products of the attention
+// heads, spends most of a GEMM call per matrix on its dispatch and blocking.
+// Below these sizes the batch is computed by the register-blocked kernel
+// below, with the batch partitioned among the intra-op threads.
+constexpr int kSmallGemmMaxDim = 128;
+constexpr int64_t kSmallGemmMaxMNK = 64 * 64 * 64;
+
+template <typename T>
+struct IsSmallGemmType {
+  static constexpr bool value =
+      std::is_same<T, float>::value || std::is_same<T, double>::value;
+};
+
+template <typename T>
+inline bool UseSmallBatchedGEMM(int M, int N, int K) {
+  return IsSmallGemmType<T>::value && M > 0 && N > 0 && K > 0 &&
+         M <= kSmallGemmMaxDim && N <= kSmallGemmMaxDim &&
+         K <= kSmallGemmMaxDim &&
+         static_cast<int64_t>(M) * N * K <= kSmallGemmMaxMNK;
+}
+
+namespace detail {
+
+// The tile of C in registers: 4 rows of 64 bytes, which take 4 AVX-512 or
+// 8 AVX registers.
+constexpr int kSmallGemmMR = 4;
+
+template <typename T>
+struct SmallGemmNR {
+  static constexpr int value = 64 / sizeof(T);
+};
+
+// acc[MR][NR] = A[rows, K] * B_panel[K, NR], where row i of A starts at
+// a_rows[i] and its elements are csa apart, and the panel is packed as K
+// rows of NR. The rows past rows repeat the last one, so the loops have
+// constant bounds and are vectorized over NR.
+template <typename T>
+void SmallGemmMicroKernel(int K,
+                          const T* const* a_rows,
+                          int64_t csa,
+                          const T* __restrict__ b_panel,
+                          T* __restrict__ acc) {
+  constexpr int MR = kSmallGemmMR;
+  constexpr int NR = SmallGemmNR<T>::value;
+  // a local tile, which the compiler keeps in registers
+  T c[MR * NR];
+  std::fill(c, c + MR * NR, static_cast<T>(0));
+  for (int p = 0; p < K; ++p) {
+    const T* b = b_panel + p * NR;
+    for (int i = 0; i < MR; ++i) {
+      const T a = a_rows[i][p * csa];
+      for (int j = 0; j < NR; ++j) {
+        c[i * NR + j] += a * b[j];
+      }
+    }
+  }
+  std::copy(c, c + MR * NR, acc);
+}
+
+// C[M, N] = alpha * op(A) * op(B) + beta * C with row-major A, B and C,
+// packing op(B) into panels of NR columns in packed_b.
+template <typename T>
+void SmallGemm(bool trans_a,
+               bool trans_b,
+               int M,
+               int N,
+               int K,
+               T alpha,
+               const T* A,
+               const T* B,
+               T beta,
+               T* C,
+               T* packed_b) {
+  constexpr int MR = kSmallGemmMR;
+  constexpr int NR = SmallGemmNR<T>::value;
+  const int64_t lda = trans_a ? M : K;
+  const int64_t ldb = trans_b ? K : N;
+  const int panels = (N + NR - 1) / NR;
+
+  // panel q holds op(B)[p, q * NR + j] at p * NR + j, padded with zeros
+  for (int q = 0; q < panels; ++q) {
+    T* panel = packed_b + static_cast<int64_t>(q) * K * NR;
+    const int cols = std::min(NR, N - q * NR);
+    for (int p = 0; p < K; ++p) {
+      T* dst = panel + p * NR;
+      for (int j = 0; j < cols; ++j) {
+        const int64_t col = q * NR + j;
+        dst[j] = trans_b ? B[col * ldb + p] : B[p * ldb + col];
+      }
+      std::fill(dst + cols, dst + NR, static_cast<T>(0));
+    }
+  }
+
+  // op(A)[i, p] is at A + i * rsa + p * csa
+  const int64_t rsa = trans_a ? 1 : lda;
+  const int64_t csa = trans_a ? lda : 1;
+  T acc[MR * NR];
+  const T* a_rows[MR];
+  for (int i0 = 0; i0 < M; i0 += MR) {
+    const int rows = std::min(MR, M - i0);
+    for (int i = 0; i < MR; ++i) {
+      a_rows[i] = A + (i0 + std::min(i, rows - 1)) * rsa;
+    }
+    for (int q = 0; q < panels; ++q) {
+      SmallGemmMicroKernel<T>(
+          K, a_rows, csa, packed_b + static_cast<int64_t>(q) * K * NR, acc);
+      const int cols = std::min(NR, N - q * NR);
+      for (int i = 0; i < rows; ++i) {
+        T* c = C + static_cast<int64_t>(i0 + i) * N + q * NR;
+        const T* acc_row = acc + i * NR;
+        if (beta == static_cast<T>(0)) {
+          // C may be uninitialized
+          for (int j = 0; j < cols; ++j) {
+            c[j] = alpha * acc_row[j];
+          }
+        } else {
+          for (int j = 0; j < cols; ++j) {
+            c[j] = alpha * acc_row[j] + beta * c[j];
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace detail
+
+// C[b] = alpha * op(A[b]) * op(B[b]) + beta * C[b] for the batch_count small
+// row-major matrices, the same as Blas::BatchedGEMM with the pointers of
+// every matrix. Each thread packs B of its matrices into its own buffer.
+template <typename T, typename Context>
+typename std::enable_if<IsSmallGemmType<T>::value>::type SmallBatchedGEMM(
+    const Context& dev_ctx,
+    bool trans_a,
+    bool trans_b,
+    int M,
+    int N,
+    int K,
+    T alpha,
+    const T* const* A,
+    const T* const* B,
+    T beta,
+    T* const* C,
+    int batch_count) {
+  constexpr int NR = detail::SmallGemmNR<T>::value;
+  const int64_t packed_size =
+      static_cast<int64_t>((N + NR - 1) / NR) * NR * K;
+  ParallelFor(dev_ctx,
+              batch_count,
+              2.0 * M * N * K,
+              [&](int64_t begin, int64_t end) {
+                std::vector<T> packed_b(packed_size);
+                for (int64_t b = begin; b < end; ++b) {
+                  detail::SmallGemm<T>(trans_a,
+                                       trans_b,
+                                       M,
+                                       N,
+                                       K,
+                                       alpha,
+                                       A[b],
+                                       B[b],
+                                       beta,
+                                       C[b],
+                                       packed_b.data());
+                }
+              });
+}
+
+// The other types are never small, see UseSmallBatchedGEMM.
+template <typename T, typename Context>
+typename std::enable_if<!IsSmallGemmType<T>::value>::type SmallBatchedGEMM(
+    const Context& dev_ctx,
+    bool trans_a,
+    bool trans_b,
+    int M,
+    int N,
+    int K,
+    T alpha,
+    const T* const* A,
+    const T* const* B,
+    T beta,
+    T* const* C,
+    int batch_count) {
+  PADDLE_THROW(phi::errors::Unimplemented(
+      "SmallBatchedGEMM supports float and double only, call it when "
+      "UseSmallBatchedGEMM is true."));
+}
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,695 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/phi/kernels/funcs/conv_cpu_engine.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/autotune/cpu_auto_tune.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+
+DECLARE_bool(conv_cpu_fast_algo);
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+// F(4x4, 3x3): a 6x6 input tile gives a 4x4 output tile with 36 products.
+constexpr int kWinogradInTile = 6;
+constexpr int kWinogradOutTile = 4;
+constexpr int kWinogradPoints = kWinogradInTile * kWinogradInTile;
+// The tiles of an image are transformed and multiplied by blocks, so that
+// the transformed input of a block stays in cache.
+constexpr int kWinogradTileBlock = 64;
+// 1x1 convolution packs at most this many output pixels of rows at a time.
+constexpr int kDirect1x1PackPixels = 256;
+
+// u = G * g, g has 3 elements and u has 6.
+template <typename T>
+inline void WinogradFilter1D(const T* g, int g_stride, T* u, int u_stride) {
+  const T g0 = g[0];
+  const T g1 = g[g_stride];
+  const T g2 = g[2 * g_stride];
+  u[0] = g0 / T(4);
+  u[u_stride] = -(g0 + g1 + g2) / T(6);
+  u[2 * u_stride] = -(g0 - g1 + g2) / T(6);
+  u[3 * u_stride] = g0 / T(24) + g1 / T(12) + g2 / T(6);
+  u[4 * u_stride] = g0 / T(24) - g1 / T(12) + g2 / T(6);
+  u[5 * u_stride] = g2;
+}
+
+// v = B^T * d, both have 6 elements.
+template <typename T>
+inline void WinogradInput1D(const T* d, int d_stride, T* v, int v_stride) {
+  const T d0 = d[0];
+  const T d1 = d[d_stride];
+  const T d2 = d[2 * d_stride];
+  const T d3 = d[3 * d_stride];
+  const T d4 = d[4 * d_stride];
+  const T d5 = d[5 * d_stride];
+  v[0] = T(4) * d0 - T(5) * d2 + d4;
+  v[v_stride] = -T(4) * (d1 + d2) + d3 + d4;
+  v[2 * v_stride] = T(4) * (d1 - d2) - d3 + d4;
+  v[3 * v_stride] = T(2) * (d3 - d1) - d2 + d4;
+  v[4 * v_stride] = T(2) * (d1 - d3) - d2 + d4;
+  v[5 * v_stride] = T(4) * d1 - T(5) * d3 + d5;
+}
+
+// y = A^T * m, m has 6 elements and y has 4.
+template <typename T>
+inline void WinogradOutput1D(const T* m, int m_stride, T* y, int y_stride) {
+  const T m0 = m[0];
+  const T m1 = m[m_stride];
+  const T m2 = m[2 * m_stride];
+  const T m3 = m[3 * m_stride];
+  const T m4 = m[4 * m_stride];
+  const T m5 = m[5 * m_stride];
+  y[0] = m0 + m1 + m2 + m3 + m4;
+  y[y_stride] = m1 - m2 + T(2) * (m3 - m4);
+  y[2 * y_stride] = m1 + m2 + T(4) * (m3 + m4);
+  y[3 * y_stride] = m1 - m2 + T(8) * (m3 - m4) + m5;
+}
+
+// The 2-D transforms apply the 1-D ones to the columns, then to the rows.
+template <typename T>
+void WinogradFilterTile(const T* g, T* u) {
+  T tmp[kWinogradInTile * 3];
+  for (int j = 0; j < 3; ++j) {
+    WinogradFilter1D(g + j, 3, tmp + j, 3);
+  }
+  for (int i = 0; i < kWinogradInTile; ++i) {
+    WinogradFilter1D(tmp + i * 3, 1, u + i * kWinogradInTile, 1);
+  }
+}
+
+template <typename T>
+void WinogradInputTile(const T* d, T* v) {
+  T tmp[kWinogradPoints];
+  for (int j = 0; j < kWinogradInTile; ++j) {
+    WinogradInput1D(d + j, kWinogradInTile, tmp + j, kWinogradInTile);
+  }
+  for (int i = 0; i < kWinogradInTile; ++i) {
+    WinogradInput1D(
+        tmp + i * kWinogradInTile, 1, v + i * kWinogradInTile, 1);
+  }
+}
+
+template <typename T>
+void WinogradOutputTile(const T* m, T* y) {
+  T tmp[kWinogradOutTile * kWinogradInTile];
+  for (int j = 0; j < kWinogradInTile; ++j) {
+    WinogradOutput1D(m + j, kWinogradInTile, tmp + j, kWinogradInTile);
+  }
+  for (int i = 0; i < kWinogradOutTile; ++i) {
+    WinogradOutput1D(
+        tmp + i * kWinogradInTile, 1, y + i * kWinogradOutTile, 1);
+  }
+}
+
+// The outputs [*begin, *end) of a dimension read the input at
+// out * stride + offset, which is inside [0, in_size).
+inline void ValidRange(
+    int in_size, int out_size, int stride, int offset, int* begin, int* end) {
+  *begin = offset >= 0 ? 0 : (-offset + stride - 1) / stride;
+  *end = in_size - 1 - offset < 0 ? 0 : (in_size - 1 - offset) / stride + 1;
+  *begin = std::min(*begin, out_size);
+  *end = std::max(std::min(*end, out_size), *begin);
+}
+
+// Visit each pair of input and output rows of a depthwise plane with the
+// filter element of (kh, kw), fn(in_row, out_row, weight, begin, end) works
+// on the output columns [begin, end) which read in_row[ow * stride_w].
+template <typename T, typename Fn>
+void ForEachDepthwiseRow(const Conv2DShape& shape,
+                         const T* filter,
+                         Fn fn) {
+  for (int kh = 0; kh < shape.k_h; ++kh) {
+    const int h_offset = kh * shape.dilation_h - shape.pad_top;
+    int oh_begin, oh_end;
+    ValidRange(shape.in_h,
+               shape.out_h,
+               shape.stride_h,
+               h_offset,
+               &oh_begin,
+               &oh_end);
+    for (int kw = 0; kw < shape.k_w; ++kw) {
+      const int w_offset = kw * shape.dilation_w - shape.pad_left;
+      int ow_begin, ow_end;
+      ValidRange(shape.in_w,
+                 shape.out_w,
+                 shape.stride_w,
+                 w_offset,
+                 &ow_begin,
+                 &ow_end);
+      const int k = kh * shape.k_w + kw;
+      for (int oh = oh_begin; oh < oh_end; ++oh) {
+        const int64_t in_row =
+            static_cast<int64_t>(oh * shape.stride_h + h_offset) * shape.in_w +
+            w_offset;
+        const int64_t out_row = static_cast<int64_t>(oh) * shape.out_w;
+        fn(in_row, out_row, k, filter[k], ow_begin, ow_end);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+Conv2DShape MakeConv2DShape(const DDim& input_dims,
+                            const DDim& filter_dims,
+                            const DDim& output_dims,
+                            const std::vector<int>& strides,
+                            const std::vector<int>& paddings,
+                            const std::vector<int>& dilations,
+                            int groups) {
+  Conv2DShape shape;
+  shape.batch = static_cast<int>(input_dims[0]);
+  shape.in_c = static_cast<int>(input_dims[1]);
+  shape.in_h = static_cast<int>(input_dims[2]);
+  shape.in_w = static_cast<int>(input_dims[3]);
+  shape.out_c = static_cast<int>(output_dims[1]);
+  shape.out_h = static_cast<int>(output_dims[2]);
+  shape.out_w = static_cast<int>(output_dims[3]);
+  shape.k_h = static_cast<int>(filter_dims[2]);
+  shape.k_w = static_cast<int>(filter_dims[3]);
+  shape.stride_h = strides[0];
+  shape.stride_w = strides[1];
+  shape.pad_top = paddings[0];
+  shape.pad_left = paddings[2];
+  shape.dilation_h = dilations[0];
+  shape.dilation_w = dilations[1];
+  shape.groups = groups;
+  return shape;
+}
+
+ConvCPUAlgo SelectConvCPUAlgo(const Conv2DShape& shape) {
+  // im2col + gemm of a depthwise conv runs a gemm of a single row for each
+  // channel, the direct loops are much faster.
+  if (shape.groups > 1 && shape.groups == shape.in_c &&
+      shape.out_c == shape.in_c) {
+    return ConvCPUAlgo::kDepthwise;
+  }
+  if (shape.groups != 1) {
+    return ConvCPUAlgo::kIm2ColGemm;
+  }
+  const bool stride_1 = shape.stride_h == 1 && shape.stride_w == 1;
+  const bool dilation_1 = shape.dilation_h == 1 && shape.dilation_w == 1;
+  // Winograd does 2.25x less multiplications, the transforms only pay off
+  // with enough channels to share them.
+  if (shape.k_h == 3 && shape.k_w == 3 && stride_1 && dilation_1 &&
+      shape.in_c >= 8 && shape.out_c >= 8 &&
+      shape.out_h >= kWinogradOutTile && shape.out_w >= kWinogradOutTile) {
+    return ConvCPUAlgo::kWinograd;
+  }
+  // 1x1 without stride and padding is a gemm on the input directly
+  if (shape.k_h == 1 && shape.k_w == 1 &&
+      (!stride_1 || shape.pad_top != 0 || shape.pad_left != 0 ||
+       shape.out_h != shape.in_h || shape.out_w != shape.in_w)) {
+    return ConvCPUAlgo::kDirect1x1;
+  }
+  return ConvCPUAlgo::kIm2ColGemm;
+}
+
+template <typename T>
+void WinogradConv2D(const CPUContext& dev_ctx,
+                    const Conv2DShape& shape,
+                    const T* input,
+                    const T* filter,
+                    T* output) {
+  const int ic = shape.in_c;
+  const int oc = shape.out_c;
+  const int tiles_h = (shape.out_h + kWinogradOutTile - 1) / kWinogradOutTile;
+  const int tiles_w = (shape.out_w + kWinogradOutTile - 1) / kWinogradOutTile;
+  const int64_t tiles = static_cast<int64_t>(tiles_h) * tiles_w;
+  const int64_t in_plane = static_cast<int64_t>(shape.in_h) * shape.in_w;
+  const int64_t out_plane = static_cast<int64_t>(shape.out_h) * shape.out_w;
+
+  // transformed filter, {36, oc, ic}
+  std::vector<T> u(static_cast<size_t>(kWinogradPoints) * oc * ic);
+  dev_ctx.ParallelFor(
+      oc, 64.0 * kWinogradPoints * ic, [&](int64_t begin, int64_t end) {
+        T tile[kWinogradPoints];
+        for (int64_t o = begin; o < end; ++o) {
+          for (int i = 0; i < ic; ++i) {
+            WinogradFilterTile(filter + (o * ic + i) * 9, tile);
+            for (int p = 0; p < kWinogradPoints; ++p) {
+              u[(p * oc + o) * ic + i] = tile[p];
+            }
+          }
+        }
+      });
+
+  auto blas = GetBlas<CPUContext, T>(dev_ctx);
+  const int64_t blocks_per_image =
+      (tiles + kWinogradTileBlock - 1) / kWinogradTileBlock;
+  const double cost_per_block =
+      2.0 * kWinogradPoints * ic * (oc + kWinogradInTile) * kWinogradTileBlock;
+  dev_ctx.ParallelFor(
+      shape.batch * blocks_per_image,
+      cost_per_block,
+      [&](int64_t begin, int64_t end) {
+        // transformed input {36, ic, nt} and products {36, oc, nt}
+        std::vector<T> v(static_cast<size_t>(kWinogradPoints) * ic *
+                         kWinogradTileBlock);
+        std::vector<T> m(static_cast<size_t>(kWinogradPoints) * oc *
+                         kWinogradTileBlock);
+        T d[kWinogradPoints];
+        T tile[kWinogradPoints];
+        for (int64_t job = begin; job < end; ++job) {
+          const int64_t n = job / blocks_per_image;
+          const int64_t tile_begin =
+              (job % blocks_per_image) * kWinogradTileBlock;
+          const int nt = static_cast<int>(
+              std::min<int64_t>(kWinogradTileBlock, tiles - tile_begin));
+          const T* in = input + n * ic * in_plane;
+          T* out = output + n * oc * out_plane;
+
+          for (int c = 0; c < ic; ++c) {
+            const T* plane = in + c * in_plane;
+            for (int t = 0; t < nt; ++t) {
+              const int th = static_cast<int>((tile_begin + t) / tiles_w);
+              const int tw = static_cast<int>((tile_begin + t) % tiles_w);
+              const int h0 = th * kWinogradOutTile - shape.pad_top;
+              const int w0 = tw * kWinogradOutTile - shape.pad_left;
+              for (int i = 0; i < kWinogradInTile; ++i) {
+                const int h = h0 + i;
+                for (int j = 0; j < kWinogradInTile; ++j) {
+                  const int w = w0 + j;
+                  d[i * kWinogradInTile + j] =
+                      (h >= 0 && h < shape.in_h && w >= 0 && w < shape.in_w)
+                          ? plane[h * shape.in_w + w]
+                          : T(0);
+                }
+              }
+              WinogradInputTile(d, tile);
+              for (int p = 0; p < kWinogradPoints; ++p) {
+                v[(p * ic + c) * nt + t] = tile[p];
+              }
+            }
+          }
+
+          for (int p = 0; p < kWinogradPoints; ++p) {
+            blas.GEMM(false,
+                      false,
+                      oc,
+                      nt,
+                      ic,
+                      T(1),
+                      u.data() + p * oc * ic,
+                      ic,
+                      v.data() + p * ic * nt,
+                      nt,
+                      T(0),
+                      m.data() + p * oc * nt,
+                      nt);
+          }
+
+          T y[kWinogradOutTile * kWinogradOutTile];
+          for (int o = 0; o < oc; ++o) {
+            T* plane = out + o * out_plane;
+            for (int t = 0; t < nt; ++t) {
+              for (int p = 0; p < kWinogradPoints; ++p) {
+                tile[p] = m[(p * oc + o) * nt + t];
+              }
+              WinogradOutputTile(tile, y);
+              const int th = static_cast<int>((tile_begin + t) / tiles_w);
+              const int tw = static_cast<int>((tile_begin + t) % tiles_w);
+              const int h0 = th * kWinogradOutTile;
+              const int w0 = tw * kWinogradOutTile;
+              const int rows = std::min(kWinogradOutTile, shape.out_h - h0);
+              const int cols = std::min(kWinogradOutTile, shape.out_w - w0);
+              for (int i = 0; i < rows; ++i) {
+                for (int j = 0; j < cols; ++j) {
+                  plane[(h0 + i) * shape.out_w + w0 + j] =
+                      y[i * kWinogradOutTile + j];
+                }
+              }
+            }
+          }
+        }
+      });
+}
+
+template <typename T>
+void WinogradConv2DGradInput(const CPUContext& dev_ctx,
+                             const Conv2DShape& shape,
+                             const T* output_grad,
+                             const T* filter,
+                             T* input_grad) {
+  Conv2DShape grad_shape = shape;
+  grad_shape.in_c = shape.out_c;
+  grad_shape.in_h = shape.out_h;
+  grad_shape.in_w = shape.out_w;
+  grad_shape.out_c = shape.in_c;
+  grad_shape.out_h = shape.in_h;
+  grad_shape.out_w = shape.in_w;
+  grad_shape.pad_top = shape.k_h - 1 - shape.pad_top;
+  grad_shape.pad_left = shape.k_w - 1 - shape.pad_left;
+
+  // {oc, ic, kh, kw} -> {ic, oc, kh, kw} rotated by 180 degrees
+  const int k = shape.k_h * shape.k_w;
+  std::vector<T> rotated(static_cast<size_t>(shape.out_c) * shape.in_c * k);
+  for (int o = 0; o < shape.out_c; ++o) {
+    for (int i = 0; i < shape.in_c; ++i) {
+      const T* src = filter + (o * shape.in_c + i) * k;
+      T* dst = rotated.data() + (i * shape.out_c + o) * k;
+      for (int j = 0; j < k; ++j) {
+        dst[j] = src[k - 1 - j];
+      }
+    }
+  }
+  WinogradConv2D<T>(
+      dev_ctx, grad_shape, output_grad, rotated.data(), input_grad);
+}
+
+template <typename T>
+void DirectConv2D1x1(const CPUContext& dev_ctx,
+                     const Conv2DShape& shape,
+                     const T* input,
+                     const T* filter,
+                     T* output) {
+  const int ic = shape.in_c;
+  const int oc = shape.out_c;
+  const int64_t in_plane = static_cast<int64_t>(shape.in_h) * shape.in_w;
+  const int64_t out_plane = static_cast<int64_t>(shape.out_h) * shape.out_w;
+  const int rows_per_block = std::max(1, kDirect1x1PackPixels / shape.out_w);
+  const int64_t blocks_per_image =
+      (shape.out_h + rows_per_block - 1) / rows_per_block;
+
+  auto blas = GetBlas<CPUContext, T>(dev_ctx);
+  dev_ctx.ParallelFor(
+      shape.batch * blocks_per_image,
+      2.0 * oc * ic * rows_per_block * shape.out_w,
+      [&](int64_t begin, int64_t end) {
+        // the strided or padded input of the rows, {ic, rows * out_w}
+        std::vector<T> packed(static_cast<size_t>(ic) * rows_per_block *
+                              shape.out_w);
+        for (int64_t job = begin; job < end; ++job) {
+          const int64_t n = job / blocks_per_image;
+          const int row_begin =
+              static_cast<int>(job % blocks_per_image) * rows_per_block;
+          const int rows = std::min(rows_per_block, shape.out_h - row_begin);
+          const int cols = rows * shape.out_w;
+          for (int c = 0; c < ic; ++c) {
+            const T* plane = input + (n * ic + c) * in_plane;
+            for (int r = 0; r < rows; ++r) {
+              T* dst = packed.data() + c * cols + r * shape.out_w;
+              const int h = (row_begin + r) * shape.stride_h - shape.pad_top;
+              if (h < 0 || h >= shape.in_h) {
+                std::fill(dst, dst + shape.out_w, T(0));
+                continue;
+              }
+              const T* src = plane + h * shape.in_w;
+              for (int ow = 0; ow < shape.out_w; ++ow) {
+                const int w = ow * shape.stride_w - shape.pad_left;
+                dst[ow] = (w >= 0 && w < shape.in_w) ? src[w] : T(0);
+              }
+            }
+          }
+          blas.GEMM(false,
+                    false,
+                    oc,
+                    cols,
+                    ic,
+                    T(1),
+                    filter,
+                    ic,
+                    packed.data(),
+                    cols,
+                    T(0),
+                    output + n * oc * out_plane + row_begin * shape.out_w,
+                    static_cast<int>(out_plane));
+        }
+      });
+}
+
+template <typename T>
+void DepthwiseConv2D(const CPUContext& dev_ctx,
+                     const Conv2DShape& shape,
+                     const T* input,
+                     const T* filter,
+                     T* output) {
+  const int64_t in_plane = static_cast<int64_t>(shape.in_h) * shape.in_w;
+  const int64_t out_plane = static_cast<int64_t>(shape.out_h) * shape.out_w;
+  const int k = shape.k_h * shape.k_w;
+  const int stride_w = shape.stride_w;
+  dev_ctx.ParallelFor(
+      static_cast<int64_t>(shape.batch) * shape.in_c,
+      2.0 * out_plane * k,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t nc = begin; nc < end; ++nc) {
+          const T* in = input + nc * in_plane;
+          T* out = output + nc * out_plane;
+          std::fill(out, out + out_plane, T(0));
+          ForEachDepthwiseRow(
+              shape,
+              filter + (nc % shape.in_c) * k,
+              [&](int64_t in_row, int64_t out_row, int, T w, int b, int e) {
+                const T* src = in + in_row;
+                T* dst = out + out_row;
+                for (int ow = b; ow < e; ++ow) {
+                  dst[ow] += w * src[ow * stride_w];
+                }
+              });
+        }
+      });
+}
+
+template <typename T>
+void DepthwiseConv2DGradInput(const CPUContext& dev_ctx,
+                              const Conv2DShape& shape,
+                              const T* output_grad,
+                              const T* filter,
+                              T* input_grad) {
+  const int64_t in_plane = static_cast<int64_t>(shape.in_h) * shape.in_w;
+  const int64_t out_plane = static_cast<int64_t>(shape.out_h) * shape.out_w;
+  const int k = shape.k_h * shape.k_w;
+  const int stride_w = shape.stride_w;
+  dev_ctx.ParallelFor(
+      static_cast<int64_t>(shape.batch) * shape.in_c,
+      2.0 * out_plane * k,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t nc = begin; nc < end; ++nc) {
+          const T* out_grad = output_grad + nc * out_plane;
+          T* in_grad = input_grad + nc * in_plane;
+          std::fill(in_grad, in_grad + in_plane, T(0));
+          ForEachDepthwiseRow(
+              shape,
+              filter + (nc % shape.in_c) * k,
+              [&](int64_t in_row, int64_t out_row, int, T w, int b, int e) {
+                const T* src = out_grad + out_row;
+                T* dst = in_grad + in_row;
+                for (int ow = b; ow < e; ++ow) {
+                  dst[ow * stride_w] += w * src[ow];
+                }
+              });
+        }
+      });
+}
+
+template <typename T>
+void DepthwiseConv2DGradFilter(const CPUContext& dev_ctx,
+                               const Conv2DShape& shape,
+                               const T* input,
+                               const T* output_grad,
+                               T* filter_grad) {
+  const int64_t in_plane = static_cast<int64_t>(shape.in_h) * shape.in_w;
+  const int64_t out_plane = static_cast<int64_t>(shape.out_h) * shape.out_w;
+  const int k = shape.k_h * shape.k_w;
+  const int stride_w = shape.stride_w;
+  // each channel owns its filter, so the channels are split among threads
+  dev_ctx.ParallelFor(
+      shape.in_c,
+      2.0 * shape.batch * out_plane * k,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t c = begin; c < end; ++c) {
+          T* grad = filter_grad + c * k;
+          std::fill(grad, grad + k, T(0));
+          for (int n = 0; n < shape.batch; ++n) {
+            const int64_t nc = static_cast<int64_t>(n) * shape.in_c + c;
+            const T* in = input + nc * in_plane;
+            const T* out_grad = output_grad + nc * out_plane;
+            ForEachDepthwiseRow(
+                shape,
+                grad,
+                [&](int64_t in_row, int64_t out_row, int j, T, int b, int e) {
+                  const T* src = in + in_row;
+                  const T* dy = out_grad + out_row;
+                  T sum = 0;
+                  for (int ow = b; ow < e; ++ow) {
+                    sum += dy[ow] * src[ow * stride_w];
+                  }
+                  grad[j] += sum;
+                });
+          }
+        }
+      });
+}
+
+template <typename T>
+bool ConvFastFunctor<CPUContext, T>::Forward(
+    const CPUContext& dev_ctx,
+    const DenseTensor& input,
+    const DenseTensor& filter,
+    const std::vector<int>& strides,
+    const std::vector<int>& paddings,
+    const std::vector<int>& dilations,
+    int groups,
+    DenseTensor* output,
+    const std::function<void()>& im2col_gemm) const {
+  if (!FLAGS_conv_cpu_fast_algo || input.dims().size() != 4) {
+    return false;
+  }
+  const Conv2DShape shape = MakeConv2DShape(input.dims(),
+                                            filter.dims(),
+                                            output->dims(),
+                                            strides,
+                                            paddings,
+                                            dilations,
+                                            groups);
+  const ConvCPUAlgo algo = SelectConvCPUAlgo(shape);
+  if (algo == ConvCPUAlgo::kIm2ColGemm) {
+    return false;
+  }
+  const T* input_data = input.data<T>();
+  const T* filter_data = filter.data<T>();
+  T* output_data = dev_ctx.template Alloc<T>(output);
+  auto run_fast = [&]() {
+    switch (algo) {
+      case ConvCPUAlgo::kWinograd:
+        WinogradConv2D<T>(dev_ctx, shape, input_data, filter_data, output_data);
+        break;
+      case ConvCPUAlgo::kDirect1x1:
+        DirectConv2D1x1<T>(
+            dev_ctx, shape, input_data, filter_data, output_data);
+        break;
+      default:
+        DepthwiseConv2D<T>(
+            dev_ctx, shape, input_data, filter_data, output_data);
+    }
+  };
+  if (!im2col_gemm) {
+    run_fast();
+    return true;
+  }
+
+  // the selected algorithm is the default, im2col + gemm is tried as well
+  autotune::CpuAutoTuner tuner(autotune::AlgorithmType::kConvForwardCPU);
+  tuner.AddCallBack(static_cast<int64_t>(algo), run_fast);
+  tuner.AddCallBack(static_cast<int64_t>(ConvCPUAlgo::kIm2ColGemm),
+                    im2col_gemm);
+  tuner.Run(autotune::ConvKey(vectorize(input.dims()),
+                              vectorize(filter.dims()),
+                              strides,
+                              paddings,
+                              dilations,
+                              input.dtype()));
+  return true;
+}
+
+template <typename T>
+bool ConvFastFunctor<CPUContext, T>::GradInput(
+    const CPUContext& dev_ctx,
+    const DenseTensor& filter,
+    const DenseTensor& output_grad,
+    const std::vector<int>& strides,
+    const std::vector<int>& paddings,
+    const std::vector<int>& dilations,
+    int groups,
+    DenseTensor* input_grad) const {
+  if (!FLAGS_conv_cpu_fast_algo || input_grad->dims().size() != 4) {
+    return false;
+  }
+  const Conv2DShape shape = MakeConv2DShape(input_grad->dims(),
+                                            filter.dims(),
+                                            output_grad.dims(),
+                                            strides,
+                                            paddings,
+                                            dilations,
+                                            groups);
+  const T* filter_data = filter.data<T>();
+  const T* output_grad_data = output_grad.data<T>();
+  T* input_grad_data = dev_ctx.template Alloc<T>(input_grad);
+  switch (SelectConvCPUAlgo(shape)) {
+    case ConvCPUAlgo::kWinograd:
+      WinogradConv2DGradInput<T>(
+          dev_ctx, shape, output_grad_data, filter_data, input_grad_data);
+      return true;
+    case ConvCPUAlgo::kDepthwise:
+      DepthwiseConv2DGradInput<T>(
+          dev_ctx, shape, output_grad_data, filter_data, input_grad_data);
+      return true;
+    default:
+      return false;
+  }
+}
+
+template <typename T>
+bool ConvFastFunctor<CPUContext, T>::GradFilter(
+    const CPUContext& dev_ctx,
+    const DenseTensor& input,
+    const DenseTensor& output_grad,
+    const std::vector<int>& strides,
+    const std::vector<int>& paddings,
+    const std::vector<int>& dilations,
+    int groups,
+    DenseTensor* filter_grad) const {
+  if (!FLAGS_conv_cpu_fast_algo || input.dims().size() != 4) {
+    return false;
+  }
+  const Conv2DShape shape = MakeConv2DShape(input.dims(),
+                                            filter_grad->dims(),
+                                            output_grad.dims(),
+                                            strides,
+                                            paddings,
+                                            dilations,
+                                            groups);
+  // the filter gradient of the other algorithms is im2col + gemm
+  if (SelectConvCPUAlgo(shape) != ConvCPUAlgo::kDepthwise) {
+    return false;
+  }
+  DepthwiseConv2DGradFilter<T>(dev_ctx,
+                               shape,
+                               input.data<T>(),
+                               output_grad.data<T>(),
+                               dev_ctx.template Alloc<T>(filter_grad));
+  return true;
+}
+
+#define INSTANTIATE_CONV_CPU_ENGINE(T)                                       \
+  template void WinogradConv2D<T>(                                           \
+      const CPUContext&, const Conv2DShape&, const T*, const T*, T*);        \
+  template void WinogradConv2DGradInput<T>(                                  \
+      const CPUContext&, const Conv2DShape&, const T*, const T*, T*);        \
+  template void DirectConv2D1x1<T>(                                          \
+      const CPUContext&, const Conv2DShape&, const T*, const T*, T*);        \
+  template void DepthwiseConv2D<T>(                                          \
+      const CPUContext&, const Conv2DShape&, const T*, const T*, T*);        \
+  template void DepthwiseConv2DGradInput<T>(                                 \
+      const CPUContext&, const Conv2DShape&, const T*, const T*, T*);        \
+  template void DepthwiseConv2DGradFilter<T>(                                \
+      const CPUContext&, const Conv2DShape&, const T*, const T*, T*);        \
+  template class ConvFastFunctor<CPUContext, T>
+
+INSTANTIATE_CONV_CPU_ENGINE(float);
+INSTANTIATE_CONV_CPU_ENGINE(double);
+
+#undef INSTANTIATE_CONV_CPU_ENGINE
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,190 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace phi {
+namespace funcs {
+
+// Algorithms of the 2-D CPU convolution without oneDNN, all of them work on
+// the NCHW layout.
+enum class ConvCPUAlgo {
+  kIm2ColGemm = 0,  // im2col + gemm of each group, the general one
+  kWinograd = 1,    // F(4x4, 3x3) for the 3x3 stride 1 convolution
+  kDirect1x1 = 2,   // 1x1 with stride or padding, packed by row blocks
+  kDepthwise = 3,   // one filter per channel, computed plane by plane
+};
+
+struct Conv2DShape {
+  int batch;
+  int in_c;
+  int in_h;
+  int in_w;
+  int out_c;
+  int out_h;
+  int out_w;
+  int k_h;
+  int k_w;
+  int stride_h;
+  int stride_w;
+  int pad_top;
+  int pad_left;
+  int dilation_h;
+  int dilation_w;
+  int groups;
+};
+
+// paddings is {top, bottom, left, right} as updated by
+// UpdatePaddingAndDilation.
+Conv2DShape MakeConv2DShape(const DDim& input_dims,
+                            const DDim& filter_dims,
+                            const DDim& output_dims,
+                            const std::vector<int>& strides,
+                            const std::vector<int>& paddings,
+                            const std::vector<int>& dilations,
+                            int groups);
+
+ConvCPUAlgo SelectConvCPUAlgo(const Conv2DShape& shape);
+
+// The computations of each algorithm on raw NCHW buffers, filter is
+// {out_c, in_c / groups, k_h, k_w}. The output is overwritten.
+template <typename T>
+void WinogradConv2D(const CPUContext& dev_ctx,
+                    const Conv2DShape& shape,
+                    const T* input,
+                    const T* filter,
+                    T* output);
+
+template <typename T>
+void DirectConv2D1x1(const CPUContext& dev_ctx,
+                     const Conv2DShape& shape,
+                     const T* input,
+                     const T* filter,
+                     T* output);
+
+template <typename T>
+void DepthwiseConv2D(const CPUContext& dev_ctx,
+                     const Conv2DShape& shape,
+                     const T* input,
+                     const T* filter,
+                     T* output);
+
+template <typename T>
+void DepthwiseConv2DGradInput(const CPUContext& dev_ctx,
+                              const Conv2DShape& shape,
+                              const T* output_grad,
+                              const T* filter,
+                              T* input_grad);
+
+template <typename T>
+void DepthwiseConv2DGradFilter(const CPUContext& dev_ctx,
+                               const Conv2DShape& shape,
+                               const T* input,
+                               const T* output_grad,
+                               T* filter_grad);
+
+// The gradient of the input of a 3x3 stride 1 convolution is the
+// convolution of output_grad with the rotated and transposed filter, which
+// is computed by WinogradConv2D.
+template <typename T>
+void WinogradConv2DGradInput(const CPUContext& dev_ctx,
+                             const Conv2DShape& shape,
+                             const T* output_grad,
+                             const T* filter,
+                             T* input_grad);
+
+// The entries of the conv kernels, each runs the selected algorithm and
+// returns true, or returns false to fall back to im2col + gemm. The tensors
+// are channel first. Only CPUContext has the fast algorithms. Forward gets
+// the im2col + gemm of the kernel as im2col_gemm, so that autotune can time
+// it against the selected algorithm and run the faster one.
+template <typename Context, typename T>
+class ConvFastFunctor {
+ public:
+  bool Forward(const Context& dev_ctx,
+               const DenseTensor& input,
+               const DenseTensor& filter,
+               const std::vector<int>& strides,
+               const std::vector<int>& paddings,
+               const std::vector<int>& dilations,
+               int groups,
+               DenseTensor* output,
+               const std::function<void()>& im2col_gemm) const {
+    return false;
+  }
+
+  bool GradInput(const Context& dev_ctx,
+                 const DenseTensor& filter,
+                 const DenseTensor& output_grad,
+                 const std::vector<int>& strides,
+                 const std::vector<int>& paddings,
+                 const std::vector<int>& dilations,
+                 int groups,
+                 DenseTensor* input_grad) const {
+    return false;
+  }
+
+  bool GradFilter(const Context& dev_ctx,
+                  const DenseTensor& input,
+                  const DenseTensor& output_grad,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations,
+                  int groups,
+                  DenseTensor* filter_grad) const {
+    return false;
+  }
+};
+
+template <typename T>
+class ConvFastFunctor<CPUContext, T> {
+ public:
+  bool Forward(const CPUContext& dev_ctx,
+               const DenseTensor& input,
+               const DenseTensor& filter,
+               const std::vector<int>& strides,
+               const std::vector<int>& paddings,
+               const std::vector<int>& dilations,
+               int groups,
+               DenseTensor* output,
+               const std::function<void()>& im2col_gemm) const;
+
+  bool GradInput(const CPUContext& dev_ctx,
+                 const DenseTensor& filter,
+                 const DenseTensor& output_grad,
+                 const std::vector<int>& strides,
+                 const std::vector<int>& paddings,
+                 const std::vector<int>& dilations,
+                 int groups,
+                 DenseTensor* input_grad) const;
+
+  // the filter gradient of depthwise only
+  bool GradFilter(const CPUContext& dev_ctx,
+                  const DenseTensor& input,
+                  const DenseTensor& output_grad,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations,
+                  int groups,
+                  DenseTensor* filter_grad) const;
+};
+
+}  // namespace funcs
+}  // namespace phi
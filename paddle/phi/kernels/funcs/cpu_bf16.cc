@@ -0,0 +1,490 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/phi/kernels/funcs/cpu_bf16.h"
+
+#include <cstring>
+#include <vector>
+
+#include "paddle/fluid/platform/cpu_info.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+
+// The SIMD code is compiled with the target attribute and picked at runtime,
+// so it does not depend on the SIMD flags of the build.
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define PADDLE_BF16_AVX2
+#define PADDLE_BF16_AVX512
+#if (defined(__clang__) && __clang_major__ >= 9) || \
+    (!defined(__clang__) && __GNUC__ >= 10)
+#define PADDLE_BF16_AVX512_BF16
+#endif
+#endif
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+using ConvertToFloat = void (*)(const uint16_t* x, float* y, int64_t n);
+using ConvertToBF16 = void (*)(const float* x, uint16_t* y, int64_t n);
+
+inline float BitsToFloat(uint16_t x) {
+  const uint32_t u = static_cast<uint32_t>(x) << 16;
+  float v;
+  std::memcpy(&v, &u, sizeof(v));
+  return v;
+}
+
+inline uint16_t FloatToBits(float v) {
+  uint32_t u;
+  std::memcpy(&u, &v, sizeof(u));
+  if ((u & 0x7fffffffu) > 0x7f800000u) {
+    // keeps the sign and makes a quiet NaN
+    return static_cast<uint16_t>((u >> 16) | 0x40u);
+  }
+  u += 0x7fffu + ((u >> 16) & 1u);
+  return static_cast<uint16_t>(u >> 16);
+}
+
+void ToFloatRef(const uint16_t* x, float* y, int64_t n) {
+  for (int64_t i = 0; i < n; ++i) {
+    y[i] = BitsToFloat(x[i]);
+  }
+}
+
+void ToBF16Ref(const float* x, uint16_t* y, int64_t n) {
+  for (int64_t i = 0; i < n; ++i) {
+    y[i] = FloatToBits(x[i]);
+  }
+}
+
+#ifdef PADDLE_BF16_AVX2
+__attribute__((target("avx2"))) void ToFloatAVX2(const uint16_t* x,
+                                                 float* y,
+                                                 int64_t n) {
+  int64_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i u = _mm256_slli_epi32(
+        _mm256_cvtepu16_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i))),
+        16);
+    _mm256_storeu_ps(y + i, _mm256_castsi256_ps(u));
+  }
+  ToFloatRef(x + i, y + i, n - i);
+}
+
+__attribute__((target("avx2"))) void ToBF16AVX2(const float* x,
+                                                uint16_t* y,
+                                                int64_t n) {
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i bias = _mm256_set1_epi32(0x7fff);
+  const __m256i quiet = _mm256_set1_epi32(0x40);
+  int64_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256 v = _mm256_loadu_ps(x + i);
+    const __m256i u = _mm256_castps_si256(v);
+    const __m256i high = _mm256_srli_epi32(u, 16);
+    __m256i r = _mm256_add_epi32(u, bias);
+    r = _mm256_srli_epi32(_mm256_add_epi32(r, _mm256_and_si256(high, one)),
+                          16);
+    const __m256i nan = _mm256_castps_si256(_mm256_cmp_ps(v, v, _CMP_UNORD_Q));
+    r = _mm256_blendv_epi8(r, _mm256_or_si256(high, quiet), nan);
+    // packs the two 128-bit lanes separately, {0, 2} holds the 8 results
+    const __m256i packed =
+        _mm256_permute4x64_epi64(_mm256_packus_epi32(r, r), 0xD8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(y + i),
+                     _mm256_castsi256_si128(packed));
+  }
+  ToBF16Ref(x + i, y + i, n - i);
+}
+#endif
+
+#ifdef PADDLE_BF16_AVX512
+__attribute__((target("avx512f"))) void ToFloatAVX512(const uint16_t* x,
+                                                      float* y,
+                                                      int64_t n) {
+  int64_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m512i u = _mm512_slli_epi32(
+        _mm512_cvtepu16_epi32(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i))),
+        16);
+    _mm512_storeu_ps(y + i, _mm512_castsi512_ps(u));
+  }
+  ToFloatRef(x + i, y + i, n - i);
+}
+
+__attribute__((target("avx512f"))) void ToBF16AVX512(const float* x,
+                                                     uint16_t* y,
+                                                     int64_t n) {
+  const __m512i one = _mm512_set1_epi32(1);
+  const __m512i bias = _mm512_set1_epi32(0x7fff);
+  const __m512i quiet = _mm512_set1_epi32(0x40);
+  int64_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m512 v = _mm512_loadu_ps(x + i);
+    const __m512i u = _mm512_castps_si512(v);
+    const __m512i high = _mm512_srli_epi32(u, 16);
+    __m512i r = _mm512_add_epi32(u, bias);
+    r = _mm512_srli_epi32(_mm512_add_epi32(r, _mm512_and_si512(high, one)),
+                          16);
+    const __mmask16 nan = _mm512_cmp_ps_mask(v, v, _CMP_UNORD_Q);
+    r = _mm512_mask_blend_epi32(nan, r, _mm512_or_si512(high, quiet));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(y + i),
+                        _mm512_cvtepi32_epi16(r));
+  }
+  ToBF16Ref(x + i, y + i, n - i);
+}
+#endif
+
+struct ConvertInfo {
+  ConvertToFloat to_float;
+  ConvertToBF16 to_bf16;
+};
+
+const ConvertInfo& GetConvert() {
+  static const ConvertInfo info = []() -> ConvertInfo {
+#ifdef PADDLE_BF16_AVX512
+    if (paddle::platform::MayIUse(paddle::platform::avx512f)) {
+      return {ToFloatAVX512, ToBF16AVX512};
+    }
+#endif
+#ifdef PADDLE_BF16_AVX2
+    if (paddle::platform::MayIUse(paddle::platform::avx2)) {
+      return {ToFloatAVX2, ToBF16AVX2};
+    }
+#endif
+    return {ToFloatRef, ToBF16Ref};
+  }();
+  return info;
+}
+
+// The packed B of the AVX512-BF16 gemm: panels of 16 columns,
+// [N / 16][K / 2][16][2], one 64-byte line holds 2 k of 16 columns, which is
+// what one vdpbf16ps consumes. The padding is filled with zeros.
+constexpr int kCols = 16;
+// rows of A computed by one call of the microkernel
+constexpr int kMicroRows = 8;
+// rows of A computed by one task of ParallelFor
+constexpr int kTaskRows = 64;
+
+#ifdef PADDLE_BF16_AVX512_BF16
+// acc is {kRows, kCols}, the rows of a hold k_pairs pairs of bfloat16.
+template <int kRows>
+__attribute__((target("avx512f,avx512bf16"))) void MicroKernelBF16Impl(
+    const uint16_t* a, int lda, const uint16_t* b, int k_pairs, float* acc) {
+  __m512 c[kRows];
+  for (int r = 0; r < kRows; ++r) {
+    c[r] = _mm512_setzero_ps();
+  }
+  for (int g = 0; g < k_pairs; ++g) {
+    const __m512i w = _mm512_loadu_si512(b + g * kCols * 2);
+    for (int r = 0; r < kRows; ++r) {
+      int32_t v;
+      std::memcpy(&v, a + r * lda + g * 2, sizeof(v));
+      c[r] = _mm512_dpbf16_ps(
+          c[r], (__m512bh)_mm512_set1_epi32(v), (__m512bh)w);  // NOLINT
+    }
+  }
+  for (int r = 0; r < kRows; ++r) {
+    _mm512_storeu_ps(acc + r * kCols, c[r]);
+  }
+}
+
+void MicroKernelBF16(const uint16_t* a,
+                     int lda,
+                     int rows,
+                     const uint16_t* b,
+                     int k_pairs,
+                     float* acc) {
+  switch (rows) {
+    case 8:
+      return MicroKernelBF16Impl<8>(a, lda, b, k_pairs, acc);
+    case 7:
+      return MicroKernelBF16Impl<7>(a, lda, b, k_pairs, acc);
+    case 6:
+      return MicroKernelBF16Impl<6>(a, lda, b, k_pairs, acc);
+    case 5:
+      return MicroKernelBF16Impl<5>(a, lda, b, k_pairs, acc);
+    case 4:
+      return MicroKernelBF16Impl<4>(a, lda, b, k_pairs, acc);
+    case 3:
+      return MicroKernelBF16Impl<3>(a, lda, b, k_pairs, acc);
+    case 2:
+      return MicroKernelBF16Impl<2>(a, lda, b, k_pairs, acc);
+    default:
+      return MicroKernelBF16Impl<1>(a, lda, b, k_pairs, acc);
+  }
+}
+
+void GemmAVX512BF16(const CPUContext& dev_ctx,
+                    bool trans_a,
+                    bool trans_b,
+                    int m,
+                    int n,
+                    int k,
+                    float alpha,
+                    const uint16_t* a,
+                    int lda,
+                    const uint16_t* b,
+                    int ldb,
+                    float beta,
+                    uint16_t* c,
+                    int ldc) {
+  const int k_pairs = (k + 1) / 2;
+  const int panels = (n + kCols - 1) / kCols;
+  const int64_t panel_size = static_cast<int64_t>(k_pairs) * kCols * 2;
+
+  std::vector<uint16_t> packed_b(panels * panel_size, 0);
+  ParallelFor(dev_ctx,
+              panels,
+              static_cast<double>(panel_size),
+              [&](int64_t begin, int64_t end) {
+                for (int64_t p = begin; p < end; ++p) {
+                  uint16_t* dst = packed_b.data() + p * panel_size;
+                  const int col0 = static_cast<int>(p) * kCols;
+                  const int cols = std::min(kCols, n - col0);
+                  for (int kk = 0; kk < k; ++kk) {
+                    uint16_t* line = dst + (kk / 2) * kCols * 2 + kk % 2;
+                    for (int j = 0; j < cols; ++j) {
+                      const int64_t idx =
+                          trans_b ? static_cast<int64_t>(col0 + j) * ldb + kk
+                                  : static_cast<int64_t>(kk) * ldb + col0 + j;
+                      line[j * 2] = b[idx];
+                    }
+                  }
+                }
+              });
+
+  // The microkernel reads A in pairs of k, so a transposed A or an odd k is
+  // copied to rows of 2 * k_pairs with a zero padding.
+  std::vector<uint16_t> packed_a;
+  if (trans_a || k % 2 != 0) {
+    const int ld = k_pairs * 2;
+    packed_a.assign(static_cast<size_t>(m) * ld, 0);
+    ParallelFor(dev_ctx,
+                m,
+                static_cast<double>(k),
+                [&](int64_t begin, int64_t end) {
+                  for (int64_t i = begin; i < end; ++i) {
+                    for (int kk = 0; kk < k; ++kk) {
+                      packed_a[i * ld + kk] =
+                          trans_a ? a[static_cast<int64_t>(kk) * lda + i]
+                                  : a[i * lda + kk];
+                    }
+                  }
+                });
+    a = packed_a.data();
+    lda = ld;
+  }
+
+  const int row_tasks = (m + kTaskRows - 1) / kTaskRows;
+  // the tasks of a panel are next to each other, so the threads share it
+  ParallelFor(
+      dev_ctx,
+      static_cast<int64_t>(row_tasks) * panels,
+      static_cast<double>(kTaskRows) * kCols * k_pairs,
+      [&](int64_t begin, int64_t end) {
+        float acc[kMicroRows * kCols];
+        for (int64_t t = begin; t < end; ++t) {
+          const int p = static_cast<int>(t / row_tasks);
+          const int row0 = static_cast<int>(t % row_tasks) * kTaskRows;
+          const int row_end = std::min(m, row0 + kTaskRows);
+          const int col0 = p * kCols;
+          const int cols = std::min(kCols, n - col0);
+          for (int r = row0; r < row_end; r += kMicroRows) {
+            const int rows = std::min(kMicroRows, row_end - r);
+            MicroKernelBF16(a + static_cast<int64_t>(r) * lda,
+                            lda,
+                            rows,
+                            packed_b.data() + p * panel_size,
+                            k_pairs,
+                            acc);
+            for (int i = 0; i < rows; ++i) {
+              uint16_t* c_row = c + static_cast<int64_t>(r + i) * ldc + col0;
+              const float* acc_row = acc + i * kCols;
+              for (int j = 0; j < cols; ++j) {
+                float v = alpha * acc_row[j];
+                if (beta != 0.f) {
+                  v += beta * BitsToFloat(c_row[j]);
+                }
+                c_row[j] = FloatToBits(v);
+              }
+            }
+          }
+        }
+      });
+}
+#endif
+
+// Converts the {rows, cols} matrix x with the leading dimension ldx to the
+// contiguous y.
+void RowsToFloat(const CPUContext& dev_ctx,
+                 const uint16_t* x,
+                 int rows,
+                 int cols,
+                 int ldx,
+                 float* y) {
+  const ConvertToFloat convert = GetConvert().to_float;
+  ParallelFor(dev_ctx,
+              rows,
+              static_cast<double>(cols),
+              [&](int64_t begin, int64_t end) {
+                for (int64_t i = begin; i < end; ++i) {
+                  convert(x + i * ldx, y + i * cols, cols);
+                }
+              });
+}
+
+void GemmFP32(const CPUContext& dev_ctx,
+              bool trans_a,
+              bool trans_b,
+              int m,
+              int n,
+              int k,
+              float alpha,
+              const uint16_t* a,
+              int lda,
+              const uint16_t* b,
+              int ldb,
+              float beta,
+              uint16_t* c,
+              int ldc) {
+  const int a_rows = trans_a ? k : m;
+  const int a_cols = trans_a ? m : k;
+  const int b_rows = trans_b ? n : k;
+  const int b_cols = trans_b ? k : n;
+  std::vector<float> a_fp32(static_cast<size_t>(a_rows) * a_cols);
+  std::vector<float> b_fp32(static_cast<size_t>(b_rows) * b_cols);
+  std::vector<float> c_fp32(static_cast<size_t>(m) * n);
+  RowsToFloat(dev_ctx, a, a_rows, a_cols, lda, a_fp32.data());
+  RowsToFloat(dev_ctx, b, b_rows, b_cols, ldb, b_fp32.data());
+  if (beta != 0.f) {
+    RowsToFloat(dev_ctx, c, m, n, ldc, c_fp32.data());
+  }
+
+  auto blas = GetBlas<CPUContext, float>(dev_ctx);
+  blas.GEMM(trans_a,
+            trans_b,
+            m,
+            n,
+            k,
+            alpha,
+            a_fp32.data(),
+            a_cols,
+            b_fp32.data(),
+            b_cols,
+            beta,
+            c_fp32.data(),
+            n);
+
+  const ConvertToBF16 convert = GetConvert().to_bf16;
+  ParallelFor(dev_ctx,
+              m,
+              static_cast<double>(n),
+              [&](int64_t begin, int64_t end) {
+                for (int64_t i = begin; i < end; ++i) {
+                  convert(c_fp32.data() + i * n, c + i * ldc, n);
+                }
+              });
+}
+
+using Gemm = void (*)(const CPUContext& dev_ctx,
+                      bool trans_a,
+                      bool trans_b,
+                      int m,
+                      int n,
+                      int k,
+                      float alpha,
+                      const uint16_t* a,
+                      int lda,
+                      const uint16_t* b,
+                      int ldb,
+                      float beta,
+                      uint16_t* c,
+                      int ldc);
+
+struct GemmInfo {
+  Gemm gemm;
+  const char* name;
+};
+
+const GemmInfo& GetGemm() {
+  static const GemmInfo info = []() -> GemmInfo {
+#ifdef PADDLE_BF16_AVX512_BF16
+    if (paddle::platform::MayIUse(paddle::platform::avx512_bf16)) {
+      return {GemmAVX512BF16, "avx512_bf16"};
+    }
+#endif
+    return {GemmFP32, "fp32_blas"};
+  }();
+  return info;
+}
+
+inline const uint16_t* Bits(const dtype::bfloat16* x) {
+  return reinterpret_cast<const uint16_t*>(x);
+}
+
+inline uint16_t* Bits(dtype::bfloat16* x) {
+  return reinterpret_cast<uint16_t*>(x);
+}
+
+}  // namespace
+
+void BF16ToFloat(const dtype::bfloat16* x, float* y, int64_t n) {
+  GetConvert().to_float(Bits(x), y, n);
+}
+
+void FloatToBF16(const float* x, dtype::bfloat16* y, int64_t n) {
+  GetConvert().to_bf16(x, Bits(y), n);
+}
+
+void BF16Gemm(const CPUContext& dev_ctx,
+              bool trans_a,
+              bool trans_b,
+              int m,
+              int n,
+              int k,
+              float alpha,
+              const dtype::bfloat16* a,
+              int lda,
+              const dtype::bfloat16* b,
+              int ldb,
+              float beta,
+              dtype::bfloat16* c,
+              int ldc) {
+  if (m == 0 || n == 0) {
+    return;
+  }
+  GetGemm().gemm(dev_ctx,
+                 trans_a,
+                 trans_b,
+                 m,
+                 n,
+                 k,
+                 alpha,
+                 Bits(a),
+                 lda,
+                 Bits(b),
+                 ldb,
+                 beta,
+                 Bits(c),
+                 ldc);
+}
+
+const char* BF16GemmKernelName() { return GetGemm().name; }
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,118 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/kernels/funcs/parallel_for.h"
+
+namespace phi {
+namespace funcs {
+
+// The bfloat16 CPU kernels compute in float. BF16ToFloat widens exactly and
+// FloatToBF16 rounds to nearest even, as vcvtneps2bf16 and oneDNN do (the
+// constructor of dtype::bfloat16 truncates). Both are vectorized with AVX512
+// or AVX2 when the CPU has it.
+void BF16ToFloat(const dtype::bfloat16* x, float* y, int64_t n);
+
+void FloatToBF16(const float* x, dtype::bfloat16* y, int64_t n);
+
+// The elements converted at once by BF16UnaryCompute and BF16BinaryCompute,
+// the float copies of a chunk stay in L1.
+constexpr int64_t kBF16ChunkSize = 1024;
+
+// y = fn(x) of n elements. fn(const float* x, float* y, int64_t n) is called
+// by the intra-op threads on the chunks of x converted to float, and its
+// results are converted back to y. cost_per_unit is per element.
+template <typename Function>
+void BF16UnaryCompute(const CPUContext& dev_ctx,
+                      const dtype::bfloat16* x,
+                      dtype::bfloat16* y,
+                      int64_t n,
+                      double cost_per_unit,
+                      const Function& fn) {
+  const int64_t chunks = (n + kBF16ChunkSize - 1) / kBF16ChunkSize;
+  ParallelFor(dev_ctx,
+              chunks,
+              cost_per_unit * kBF16ChunkSize,
+              [&](int64_t begin, int64_t end) {
+                float x_fp32[kBF16ChunkSize];
+                float y_fp32[kBF16ChunkSize];
+                for (int64_t c = begin; c < end; ++c) {
+                  const int64_t offset = c * kBF16ChunkSize;
+                  const int64_t len = std::min(kBF16ChunkSize, n - offset);
+                  BF16ToFloat(x + offset, x_fp32, len);
+                  fn(x_fp32, y_fp32, len);
+                  FloatToBF16(y_fp32, y + offset, len);
+                }
+              });
+}
+
+// z = fn(x, y) of n elements, fn(const float* x, const float* y, float* z,
+// int64_t n) is called like the fn of BF16UnaryCompute.
+template <typename Function>
+void BF16BinaryCompute(const CPUContext& dev_ctx,
+                       const dtype::bfloat16* x,
+                       const dtype::bfloat16* y,
+                       dtype::bfloat16* z,
+                       int64_t n,
+                       double cost_per_unit,
+                       const Function& fn) {
+  const int64_t chunks = (n + kBF16ChunkSize - 1) / kBF16ChunkSize;
+  ParallelFor(dev_ctx,
+              chunks,
+              cost_per_unit * kBF16ChunkSize,
+              [&](int64_t begin, int64_t end) {
+                float x_fp32[kBF16ChunkSize];
+                float y_fp32[kBF16ChunkSize];
+                float z_fp32[kBF16ChunkSize];
+                for (int64_t c = begin; c < end; ++c) {
+                  const int64_t offset = c * kBF16ChunkSize;
+                  const int64_t len = std::min(kBF16ChunkSize, n - offset);
+                  BF16ToFloat(x + offset, x_fp32, len);
+                  BF16ToFloat(y + offset, y_fp32, len);
+                  fn(x_fp32, y_fp32, z_fp32, len);
+                  FloatToBF16(z_fp32, z + offset, len);
+                }
+              });
+}
+
+// C = alpha * op(A) * op(B) + beta * C of row-major bfloat16 matrices, the
+// products are accumulated in float. On CPUs with AVX512-BF16, op(B) is
+// packed in pairs of k and multiplied with vdpbf16ps, otherwise the matrices
+// are converted to float and multiplied by the float Blas GEMM.
+void BF16Gemm(const CPUContext& dev_ctx,
+              bool trans_a,
+              bool trans_b,
+              int m,
+              int n,
+              int k,
+              float alpha,
+              const dtype::bfloat16* a,
+              int lda,
+              const dtype::bfloat16* b,
+              int ldb,
+              float beta,
+              dtype::bfloat16* c,
+              int ldc);
+
+// The name of the gemm picked for this CPU: "avx512_bf16" or "fp32_blas".
+const char* BF16GemmKernelName();
+
+}  // namespace funcs
+}  // namespace phi
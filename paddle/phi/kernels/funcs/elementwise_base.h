@@ -21,6 +21,7 @@ limitations under the License. */
 #include "paddle/phi/kernels/funcs/common_shape.h"
 #include "paddle/phi/kernels/funcs/elementwise_utils.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
+#include "paddle/phi/kernels/funcs/parallel_for.h"
 
 #if defined(__NVCC__) || defined(__HIPCC__) || defined(__xpu__)
 #include "paddle/fluid/platform/function_traits.h"
@@ -60,7 +61,8 @@ class RowwiseTransformIterator<T, CPUContext>
                            T *,
                            T &> {
  public:
-  RowwiseTransformIterator(const T *ptr, int n) : ptr_(ptr), i_(0), n_(n) {}
+  RowwiseTransformIterator(const T *ptr, int n, int64_t offset = 0)
+      : ptr_(ptr), i_(offset % n), n_(n) {}
 
   RowwiseTransformIterator<T, CPUContext> &operator++() {
     ++i_;
@@ -105,8 +107,12 @@ class MidWiseTransformIterator<T, CPUContext>
                            T *,
                            T &> {
  public:
-  MidWiseTransformIterator(const T *ptr, int n, int post)
-      : ptr_(ptr), i_(0), j_(0), n_(n), post_(post) {}
+  MidWiseTransformIterator(const T *ptr, int n, int post, int64_t offset = 0)
+      : ptr_(ptr),
+        i_((offset / post) % n),
+        j_(offset % post),
+        n_(n),
+        post_(post) {}
 
   MidWiseTransformIterator<T, CPUContext> &operator++() {
     ++j_;
@@ -161,8 +167,8 @@ class RowwiseTransformIterator<T, GPUContext>
   typedef thrust::iterator_adaptor<RowwiseTransformIterator<T, GPUContext>,
                                    const T *>
       super_t;
-  HOSTDEVICE RowwiseTransformIterator(const T *x, int n)
-      : super_t(x), begin_(x), n_(n) {}
+  HOSTDEVICE RowwiseTransformIterator(const T *x, int n, int64_t offset = 0)
+      : super_t(x + offset), begin_(x), n_(n) {}
   friend class thrust::iterator_core_access;
 
  private:
@@ -181,8 +187,11 @@ class MidWiseTransformIterator<T, GPUContext>
   typedef thrust::iterator_adaptor<MidWiseTransformIterator<T, GPUContext>,
                                    const T *>
       super_t;
-  HOSTDEVICE MidWiseTransformIterator(const T *x, int n, int post)
-      : super_t(x), begin_(x), n_(n), post_(post) {}
+  HOSTDEVICE MidWiseTransformIterator(const T *x,
+                                      int n,
+                                      int post,
+                                      int64_t offset = 0)
+      : super_t(x + offset), begin_(x), n_(n), post_(post) {}
   friend class thrust::iterator_core_access;
 
  private:
@@ -219,47 +228,60 @@ class TransformFunctor {
     }
   }
 
+  // The output is split into ranges run by the intra-op threads of a
+  // CPUContext, the broadcast iterators start at the offset of each range.
   inline void Run() const {
-    paddle::platform::Transform<DeviceContext> trans;
-    trans(ctx_, x_, x_ + nx_, y_, z_, func_);
+    ParallelFor(
+        ctx_, nx_, kElementwiseCostPerUnit, [&](int64_t begin, int64_t end) {
+          paddle::platform::Transform<DeviceContext> trans;
+          trans(ctx_, x_ + begin, x_ + end, y_ + begin, z_ + begin, func_);
+        });
   }
 
   inline void RunRowWise(int n, int pre) const {
-    paddle::platform::Transform<DeviceContext> trans;
-    if (is_xsize_larger_) {
-      trans(ctx_,
-            x_,
-            x_ + nx_,
-            RowwiseTransformIterator<T, DeviceContext>(y_, n),
-            z_,
-            func_);
-    } else {
-      trans(ctx_,
-            y_,
-            y_ + nx_,
-            RowwiseTransformIterator<T, DeviceContext>(x_, n),
-            z_,
-            func_);
-    }
+    ParallelFor(
+        ctx_, nx_, kElementwiseCostPerUnit, [&](int64_t begin, int64_t end) {
+          paddle::platform::Transform<DeviceContext> trans;
+          if (is_xsize_larger_) {
+            trans(ctx_,
+                  x_ + begin,
+                  x_ + end,
+                  RowwiseTransformIterator<T, DeviceContext>(y_, n, begin),
+                  z_ + begin,
+                  func_);
+          } else {
+            trans(ctx_,
+                  y_ + begin,
+                  y_ + end,
+                  RowwiseTransformIterator<T, DeviceContext>(x_, n, begin),
+                  z_ + begin,
+                  func_);
+          }
+        });
   }
 
   inline void RunMidWise(int n, int pre, int post) const {
-    paddle::platform::Transform<DeviceContext> trans;
-    if (is_xsize_larger_) {
-      trans(ctx_,
-            x_,
-            x_ + nx_,
-            MidWiseTransformIterator<T, DeviceContext>(y_, n, post),
-            z_,
-            func_);
-    } else {
-      trans(ctx_,
-            y_,
-            y_ + nx_,
-            MidWiseTransformIterator<T, DeviceContext>(x_, n, post),
-            z_,
-            func_);
-    }
+    ParallelFor(
+        ctx_, nx_, kElementwiseCostPerUnit, [&](int64_t begin, int64_t end) {
+          paddle::platform::Transform<DeviceContext> trans;
+          if (is_xsize_larger_) {
+            trans(
+                ctx_,
+                x_ + begin,
+                x_ + end,
+                MidWiseTransformIterator<T, DeviceContext>(y_, n, post, begin),
+                z_ + begin,
+                func_);
+          } else {
+            trans(
+                ctx_,
+                y_ + begin,
+                y_ + end,
+                MidWiseTransformIterator<T, DeviceContext>(x_, n, post, begin),
+                z_ + begin,
+                func_);
+          }
+        });
   }
 
  private:
@@ -283,7 +305,6 @@ void CommonForwardBroadcastCPU(const DenseTensor &x,
                                const CPUContext &ctx,
                                Functor func,
                                const bool is_xsize_larger = true) {
-  std::vector<int> index_array(max_dim, 0);
   const T *x_data = x.data<T>();
   const T *y_data = y.data<T>();
   PADDLE_ENFORCE_NOT_NULL(
@@ -294,18 +315,31 @@ void CommonForwardBroadcastCPU(const DenseTensor &x,
 
   const int out_size = std::accumulate(
       out_dims_array, out_dims_array + max_dim, 1, std::multiplies<int>());
-  int x_index, y_index;
-  for (int out_index = 0; out_index < out_size; ++out_index) {
-    x_index = GetElementwiseIndex(x_dims_array, max_dim, index_array.data());
-    y_index = GetElementwiseIndex(y_dims_array, max_dim, index_array.data());
-    if (is_xsize_larger) {
-      out_data[out_index] = func(x_data[x_index], y_data[y_index]);
-    } else {
-      out_data[out_index] = func(y_data[y_index], x_data[x_index]);
-    }
-
-    UpdateElementwiseIndexArray(out_dims_array, max_dim, index_array.data());
-  }
+  ParallelFor(
+      ctx, out_size, kBroadcastCostPerUnit, [&](int64_t begin, int64_t end) {
+        // the index array of the first output of this range
+        std::vector<int> index_array(max_dim, 0);
+        int64_t remain = begin;
+        for (int i = max_dim - 1; i >= 0; --i) {
+          index_array[i] = remain % out_dims_array[i];
+          remain /= out_dims_array[i];
+        }
+        int x_index, y_index;
+        for (int64_t out_index = begin; out_index < end; ++out_index) {
+          x_index =
+              GetElementwiseIndex(x_dims_array, max_dim, index_array.data());
+          y_index =
+              GetElementwiseIndex(y_dims_array, max_dim, index_array.data());
+          if (is_xsize_larger) {
+            out_data[out_index] = func(x_data[x_index], y_data[y_index]);
+          } else {
+            out_data[out_index] = func(y_data[y_index], x_data[x_index]);
+          }
+
+          UpdateElementwiseIndexArray(
+              out_dims_array, max_dim, index_array.data());
+        }
+      });
 }
 
 template <typename Functor, typename T, typename OutType = T>
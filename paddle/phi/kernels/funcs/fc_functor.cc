@@ -31,11 +31,33 @@ void FCFunctor<DeviceContext, T>::operator()(const DeviceContext& context,
                                              T* Y,
                                              const T* B,
                                              bool relu,
-                                             bool padding_weights) {
+                                             bool padding_weights,
+                                             const T* packed_W) {
   auto blas = GetBlas<DeviceContext, T>(context);
   paddle::framework::Tensor Y1;
   T* Y1_data = nullptr;
-  if (padding_weights) {
+  // The packed weight is packed without the padding, so X and Y are not
+  // padded either.
+  if (packed_W != nullptr) {
+    padding_weights = false;
+#ifdef PADDLE_WITH_MKLML
+    blas.GEMM_COMPUTE(CblasNoTrans,
+                      CblasPacked,
+                      M,
+                      N,
+                      K,
+                      X,
+                      K,
+                      packed_W,
+                      N,
+                      static_cast<T>(0.0),
+                      Y,
+                      N);
+#else
+    PADDLE_THROW(errors::Unimplemented(
+        "The packed weight of fc is only supported with MKLML."));
+#endif
+  } else if (padding_weights) {
     const int NN = N + 4;
     const int KK = K + 4;
     paddle::framework::Tensor X1;
@@ -97,6 +119,47 @@ void FCFunctor<DeviceContext, T>::operator()(const DeviceContext& context,
   }
 }
 
+template <typename T>
+bool PackFCWeight(const CPUContext& context,
+                  const int N,
+                  const int K,
+                  const T* W,
+                  const int ldw,
+                  DenseTensor* packed_W) {
+#ifdef PADDLE_WITH_MKLML
+  auto blas = GetBlas<CPUContext, T>(context);
+  // The height of X does not matter to the packed weight.
+  const size_t bytes = blas.GEMM_PACK_GET_SIZE(CblasBMatrix, 1, N, K);
+  packed_W->Resize({static_cast<int64_t>((bytes + sizeof(T) - 1) / sizeof(T))});
+  T* dst = context.template Alloc<T>(packed_W);
+  blas.GEMM_PACK(CblasBMatrix,
+                 CblasNoTrans,
+                 1,
+                 N,
+                 K,
+                 static_cast<T>(1.0),
+                 W,
+                 ldw,
+                 dst);
+  return true;
+#else
+  return false;
+#endif
+}
+
+template bool PackFCWeight<float>(const CPUContext& context,
+                                  const int N,
+                                  const int K,
+                                  const float* W,
+                                  const int ldw,
+                                  DenseTensor* packed_W);
+template bool PackFCWeight<double>(const CPUContext& context,
+                                   const int N,
+                                   const int K,
+                                   const double* W,
+                                   const int ldw,
+                                   DenseTensor* packed_W);
+
 template class FCFunctor<paddle::platform::CPUDeviceContext, float>;
 template class FCFunctor<paddle::platform::CPUDeviceContext, double>;
 template class FCFunctor<CPUContext, float>;
@@ -84,7 +84,12 @@ void FCFunctor<DeviceContext, T>::operator()(const DeviceContext& context,
                                              T* Y,
                                              const T* B,
                                              bool relu,
-                                             bool padding_weights) {
+                                             bool padding_weights,
+                                             const T* packed_W) {
+  PADDLE_ENFORCE_EQ(
+      packed_W == nullptr,
+      true,
+      errors::PermissionDenied("Weight packing in fc can not be used in GPU."));
   PADDLE_ENFORCE_EQ(padding_weights,
                     false,
                     errors::PermissionDenied(
@@ -16,10 +16,15 @@ limitations under the License. */
 
 #include <string>
 #include "paddle/fluid/platform/device_context.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
 
 namespace phi {
 namespace funcs {
 
+// Y = X * W + B with the optional relu, where W is K x N. packed_W is the
+// packed layout of the GEMM backend of W, see PackFCWeight, which is used
+// instead of W when it is not null.
 template <typename DeviceContext, typename T>
 class FCFunctor {
  public:
@@ -32,8 +37,20 @@ class FCFunctor {
                   T* Y,
                   const T* B = nullptr,
                   bool relu = false,
-                  bool weight_pass = false);
+                  bool weight_pass = false,
+                  const T* packed_W = nullptr);
 };
 
+// Packs the K x N weight of FCFunctor, whose rows are ldw apart, into
+// packed_W in the layout of the GEMM backend, so that FCFunctor does not pack
+// it on every call. Returns false if the backend has no packed layout.
+template <typename T>
+bool PackFCWeight(const CPUContext& context,
+                  const int N,
+                  const int K,
+                  const T* W,
+                  const int ldw,
+                  DenseTensor* packed_W);
+
 }  // namespace funcs
 }  // namespace phi
@@ -0,0 +1,468 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/phi/kernels/funcs/int8_gemm.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "paddle/fluid/platform/cpu_info.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/funcs/parallel_for.h"
+
+// The SIMD microkernels are compiled with the target attribute and picked
+// at runtime, so they do not depend on the SIMD flags of the build.
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define PADDLE_INT8_GEMM_AVX2
+#if defined(__clang__) || __GNUC__ >= 8
+#define PADDLE_INT8_GEMM_AVX512_VNNI
+#endif
+#endif
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+constexpr int kCols = PackedInt8Matrix::kPanelCols;
+// rows of A computed by one call of a microkernel
+constexpr int kMicroRows = 4;
+// rows of A computed by one task of ParallelFor
+constexpr int kTaskRows = 32;
+constexpr uint8_t kZeroPoint = 128;
+
+// acc is {rows, kCols}, b is one panel of PackedInt8Matrix
+using MicroKernel = void (*)(const uint8_t* a,
+                             int lda,
+                             int rows,
+                             const int8_t* b,
+                             int k_groups,
+                             int32_t* acc);
+
+void MicroKernelRef(const uint8_t* a,
+                    int lda,
+                    int rows,
+                    const int8_t* b,
+                    int k_groups,
+                    int32_t* acc) {
+  std::fill(acc, acc + rows * kCols, 0);
+  for (int g = 0; g < k_groups; ++g) {
+    const int8_t* bg = b + g * kCols * 4;
+    for (int r = 0; r < rows; ++r) {
+      const uint8_t* ar = a + r * lda + g * 4;
+      int32_t* accr = acc + r * kCols;
+      for (int j = 0; j < kCols; ++j) {
+        accr[j] += ar[0] * bg[j * 4] + ar[1] * bg[j * 4 + 1] +
+                   ar[2] * bg[j * 4 + 2] + ar[3] * bg[j * 4 + 3];
+      }
+    }
+  }
+}
+
+#ifdef PADDLE_INT8_GEMM_AVX2
+// c[i] holds the two partial sums of the columns 4i .. 4i + 3
+__attribute__((target("avx2"))) inline void StorePairSumsAVX2(
+    const __m256i* c, int32_t* out) {
+  for (int h = 0; h < 2; ++h) {
+    // {0, 1, 4, 5 | 2, 3, 6, 7} of the 8 columns
+    __m256i s = _mm256_hadd_epi32(c[2 * h], c[2 * h + 1]);
+    s = _mm256_permute4x64_epi64(s, _MM_SHUFFLE(3, 1, 2, 0));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 8 * h), s);
+  }
+}
+
+// Widens u8 and s8 to int16 and multiplies with vpmaddwd, which cannot
+// saturate like vpmaddubsw does for the u8s8 products.
+__attribute__((target("avx2"))) void MicroKernelAVX2(const uint8_t* a,
+                                                     int lda,
+                                                     int rows,
+                                                     const int8_t* b,
+                                                     int k_groups,
+                                                     int32_t* acc) {
+  for (int r = 0; r < rows; r += 2) {
+    const uint8_t* a0 = a + r * lda;
+    const uint8_t* a1 = r + 1 < rows ? a0 + lda : a0;
+    __m256i c0[4];
+    __m256i c1[4];
+    for (int i = 0; i < 4; ++i) {
+      c0[i] = _mm256_setzero_si256();
+      c1[i] = _mm256_setzero_si256();
+    }
+    for (int g = 0; g < k_groups; ++g) {
+      const int8_t* bg = b + g * kCols * 4;
+      int32_t v0;
+      int32_t v1;
+      std::memcpy(&v0, a0 + g * 4, sizeof(v0));
+      std::memcpy(&v1, a1 + g * 4, sizeof(v1));
+      // 4 k of the row, repeated for 4 columns
+      const __m256i x0 = _mm256_cvtepu8_epi16(_mm_set1_epi32(v0));
+      const __m256i x1 = _mm256_cvtepu8_epi16(_mm_set1_epi32(v1));
+      for (int i = 0; i < 4; ++i) {
+        // 4 k of 4 columns
+        const __m256i w = _mm256_cvtepi8_epi16(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(bg + 16 * i)));
+        c0[i] = _mm256_add_epi32(c0[i], _mm256_madd_epi16(w, x0));
+        c1[i] = _mm256_add_epi32(c1[i], _mm256_madd_epi16(w, x1));
+      }
+    }
+    StorePairSumsAVX2(c0, acc + r * kCols);
+    if (r + 1 < rows) {
+      StorePairSumsAVX2(c1, acc + (r + 1) * kCols);
+    }
+  }
+}
+#endif
+
+#ifdef PADDLE_INT8_GEMM_AVX512_VNNI
+template <int kRows>
+__attribute__((target("avx512f,avx512vnni"))) void MicroKernelVNNIImpl(
+    const uint8_t* a, int lda, const int8_t* b, int k_groups, int32_t* acc) {
+  __m512i c[kRows];
+  for (int r = 0; r < kRows; ++r) {
+    c[r] = _mm512_setzero_si512();
+  }
+  for (int g = 0; g < k_groups; ++g) {
+    const __m512i w = _mm512_loadu_si512(b + g * kCols * 4);
+    for (int r = 0; r < kRows; ++r) {
+      int32_t v;
+      std::memcpy(&v, a + r * lda + g * 4, sizeof(v));
+      c[r] = _mm512_dpbusd_epi32(c[r], _mm512_set1_epi32(v), w);
+    }
+  }
+  for (int r = 0; r < kRows; ++r) {
+    _mm512_storeu_si512(acc + r * kCols, c[r]);
+  }
+}
+
+void MicroKernelVNNI(const uint8_t* a,
+                     int lda,
+                     int rows,
+                     const int8_t* b,
+                     int k_groups,
+                     int32_t* acc) {
+  switch (rows) {
+    case 1:
+      MicroKernelVNNIImpl<1>(a, lda, b, k_groups, acc);
+      break;
+    case 2:
+      MicroKernelVNNIImpl<2>(a, lda, b, k_groups, acc);
+      break;
+    case 3:
+      MicroKernelVNNIImpl<3>(a, lda, b, k_groups, acc);
+      break;
+    default:
+      MicroKernelVNNIImpl<kMicroRows>(a, lda, b, k_groups, acc);
+      break;
+  }
+}
+#endif
+
+struct MicroKernelInfo {
+  MicroKernel kernel;
+  const char* name;
+};
+
+const MicroKernelInfo& GetMicroKernel() {
+  static const MicroKernelInfo info = []() -> MicroKernelInfo {
+#ifdef PADDLE_INT8_GEMM_AVX512_VNNI
+    if (paddle::platform::MayIUse(paddle::platform::avx512_core_vnni)) {
+      return {MicroKernelVNNI, "avx512_vnni"};
+    }
+#endif
+#ifdef PADDLE_INT8_GEMM_AVX2
+    if (paddle::platform::MayIUse(paddle::platform::avx2)) {
+      return {MicroKernelAVX2, "avx2"};
+    }
+#endif
+    return {MicroKernelRef, "reference"};
+  }();
+  return info;
+}
+
+inline void StoreResult(float y, float inv_out_scale, float* out) {
+  *out = y;
+}
+
+inline void StoreResult(float y, float inv_out_scale, int8_t* out) {
+  const float q = std::round(y * inv_out_scale);
+  *out = static_cast<int8_t>(std::min(127.f, std::max(-128.f, q)));
+}
+
+// removes the zero point of A and applies the epilogue to a tile of C
+template <typename T>
+void StoreTile(const PackedInt8Matrix& b,
+               const Int8GemmEpilogue& epilogue,
+               const int32_t* acc,
+               int rows,
+               int col0,
+               int cols,
+               T* c,
+               int ldc) {
+  const int32_t* col_sums = b.col_sums() + col0;
+  const float* scales = b.scales() + col0;
+  const float* bias = epilogue.bias ? epilogue.bias + col0 : nullptr;
+  const float inv_out_scale = 1.f / epilogue.out_scale;
+  for (int r = 0; r < rows; ++r) {
+    const int32_t* accr = acc + r * kCols;
+    T* cr = c + r * ldc;
+    for (int j = 0; j < cols; ++j) {
+      const int32_t v = accr[j] - kZeroPoint * col_sums[j];
+      float y = static_cast<float>(v) * epilogue.a_scale * scales[j];
+      if (bias) {
+        y += bias[j];
+      }
+      if (epilogue.relu) {
+        y = std::max(y, 0.f);
+      }
+      StoreResult(y, inv_out_scale, cr + j);
+    }
+  }
+}
+
+}  // namespace
+
+void PackedInt8Matrix::Pack(const int8_t* b,
+                            int k,
+                            int n,
+                            int ldb,
+                            bool trans_b,
+                            const std::vector<float>& scales) {
+  PADDLE_ENFORCE_EQ(
+      scales.size() == 1 || scales.size() == static_cast<size_t>(n),
+      true,
+      phi::errors::InvalidArgument(
+          "The scales of the int8 matrix should have 1 or n (%d) entries, "
+          "but received %d.",
+          n,
+          scales.size()));
+  k_ = k;
+  n_ = n;
+  const int groups = k_groups();
+  data_.assign(static_cast<size_t>(panels()) * groups * kCols * 4, 0);
+  col_sums_.assign(n, 0);
+  scales_.assign(n, scales[0]);
+  if (scales.size() > 1) {
+    scales_ = scales;
+  }
+  for (int j = 0; j < n; ++j) {
+    int8_t* panel = data_.data() +
+                    static_cast<size_t>(j / kCols) * groups * kCols * 4 +
+                    (j % kCols) * 4;
+    int32_t sum = 0;
+    for (int i = 0; i < k; ++i) {
+      const int8_t v = trans_b ? b[static_cast<int64_t>(j) * ldb + i]
+                               : b[static_cast<int64_t>(i) * ldb + j];
+      panel[(i / 4) * kCols * 4 + i % 4] = v;
+      sum += v;
+    }
+    col_sums_[j] = sum;
+  }
+}
+
+void PackedInt8Matrix::QuantizeAndPack(const float* b,
+                                       int k,
+                                       int n,
+                                       int ldb,
+                                       bool trans_b,
+                                       const std::vector<float>& scales) {
+  auto at = [&](int i, int j) {
+    return trans_b ? b[static_cast<int64_t>(j) * ldb + i]
+                   : b[static_cast<int64_t>(i) * ldb + j];
+  };
+  std::vector<float> col_scales(n);
+  for (int j = 0; j < n; ++j) {
+    if (!scales.empty()) {
+      col_scales[j] = scales.size() == 1 ? scales[0] : scales[j];
+      continue;
+    }
+    float max_abs = 0.f;
+    for (int i = 0; i < k; ++i) {
+      max_abs = std::max(max_abs, std::abs(at(i, j)));
+    }
+    col_scales[j] = max_abs > 0.f ? max_abs / 127.f : 1.f;
+  }
+  std::vector<int8_t> quantized(static_cast<size_t>(k) * n);
+  for (int i = 0; i < k; ++i) {
+    for (int j = 0; j < n; ++j) {
+      const float q = std::round(at(i, j) / col_scales[j]);
+      quantized[static_cast<size_t>(i) * n + j] =
+          static_cast<int8_t>(std::min(127.f, std::max(-127.f, q)));
+    }
+  }
+  Pack(quantized.data(), k, n, n, false, col_scales);
+}
+
+void QuantizeToUint8(const CPUContext& dev_ctx,
+                     const float* x,
+                     int m,
+                     int k,
+                     int ldx,
+                     float scale,
+                     uint8_t* out,
+                     int ld_out) {
+  const int padded_k = Int8GemmPaddedK(k);
+  PADDLE_ENFORCE_GE(
+      ld_out,
+      padded_k,
+      phi::errors::InvalidArgument("The rows of the quantized matrix should "
+                                   "have at least %d bytes, but received %d.",
+                                   padded_k,
+                                   ld_out));
+  const float inv_scale = 1.f / scale;
+  ParallelFor(dev_ctx, m, 2.0 * k, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      const float* xi = x + i * ldx;
+      uint8_t* oi = out + i * ld_out;
+      for (int j = 0; j < k; ++j) {
+        const float q = std::round(xi[j] * inv_scale) + kZeroPoint;
+        oi[j] = static_cast<uint8_t>(std::min(255.f, std::max(0.f, q)));
+      }
+      std::fill(oi + k, oi + padded_k, kZeroPoint);
+    }
+  });
+}
+
+template <typename T>
+void Int8Gemm(const CPUContext& dev_ctx,
+              int m,
+              const uint8_t* a,
+              int lda,
+              const PackedInt8Matrix& b,
+              const Int8GemmEpilogue& epilogue,
+              T* c,
+              int ldc) {
+  PADDLE_ENFORCE_GE(
+      lda,
+      Int8GemmPaddedK(b.k()),
+      phi::errors::InvalidArgument("The rows of A should have at least %d "
+                                   "bytes, but received %d.",
+                                   Int8GemmPaddedK(b.k()),
+                                   lda));
+  const MicroKernel kernel = GetMicroKernel().kernel;
+  const int panels = b.panels();
+  const int row_tasks = (m + kTaskRows - 1) / kTaskRows;
+  const int k_groups = b.k_groups();
+  // the tasks of a panel are next to each other, so the threads share it
+  ParallelFor(dev_ctx,
+              static_cast<int64_t>(row_tasks) * panels,
+              static_cast<double>(kTaskRows) * kCols * k_groups,
+              [&](int64_t begin, int64_t end) {
+                int32_t acc[kMicroRows * kCols];
+                for (int64_t t = begin; t < end; ++t) {
+                  const int p = static_cast<int>(t / row_tasks);
+                  const int row0 = static_cast<int>(t % row_tasks) * kTaskRows;
+                  const int row_end = std::min(m, row0 + kTaskRows);
+                  const int col0 = p * kCols;
+                  const int cols = std::min(kCols, b.n() - col0);
+                  for (int r = row0; r < row_end; r += kMicroRows) {
+                    const int rows = std::min(kMicroRows, row_end - r);
+                    kernel(a + static_cast<int64_t>(r) * lda,
+                           lda,
+                           rows,
+                           b.panel(p),
+                           k_groups,
+                           acc);
+                    StoreTile(b,
+                              epilogue,
+                              acc,
+                              rows,
+                              col0,
+                              cols,
+                              c + static_cast<int64_t>(r) * ldc + col0,
+                              ldc);
+                  }
+                }
+              });
+}
+
+template void Int8Gemm<float>(const CPUContext& dev_ctx,
+                              int m,
+                              const uint8_t* a,
+                              int lda,
+                              const PackedInt8Matrix& b,
+                              const Int8GemmEpilogue& epilogue,
+                              float* c,
+                              int ldc);
+template void Int8Gemm<int8_t>(const CPUContext& dev_ctx,
+                               int m,
+                               const uint8_t* a,
+                               int lda,
+                               const PackedInt8Matrix& b,
+                               const Int8GemmEpilogue& epilogue,
+                               int8_t* c,
+                               int ldc);
+
+const char* Int8GemmKernelName() { return GetMicroKernel().name; }
+
+PackedInt8WeightCache& PackedInt8WeightCache::Instance() {
+  static PackedInt8WeightCache cache;
+  return cache;
+}
+
+std::shared_ptr<const PackedInt8Matrix> PackedInt8WeightCache::Get(
+    const DenseTensor& weight,
+    int k,
+    int n,
+    int ldw,
+    bool trans,
+    const std::vector<float>& scales) {
+  const void* data = weight.data();
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto it = items_.begin(); it != items_.end();) {
+      if (it->holder.expired()) {
+        it = items_.erase(it);
+        continue;
+      }
+      if (it->holder.lock() == weight.Holder() && it->data == data &&
+          it->k == k && it->n == n && it->ldw == ldw && it->trans == trans &&
+          it->scales == scales) {
+        auto packed = it->packed;
+        items_.splice(items_.begin(), items_, it);
+        return packed;
+      }
+      ++it;
+    }
+  }
+
+  auto packed = std::make_shared<PackedInt8Matrix>();
+  if (weight.dtype() == DataType::INT8) {
+    packed->Pack(weight.data<int8_t>(), k, n, ldw, trans, scales);
+  } else {
+    packed->QuantizeAndPack(weight.data<float>(), k, n, ldw, trans, scales);
+  }
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  items_.push_front(
+      Item{weight.Holder(), data, k, n, ldw, trans, scales, packed});
+  while (items_.size() > kCapacity) {
+    items_.pop_back();
+  }
+  return packed;
+}
+
+void PackedInt8WeightCache::Clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  items_.clear();
+}
+
+size_t PackedInt8WeightCache::Size() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return items_.size();
+}
+
+}  // namespace funcs
+}  // namespace phi
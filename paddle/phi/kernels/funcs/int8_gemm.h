@@ -0,0 +1,160 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace phi {
+namespace funcs {
+
+// The u8s8s32 gemm of the quantized CPU kernels without oneDNN:
+//   C = epilogue(A * B)
+// A is quantized to uint8 with a zero point of 128, B is int8 quantized per
+// column (output channel) and the products are accumulated exactly in int32.
+// The zero point of A is removed with the column sums of B, so A may hold
+// negative values:
+//   (A + 128) * B - 128 * sum_k(B) = A * B
+
+// The microkernels consume A by groups of 4 along K, the rows of the
+// quantized A must have at least this many bytes.
+inline int Int8GemmPaddedK(int k) { return (k + 3) / 4 * 4; }
+
+// B packed in panels of 16 columns, [N / 16][K / 4][16][4], one 64-byte line
+// holds 4 k of 16 columns, which is what one VNNI instruction consumes. The
+// padding is filled with zeros.
+class PackedInt8Matrix {
+ public:
+  static constexpr int kPanelCols = 16;
+
+  // b is {k, n} with the leading dimension ldb, or {n, k} if trans_b.
+  // scales has 1 or n entries, the real value of b is q * scale.
+  void Pack(const int8_t* b,
+            int k,
+            int n,
+            int ldb,
+            bool trans_b,
+            const std::vector<float>& scales);
+
+  // Quantizes a float b per column with scale = max(|b|) / 127, or with the
+  // given scales (1 or n entries) if they are not empty.
+  void QuantizeAndPack(const float* b,
+                       int k,
+                       int n,
+                       int ldb,
+                       bool trans_b,
+                       const std::vector<float>& scales = {});
+
+  int k() const { return k_; }
+  int n() const { return n_; }
+  int panels() const { return (n_ + kPanelCols - 1) / kPanelCols; }
+  int k_groups() const { return Int8GemmPaddedK(k_) / 4; }
+  const int8_t* panel(int p) const {
+    return data_.data() + static_cast<size_t>(p) * k_groups() * kPanelCols * 4;
+  }
+  const int32_t* col_sums() const { return col_sums_.data(); }
+  const float* scales() const { return scales_.data(); }
+
+ private:
+  int k_{0};
+  int n_{0};
+  std::vector<int8_t> data_;
+  std::vector<int32_t> col_sums_;  // n entries
+  std::vector<float> scales_;      // n entries
+};
+
+// q = clamp(round(x / scale) + 128, 0, 255) of a {m, k} x, the rows of out
+// have ld_out >= Int8GemmPaddedK(k) bytes and are padded with the zero point.
+void QuantizeToUint8(const CPUContext& dev_ctx,
+                     const float* x,
+                     int m,
+                     int k,
+                     int ldx,
+                     float scale,
+                     uint8_t* out,
+                     int ld_out);
+
+struct Int8GemmEpilogue {
+  float a_scale{1.f};          // the real value of A is (q - 128) * a_scale
+  const float* bias{nullptr};  // n entries or nullptr
+  bool relu{false};
+  float out_scale{1.f};  // q = round(y / out_scale) of an int8 C
+};
+
+// T is float to dequantize the result or int8_t to requantize it. The
+// A rows have lda >= Int8GemmPaddedK(b.k()) bytes, see QuantizeToUint8.
+template <typename T>
+void Int8Gemm(const CPUContext& dev_ctx,
+              int m,
+              const uint8_t* a,
+              int lda,
+              const PackedInt8Matrix& b,
+              const Int8GemmEpilogue& epilogue,
+              T* c,
+              int ldc);
+
+// The name of the microkernel picked for this CPU: "avx512_vnni", "avx2" or
+// "reference".
+const char* Int8GemmKernelName();
+
+// Keeps the packed float weights of the quantized kernels. A weight is
+// quantized and packed at its first use and reused while the tensor keeps
+// the same allocation, so the weights are taken as constants, which is what
+// the int8 inference programs guarantee. It keeps at most kCapacity weights
+// and drops the least recently used one first.
+class PackedInt8WeightCache {
+ public:
+  static constexpr size_t kCapacity = 256;
+
+  static PackedInt8WeightCache& Instance();
+
+  std::shared_ptr<const PackedInt8Matrix> Get(
+      const DenseTensor& weight,
+      int k,
+      int n,
+      int ldw,
+      bool trans,
+      const std::vector<float>& scales);
+
+  void Clear();
+
+  size_t Size() const;
+
+ private:
+  PackedInt8WeightCache() = default;
+
+  struct Item {
+    std::weak_ptr<phi::Allocation> holder;
+    const void* data;
+    int k;
+    int n;
+    int ldw;
+    bool trans;
+    std::vector<float> scales;
+    std::shared_ptr<const PackedInt8Matrix> packed;
+  };
+
+  mutable std::mutex mutex_;
+  std::list<Item> items_;  // the most recently used first
+};
+
+}  // namespace funcs
+}  // namespace phi
@@ -158,7 +158,7 @@ void TransposeNormal<DeviceContext, T>::operator()(
       out_ptr[out_idx] = in_ptr[in_idx];
     }
   };
-  transpose_helper(0, out->numel());
+  ParallelFor(context, out->numel(), 2.0 * rank, transpose_helper);
 }
 
 // define transpose normal
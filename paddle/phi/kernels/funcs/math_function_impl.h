@@ -17,6 +17,7 @@ limitations under the License. */
 #include <vector>
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
+#include "paddle/phi/kernels/funcs/parallel_for.h"
 
 namespace phi {
 namespace funcs {
@@ -61,7 +62,23 @@ void Transpose<DeviceContext, T, Rank>::operator()(
     To32BitIndex(eigen_out).device(*dev) =
         To32BitIndex(eigen_in).shuffle(permute);
   } else {
-    eigen_out.device(*dev) = eigen_in.shuffle(permute);
+    // The output is split along dim 0 among the intra-op threads of a
+    // CPUContext, other contexts compute the whole output at once.
+    const int64_t rows = eigen_out.dimension(0);
+    const double cost_per_row =
+        rows > 0 ? 2.0 * Rank * eigen_out.size() / rows : 0.0;
+    ParallelFor(context, rows, cost_per_row, [&](int64_t begin, int64_t end) {
+      if (begin == 0 && end == rows) {
+        eigen_out.device(*dev) = eigen_in.shuffle(permute);
+        return;
+      }
+      Eigen::DSizes<Eigen::DenseIndex, Rank> offsets;
+      Eigen::DSizes<Eigen::DenseIndex, Rank> extents = eigen_out.dimensions();
+      offsets[0] = begin;
+      extents[0] = end - begin;
+      eigen_out.slice(offsets, extents).device(*dev) =
+          eigen_in.shuffle(permute).slice(offsets, extents);
+    });
   }
 }
 
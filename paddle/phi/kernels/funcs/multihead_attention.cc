@@ -0,0 +1,235 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/phi/kernels/funcs/multihead_attention.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "paddle/fluid/operators/jit/kernels.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/parallel_for.h"
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+namespace jit = paddle::operators::jit;
+
+// A block of 32 queries and 128 keys of 64 features takes 16KB of scores,
+// 8KB of partial outputs and 64KB of K and V, which stay in L2 while the
+// block is processed.
+constexpr int kBlockQ = 32;
+constexpr int kBlockK = 128;
+
+// The jit kernels are generated for each length, and cached per thread.
+template <typename KernelTuple>
+typename KernelTuple::func_type JitKernel(int n) {
+  return jit::KernelFuncs<KernelTuple, phi::CPUPlace>::Cache().At(n);
+}
+
+}  // namespace
+
+void MultiHeadAttention(const CPUContext& dev_ctx,
+                        int batch,
+                        int seq_len,
+                        int head_number,
+                        int head_size,
+                        const float* qkv,
+                        const float* mask,
+                        const DDim& mask_dims,
+                        float scale,
+                        float* out) {
+  if (batch == 0 || seq_len == 0 || head_number == 0 || head_size == 0) {
+    return;
+  }
+
+  // the mask is broadcast on the heads and the queries
+  int64_t mask_batch_stride = 0;
+  int64_t mask_head_stride = 0;
+  int64_t mask_row_stride = 0;
+  if (mask != nullptr) {
+    PADDLE_ENFORCE_EQ(
+        mask_dims.size(),
+        4,
+        errors::InvalidArgument(
+            "The mask of the attention should be a 4-D tensor, but got %d-D.",
+            mask_dims.size()));
+    PADDLE_ENFORCE_EQ(
+        mask_dims[0] == batch &&
+            (mask_dims[1] == 1 || mask_dims[1] == head_number) &&
+            (mask_dims[2] == 1 || mask_dims[2] == seq_len) &&
+            mask_dims[3] == seq_len,
+        true,
+        errors::InvalidArgument(
+            "The mask of the attention should be [%d, 1 or %d, 1 or %d, %d], "
+            "but got [%s].",
+            batch,
+            head_number,
+            seq_len,
+            seq_len,
+            mask_dims));
+    mask_row_stride = mask_dims[2] == 1 ? 0 : seq_len;
+    mask_head_stride = mask_dims[1] == 1 ? 0 : mask_dims[2] * seq_len;
+    mask_batch_stride = mask_dims[1] * mask_dims[2] * seq_len;
+  }
+
+  const int hidden = head_number * head_size;
+  const int qkv_ld = 3 * hidden;
+  const int q_blocks = (seq_len + kBlockQ - 1) / kBlockQ;
+  // the two gemms of a query block
+  const double cost_per_block = 4.0 * kBlockQ * seq_len * head_size;
+
+  ParallelFor(
+      dev_ctx,
+      static_cast<int64_t>(batch) * head_number * q_blocks,
+      cost_per_block,
+      [&](int64_t begin, int64_t end) {
+        auto blas = GetBlas<CPUContext, float>(dev_ctx);
+        std::vector<float> scores(kBlockQ * kBlockK);
+        std::vector<float> acc(kBlockQ * head_size);
+        float row_max[kBlockQ];
+        float row_sum[kBlockQ];
+        auto vscal = JitKernel<jit::VScalTuple<float>>(head_size);
+
+        for (int64_t t = begin; t < end; ++t) {
+          const int q_block = t % q_blocks;
+          const int n = (t / q_blocks) % head_number;
+          const int b = t / (static_cast<int64_t>(q_blocks) * head_number);
+          const int q_begin = q_block * kBlockQ;
+          const int rows = std::min(kBlockQ, seq_len - q_begin);
+
+          const float* batch_qkv =
+              qkv + static_cast<int64_t>(b) * seq_len * qkv_ld;
+          const float* q =
+              batch_qkv + static_cast<int64_t>(q_begin) * qkv_ld +
+              n * head_size;
+          const float* k = batch_qkv + hidden + n * head_size;
+          const float* v = batch_qkv + 2 * hidden + n * head_size;
+          const float* block_mask =
+              mask == nullptr ? nullptr
+                              : mask + b * mask_batch_stride +
+                                    n * mask_head_stride +
+                                    q_begin * mask_row_stride;
+
+          // The padded keys at the end are skipped. If all the keys are
+          // masked, the softmax of the masked scores is computed as is.
+          int kv_len = seq_len;
+          if (block_mask != nullptr) {
+            kv_len = 0;
+            const int mask_rows = mask_row_stride == 0 ? 1 : rows;
+            for (int i = 0; i < mask_rows; ++i) {
+              const float* m = block_mask + i * mask_row_stride;
+              int j = seq_len;
+              while (j > kv_len && m[j - 1] <= kAttentionMaskedScore) {
+                --j;
+              }
+              kv_len = j;
+            }
+            if (kv_len == 0) {
+              kv_len = seq_len;
+            }
+          }
+
+          std::fill(acc.begin(), acc.begin() + rows * head_size, 0.f);
+          std::fill(
+              row_max, row_max + rows, -std::numeric_limits<float>::infinity());
+          std::fill(row_sum, row_sum + rows, 0.f);
+
+          for (int k_begin = 0; k_begin < kv_len; k_begin += kBlockK) {
+            const int cols = std::min(kBlockK, kv_len - k_begin);
+            auto vadd = JitKernel<jit::VAddTuple<float>>(cols);
+            auto vadd_bias = JitKernel<jit::VAddBiasTuple<float>>(cols);
+            auto vexp = JitKernel<jit::VExpTuple<float>>(cols);
+            auto hmax = JitKernel<jit::HMaxTuple<float>>(cols);
+            auto hsum = JitKernel<jit::HSumTuple<float>>(cols);
+
+            // scores = scale * Q * K^T of the block
+            blas.GEMM(false,
+                      true,
+                      rows,
+                      cols,
+                      head_size,
+                      scale,
+                      q,
+                      qkv_ld,
+                      k + static_cast<int64_t>(k_begin) * qkv_ld,
+                      qkv_ld,
+                      0.f,
+                      scores.data(),
+                      kBlockK);
+
+            for (int i = 0; i < rows; ++i) {
+              float* s = scores.data() + i * kBlockK;
+              float* acc_row = acc.data() + i * head_size;
+              if (block_mask != nullptr) {
+                vadd(s, block_mask + i * mask_row_stride + k_begin, s, cols);
+              }
+              float block_max;
+              hmax(s, &block_max, cols);
+              const float new_max = std::max(row_max[i], block_max);
+              if (std::isinf(new_max) && new_max < 0) {
+                // no key of the row is attended so far
+                std::fill(s, s + cols, 0.f);
+                continue;
+              }
+              const float neg_max = -new_max;
+              vadd_bias(&neg_max, s, s, cols);
+              vexp(s, s, cols);
+              float block_sum;
+              hsum(s, &block_sum, cols);
+              const float correction = std::exp(row_max[i] - new_max);
+              if (correction != 1.f) {
+                vscal(&correction, acc_row, acc_row, head_size);
+              }
+              row_sum[i] = row_sum[i] * correction + block_sum;
+              row_max[i] = new_max;
+            }
+
+            // acc += exp(scores - max) * V of the block
+            blas.GEMM(false,
+                      false,
+                      rows,
+                      head_size,
+                      cols,
+                      1.f,
+                      scores.data(),
+                      kBlockK,
+                      v + static_cast<int64_t>(k_begin) * qkv_ld,
+                      qkv_ld,
+                      1.f,
+                      acc.data(),
+                      head_size);
+          }
+
+          for (int i = 0; i < rows; ++i) {
+            const float inv_sum = 1.f / row_sum[i];
+            vscal(&inv_sum,
+                  acc.data() + i * head_size,
+                  out +
+                      (static_cast<int64_t>(b) * seq_len + q_begin + i) *
+                          hidden +
+                      n * head_size,
+                  head_size);
+          }
+        }
+      });
+}
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,48 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/ddim.h"
+
+namespace phi {
+namespace funcs {
+
+// The mask values at or below kAttentionMaskedScore mark the padded keys.
+// Their exp underflows to zero in the softmax, so the trailing keys masked
+// for all the rows of a query block are skipped instead of computed.
+constexpr float kAttentionMaskedScore = -1000.f;
+
+// out = softmax(scale * Q * K^T + mask) * V of every batch and head, where
+//   qkv:  [batch, seq_len, 3, head_number, head_size], the projected Q, K, V.
+//   mask: [batch, 1 or head_number, 1 or seq_len, seq_len], or nullptr.
+//   out:  [batch, seq_len, head_number, head_size].
+// The queries and keys are processed in blocks that stay in cache with an
+// online softmax, which rescales the partial sums when the running max of a
+// row grows, so the [seq_len, seq_len] scores are never materialized. The
+// blocks of all the batches and heads are run by the intra-op threads.
+void MultiHeadAttention(const CPUContext& dev_ctx,
+                        int batch,
+                        int seq_len,
+                        int head_number,
+                        int head_size,
+                        const float* qkv,
+                        const float* mask,
+                        const DDim& mask_dims,
+                        float scale,
+                        float* out);
+
+}  // namespace funcs
+}  // namespace phi
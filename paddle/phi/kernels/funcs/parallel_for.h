@@ -0,0 +1,87 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+
+namespace phi {
+namespace funcs {
+
+// Rough cycles to process one element, used as cost_per_unit of ParallelFor.
+constexpr double kElementwiseCostPerUnit = 1.0;
+constexpr double kBroadcastCostPerUnit = 8.0;
+
+namespace detail {
+
+template <typename Context, typename Function>
+inline void ParallelForImpl(const Context& dev_ctx,
+                            int64_t n,
+                            double cost_per_unit,
+                            Function&& func,
+                            std::true_type) {
+  static_cast<const phi::CPUContext&>(dev_ctx).ParallelFor(
+      n, cost_per_unit, std::forward<Function>(func));
+}
+
+template <typename Context, typename Function>
+inline void ParallelForImpl(const Context& dev_ctx,
+                            int64_t n,
+                            double cost_per_unit,
+                            Function&& func,
+                            std::false_type) {
+  if (n > 0) {
+    func(0, n);
+  }
+}
+
+template <typename Context>
+inline int NumThreadsImpl(const Context& dev_ctx, std::true_type) {
+  return static_cast<const phi::CPUContext&>(dev_ctx).GetNumThreads();
+}
+
+template <typename Context>
+inline int NumThreadsImpl(const Context& dev_ctx, std::false_type) {
+  return 1;
+}
+
+}  // namespace detail
+
+// Call func(begin, end) on disjoint ranges which cover [0, n). The ranges are
+// run by the intra-op threads of a CPUContext (including the fluid
+// CPUDeviceContext), other contexts get a single func(0, n) on the calling
+// thread, so device code can share the same host-side loop.
+template <typename Context, typename Function>
+inline void ParallelFor(const Context& dev_ctx,
+                        int64_t n,
+                        double cost_per_unit,
+                        Function&& func) {
+  using IsCPUContext = typename std::is_base_of<phi::CPUContext, Context>::type;
+  detail::ParallelForImpl(
+      dev_ctx, n, cost_per_unit, std::forward<Function>(func), IsCPUContext());
+}
+
+// The number of threads ParallelFor may split the ranges among.
+template <typename Context>
+inline int NumThreads(const Context& dev_ctx) {
+  using IsCPUContext = typename std::is_base_of<phi::CPUContext, Context>::type;
+  return detail::NumThreadsImpl(dev_ctx, IsCPUContext());
+}
+
+}  // namespace funcs
+}  // namespace phi
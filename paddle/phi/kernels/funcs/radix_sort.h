@@ -0,0 +1,461 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/funcs/parallel_for.h"
+
+namespace phi {
+namespace funcs {
+
+// RadixKey<T>::Get maps a value to an unsigned key which compares as the
+// value does. -0 is mapped as 0, and all the NaNs are mapped to the largest
+// key, so they come last in the ascending order and first in the descending
+// order, as the comparators of sort and top_k put them.
+template <typename T, typename Enable = void>
+struct RadixKey;
+
+template <typename T>
+struct RadixKey<
+    T,
+    typename std::enable_if<std::is_floating_point<T>::value>::type> {
+  using Type = typename std::
+      conditional<sizeof(T) == sizeof(uint32_t), uint32_t, uint64_t>::type;
+  static_assert(sizeof(T) == sizeof(Type), "float or double is expected");
+
+  static Type Get(T value) {
+    constexpr Type kSignBit = Type(1) << (sizeof(Type) * 8 - 1);
+    if (std::isnan(value)) {
+      return ~Type(0);
+    }
+    if (value == 0) {
+      value = 0;
+    }
+    Type bits;
+    std::memcpy(&bits, &value, sizeof(T));
+    return (bits & kSignBit) ? ~bits : (bits | kSignBit);
+  }
+};
+
+template <typename T>
+struct RadixKey<T,
+                typename std::enable_if<std::is_integral<T>::value &&
+                                        std::is_signed<T>::value>::type> {
+  using Type = typename std::make_unsigned<T>::type;
+
+  static Type Get(T value) {
+    constexpr Type kSignBit = Type(1) << (sizeof(Type) * 8 - 1);
+    return static_cast<Type>(value) ^ kSignBit;
+  }
+};
+
+// The keys are sorted 8 bits per pass.
+constexpr int kRadixBits = 8;
+constexpr int kRadixBuckets = 1 << kRadixBits;
+// Shorter sequences are sorted by insertion.
+constexpr int64_t kRadixSortMinSize = 32;
+// Shorter rows of top_k are selected by std::nth_element.
+constexpr int64_t kRadixSelectMinSize = 1024;
+// A row is split into chunks of at least kRadixChunkSize elements, sorted
+// by all the threads, when there are fewer rows than the threads.
+constexpr int64_t kRadixChunkSize = 1 << 16;
+
+namespace detail {
+
+// fn(c) for the chunks c in [0, num_chunks), by the intra-op threads if
+// there is more than one chunk.
+template <typename Function>
+void ForEachChunk(const CPUContext& dev_ctx,
+                  int64_t num_chunks,
+                  const Function& fn) {
+  if (num_chunks == 1) {
+    fn(0);
+    return;
+  }
+  ParallelFor(dev_ctx,
+              num_chunks,
+              static_cast<double>(kRadixChunkSize),
+              [&](int64_t begin, int64_t end) {
+                for (int64_t c = begin; c < end; ++c) {
+                  fn(c);
+                }
+              });
+}
+
+inline int64_t NumChunks(const CPUContext& dev_ctx,
+                         int64_t height,
+                         int64_t width) {
+  const int64_t threads = dev_ctx.GetNumThreads();
+  if (height >= threads) {
+    return 1;
+  }
+  return std::max<int64_t>(1, std::min(threads, width / kRadixChunkSize));
+}
+
+template <typename KeyT, typename IndexT>
+void InsertionSortPairs(KeyT* keys, IndexT* indices, int64_t n) {
+  for (int64_t i = 1; i < n; ++i) {
+    const KeyT key = keys[i];
+    const IndexT index = indices[i];
+    int64_t j = i;
+    for (; j > 0 && keys[j - 1] > key; --j) {
+      keys[j] = keys[j - 1];
+      indices[j] = indices[j - 1];
+    }
+    keys[j] = key;
+    indices[j] = index;
+  }
+}
+
+}  // namespace detail
+
+// Sorts n keys in ascending order and moves the indices with them. The sort
+// is a stable LSD radix sort, the equal keys keep their order. keys_buf and
+// indices_buf are the scratch of n elements. With num_chunks > 1 every pass
+// is split into chunks run by the intra-op threads, each chunk scatters to
+// the offsets given by the prefix sums of the chunk histograms.
+template <typename KeyT, typename IndexT>
+void RadixSortPairs(const CPUContext& dev_ctx,
+                    KeyT* keys,
+                    IndexT* indices,
+                    KeyT* keys_buf,
+                    IndexT* indices_buf,
+                    int64_t n,
+                    int64_t num_chunks = 1) {
+  if (n <= kRadixSortMinSize) {
+    detail::InsertionSortPairs(keys, indices, n);
+    return;
+  }
+  num_chunks = std::max<int64_t>(1, std::min(num_chunks, n));
+  const int64_t chunk_size = (n + num_chunks - 1) / num_chunks;
+  std::vector<int64_t> hist(num_chunks * kRadixBuckets);
+
+  KeyT* src_keys = keys;
+  IndexT* src_indices = indices;
+  KeyT* dst_keys = keys_buf;
+  IndexT* dst_indices = indices_buf;
+  for (int shift = 0; shift < static_cast<int>(sizeof(KeyT) * 8);
+       shift += kRadixBits) {
+    detail::ForEachChunk(dev_ctx, num_chunks, [&](int64_t c) {
+      int64_t* h = hist.data() + c * kRadixBuckets;
+      std::fill(h, h + kRadixBuckets, 0);
+      const int64_t end = std::min(n, (c + 1) * chunk_size);
+      for (int64_t i = c * chunk_size; i < end; ++i) {
+        ++h[(src_keys[i] >> shift) & (kRadixBuckets - 1)];
+      }
+    });
+
+    // the digit shared by all the keys does not move them
+    bool same_digit = false;
+    for (int d = 0; d < kRadixBuckets && !same_digit; ++d) {
+      int64_t total = 0;
+      for (int64_t c = 0; c < num_chunks; ++c) {
+        total += hist[c * kRadixBuckets + d];
+      }
+      same_digit = total == n;
+    }
+    if (same_digit) {
+      continue;
+    }
+
+    int64_t offset = 0;
+    for (int d = 0; d < kRadixBuckets; ++d) {
+      for (int64_t c = 0; c < num_chunks; ++c) {
+        const int64_t count = hist[c * kRadixBuckets + d];
+        hist[c * kRadixBuckets + d] = offset;
+        offset += count;
+      }
+    }
+    detail::ForEachChunk(dev_ctx, num_chunks, [&](int64_t c) {
+      int64_t* h = hist.data() + c * kRadixBuckets;
+      const int64_t end = std::min(n, (c + 1) * chunk_size);
+      for (int64_t i = c * chunk_size; i < end; ++i) {
+        const int64_t pos = h[(src_keys[i] >> shift) & (kRadixBuckets - 1)]++;
+        dst_keys[pos] = src_keys[i];
+        dst_indices[pos] = src_indices[i];
+      }
+    });
+    std::swap(src_keys, dst_keys);
+    std::swap(src_indices, dst_indices);
+  }
+  if (src_keys != keys) {
+    std::memcpy(keys, src_keys, n * sizeof(KeyT));
+    std::memcpy(indices, src_indices, n * sizeof(IndexT));
+  }
+}
+
+// Sorts every row of x [height, width] into out and the positions of the
+// sorted values in the row into indices. The equal values keep their order.
+// The rows are partitioned among the intra-op threads, a single large row
+// is sorted by all of them.
+template <typename T, typename IndexT>
+void ArgsortRows(const CPUContext& dev_ctx,
+                 const T* x,
+                 int64_t height,
+                 int64_t width,
+                 bool descending,
+                 T* out,
+                 IndexT* indices) {
+  using KeyT = typename RadixKey<T>::Type;
+  const int64_t num_chunks = detail::NumChunks(dev_ctx, height, width);
+  const int64_t chunk_size = (width + num_chunks - 1) / num_chunks;
+  const KeyT flip = descending ? ~KeyT(0) : KeyT(0);
+
+  auto sort_rows = [&](int64_t begin, int64_t end) {
+    std::vector<KeyT> keys(width);
+    std::vector<KeyT> keys_buf(width);
+    std::vector<IndexT> indices_buf(width);
+    for (int64_t row = begin; row < end; ++row) {
+      const T* row_x = x + row * width;
+      T* row_out = out + row * width;
+      IndexT* row_indices = indices + row * width;
+      detail::ForEachChunk(dev_ctx, num_chunks, [&](int64_t c) {
+        const int64_t end = std::min(width, (c + 1) * chunk_size);
+        for (int64_t j = c * chunk_size; j < end; ++j) {
+          keys[j] = RadixKey<T>::Get(row_x[j]) ^ flip;
+          row_indices[j] = static_cast<IndexT>(j);
+        }
+      });
+      RadixSortPairs(dev_ctx,
+                     keys.data(),
+                     row_indices,
+                     keys_buf.data(),
+                     indices_buf.data(),
+                     width,
+                     num_chunks);
+      detail::ForEachChunk(dev_ctx, num_chunks, [&](int64_t c) {
+        const int64_t end = std::min(width, (c + 1) * chunk_size);
+        for (int64_t j = c * chunk_size; j < end; ++j) {
+          row_out[j] = row_x[row_indices[j]];
+        }
+      });
+    }
+  };
+  if (num_chunks > 1) {
+    sort_rows(0, height);
+  } else {
+    ParallelFor(dev_ctx,
+                height,
+                static_cast<double>(width) * sizeof(KeyT) * 2,
+                sort_rows);
+  }
+}
+
+// The k largest (or smallest) values of every row of x [height, width] and
+// their positions in the row, the results of a row are [k] in out and
+// indices, sorted if sorted is true, and in the order of the row otherwise.
+// Among the equal values the first ones of the row are taken.
+//
+// The k-th key is found by an MSD radix select: a histogram of the top 8
+// bits of the keys picks the bucket holding the k-th key, only the keys of
+// that bucket are kept for the next 8 bits, and so on. Then one pass takes
+// the keys below the k-th key and the first equal ones.
+template <typename T, typename IndexT>
+void TopkRows(const CPUContext& dev_ctx,
+              const T* x,
+              int64_t height,
+              int64_t width,
+              int64_t k,
+              bool largest,
+              bool sorted,
+              T* out,
+              IndexT* indices) {
+  using KeyT = typename RadixKey<T>::Type;
+  if (k <= 0) {
+    return;
+  }
+  const int64_t num_chunks = detail::NumChunks(dev_ctx, height, width);
+  const int64_t chunk_size = (width + num_chunks - 1) / num_chunks;
+  // the k smallest keys are selected
+  const KeyT flip = largest ? ~KeyT(0) : KeyT(0);
+  auto key_of = [&](const T* row_x, int64_t j) {
+    return RadixKey<T>::Get(row_x[j]) ^ flip;
+  };
+
+  auto select_rows = [&](int64_t begin, int64_t end) {
+    std::vector<KeyT> candidates;
+    std::vector<KeyT> keys(k);
+    std::vector<KeyT> keys_buf(k);
+    std::vector<IndexT> indices_buf(k);
+    std::vector<int64_t> hist(num_chunks * kRadixBuckets);
+    std::vector<int64_t> less(num_chunks);
+    std::vector<int64_t> equal(num_chunks);
+    for (int64_t row = begin; row < end; ++row) {
+      const T* row_x = x + row * width;
+      T* row_out = out + row * k;
+      IndexT* row_indices = indices + row * k;
+
+      if (width < kRadixSelectMinSize) {
+        std::vector<std::pair<KeyT, int64_t>> pairs(width);
+        for (int64_t j = 0; j < width; ++j) {
+          pairs[j] = std::make_pair(key_of(row_x, j), j);
+        }
+        if (k < width) {
+          std::nth_element(pairs.begin(), pairs.begin() + k - 1, pairs.end());
+        }
+        if (sorted) {
+          std::sort(pairs.begin(), pairs.begin() + k);
+        } else {
+          std::sort(pairs.begin(),
+                    pairs.begin() + k,
+                    [](const std::pair<KeyT, int64_t>& l,
+                       const std::pair<KeyT, int64_t>& r) {
+                      return l.second < r.second;
+                    });
+        }
+        for (int64_t j = 0; j < k; ++j) {
+          row_out[j] = row_x[pairs[j].second];
+          row_indices[j] = static_cast<IndexT>(pairs[j].second);
+        }
+        continue;
+      }
+
+      // the top digit over the row, by chunks
+      int shift = static_cast<int>(sizeof(KeyT) * 8) - kRadixBits;
+      detail::ForEachChunk(dev_ctx, num_chunks, [&](int64_t c) {
+        int64_t* h = hist.data() + c * kRadixBuckets;
+        std::fill(h, h + kRadixBuckets, 0);
+        const int64_t end = std::min(width, (c + 1) * chunk_size);
+        for (int64_t j = c * chunk_size; j < end; ++j) {
+          ++h[key_of(row_x, j) >> shift];
+        }
+      });
+      // rank is the rank of the k-th key among the keys of its bucket
+      int64_t rank = k;
+      int bucket = 0;
+      for (;; ++bucket) {
+        int64_t total = 0;
+        for (int64_t c = 0; c < num_chunks; ++c) {
+          total += hist[c * kRadixBuckets + bucket];
+        }
+        if (rank <= total) {
+          break;
+        }
+        rank -= total;
+      }
+      KeyT kth = static_cast<KeyT>(bucket) << shift;
+
+      // the keys of the bucket, then the next digits over them
+      int64_t num_candidates = 0;
+      for (int64_t c = 0; c < num_chunks; ++c) {
+        const int64_t count = hist[c * kRadixBuckets + bucket];
+        hist[c * kRadixBuckets + bucket] = num_candidates;
+        num_candidates += count;
+      }
+      candidates.resize(num_candidates);
+      detail::ForEachChunk(dev_ctx, num_chunks, [&](int64_t c) {
+        int64_t pos = hist[c * kRadixBuckets + bucket];
+        const int64_t end = std::min(width, (c + 1) * chunk_size);
+        for (int64_t j = c * chunk_size; j < end; ++j) {
+          const KeyT key = key_of(row_x, j);
+          if ((key >> shift) == static_cast<KeyT>(bucket)) {
+            candidates[pos++] = key;
+          }
+        }
+      });
+      while (shift > 0 && num_candidates > 1) {
+        shift -= kRadixBits;
+        int64_t* h = hist.data();
+        std::fill(h, h + kRadixBuckets, 0);
+        for (int64_t i = 0; i < num_candidates; ++i) {
+          ++h[(candidates[i] >> shift) & (kRadixBuckets - 1)];
+        }
+        for (bucket = 0; rank > h[bucket]; ++bucket) {
+          rank -= h[bucket];
+        }
+        kth |= static_cast<KeyT>(bucket) << shift;
+        int64_t kept = 0;
+        for (int64_t i = 0; i < num_candidates; ++i) {
+          if (((candidates[i] >> shift) & (kRadixBuckets - 1)) ==
+              static_cast<KeyT>(bucket)) {
+            candidates[kept++] = candidates[i];
+          }
+        }
+        num_candidates = kept;
+      }
+      if (num_candidates == 1) {
+        kth = candidates[0];
+      }
+
+      // k - rank keys are less than kth, and the first rank equal ones are
+      // taken, the chunks write at the offsets of their counts
+      detail::ForEachChunk(dev_ctx, num_chunks, [&](int64_t c) {
+        less[c] = 0;
+        equal[c] = 0;
+        const int64_t end = std::min(width, (c + 1) * chunk_size);
+        for (int64_t j = c * chunk_size; j < end; ++j) {
+          const KeyT key = key_of(row_x, j);
+          less[c] += key < kth;
+          equal[c] += key == kth;
+        }
+      });
+      int64_t offset = 0;
+      int64_t equal_left = rank;
+      for (int64_t c = 0; c < num_chunks; ++c) {
+        equal[c] = std::min(equal[c], equal_left);
+        equal_left -= equal[c];
+        const int64_t count = less[c] + equal[c];
+        less[c] = offset;
+        offset += count;
+      }
+      // less[c] is the offset of chunk c, equal[c] its equal keys to take
+      detail::ForEachChunk(dev_ctx, num_chunks, [&](int64_t c) {
+        int64_t pos = less[c];
+        int64_t equal_taken = 0;
+        const int64_t end = std::min(width, (c + 1) * chunk_size);
+        for (int64_t j = c * chunk_size; j < end; ++j) {
+          const KeyT key = key_of(row_x, j);
+          if (key < kth || (key == kth && equal_taken < equal[c])) {
+            equal_taken += key == kth;
+            keys[pos] = key;
+            row_indices[pos] = static_cast<IndexT>(j);
+            ++pos;
+          }
+        }
+      });
+
+      if (sorted) {
+        RadixSortPairs(dev_ctx,
+                       keys.data(),
+                       row_indices,
+                       keys_buf.data(),
+                       indices_buf.data(),
+                       k);
+      }
+      for (int64_t j = 0; j < k; ++j) {
+        row_out[j] = row_x[row_indices[j]];
+      }
+    }
+  };
+  if (num_chunks > 1) {
+    select_rows(0, height);
+  } else {
+    ParallelFor(dev_ctx,
+                height,
+                static_cast<double>(width) * 2,
+                select_rows);
+  }
+}
+
+}  // namespace funcs
+}  // namespace phi
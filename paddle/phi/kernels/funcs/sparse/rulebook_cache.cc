@@ -0,0 +1,140 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/phi/kernels/funcs/sparse/rulebook_cache.h"
+
+#include <cstring>
+#include <sstream>
+
+#include "gflags/gflags.h"
+
+DECLARE_int32(sparse_conv_rulebook_cache_size);
+
+namespace phi {
+namespace funcs {
+namespace sparse {
+
+namespace {
+
+// FNV-1a over 8 bytes at a time
+uint64_t HashBytes(const uint8_t* data, size_t size) {
+  uint64_t hash = 14695981039346656037ULL;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    hash = (hash ^ word) * 1099511628211ULL;
+  }
+  for (; i < size; ++i) {
+    hash = (hash ^ data[i]) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+size_t IndicesBytes(const DenseTensor& indices) {
+  return static_cast<size_t>(indices.numel()) * SizeOf(indices.dtype());
+}
+
+}  // namespace
+
+RulebookCache& RulebookCache::Instance() {
+  static RulebookCache cache;
+  return cache;
+}
+
+bool RulebookCache::Find(const std::string& key,
+                         const DenseTensor& indices,
+                         RulebookCacheEntry* entry) {
+  if (FLAGS_sparse_conv_rulebook_cache_size <= 0) {
+    return false;
+  }
+  const auto* data = reinterpret_cast<const uint8_t*>(indices.data());
+  const size_t size = IndicesBytes(indices);
+  const uint64_t hash = HashBytes(data, size);
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (auto it = items_.begin(); it != items_.end(); ++it) {
+    if (it->hash != hash || it->dtype != indices.dtype() ||
+        it->indices.size() != size || it->key != key ||
+        std::memcmp(it->indices.data(), data, size) != 0) {
+      continue;
+    }
+    *entry = it->entry;
+    items_.splice(items_.begin(), items_, it);
+    return true;
+  }
+  return false;
+}
+
+void RulebookCache::Insert(const std::string& key,
+                           const DenseTensor& indices,
+                           const RulebookCacheEntry& entry) {
+  const int capacity = FLAGS_sparse_conv_rulebook_cache_size;
+  if (capacity <= 0) {
+    return;
+  }
+  Item item;
+  item.key = key;
+  item.dtype = indices.dtype();
+  const auto* data = reinterpret_cast<const uint8_t*>(indices.data());
+  item.indices.assign(data, data + IndicesBytes(indices));
+  item.hash = HashBytes(item.indices.data(), item.indices.size());
+  item.entry = entry;
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  items_.push_front(std::move(item));
+  while (items_.size() > static_cast<size_t>(capacity)) {
+    items_.pop_back();
+  }
+}
+
+void RulebookCache::Clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  items_.clear();
+}
+
+size_t RulebookCache::Size() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return items_.size();
+}
+
+std::string MakeRulebookKey(const DDim& x_dims,
+                            const std::vector<int>& kernel_sizes,
+                            const std::vector<int>& paddings,
+                            const std::vector<int>& dilations,
+                            const std::vector<int>& strides,
+                            bool subm) {
+  std::ostringstream os;
+  auto append = [&os](const std::vector<int>& v) {
+    for (int i : v) {
+      os << i << ",";
+    }
+    os << ";";
+  };
+  // the channels of x and the kernel do not change the rulebook
+  for (int i = 0; i < x_dims.size() - 1; ++i) {
+    os << x_dims[i] << ",";
+  }
+  os << ";";
+  append(std::vector<int>(kernel_sizes.begin(), kernel_sizes.begin() + 3));
+  append(paddings);
+  append(dilations);
+  append(strides);
+  os << subm;
+  return os.str();
+}
+
+}  // namespace sparse
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,84 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace phi {
+namespace funcs {
+namespace sparse {
+
+struct RulebookCacheEntry {
+  DenseTensor rulebook;
+  DenseTensor counter;
+  DenseTensor out_indices;
+};
+
+// Keeps the recent rulebooks of the sparse conv kernels. The layers of a
+// sparse network usually share the indices (e.g. a stack of subm convs with
+// activations between them), an entry is found by the geometry of the conv
+// and the content of the input indices, so it does not matter whether the
+// indices tensor itself is shared. It keeps at most
+// FLAGS_sparse_conv_rulebook_cache_size entries and drops the least recently
+// used one first.
+class RulebookCache {
+ public:
+  static RulebookCache& Instance();
+
+  // key describes the geometry, see MakeRulebookKey
+  bool Find(const std::string& key,
+            const DenseTensor& indices,
+            RulebookCacheEntry* entry);
+
+  void Insert(const std::string& key,
+              const DenseTensor& indices,
+              const RulebookCacheEntry& entry);
+
+  void Clear();
+
+  size_t Size() const;
+
+ private:
+  RulebookCache() = default;
+
+  struct Item {
+    std::string key;
+    uint64_t hash;
+    DataType dtype;
+    // a copy of the indices, which may be changed in place by the owner
+    std::vector<uint8_t> indices;
+    RulebookCacheEntry entry;
+  };
+
+  mutable std::mutex mutex_;
+  std::list<Item> items_;  // the most recently used first
+};
+
+std::string MakeRulebookKey(const DDim& x_dims,
+                            const std::vector<int>& kernel_sizes,
+                            const std::vector<int>& paddings,
+                            const std::vector<int>& dilations,
+                            const std::vector<int>& strides,
+                            bool subm);
+
+}  // namespace sparse
+}  // namespace funcs
+}  // namespace phi
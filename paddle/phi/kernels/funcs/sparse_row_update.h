@@ -0,0 +1,158 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/funcs/parallel_for.h"
+#include "paddle/phi/kernels/funcs/radix_sort.h"
+
+namespace phi {
+namespace funcs {
+
+// The rows of a SelectedRows gradient grouped by their row ids, which is
+// what the sparse optimizers need instead of a merged SelectedRows: the
+// duplicated ids of an embedding gradient are summed row by row when the
+// parameter row is updated, and the merged values are never stored.
+//
+// rows holds the unique ids in ascending order, and the gradient rows of
+// rows[g] are order[starts[g]] .. order[starts[g + 1] - 1], in the order
+// they appear in the gradient.
+struct SparseRowGroups {
+  std::vector<int64_t> rows;
+  std::vector<int64_t> starts;
+  std::vector<int64_t> order;
+
+  int64_t size() const { return static_cast<int64_t>(rows.size()); }
+};
+
+// Groups the n gradient rows by id with a stable radix sort. The ids should
+// be in [0, height).
+inline void GroupSparseRows(const CPUContext& dev_ctx,
+                            const int64_t* grad_rows,
+                            int64_t n,
+                            int64_t height,
+                            SparseRowGroups* groups) {
+  bool strict_sorted = true;
+  for (int64_t i = 0; i < n; ++i) {
+    PADDLE_ENFORCE_EQ(
+        grad_rows[i] >= 0 && grad_rows[i] < height,
+        true,
+        errors::OutOfRange("The row %d of the sparse gradient should be in "
+                           "[0, %d), but got %d.",
+                           i,
+                           height,
+                           grad_rows[i]));
+    if (i > 0 && grad_rows[i - 1] >= grad_rows[i]) {
+      strict_sorted = false;
+    }
+  }
+
+  groups->rows.clear();
+  groups->starts.clear();
+  groups->order.resize(n);
+  if (strict_sorted) {
+    groups->rows.assign(grad_rows, grad_rows + n);
+    groups->starts.resize(n + 1);
+    for (int64_t i = 0; i <= n; ++i) {
+      groups->starts[i] = i;
+      if (i < n) {
+        groups->order[i] = i;
+      }
+    }
+    return;
+  }
+
+  std::vector<uint64_t> keys(grad_rows, grad_rows + n);
+  std::vector<uint64_t> keys_buf(n);
+  std::vector<int64_t> order_buf(n);
+  for (int64_t i = 0; i < n; ++i) {
+    groups->order[i] = i;
+  }
+  RadixSortPairs(dev_ctx,
+                 keys.data(),
+                 groups->order.data(),
+                 keys_buf.data(),
+                 order_buf.data(),
+                 n,
+                 detail::NumChunks(dev_ctx, 1, n));
+  for (int64_t i = 0; i < n; ++i) {
+    if (i == 0 || keys[i] != keys[i - 1]) {
+      groups->rows.push_back(static_cast<int64_t>(keys[i]));
+      groups->starts.push_back(i);
+    }
+  }
+  groups->starts.push_back(n);
+}
+
+// The gradient of the parameter row of group g: the gradient row itself if
+// it is not duplicated, otherwise the sum of the duplicates in buffer.
+template <typename T>
+const T* SparseGroupGrad(const SparseRowGroups& groups,
+                         int64_t g,
+                         const T* grad,
+                         int64_t row_numel,
+                         T* buffer) {
+  const int64_t begin = groups.starts[g];
+  const int64_t end = groups.starts[g + 1];
+  const T* first = grad + groups.order[begin] * row_numel;
+  if (end - begin == 1) {
+    return first;
+  }
+  std::copy(first, first + row_numel, buffer);
+  for (int64_t i = begin + 1; i < end; ++i) {
+    const T* row = grad + groups.order[i] * row_numel;
+    for (int64_t j = 0; j < row_numel; ++j) {
+      buffer[j] += row[j];
+    }
+  }
+  return buffer;
+}
+
+// Calls update(row, grad_row) for the parameter rows with a gradient, where
+// grad_row is their summed gradient of row_numel elements. The groups are
+// partitioned among the intra-op threads, and each row is updated by one
+// thread, so update can write the parameter and its moments in place.
+template <typename T, typename Function>
+void ForEachSparseRow(const CPUContext& dev_ctx,
+                      const SparseRowGroups& groups,
+                      const T* grad,
+                      int64_t row_numel,
+                      const Function& update) {
+  const int64_t num_groups = groups.size();
+  if (num_groups == 0) {
+    return;
+  }
+  const double grad_rows_per_group =
+      static_cast<double>(groups.order.size()) / num_groups;
+  ParallelFor(dev_ctx,
+              num_groups,
+              row_numel * (grad_rows_per_group + 4),
+              [&](int64_t begin, int64_t end) {
+                std::vector<T> buffer(row_numel);
+                for (int64_t g = begin; g < end; ++g) {
+                  update(groups.rows[g],
+                         SparseGroupGrad(
+                             groups, g, grad, row_numel, buffer.data()));
+                }
+              });
+}
+
+}  // namespace funcs
+}  // namespace phi
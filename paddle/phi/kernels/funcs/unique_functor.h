@@ -17,10 +17,55 @@
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/kernels/funcs/concat_and_split_functor.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
+#include "paddle/phi/kernels/funcs/radix_sort.h"
 
 namespace phi {
 namespace funcs {
 
+// Groups the equal values of in_data[n] with a stable radix sort, so the
+// groups are flat arrays instead of the nodes of a set or a hash map. sorted
+// holds the positions of the values in ascending order, the positions of
+// group g are sorted[starts[g]] .. sorted[starts[g + 1] - 1], and the first
+// one is the first occurrence of the value. All the NaNs share the largest
+// key, but as NaN != NaN each of them is a group of its own, as in a hash
+// map of the values.
+template <typename Context, typename InT>
+static void SortedGroups(const Context& context,
+                         const InT* in_data,
+                         int64_t n,
+                         std::vector<int64_t>* sorted,
+                         std::vector<int64_t>* starts) {
+  using KeyT = typename RadixKey<InT>::Type;
+  std::vector<KeyT> keys(n);
+  std::vector<KeyT> keys_buf(n);
+  std::vector<int64_t> sorted_buf(n);
+  sorted->resize(n);
+  ParallelFor(context,
+              n,
+              kElementwiseCostPerUnit,
+              [&](int64_t begin, int64_t end) {
+                for (int64_t i = begin; i < end; ++i) {
+                  keys[i] = RadixKey<InT>::Get(in_data[i]);
+                  (*sorted)[i] = i;
+                }
+              });
+  RadixSortPairs(context,
+                 keys.data(),
+                 sorted->data(),
+                 keys_buf.data(),
+                 sorted_buf.data(),
+                 n,
+                 detail::NumChunks(context, 1, n));
+  starts->clear();
+  for (int64_t i = 0; i < n; ++i) {
+    if (i == 0 || keys[i] != keys[i - 1] ||
+        in_data[(*sorted)[i]] != in_data[(*sorted)[i - 1]]) {
+      starts->push_back(i);
+    }
+  }
+  starts->push_back(n);
+}
+
 template <typename Context, typename InT>
 struct UniqueOpFunctor {
   const Context& context_;
@@ -41,12 +86,6 @@ struct UniqueOpFunctor {
     auto* in_data = in_->data<InT>();
     auto* index_data = context_.template Alloc<IndexT>(index_);
 
-    int64_t j = 0;
-
-    // TODO(fangzeyang): Should optimize performance here.
-    std::unordered_map<InT, int64_t> dict;
-    std::vector<InT> uniq;
-
     PADDLE_ENFORCE_LT(
         in_->numel(),
         pow(2, 31),
@@ -55,24 +94,37 @@ struct UniqueOpFunctor {
             "but received num is %d.",
             in_->numel()));
 
-    for (auto i = 0; i < in_->numel(); i++) {
-      auto it = dict.find(in_data[i]);
-      if (it == dict.end()) {
-        dict.emplace(std::make_pair(in_data[i], j));
-        uniq.emplace_back(in_data[i]);
-        index_data[i] = static_cast<IndexT>(j);
-        j++;
-      } else {
-        index_data[i] = static_cast<IndexT>(it->second);
+    std::vector<int64_t> sorted;
+    std::vector<int64_t> starts;
+    SortedGroups(context_, in_data, in_->numel(), &sorted, &starts);
+    const int64_t num_unique = static_cast<int64_t>(starts.size()) - 1;
+
+    // the groups in the order of their first occurrences
+    std::vector<uint64_t> first(num_unique);
+    std::vector<uint64_t> first_buf(num_unique);
+    std::vector<int64_t> order(num_unique);
+    std::vector<int64_t> order_buf(num_unique);
+    for (int64_t g = 0; g < num_unique; ++g) {
+      first[g] = sorted[starts[g]];
+      order[g] = g;
+    }
+    RadixSortPairs(context_,
+                   first.data(),
+                   order.data(),
+                   first_buf.data(),
+                   order_buf.data(),
+                   num_unique);
+    for (int64_t j = 0; j < num_unique; ++j) {
+      const int64_t g = order[j];
+      for (int64_t i = starts[g]; i < starts[g + 1]; ++i) {
+        index_data[sorted[i]] = static_cast<IndexT>(j);
       }
     }
 
     if (count_ != nullptr) {
       // Resize the count tensor dims to allocate the memory
-      count_->Resize(phi::make_ddim({static_cast<int64_t>(uniq.size())}));
+      count_->Resize(phi::make_ddim({num_unique}));
       IndexT* count_data = context_.template Alloc<IndexT>(count_);
-      // init count_data to 0
-      memset(count_data, 0, uniq.size() * sizeof(IndexT));
 
       const auto& index_type = index_->dtype();
       bool index_type_match =
@@ -90,22 +142,17 @@ struct UniqueOpFunctor {
               paddle::framework::DataTypeToString(
                   paddle::framework::TransToProtoVarType(DataType::INT64))));
 
-      if (index_type == DataType::INT32) {
-        for (auto i = 0; i < in_->numel(); ++i) {
-          const IndexT& index = index_data[i];
-          count_data[static_cast<int32_t>(index)] += static_cast<IndexT>(1);
-        }
-      } else {
-        for (auto i = 0; i < in_->numel(); ++i) {
-          const IndexT& index = index_data[i];
-          count_data[static_cast<int64_t>(index)] += static_cast<IndexT>(1);
-        }
+      for (int64_t j = 0; j < num_unique; ++j) {
+        const int64_t g = order[j];
+        count_data[j] = static_cast<IndexT>(starts[g + 1] - starts[g]);
       }
     }
 
-    out_->Resize(phi::make_ddim({static_cast<int64_t>(uniq.size())}));
+    out_->Resize(phi::make_ddim({num_unique}));
     auto* out_data = context_.template Alloc<InT>(out_);
-    std::memcpy(out_data, uniq.data(), uniq.size() * sizeof(InT));
+    for (int64_t j = 0; j < num_unique; ++j) {
+      out_data[j] = in_data[first[j]];
+    }
   }
 };
 
@@ -142,51 +189,40 @@ static void UniqueFlattendTensor(const Context& context,
                                  bool return_inverse,
                                  bool return_counts) {
   const InT* in_data = in.data<InT>();
-  std::set<InT> unique(in_data, in_data + in.numel());
-  out->Resize(phi::make_ddim({static_cast<int64_t>(unique.size())}));
+  std::vector<int64_t> sorted;
+  std::vector<int64_t> starts;
+  SortedGroups(context, in_data, in.numel(), &sorted, &starts);
+  const int64_t num_unique = static_cast<int64_t>(starts.size()) - 1;
+
+  out->Resize(phi::make_ddim({num_unique}));
   auto* out_data = context.template Alloc<InT>(out);
-  std::copy(unique.begin(), unique.end(), out_data);
+  for (int64_t g = 0; g < num_unique; ++g) {
+    out_data[g] = in_data[sorted[starts[g]]];
+  }
 
   if (return_index) {
-    indices->Resize(phi::make_ddim({out->numel()}));
+    indices->Resize(phi::make_ddim({num_unique}));
     auto indices_data = context.template Alloc<IndexT>(indices);
-    std::unordered_map<InT, IndexT> indices_map;
-    indices_map.reserve(out->numel());
-    for (int64_t i = 0; i < in.numel(); ++i) {
-      if (indices_map.find(in_data[i]) != indices_map.end()) continue;
-      indices_map[in_data[i]] = i;
-    }
-    for (int64_t i = 0; i < out->numel(); ++i) {
-      indices_data[i] = indices_map[out_data[i]];
+    for (int64_t g = 0; g < num_unique; ++g) {
+      indices_data[g] = static_cast<IndexT>(sorted[starts[g]]);
     }
   }
 
   if (return_inverse) {
     index->Resize(phi::make_ddim({in.numel()}));
     auto inverse_data = context.template Alloc<IndexT>(index);
-    std::unordered_map<InT, IndexT> inverse_map;
-    inverse_map.reserve(out->numel());
-    for (int64_t i = 0; i < out->numel(); ++i) {
-      inverse_map[out_data[i]] = i;
-    }
-    for (int64_t i = 0; i < in.numel(); ++i) {
-      inverse_data[i] = inverse_map[in_data[i]];
+    for (int64_t g = 0; g < num_unique; ++g) {
+      for (int64_t i = starts[g]; i < starts[g + 1]; ++i) {
+        inverse_data[sorted[i]] = static_cast<IndexT>(g);
+      }
     }
   }
 
   if (return_counts) {
-    count->Resize(phi::make_ddim({out->numel()}));
+    count->Resize(phi::make_ddim({num_unique}));
     auto count_data = context.template Alloc<IndexT>(count);
-    std::unordered_map<InT, IndexT> counts_map;
-    counts_map.reserve(out->numel());
-    for (int64_t i = 0; i < out->numel(); ++i) {
-      counts_map[out_data[i]] = 0;
-    }
-    for (int64_t i = 0; i < in.numel(); i++) {
-      counts_map[in_data[i]] += 1;
-    }
-    for (int64_t i = 0; i < out->numel(); i++) {
-      count_data[i] = counts_map[out_data[i]];
+    for (int64_t g = 0; g < num_unique; ++g) {
+      count_data[g] = static_cast<IndexT>(starts[g + 1] - starts[g]);
     }
   }
 }
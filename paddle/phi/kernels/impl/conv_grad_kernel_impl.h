@@ -20,6 +20,7 @@
 #include "paddle/phi/kernels/cpu/conv_util.h"
 #include "paddle/phi/kernels/funcs/batch_norm_utils.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/conv_cpu_engine.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
 
 namespace phi {
@@ -135,6 +136,8 @@ void ConvGradKernel(const Context& dev_ctx,
 
   phi::funcs::SetConstant<Context, T> set_zero;
   auto blas = phi::funcs::GetBlas<Context, T>(dev_ctx);
+  // Winograd or depthwise algorithm selected by the shape
+  phi::funcs::ConvFastFunctor<Context, T> conv_fast;
 
   if (input_grad) {
     dev_ctx.template Alloc<T>(input_grad);
@@ -146,53 +149,62 @@ void ConvGradKernel(const Context& dev_ctx,
     } else {
       transformed_input_grad = *input_grad;
     }
-    // if is_expand is false, the operation of set_zero is unnecessary,
-    // because math::matmul will reset input_grad.
-    if (is_expand) {
-      set_zero(dev_ctx, &transformed_input_grad, static_cast<T>(0));
-    }
-    paddle::operators::math::Col2VolFunctor<Context, T> col2vol;
-    paddle::operators::math::
-        Col2ImFunctor<paddle::operators::math::ColFormat::kCFO, Context, T>
-            col2im;
-
-    for (int i = 0; i < batch_size; i++) {
-      DenseTensor out_grad_batch =
-          transformed_output_grad.Slice(i, i + 1).Resize(output_matrix_shape);
-      DenseTensor in_grad_batch =
-          transformed_input_grad.Slice(i, i + 1).Resize(input_shape);
-      for (int g = 0; g < groups; g++) {
-        // gemm
-        DenseTensor out_grad_slice =
-            out_grad_batch.Slice(g * out_step, (g + 1) * out_step);
-        DenseTensor filter_slice =
-            filter.Slice(g * out_step, (g + 1) * out_step);
-
-        DenseTensor in_grad_slice =
-            in_grad_batch.Slice(g * in_step, (g + 1) * in_step);
-
-        if (!is_expand) {
-          col_matrix.ShareDataWith(in_grad_slice);
-          col_matrix.Resize(col_matrix_shape);
-        }
-        blas.MatMul(filter_slice,
-                    true,
-                    out_grad_slice,
-                    false,
-                    T(1.0),
-                    &col_matrix,
-                    T(0.0));
-
-        if (is_expand && data_dim == 2U) {
-          col2im(dev_ctx,
-                 col,
-                 dilations,
-                 strides,
-                 std::vector<int>{
-                     paddings[0], paddings[2], paddings[1], paddings[3]},
-                 &in_grad_slice);
-        } else if (is_expand && data_dim == 3U) {
-          col2vol(dev_ctx, col, dilations, strides, paddings, &in_grad_slice);
+    if (!conv_fast.GradInput(dev_ctx,
+                             filter_t,
+                             transformed_output_grad,
+                             strides,
+                             paddings,
+                             dilations,
+                             groups,
+                             &transformed_input_grad)) {
+      // if is_expand is false, the operation of set_zero is unnecessary,
+      // because math::matmul will reset input_grad.
+      if (is_expand) {
+        set_zero(dev_ctx, &transformed_input_grad, static_cast<T>(0));
+      }
+      paddle::operators::math::Col2VolFunctor<Context, T> col2vol;
+      paddle::operators::math::
+          Col2ImFunctor<paddle::operators::math::ColFormat::kCFO, Context, T>
+              col2im;
+
+      for (int i = 0; i < batch_size; i++) {
+        DenseTensor out_grad_batch =
+            transformed_output_grad.Slice(i, i + 1).Resize(output_matrix_shape);
+        DenseTensor in_grad_batch =
+            transformed_input_grad.Slice(i, i + 1).Resize(input_shape);
+        for (int g = 0; g < groups; g++) {
+          // gemm
+          DenseTensor out_grad_slice =
+              out_grad_batch.Slice(g * out_step, (g + 1) * out_step);
+          DenseTensor filter_slice =
+              filter.Slice(g * out_step, (g + 1) * out_step);
+
+          DenseTensor in_grad_slice =
+              in_grad_batch.Slice(g * in_step, (g + 1) * in_step);
+
+          if (!is_expand) {
+            col_matrix.ShareDataWith(in_grad_slice);
+            col_matrix.Resize(col_matrix_shape);
+          }
+          blas.MatMul(filter_slice,
+                      true,
+                      out_grad_slice,
+                      false,
+                      T(1.0),
+                      &col_matrix,
+                      T(0.0));
+
+          if (is_expand && data_dim == 2U) {
+            col2im(dev_ctx,
+                   col,
+                   dilations,
+                   strides,
+                   std::vector<int>{
+                       paddings[0], paddings[2], paddings[1], paddings[3]},
+                   &in_grad_slice);
+          } else if (is_expand && data_dim == 3U) {
+            col2vol(dev_ctx, col, dilations, strides, paddings, &in_grad_slice);
+          }
         }
       }
     }
@@ -204,6 +216,16 @@ void ConvGradKernel(const Context& dev_ctx,
 
   if (filter_grad) {
     dev_ctx.template Alloc<T>(filter_grad);
+    if (conv_fast.GradFilter(dev_ctx,
+                             transformed_input,
+                             transformed_output_grad,
+                             strides,
+                             paddings,
+                             dilations,
+                             groups,
+                             filter_grad)) {
+      return;
+    }
     Tensor filter_grad_ = *filter_grad;
     filter_grad_.Resize(filter_matrix_shape);
     set_zero(dev_ctx, filter_grad, static_cast<T>(0));
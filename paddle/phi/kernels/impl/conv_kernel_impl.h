@@ -20,6 +20,7 @@
 #include "paddle/phi/kernels/cpu/conv_util.h"
 #include "paddle/phi/kernels/funcs/batch_norm_utils.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/conv_cpu_engine.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
 
 namespace phi {
@@ -73,107 +74,128 @@ void ConvKernel(const Context& dev_ctx,
   UpdatePaddingAndDilation(
       &paddings, &dilations, padding_algorithm, in_data_dims, strides, ksize);
 
-  const int batch_size = static_cast<int>(transformed_input.dims()[0]);
-
-  // filter_shape_vec:
-  // {k_o, k_i, k_h, k_w} or {k_o, k_i, k_d, k_h, k_w}
-  std::vector<int64_t> filter_shape_vec(vectorize(filter.dims()));
-
-  // output_shape_vec:
-  // {o_n, o_c, o_h, o_w} or {o_n, o_c, o_d, o_h, o_w}
-  std::vector<int64_t> output_shape_vec(vectorize(transformed_output.dims()));
-
-  // use col_shape in the im2col calculation
-  // col_shape_vec:
-  // {i_c/g, k_h, k_w, o_h, o_w} or {i_c/g, k_d, k_h, k_w,
-  // o_d,o_h, o_w}
-  size_t data_dim = filter_shape_vec.size() - 2;
-
-  std::vector<int64_t> col_shape_vec(1 + 2 * data_dim);
-  col_shape_vec[0] = trans_in_dims[1] / groups;
-  for (size_t j = 0; j < data_dim; ++j) {
-    col_shape_vec[j + 1] = filter_shape_vec[j + 2];
-    col_shape_vec[j + 1 + data_dim] = output_shape_vec[j + 2];
-  }
-
-  DDim col_shape(make_ddim(col_shape_vec));
-
-  // use col_matrix_shape in the gemm calculation
-  // size:
-  // (i_c/g * k_h * k_w, o_h * o_w) or (i_c/g * k_d * k_h * k_w, o_d * o_h *
-  // o_w)
-
-  DDim col_matrix_shape = flatten_to_2d(col_shape, data_dim);
+  // convolution operator: im2col(or vol2col) + gemm
+  auto im2col_gemm = [&]() {
+    const int batch_size = static_cast<int>(transformed_input.dims()[0]);
+
+    // filter_shape_vec:
+    // {k_o, k_i, k_h, k_w} or {k_o, k_i, k_d, k_h, k_w}
+    std::vector<int64_t> filter_shape_vec(vectorize(filter.dims()));
+
+    // output_shape_vec:
+    // {o_n, o_c, o_h, o_w} or {o_n, o_c, o_d, o_h, o_w}
+    std::vector<int64_t> output_shape_vec(vectorize(transformed_output.dims()));
+
+    // use col_shape in the im2col calculation
+    // col_shape_vec:
+    // {i_c/g, k_h, k_w, o_h, o_w} or {i_c/g, k_d, k_h, k_w,
+    // o_d,o_h, o_w}
+    size_t data_dim = filter_shape_vec.size() - 2;
+
+    std::vector<int64_t> col_shape_vec(1 + 2 * data_dim);
+    col_shape_vec[0] = trans_in_dims[1] / groups;
+    for (size_t j = 0; j < data_dim; ++j) {
+      col_shape_vec[j + 1] = filter_shape_vec[j + 2];
+      col_shape_vec[j + 1 + data_dim] = output_shape_vec[j + 2];
+    }
 
-  bool is_expand = IsExpand(filter_shape_vec, strides, paddings, dilations);
+    DDim col_shape(make_ddim(col_shape_vec));
 
-  DenseTensor col;
-  // col_matrix shares the same piece of data with col,
-  // but will be reshaped into a two-dimensional matrix shape
-  // to call the matrix multiplication interface.
-  DenseTensor col_matrix;
-  if (is_expand) {
-    // col = context.AllocateTmpTensor<T, DeviceContext>(col_shape, dev_ctx);
-    col.Resize(col_shape);
-    dev_ctx.template Alloc<T>(&col);
-    col_matrix.ShareDataWith(col);
-    col_matrix.Resize(col_matrix_shape);
-  }
+    // use col_matrix_shape in the gemm calculation
+    // size:
+    // (i_c/g * k_h * k_w, o_h * o_w) or (i_c/g * k_d * k_h * k_w, o_d * o_h *
+    // o_w)
 
-  DDim in_matrix_shape =
-      slice_ddim(transformed_input.dims(), 1, transformed_input.dims().size());
+    DDim col_matrix_shape = flatten_to_2d(col_shape, data_dim);
 
-  DDim filter_matrix_shape = {filter.dims()[0],
-                              filter.numel() / filter.dims()[0]};
-  filter.Resize(filter_matrix_shape);
+    bool is_expand = IsExpand(filter_shape_vec, strides, paddings, dilations);
 
-  DDim output_matrix_shape = {
-      transformed_output.dims()[1],
-      transformed_output.numel() /
-          (transformed_output.dims()[0] * transformed_output.dims()[1])};
+    DenseTensor col;
+    // col_matrix shares the same piece of data with col,
+    // but will be reshaped into a two-dimensional matrix shape
+    // to call the matrix multiplication interface.
+    DenseTensor col_matrix;
+    if (is_expand) {
+      // col = context.AllocateTmpTensor<T, DeviceContext>(col_shape, dev_ctx);
+      col.Resize(col_shape);
+      dev_ctx.template Alloc<T>(&col);
+      col_matrix.ShareDataWith(col);
+      col_matrix.Resize(col_matrix_shape);
+    }
 
-  // convolution operator: im2col(or vol2col) + gemm
-  int in_step = static_cast<int>(transformed_input.dims()[1]) / groups;
-  int out_step = static_cast<int>(transformed_output.dims()[1]) / groups;
-
-  paddle::operators::math::Vol2ColFunctor<Context, T> vol2col;
-  paddle::operators::math::
-      Im2ColFunctor<paddle::operators::math::ColFormat::kCFO, Context, T>
-          im2col;
-
-  auto blas = phi::funcs::GetBlas<Context, T>(dev_ctx);
-  for (int i = 0; i < batch_size; i++) {
-    DenseTensor in_batch =
-        transformed_input.Slice(i, i + 1).Resize(in_matrix_shape);
-    DenseTensor out_batch =
-        transformed_output.Slice(i, i + 1).Resize(output_matrix_shape);
-
-    for (int g = 0; g < groups; g++) {
-      DenseTensor in_slice = in_batch.Slice(g * in_step, (g + 1) * in_step);
-
-      if (!is_expand) {
-        col.ShareDataWith(in_slice);
-        col_matrix.ShareDataWith(col);
-        col_matrix.Resize(col_matrix_shape);
-      } else if (data_dim == 2U) {
-        im2col(dev_ctx,
-               in_slice,
-               dilations,
-               strides,
-               std::vector<int>{
-                   paddings[0], paddings[2], paddings[1], paddings[3]},
-               &col);
-
-      } else if (data_dim == 3U) {
-        vol2col(dev_ctx, in_slice, dilations, strides, paddings, &col);
+    DDim in_matrix_shape = slice_ddim(
+        transformed_input.dims(), 1, transformed_input.dims().size());
+
+    // the filter of the fast algorithms keeps its shape
+    DenseTensor filter_matrix = filter;
+    DDim filter_matrix_shape = {filter.dims()[0],
+                                filter.numel() / filter.dims()[0]};
+    filter_matrix.Resize(filter_matrix_shape);
+
+    DDim output_matrix_shape = {
+        transformed_output.dims()[1],
+        transformed_output.numel() /
+            (transformed_output.dims()[0] * transformed_output.dims()[1])};
+
+    int in_step = static_cast<int>(transformed_input.dims()[1]) / groups;
+    int out_step = static_cast<int>(transformed_output.dims()[1]) / groups;
+
+    paddle::operators::math::Vol2ColFunctor<Context, T> vol2col;
+    paddle::operators::math::
+        Im2ColFunctor<paddle::operators::math::ColFormat::kCFO, Context, T>
+            im2col;
+
+    auto blas = phi::funcs::GetBlas<Context, T>(dev_ctx);
+    for (int i = 0; i < batch_size; i++) {
+      DenseTensor in_batch =
+          transformed_input.Slice(i, i + 1).Resize(in_matrix_shape);
+      DenseTensor out_batch =
+          transformed_output.Slice(i, i + 1).Resize(output_matrix_shape);
+
+      for (int g = 0; g < groups; g++) {
+        DenseTensor in_slice = in_batch.Slice(g * in_step, (g + 1) * in_step);
+
+        if (!is_expand) {
+          col.ShareDataWith(in_slice);
+          col_matrix.ShareDataWith(col);
+          col_matrix.Resize(col_matrix_shape);
+        } else if (data_dim == 2U) {
+          im2col(dev_ctx,
+                 in_slice,
+                 dilations,
+                 strides,
+                 std::vector<int>{
+                     paddings[0], paddings[2], paddings[1], paddings[3]},
+                 &col);
+
+        } else if (data_dim == 3U) {
+          vol2col(dev_ctx, in_slice, dilations, strides, paddings, &col);
+        }
+
+        // gemm
+        DenseTensor out_slice =
+            out_batch.Slice(g * out_step, (g + 1) * out_step);
+        DenseTensor filter_slice =
+            filter_matrix.Slice(g * out_step, (g + 1) * out_step);
+        blas.MatMul(
+            filter_slice, false, col_matrix, false, T(1.0), &out_slice, T(0.0));
       }
-
-      // gemm
-      DenseTensor out_slice = out_batch.Slice(g * out_step, (g + 1) * out_step);
-      DenseTensor filter_slice = filter.Slice(g * out_step, (g + 1) * out_step);
-      blas.MatMul(
-          filter_slice, false, col_matrix, false, T(1.0), &out_slice, T(0.0));
     }
+  };
+
+  // Winograd, direct 1x1 or depthwise algorithm selected by the shape, or
+  // the faster one of it and im2col + gemm under autotune
+  phi::funcs::ConvFastFunctor<Context, T> conv_fast;
+  if (!conv_fast.Forward(dev_ctx,
+                         transformed_input,
+                         filter,
+                         strides,
+                         paddings,
+                         dilations,
+                         groups,
+                         &transformed_output,
+                         im2col_gemm)) {
+    im2col_gemm();
   }
   if (channel_last) {
     TransToChannelLast<Context, T>(dev_ctx, &transformed_output, output);
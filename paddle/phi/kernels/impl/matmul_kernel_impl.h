@@ -17,6 +17,8 @@ limitations under the License. */
 #include "paddle/phi/kernels/funcs/blas/blas.h"
 #include "paddle/phi/kernels/funcs/complex_functors.h"
 
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/common/bfloat16.h"
 #include "paddle/phi/core/dense_tensor.h"
 
 namespace phi {
@@ -85,6 +87,37 @@ static void IndexIncreaseFromDims(const int ndim,
   }
 }
 
+// The CPU has no Blas of bfloat16, its matmul multiplies with
+// funcs::BF16Gemm and returns true. The other contexts and types return false
+// and run the Blas of T.
+template <typename Context, typename T>
+struct MatMulBF16Functor {
+  bool operator()(const Context& dev_ctx,
+                  const DenseTensor& X,
+                  const DenseTensor& Y,
+                  const std::vector<std::int64_t>& x_dims,
+                  const std::vector<std::int64_t>& y_dims,
+                  DenseTensor* Out,
+                  bool trans_x,
+                  bool trans_y,
+                  bool flag) const {
+    return false;
+  }
+};
+
+template <>
+struct MatMulBF16Functor<CPUContext, phi::dtype::bfloat16> {
+  bool operator()(const CPUContext& dev_ctx,
+                  const DenseTensor& X,
+                  const DenseTensor& Y,
+                  const std::vector<std::int64_t>& x_dims,
+                  const std::vector<std::int64_t>& y_dims,
+                  DenseTensor* Out,
+                  bool trans_x,
+                  bool trans_y,
+                  bool flag) const;
+};
+
 template <typename Context, typename T>
 void MatMulFunction(const Context& dev_ctx,
                     const DenseTensor& X,
@@ -95,6 +128,10 @@ void MatMulFunction(const Context& dev_ctx,
                     bool trans_x,
                     bool trans_y,
                     bool flag = false) {
+  if (MatMulBF16Functor<Context, T>()(
+          dev_ctx, X, Y, x_dims, y_dims, Out, trans_x, trans_y, flag)) {
+    return;
+  }
   const int x_ndim = x_dims.size();
   const int y_ndim = y_dims.size();
 
@@ -0,0 +1,46 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/utils/optional.h"
+
+namespace phi {
+
+// The fc / matmul of the int8 inference programs on CPU without oneDNN,
+//   out = activation(dequantize(quantize(x) * quantize(w)) + bias)
+// x is flattened to 2-D by in_num_col_dims and quantized with the step
+// scale_in. w is {K, N} ({N, K} if trans_w), either int8 with scale_weights
+// or float, which is quantized per output channel with scale_weights, or
+// with its maximum absolute values if scale_weights is empty. The float
+// weights are packed at their first use, see PackedInt8WeightCache.
+// padding_weights is the same as the one of the fc op.
+template <typename T, typename Context>
+void QuantLinearKernel(const Context& dev_ctx,
+                       const DenseTensor& x,
+                       const DenseTensor& w,
+                       paddle::optional<const DenseTensor&> bias,
+                       int in_num_col_dims,
+                       bool trans_w,
+                       bool padding_weights,
+                       const std::string& activation_type,
+                       float scale_in,
+                       const std::vector<float>& scale_weights,
+                       DenseTensor* out);
+
+}  // namespace phi
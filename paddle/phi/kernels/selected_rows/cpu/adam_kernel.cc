@@ -14,13 +14,16 @@
 
 #include "paddle/phi/kernels/selected_rows/adam_kernel.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "paddle/fluid/framework/tensor_util.h"
-#include "paddle/fluid/framework/threadpool.h"
-#include "paddle/fluid/operators/math/selected_rows_functor.h"
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/copy_kernel.h"
 #include "paddle/phi/kernels/funcs/adam_functors.h"
+#include "paddle/phi/kernels/funcs/parallel_for.h"
+#include "paddle/phi/kernels/funcs/sparse_row_update.h"
 
 namespace phi {
 namespace sr {
@@ -102,34 +105,16 @@ void AdamDenseParamSparseGradKernel(
     return;
   }
 
-  std::vector<int64_t> cpu_rows(grad.rows().begin(), grad.rows().end());
-  bool is_strict_sorted = true;
-  for (size_t i = 1; i < cpu_rows.size(); ++i) {
-    if (cpu_rows[i - 1] >= cpu_rows[i]) {
-      is_strict_sorted = false;
-      break;
-    }
-  }
-
-  phi::SelectedRows tmp_grad_merge;
-  const phi::SelectedRows* grad_merge_ptr;
-  if (is_strict_sorted) {
-    grad_merge_ptr = &grad;
-  } else {
-    // merge duplicated rows if any.
-    // The rows of grad_merge have been sorted inside MergeAdd functor
-    paddle::operators::math::scatter::MergeAdd<Context, T> merge_func;
-    merge_func(dev_ctx, grad, &tmp_grad_merge, true);
-    grad_merge_ptr = &tmp_grad_merge;
-  }
-
-  auto& grad_merge = *grad_merge_ptr;
-  auto& grad_tensor = grad_merge.value();
-  const T* grad_data = grad_tensor.template data<T>();
-  auto* grad_merge_rows = &grad_merge.rows();
-  paddle::framework::MixVector<int64_t> mixv_grad_merge_rows(grad_merge_rows);
-  const int64_t* rows = mixv_grad_merge_rows.Data(dev_ctx.GetPlace());
-  auto row_numel = grad_tensor.numel() / grad_merge.rows().size();
+  // The duplicated rows of the gradient are summed while their parameter row
+  // is updated, so it is not merged into another SelectedRows.
+  funcs::SparseRowGroups groups;
+  funcs::GroupSparseRows(dev_ctx,
+                         grad.rows().data(),
+                         grad.rows().size(),
+                         param.dims()[0],
+                         &groups);
+  const T* grad_data = grad.value().template data<T>();
+  const int64_t row_numel = grad.value().numel() / grad.rows().size();
 
   funcs::SparseAdamFunctor<T, funcs::CPUAdam> functor(
       beta1_,
@@ -145,9 +130,9 @@ void AdamDenseParamSparseGradKernel(
       grad_data,
       param.data<T>(),
       dev_ctx.template Alloc<T>(param_out),
-      rows,
+      groups.rows.data(),
       row_numel,
-      grad_merge.rows().size(),
+      groups.size(),
       lazy_mode);
   // update beta1 and beta2
   if (!use_global_beta_pow) {
@@ -156,78 +141,39 @@ void AdamDenseParamSparseGradKernel(
     dev_ctx.template Alloc<T>(beta2_pow_out)[0] =
         beta2_ * beta2_pow.data<T>()[0];
   }
+
+  // The rows are partitioned among the intra-op threads, whose number is
+  // FLAGS_inner_op_parallelism, so min_row_size_to_use_multithread is left
+  // to the cost of ParallelFor.
   if (lazy_mode) {
     VLOG(3) << "run cpu lazy mode";
-    size_t row_count = grad_merge.rows().size();
-    std::vector<int64_t> cpu_rows(grad_merge.rows());
-    for (size_t row_index = 0; row_index < row_count; ++row_index) {
-      for (size_t offset = 0; offset < row_numel; ++offset) {
-        size_t i = cpu_rows[row_index] * row_numel + offset;
-        functor.adam_update(i, grad_data[row_index * row_numel + offset]);
-      }
-    }
-  }
-#ifndef _WIN32
-  else if (FLAGS_inner_op_parallelism > 1 &&  // NOLINT
-           min_row_size_to_use_multithread > 0 &&
-           param.dims()[0] > min_row_size_to_use_multithread) {
-    VLOG(3) << "use multi thread, inner_op_parallelism="
-            << FLAGS_inner_op_parallelism << " min_row_size_to_use_multithread="
-            << min_row_size_to_use_multithread;
-    if (FLAGS_inner_op_parallelism > 10) {
-      VLOG(1) << "FLAGS_inner_op_parallelism " << FLAGS_inner_op_parallelism
-              << " is two large!";
-    }
-    auto& grad_rows = grad_merge.rows();
-    std::unordered_map<size_t, int> row_id_to_grad_row_offset;
-    size_t param_row_count = param.numel() / row_numel;
-    if (param_row_count < 1000) {
-      VLOG(1) << "param_row_count should be larger then 1000 to use "
-                 "multi thread, currently "
-              << param_row_count;
-    }
-    for (size_t i = 0; i < grad_rows.size(); ++i) {
-      row_id_to_grad_row_offset[grad_rows[i]] = i;
-    }
-    std::vector<std::future<void>> fs;
-    int64_t line_in_each_thread =
-        param_row_count / FLAGS_inner_op_parallelism + 1;
-    for (int i = 0; i < FLAGS_inner_op_parallelism; ++i) {
-      int64_t start = i * line_in_each_thread;
-      int64_t end = (i + 1) * line_in_each_thread;
-      if (start >= static_cast<int64_t>(param_row_count)) {
-        break;
-      }
-      if (end > static_cast<int64_t>(param_row_count)) {
-        end = static_cast<int64_t>(param_row_count);
-      }
-      fs.push_back(paddle::framework::Async([&functor,
-                                             &row_id_to_grad_row_offset,
-                                             &grad_data,
-                                             row_numel,
-                                             start,
-                                             end]() {
-        for (int64_t row_id = start; row_id < end; ++row_id) {
-          auto iter = row_id_to_grad_row_offset.find(row_id);
-          if (iter != row_id_to_grad_row_offset.end()) {
-            for (size_t row_offset = 0U; row_offset < row_numel; ++row_offset) {
-              functor.adam_update(
-                  row_id * row_numel + row_offset,
-                  grad_data[iter->second * row_numel + row_offset]);
-            }
-          } else {
-            for (size_t row_offset = 0U; row_offset < row_numel; ++row_offset) {
-              functor.adam_update(row_id * row_numel + row_offset, 0);
+    funcs::ForEachSparseRow(
+        dev_ctx, groups, grad_data, row_numel, [&](int64_t row, const T* g) {
+          functor.update_row(row, g);
+        });
+  } else {
+    const int64_t param_row_count = param.numel() / row_numel;
+    funcs::ParallelFor(
+        dev_ctx,
+        param_row_count,
+        row_numel * 8,
+        [&](int64_t begin, int64_t end) {
+          std::vector<T> buffer(row_numel);
+          int64_t g =
+              std::lower_bound(groups.rows.begin(), groups.rows.end(), begin) -
+              groups.rows.begin();
+          for (int64_t row = begin; row < end; ++row) {
+            if (g < groups.size() && groups.rows[g] == row) {
+              functor.update_row(
+                  row,
+                  funcs::SparseGroupGrad(
+                      groups, g, grad_data, row_numel, buffer.data()));
+              ++g;
+            } else {
+              functor.decay_row(row);
             }
           }
-        }
-      }));
-    }
-    for (size_t i = 0; i < fs.size(); ++i) fs[i].wait();
-  }
-#endif    // !_WIN32
-  else {  // NOLINT
-    functor(param.numel());
+        });
   }
 }
 
@@ -14,13 +14,17 @@ limitations under the License. */
 
 #pragma once
 
-#include <set>
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+#include <vector>
 
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/core/sparse_coo_tensor.h"
 #include "paddle/phi/core/tensor_meta.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/parallel_for.h"
 #include "paddle/phi/kernels/sparse/convolution_kernel.h"
 
 namespace phi {
@@ -28,9 +32,17 @@ namespace sparse {
 
 using Dims4D = phi::funcs::sparse::Dims4D;
 
+// The number of nonzeros of x handled by one task of ProductRuleBook.
+constexpr int64_t kRulebookBlockSize = 1024;
+// The max number of rows of the gemm of one task of the conv kernels.
+constexpr int kRulebookGemmRows = 256;
+
 // such as: kernel(3, 3, 3), kernel_size = 27
 // counter_per_weight: (kernel_size)
-// TODO(zhangkaihuo): optimize performance with multithreading
+// The nonzeros are split into blocks which are processed in parallel, first
+// to count the rules of each block and kernel offset, then to write them
+// into the rulebook at the prefix sums of the counts. The rules are ordered
+// by kernel offset and then by the nonzero, the same as a serial loop.
 template <typename T, typename Context, typename IntT = int>
 void ProductRuleBook(const Context& dev_ctx,
                      const SparseCooTensor& x,
@@ -49,8 +61,6 @@ void ProductRuleBook(const Context& dev_ctx,
   int kernel_size = kernel_sizes[0] * kernel_sizes[1] * kernel_sizes[2];
   memset(counter_ptr, 0, kernel_size * sizeof(int));
 
-  int rulebook_len = 0;
-  // calc the rulebook_len
   const auto& x_dims = x.dims();
   const Dims4D c_x_dims(x_dims[0], x_dims[3], x_dims[2], x_dims[1]);
   const Dims4D c_kernel_dims(
@@ -60,9 +70,11 @@ void ProductRuleBook(const Context& dev_ctx,
   const Dims4D c_strides(1, strides[2], strides[1], strides[0]);
   const Dims4D c_dilations(1, dilations[2], dilations[1], dilations[0]);
 
-  std::set<IntT> hash_in;
+  // the linear indices of x, an output of subm is kept only if it is in x
+  std::unordered_set<IntT> hash_in;
   if (subm) {
-    for (int i = 0; i < non_zero_num; i++) {
+    hash_in.reserve(non_zero_num);
+    for (int64_t i = 0; i < non_zero_num; i++) {
       IntT batch = indices_ptr[i];
       IntT in_z = indices_ptr[i + non_zero_num];
       IntT in_y = indices_ptr[i + 2 * non_zero_num];
@@ -73,58 +85,74 @@ void ProductRuleBook(const Context& dev_ctx,
     }
   }
 
-  auto f_calc_rulebook = [&](IntT* rulebook_ptr) {
-    int kernel_index = 0, rulebook_index = 0;
+  // call func(kernel_index, out_index) for each rule of the i-th nonzero
+  auto for_each_rule = [&](int64_t i, auto&& func) {
+    IntT batch = indices_ptr[i];
+    IntT in_z = indices_ptr[i + non_zero_num];
+    IntT in_y = indices_ptr[i + 2 * non_zero_num];
+    IntT in_x = indices_ptr[i + 3 * non_zero_num];
+    int kernel_index = 0;
     for (int kz = 0; kz < kernel_sizes[0]; kz++) {
       for (int ky = 0; ky < kernel_sizes[1]; ky++) {
-        for (int kx = 0; kx < kernel_sizes[2]; kx++) {
-          ++kernel_index;
-          for (int64_t i = 0; i < non_zero_num; i++) {
-            IntT batch = indices_ptr[i];
-            IntT in_z = indices_ptr[i + non_zero_num];
-            IntT in_y = indices_ptr[i + 2 * non_zero_num];
-            IntT in_x = indices_ptr[i + 3 * non_zero_num];
-            IntT out_z = (in_z + paddings[0] - kz * dilations[0]) / strides[0];
-            IntT out_y = (in_y + paddings[1] - ky * dilations[1]) / strides[1];
-            IntT out_x = (in_x + paddings[2] - kx * dilations[2]) / strides[2];
-            if (phi::funcs::sparse::Check(c_x_dims,
-                                          c_kernel_dims,
-                                          c_paddings,
-                                          c_dilations,
-                                          c_strides,
-                                          in_x,
-                                          in_y,
-                                          in_z,
-                                          kx,
-                                          ky,
-                                          kz)) {
-              if (subm) {
-                IntT out_index = phi::funcs::sparse::PointToIndex<DDim>(
-                    batch, out_x, out_y, out_z, out_dims);
-                if (hash_in.find(out_index) == hash_in.end()) {
-                  continue;
-                }
-              }
-
-              if (rulebook_ptr == nullptr) {
-                counter_ptr[kernel_index - 1] += 1;
-                ++rulebook_len;
-              } else {
-                rulebook_ptr[rulebook_index] = kernel_index - 1;
-                rulebook_ptr[rulebook_index + rulebook_len] = i;  // in_i
-                rulebook_ptr[rulebook_index + rulebook_len * 2] =
-                    phi::funcs::sparse::PointToIndex<DDim>(
-                        batch, out_x, out_y, out_z, out_dims);  // out_index
-                ++rulebook_index;
-              }
-            }
+        for (int kx = 0; kx < kernel_sizes[2]; kx++, kernel_index++) {
+          if (!phi::funcs::sparse::Check(c_x_dims,
+                                         c_kernel_dims,
+                                         c_paddings,
+                                         c_dilations,
+                                         c_strides,
+                                         in_x,
+                                         in_y,
+                                         in_z,
+                                         kx,
+                                         ky,
+                                         kz)) {
+            continue;
           }
+          IntT out_z = (in_z + paddings[0] - kz * dilations[0]) / strides[0];
+          IntT out_y = (in_y + paddings[1] - ky * dilations[1]) / strides[1];
+          IntT out_x = (in_x + paddings[2] - kx * dilations[2]) / strides[2];
+          IntT out_index = phi::funcs::sparse::PointToIndex<DDim>(
+              batch, out_x, out_y, out_z, out_dims);
+          if (subm && hash_in.find(out_index) == hash_in.end()) {
+            continue;
+          }
+          func(kernel_index, out_index);
         }
       }
     }
   };
 
-  f_calc_rulebook(nullptr);
+  const int64_t num_blocks =
+      (non_zero_num + kRulebookBlockSize - 1) / kRulebookBlockSize;
+  const double cost_per_block =
+      static_cast<double>(kRulebookBlockSize) * kernel_size * 20;
+  // block_counter[b * kernel_size + k]: the rules of block b and offset k
+  std::vector<int> block_counter(num_blocks * kernel_size, 0);
+  phi::funcs::ParallelFor(
+      dev_ctx, num_blocks, cost_per_block, [&](int64_t begin, int64_t end) {
+        for (int64_t b = begin; b < end; b++) {
+          int* counter = block_counter.data() + b * kernel_size;
+          const int64_t last =
+              std::min(non_zero_num, (b + 1) * kRulebookBlockSize);
+          for (int64_t i = b * kRulebookBlockSize; i < last; i++) {
+            for_each_rule(i, [&](int kernel_index, IntT out_index) {
+              counter[kernel_index] += 1;
+            });
+          }
+        }
+      });
+
+  // turn the counts into the position of the first rule of each block
+  int rulebook_len = 0;
+  for (int k = 0; k < kernel_size; k++) {
+    for (int64_t b = 0; b < num_blocks; b++) {
+      int count = block_counter[b * kernel_size + k];
+      block_counter[b * kernel_size + k] = rulebook_len;
+      rulebook_len += count;
+      counter_ptr[k] += count;
+    }
+  }
+
   // alloc the rulebook
   *rulebook = phi::Empty(
       dev_ctx,
@@ -132,9 +160,28 @@ void ProductRuleBook(const Context& dev_ctx,
                       {3, rulebook_len},
                       DataLayout::NCHW));
   IntT* rulebook_ptr = rulebook->data<IntT>();
-  f_calc_rulebook(rulebook_ptr);
+  phi::funcs::ParallelFor(
+      dev_ctx, num_blocks, cost_per_block, [&](int64_t begin, int64_t end) {
+        for (int64_t b = begin; b < end; b++) {
+          int* position = block_counter.data() + b * kernel_size;
+          const int64_t last =
+              std::min(non_zero_num, (b + 1) * kRulebookBlockSize);
+          for (int64_t i = b * kRulebookBlockSize; i < last; i++) {
+            for_each_rule(i, [&](int kernel_index, IntT out_index) {
+              const int rulebook_index = position[kernel_index]++;
+              rulebook_ptr[rulebook_index] = kernel_index;
+              rulebook_ptr[rulebook_index + rulebook_len] = i;  // in_i
+              rulebook_ptr[rulebook_index + rulebook_len * 2] = out_index;
+            });
+          }
+        }
+      });
 }
 
+// Replace the out indexes of the rulebook with the position in the sorted
+// out indexes, which are the indices of out. The out indexes of one kernel
+// offset are unique, so the segments of the offsets are sorted in parallel
+// and then merged pairwise.
 template <typename T, typename Context, typename IntT = int>
 void UpdateRulebookAndOutIndex(const Context& dev_ctx,
                                const SparseCooTensor& x,
@@ -143,11 +190,49 @@ void UpdateRulebookAndOutIndex(const Context& dev_ctx,
                                const DDim& out_dims,
                                DenseTensor* rulebook,
                                SparseCooTensor* out) {
-  std::set<IntT> out_indexs;
   int n = rulebook->dims()[1];
   IntT* rulebook_ptr = rulebook->data<IntT>();
-  for (int i = 0; i < n; i++) {
-    out_indexs.insert(rulebook_ptr[i + n * 2]);
+
+  std::vector<std::vector<IntT>> segments;
+  for (int begin = 0, end = 0; begin < n; begin = end) {
+    while (end < n && rulebook_ptr[end] == rulebook_ptr[begin]) {
+      end++;
+    }
+    segments.emplace_back(rulebook_ptr + n * 2 + begin,
+                          rulebook_ptr + n * 2 + end);
+  }
+  const double sort_cost = static_cast<double>(n) /
+                           std::max<size_t>(segments.size(), 1) * 20;
+  phi::funcs::ParallelFor(
+      dev_ctx, segments.size(), sort_cost, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          std::sort(segments[i].begin(), segments[i].end());
+        }
+      });
+  while (segments.size() > 1) {
+    std::vector<std::vector<IntT>> merged((segments.size() + 1) / 2);
+    phi::funcs::ParallelFor(
+        dev_ctx, merged.size(), sort_cost, [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; i++) {
+            if (2 * i + 1 == static_cast<int64_t>(segments.size())) {
+              merged[i] = std::move(segments[2 * i]);
+              continue;
+            }
+            const auto& a = segments[2 * i];
+            const auto& b = segments[2 * i + 1];
+            merged[i].reserve(a.size() + b.size());
+            std::set_union(a.begin(),
+                           a.end(),
+                           b.begin(),
+                           b.end(),
+                           std::back_inserter(merged[i]));
+          }
+        });
+    segments.swap(merged);
+  }
+  std::vector<IntT> out_indexs;
+  if (!segments.empty()) {
+    out_indexs.swap(segments[0]);
   }
 
   int out_non_zero_num = out_indexs.size();
@@ -162,43 +247,111 @@ void UpdateRulebookAndOutIndex(const Context& dev_ctx,
   phi::DenseTensor out_indices = phi::Empty(dev_ctx, std::move(indices_meta));
   phi::DenseTensor out_values = phi::Empty(dev_ctx, std::move(values_meta));
   IntT* out_indices_ptr = out_indices.data<IntT>();
-  int i = 0;
-  for (auto it = out_indexs.begin(); it != out_indexs.end(); it++, i++) {
-    const IntT index = *it;
-    IntT batch, x, y, z;
-    phi::funcs::sparse::IndexToPoint<DDim>(index, out_dims, &batch, &x, &y, &z);
-    out_indices_ptr[i] = batch;
-    out_indices_ptr[i + out_non_zero_num] = z;
-    out_indices_ptr[i + out_non_zero_num * 2] = y;
-    out_indices_ptr[i + out_non_zero_num * 3] = x;
-  }
-  for (i = 0; i < n; i++) {
-    IntT out_index = rulebook_ptr[i + n * 2];
-    rulebook_ptr[i + n * 2] =
-        std::distance(out_indexs.begin(), out_indexs.find(out_index));
-  }
+  phi::funcs::ParallelFor(
+      dev_ctx, out_non_zero_num, 8, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          IntT batch, x, y, z;
+          phi::funcs::sparse::IndexToPoint<DDim>(
+              out_indexs[i], out_dims, &batch, &x, &y, &z);
+          out_indices_ptr[i] = batch;
+          out_indices_ptr[i + out_non_zero_num] = z;
+          out_indices_ptr[i + out_non_zero_num * 2] = y;
+          out_indices_ptr[i + out_non_zero_num * 3] = x;
+        }
+      });
+  phi::funcs::ParallelFor(dev_ctx, n, 20, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      IntT* out_index = rulebook_ptr + i + n * 2;
+      *out_index = std::lower_bound(
+                       out_indexs.begin(), out_indexs.end(), *out_index) -
+                   out_indexs.begin();
+    }
+  });
 
   out->SetMember(out_indices, out_values, out_dims, true);
 }
 
 template <typename T, typename IntT = int>
-void Gather(
-    const T* x, const IntT* indexs, const int n, const int channels, T* out) {
-  for (int i = 0; i < n; i++) {
-    IntT real_i = indexs[i];
-    memcpy(out + i * channels, x + real_i * channels, channels * sizeof(T));
-  }
+void Gather(const CPUContext& dev_ctx,
+            const T* x,
+            const IntT* indexs,
+            const int n,
+            const int channels,
+            T* out) {
+  phi::funcs::ParallelFor(
+      dev_ctx, n, channels, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          IntT real_i = indexs[i];
+          memcpy(
+              out + i * channels, x + real_i * channels, channels * sizeof(T));
+        }
+      });
 }
 
+// out[indexs[i]] += x[i] for the n rows of x. The rows of x are grouped by
+// the row of out first, so the threads write disjoint rows of out and each
+// row adds its inputs in the same order as a serial loop.
 template <typename T, typename IntT = int>
-void Scatter(
-    const T* x, const IntT* indexs, const int n, const int channels, T* out) {
+void Scatter(const CPUContext& dev_ctx,
+             const T* x,
+             const IntT* indexs,
+             const int n,
+             const int channels,
+             const int out_rows,
+             T* out) {
+  std::vector<int> row_offsets(out_rows + 1, 0);
+  for (int i = 0; i < n; i++) {
+    row_offsets[indexs[i] + 1] += 1;
+  }
+  for (int r = 0; r < out_rows; r++) {
+    row_offsets[r + 1] += row_offsets[r];
+  }
+  std::vector<int> order(n);
+  std::vector<int> cursor(row_offsets.begin(), row_offsets.end() - 1);
   for (int i = 0; i < n; i++) {
-    IntT real_i = indexs[i];
-    for (int j = 0; j < channels; j++) {
-      out[real_i * channels + j] += x[i * channels + j];
+    order[cursor[indexs[i]]++] = i;
+  }
+
+  const double cost =
+      static_cast<double>(n) / std::max(out_rows, 1) * channels + channels;
+  phi::funcs::ParallelFor(
+      dev_ctx, out_rows, cost, [&](int64_t begin, int64_t end) {
+        for (int64_t r = begin; r < end; r++) {
+          T* dst = out + r * channels;
+          for (int j = row_offsets[r]; j < row_offsets[r + 1]; j++) {
+            const T* src = x + static_cast<int64_t>(order[j]) * channels;
+            for (int c = 0; c < channels; c++) {
+              dst[c] += src[c];
+            }
+          }
+        }
+      });
+}
+
+// A block of the rulebook which uses the same kernel offset.
+struct RulebookBlock {
+  int kernel_index;
+  int begin;
+  int end;
+};
+
+// Cut the rules of each kernel offset into blocks of at most max_rows, so
+// that an offset with many rules is spread over the threads. offsets is the
+// prefix sum of the counter, skip_kernel_index is left out if not -1.
+inline std::vector<RulebookBlock> SplitRulebook(
+    const std::vector<int>& offsets, int max_rows, int skip_kernel_index) {
+  std::vector<RulebookBlock> blocks;
+  for (size_t k = 0; k + 1 < offsets.size(); k++) {
+    if (static_cast<int>(k) == skip_kernel_index) {
+      continue;
+    }
+    for (int begin = offsets[k]; begin < offsets[k + 1]; begin += max_rows) {
+      blocks.push_back({static_cast<int>(k),
+                        begin,
+                        std::min(begin + max_rows, offsets[k + 1])});
     }
   }
+  return blocks;
 }
 
 }  // namespace sparse
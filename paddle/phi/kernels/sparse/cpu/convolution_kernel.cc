@@ -17,6 +17,7 @@ limitations under the License. */
 #include "paddle/phi/core/tensor_meta.h"
 #include "paddle/phi/core/visit_type.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/sparse/rulebook_cache.h"
 
 namespace phi {
 namespace sparse {
@@ -65,88 +66,107 @@ void Conv3dCPUKernel(const CPUContext& dev_ctx,
 
   // Second algorithm:
   // https://pdfs.semanticscholar.org/5125/a16039cabc6320c908a4764f32596e018ad3.pdf
-  // 1. product rulebook
+  // 1. product rulebook, or reuse the one of a layer with the same indices
   DenseTensorMeta counter_meta(
       DataType::INT32, {kernel_size}, DataLayout::NCHW);
-  DenseTensor counter_per_kernel = phi::Empty(dev_ctx, std::move(counter_meta));
-
-  ProductRuleBook<T, CPUContext, IntT>(dev_ctx,
-                                       x,
-                                       kernel_sizes,
-                                       subm_paddings,
-                                       dilations,
-                                       subm_strides,
-                                       out_dims,
-                                       subm,
-                                       rulebook,
-                                       &counter_per_kernel);
-
-  UpdateRulebookAndOutIndex<T, CPUContext, IntT>(
-      dev_ctx, x, kernel_size, out_channels, out_dims, rulebook, out);
+  DenseTensor counter_per_kernel;
+
+  auto& cache = phi::funcs::sparse::RulebookCache::Instance();
+  const std::string cache_key = phi::funcs::sparse::MakeRulebookKey(
+      x_dims, kernel_sizes, subm_paddings, dilations, subm_strides, subm);
+  phi::funcs::sparse::RulebookCacheEntry cached;
+  if (cache.Find(cache_key, x.non_zero_indices(), &cached)) {
+    *rulebook = cached.rulebook;
+    counter_per_kernel = cached.counter;
+    DenseTensorMeta values_meta(x.dtype(),
+                                {cached.out_indices.dims()[1], out_channels},
+                                x.non_zero_elements().layout());
+    out->SetMember(cached.out_indices,
+                   phi::Empty(dev_ctx, std::move(values_meta)),
+                   out_dims,
+                   true);
+  } else {
+    counter_per_kernel = phi::Empty(dev_ctx, std::move(counter_meta));
+    ProductRuleBook<T, CPUContext, IntT>(dev_ctx,
+                                         x,
+                                         kernel_sizes,
+                                         subm_paddings,
+                                         dilations,
+                                         subm_strides,
+                                         out_dims,
+                                         subm,
+                                         rulebook,
+                                         &counter_per_kernel);
+
+    UpdateRulebookAndOutIndex<T, CPUContext, IntT>(
+        dev_ctx, x, kernel_size, out_channels, out_dims, rulebook, out);
+    cache.Insert(cache_key,
+                 x.non_zero_indices(),
+                 {*rulebook, counter_per_kernel, out->non_zero_indices()});
+  }
 
   int n = rulebook->dims()[1];
   const int* counter_ptr = counter_per_kernel.data<int>();
+  const IntT* rulebook_ptr = rulebook->data<IntT>();
 
-  // 2. gather
-  DenseTensorMeta in_features_meta(
-      x.dtype(), {n, in_channels}, DataLayout::NHWC);
   DenseTensorMeta out_features_meta(
       x.dtype(), {n, out_channels}, DataLayout::NHWC);
-  phi::DenseTensor in_features =
-      phi::Empty(dev_ctx, std::move(in_features_meta));
   phi::DenseTensor out_features =
       phi::Empty(dev_ctx, std::move(out_features_meta));
-  T* in_features_ptr = in_features.data<T>();
   T* out_features_ptr = out_features.data<T>();
 
-  Gather<T, IntT>(x.non_zero_elements().data<T>(),
-                  rulebook->data<IntT>() + n,
-                  n,
-                  in_channels,
-                  in_features_ptr);
-
-  // 3. call gemm for every werght
-  auto blas = phi::funcs::GetBlas<CPUContext, T>(dev_ctx);
   std::vector<int> offsets(kernel_size + 1);
-  int offset = 0;
-  for (int i = 0; i < kernel_size; i++) {
-    offsets[i] = offset;
-    offset += counter_ptr[i];
-  }
-  offsets[kernel_size] = offset;
+  phi::funcs::sparse::PrefixSum(counter_ptr, &offsets[0], kernel_size);
 
+  // 2. gather and 3. call gemm for every weight, the rules of each kernel
+  // offset are cut into blocks and the blocks are run in parallel, each
+  // gathers its input rows into a small buffer before the gemm.
+  auto blas = phi::funcs::GetBlas<CPUContext, T>(dev_ctx);
+  const T* x_values_ptr = x.non_zero_elements().data<T>();
   const T* kernel_ptr = kernel.data<T>();
-  for (int i = 0; i < kernel_size; i++) {
-    if (counter_ptr[i] <= 0) {
-      continue;
-    }
-
-    // call gemm: (n, in_channels) * (in_channels, out_channels)
-    const int M = counter_ptr[i];
-    const int K = in_channels;   // in_channels
-    const int N = out_channels;  // out_channels
-    T* tmp_in_ptr = in_features_ptr + offsets[i] * in_channels;
-    const T* tmp_kernel_ptr = kernel_ptr + i * K * N;
-    T* tmp_out_ptr = out_features_ptr + offsets[i] * out_channels;
-    blas.GEMM(CblasNoTrans,
-              CblasNoTrans,
-              M,
-              N,
-              K,
-              static_cast<T>(1),
-              tmp_in_ptr,
-              tmp_kernel_ptr,
-              static_cast<T>(0),
-              tmp_out_ptr);
-  }
+  const auto blocks = SplitRulebook(offsets, kRulebookGemmRows, -1);
+  const double cost_per_block =
+      static_cast<double>(kRulebookGemmRows) * in_channels * out_channels;
+  phi::funcs::ParallelFor(
+      dev_ctx, blocks.size(), cost_per_block, [&](int64_t begin, int64_t end) {
+        std::vector<T> in_buffer(kRulebookGemmRows * in_channels);
+        for (int64_t b = begin; b < end; b++) {
+          const auto& block = blocks[b];
+          const int M = block.end - block.begin;
+          for (int i = 0; i < M; i++) {
+            const IntT in_i = rulebook_ptr[n + block.begin + i];
+            memcpy(in_buffer.data() + i * in_channels,
+                   x_values_ptr + in_i * in_channels,
+                   in_channels * sizeof(T));
+          }
+
+          // call gemm: (n, in_channels) * (in_channels, out_channels)
+          const int K = in_channels;   // in_channels
+          const int N = out_channels;  // out_channels
+          const T* tmp_kernel_ptr = kernel_ptr + block.kernel_index * K * N;
+          T* tmp_out_ptr = out_features_ptr + block.begin * out_channels;
+          blas.GEMM(CblasNoTrans,
+                    CblasNoTrans,
+                    M,
+                    N,
+                    K,
+                    static_cast<T>(1),
+                    in_buffer.data(),
+                    tmp_kernel_ptr,
+                    static_cast<T>(0),
+                    tmp_out_ptr);
+        }
+      });
 
   // 4. scatter
   T* out_values_ptr = out->mutable_non_zero_elements()->data<T>();
   memset(out_values_ptr, 0, sizeof(T) * out->nnz() * out_channels);
-  Scatter<T, IntT>(out_features_ptr,
-                   rulebook->data<IntT>() + n * 2,
+  Scatter<T, IntT>(dev_ctx,
+                   out_features_ptr,
+                   rulebook_ptr + n * 2,
                    n,
                    out_channels,
+                   out->nnz(),
                    out_values_ptr);
 }
 
@@ -12,6 +12,10 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 // TODO(wilber): will remove after the cpu, gpu context megre.
@@ -50,5 +54,59 @@ TEST(DeviceContext, cpu_context) {
   delete device;
 }
 
+TEST(DeviceContext, cpu_context_parallel_for) {
+  phi::CPUContext ctx;
+  ctx.Init();
+  EXPECT_EQ(ctx.GetNumThreads(), 1);
+  for (int num_threads : {1, 4}) {
+    ctx.SetNumThreads(num_threads);
+    EXPECT_EQ(ctx.GetNumThreads(), num_threads);
+
+    // every unit is visited exactly once
+    const int64_t n = 100003;
+    std::vector<std::atomic<int>> visits(n);
+    for (auto& v : visits) {
+      v = 0;
+    }
+    std::atomic<int> num_calls(0);
+    ctx.ParallelFor(n, 1000.0, [&](int64_t begin, int64_t end) {
+      ++num_calls;
+      // nested calls run on the calling thread
+      ctx.ParallelFor(end - begin, 1000.0, [&](int64_t b, int64_t e) {
+        for (int64_t i = begin + b; i < begin + e; ++i) {
+          ++visits[i];
+        }
+      });
+    });
+    for (int64_t i = 0; i < n; ++i) {
+      ASSERT_EQ(visits[i].load(), 1);
+    }
+    if (num_threads == 1) {
+      EXPECT_EQ(num_calls.load(), 1);
+    } else {
+      EXPECT_GT(num_calls.load(), 1);
+    }
+
+    // cheap work stays on the calling thread
+    num_calls = 0;
+    ctx.ParallelFor(16, 1.0, [&](int64_t begin, int64_t end) {
+      EXPECT_EQ(begin, 0);
+      EXPECT_EQ(end, 16);
+      ++num_calls;
+    });
+    EXPECT_EQ(num_calls.load(), 1);
+
+    // an exception of any range is thrown to the caller
+    EXPECT_THROW(ctx.ParallelFor(n,
+                                 1000.0,
+                                 [&](int64_t begin, int64_t end) {
+                                   if (end == n) {
+                                     throw std::runtime_error("last range");
+                                   }
+                                 }),
+                 std::runtime_error);
+  }
+}
+
 }  // namespace tests
 }  // namespace phi
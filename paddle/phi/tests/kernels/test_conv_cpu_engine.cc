@@ -0,0 +1,249 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/conv_grad_kernel.h"
+#include "paddle/phi/kernels/conv_kernel.h"
+#include "paddle/phi/kernels/funcs/conv_cpu_engine.h"
+
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/phi/api/lib/utils/allocator.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/tests/core/timer.h"
+
+DECLARE_bool(conv_cpu_fast_algo);
+
+namespace phi {
+namespace tests {
+
+struct ConvCase {
+  std::string name;
+  int batch;
+  int in_c;
+  int size;
+  int out_c;
+  int k;
+  int stride;
+  int pad;
+  int groups;
+};
+
+// Runs the CPU conv kernels with the fast algorithms and with im2col + gemm,
+// checks that both give the same result and logs the time of each.
+class ConvCPUEngineTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    alloc_ = std::make_unique<paddle::experimental::DefaultAllocator>(
+        paddle::platform::CPUPlace());
+    dev_ctx_.SetAllocator(
+        paddle::memory::allocation::AllocatorFacade::Instance()
+            .GetAllocator(paddle::platform::CPUPlace())
+            .get());
+    dev_ctx_.Init();
+  }
+
+  void TearDown() override { FLAGS_conv_cpu_fast_algo = false; }
+
+  phi::DenseTensor RandomTensor(const std::vector<int64_t>& dims) {
+    phi::DenseTensor t(alloc_.get(),
+                       phi::DenseTensorMeta(phi::DataType::FLOAT32,
+                                            phi::make_ddim(dims),
+                                            phi::DataLayout::NCHW));
+    auto* data = t.mutable_data<float>(paddle::platform::CPUPlace());
+    for (int64_t i = 0; i < t.numel(); ++i) {
+      data[i] = static_cast<float>((i * 7919) % 1000) / 1000.f - 0.5f;
+    }
+    return t;
+  }
+
+  phi::DenseTensor EmptyTensor(const phi::DDim& dims) {
+    return phi::DenseTensor(
+        alloc_.get(),
+        phi::DenseTensorMeta(
+            phi::DataType::FLOAT32, dims, phi::DataLayout::NCHW));
+  }
+
+  int OutSize(const ConvCase& c) {
+    return (c.size + 2 * c.pad - c.k) / c.stride + 1;
+  }
+
+  phi::DenseTensor Forward(const ConvCase& c,
+                           const phi::DenseTensor& input,
+                           const phi::DenseTensor& filter) {
+    const int out_size = OutSize(c);
+    auto out =
+        EmptyTensor(phi::make_ddim({c.batch, c.out_c, out_size, out_size}));
+    phi::ConvKernel<float, phi::CPUContext>(dev_ctx_,
+                                            input,
+                                            filter,
+                                            {c.stride, c.stride},
+                                            {c.pad, c.pad},
+                                            "EXPLICIT",
+                                            c.groups,
+                                            {1, 1},
+                                            "NCHW",
+                                            false,
+                                            0,
+                                            false,
+                                            &out);
+    return out;
+  }
+
+  void Backward(const ConvCase& c,
+                const phi::DenseTensor& input,
+                const phi::DenseTensor& filter,
+                const phi::DenseTensor& out_grad,
+                phi::DenseTensor* input_grad,
+                phi::DenseTensor* filter_grad) {
+    phi::ConvGradKernel<float, phi::CPUContext>(dev_ctx_,
+                                                input,
+                                                filter,
+                                                out_grad,
+                                                {c.stride, c.stride},
+                                                {c.pad, c.pad},
+                                                "EXPLICIT",
+                                                c.groups,
+                                                {1, 1},
+                                                "NCHW",
+                                                false,
+                                                0,
+                                                false,
+                                                input_grad,
+                                                filter_grad);
+  }
+
+  double TimeOf(const std::function<void()>& fn) {
+    fn();  // warm up
+    Timer timer;
+    timer.tic();
+    for (int i = 0; i < repeat_; ++i) {
+      fn();
+    }
+    return timer.toc() / repeat_;
+  }
+
+  void ExpectNear(const std::string& name,
+                  const phi::DenseTensor& out,
+                  const phi::DenseTensor& expected,
+                  float rel_error) {
+    ASSERT_EQ(out.numel(), expected.numel()) << name;
+    for (int64_t i = 0; i < out.numel(); ++i) {
+      const float e = expected.data<float>()[i];
+      ASSERT_NEAR(out.data<float>()[i], e, rel_error * (1.f + std::abs(e)))
+          << name << " at " << i;
+    }
+  }
+
+  void Run(const ConvCase& c) {
+    auto input = RandomTensor({c.batch, c.in_c, c.size, c.size});
+    auto filter = RandomTensor({c.out_c, c.in_c / c.groups, c.k, c.k});
+
+    const int out_size = OutSize(c);
+    auto shape = phi::funcs::MakeConv2DShape(
+        input.dims(),
+        filter.dims(),
+        phi::make_ddim({c.batch, c.out_c, out_size, out_size}),
+        {c.stride, c.stride},
+        {c.pad, c.pad, c.pad, c.pad},
+        {1, 1},
+        c.groups);
+    const int algo = static_cast<int>(phi::funcs::SelectConvCPUAlgo(shape));
+
+    FLAGS_conv_cpu_fast_algo = false;
+    auto expected = Forward(c, input, filter);
+    const double im2col_ms = TimeOf([&]() { Forward(c, input, filter); });
+    FLAGS_conv_cpu_fast_algo = true;
+    auto out = Forward(c, input, filter);
+    const double fast_ms = TimeOf([&]() { Forward(c, input, filter); });
+    LOG(INFO) << c.name << " forward with algo " << algo
+              << " costs: " << fast_ms << " ms, im2col costs: " << im2col_ms
+              << " ms.";
+    // winograd changes the order of the additions
+    ExpectNear(c.name, out, expected, 1e-3f);
+
+    auto out_grad = RandomTensor(phi::vectorize(out.dims()));
+    auto expected_dx = EmptyTensor(input.dims());
+    auto expected_dw = EmptyTensor(filter.dims());
+    auto dx = EmptyTensor(input.dims());
+    auto dw = EmptyTensor(filter.dims());
+    FLAGS_conv_cpu_fast_algo = false;
+    Backward(c, input, filter, out_grad, &expected_dx, &expected_dw);
+    const double im2col_grad_ms = TimeOf(
+        [&]() { Backward(c, input, filter, out_grad, &expected_dx, &dw); });
+    FLAGS_conv_cpu_fast_algo = true;
+    Backward(c, input, filter, out_grad, &dx, &dw);
+    const double fast_grad_ms =
+        TimeOf([&]() { Backward(c, input, filter, out_grad, &dx, &dw); });
+    LOG(INFO) << c.name << " backward with algo " << algo
+              << " costs: " << fast_grad_ms
+              << " ms, im2col costs: " << im2col_grad_ms << " ms.";
+    ExpectNear(c.name + "@input_grad", dx, expected_dx, 1e-3f);
+    ExpectNear(c.name + "@filter_grad", dw, expected_dw, 1e-3f);
+  }
+
+  const int repeat_ = 5;
+  std::unique_ptr<paddle::experimental::DefaultAllocator> alloc_;
+  phi::CPUContext dev_ctx_;
+};
+
+TEST_F(ConvCPUEngineTest, resnet) {
+  std::vector<ConvCase> cases = {
+      {"res2_3x3", 1, 64, 56, 64, 3, 1, 1, 1},
+      {"res3_3x3", 1, 128, 28, 128, 3, 1, 1, 1},
+      {"res4_3x3", 1, 256, 14, 256, 3, 1, 1, 1},
+      {"res5_3x3", 1, 512, 7, 512, 3, 1, 1, 1},
+      {"res3_downsample_1x1", 1, 256, 56, 512, 1, 2, 0, 1},
+      {"res4_downsample_1x1", 1, 512, 28, 1024, 1, 2, 0, 1},
+  };
+  for (auto& c : cases) {
+    Run(c);
+  }
+}
+
+TEST_F(ConvCPUEngineTest, mobilenet) {
+  std::vector<ConvCase> cases = {
+      {"dw_112_s1", 1, 32, 112, 32, 3, 1, 1, 32},
+      {"dw_112_s2", 1, 64, 112, 64, 3, 2, 1, 64},
+      {"dw_14_s1", 1, 512, 14, 512, 3, 1, 1, 512},
+      {"pw_56", 1, 128, 56, 128, 1, 1, 0, 1},
+  };
+  for (auto& c : cases) {
+    Run(c);
+  }
+}
+
+TEST_F(ConvCPUEngineTest, small_shapes) {
+  // tiles which are cut by the border and a batch larger than one
+  std::vector<ConvCase> cases = {
+      {"winograd_odd", 2, 8, 13, 16, 3, 1, 1, 1},
+      {"winograd_no_pad", 2, 16, 10, 8, 3, 1, 0, 1},
+      {"dw_odd_s2", 2, 6, 11, 6, 3, 2, 1, 6},
+      {"1x1_pad", 2, 5, 9, 7, 1, 1, 1, 1},
+  };
+  for (auto& c : cases) {
+    Run(c);
+  }
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,301 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/activation_kernel.h"
+#include "paddle/phi/kernels/elementwise_add_kernel.h"
+#include "paddle/phi/kernels/funcs/cpu_bf16.h"
+#include "paddle/phi/kernels/gelu_kernel.h"
+#include "paddle/phi/kernels/layer_norm_grad_kernel.h"
+#include "paddle/phi/kernels/layer_norm_kernel.h"
+#include "paddle/phi/kernels/matmul_kernel.h"
+#include "paddle/phi/kernels/softmax_kernel.h"
+
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/phi/api/lib/utils/allocator.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/tests/core/timer.h"
+
+namespace phi {
+namespace tests {
+
+using bfloat16 = phi::dtype::bfloat16;
+
+// Runs the bfloat16 kernels and the float kernels on the same values, which
+// are exact in bfloat16, and compares the results with the bfloat16
+// precision.
+class CPUBF16Test : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    alloc_ = std::make_unique<paddle::experimental::DefaultAllocator>(
+        paddle::platform::CPUPlace());
+    dev_ctx_.SetAllocator(
+        paddle::memory::allocation::AllocatorFacade::Instance()
+            .GetAllocator(paddle::platform::CPUPlace())
+            .get());
+    dev_ctx_.Init();
+  }
+
+  DenseTensor Empty(DataType dtype, const std::vector<int64_t>& dims) {
+    return DenseTensor(
+        alloc_.get(),
+        DenseTensorMeta(dtype, phi::make_ddim(dims), DataLayout::NCHW));
+  }
+
+  // a float tensor and its bfloat16 copy
+  std::pair<DenseTensor, DenseTensor> Random(const std::vector<int64_t>& dims,
+                                             int seed) {
+    auto fp32 = Empty(DataType::FLOAT32, dims);
+    auto bf16 = Empty(DataType::BFLOAT16, dims);
+    float* fp32_data = fp32.mutable_data<float>(paddle::platform::CPUPlace());
+    bfloat16* bf16_data =
+        bf16.mutable_data<bfloat16>(paddle::platform::CPUPlace());
+    for (int64_t i = 0; i < fp32.numel(); ++i) {
+      bf16_data[i] =
+          bfloat16(static_cast<float>((i * 7919 + seed) % 1000) / 500.f - 1.f);
+      fp32_data[i] = static_cast<float>(bf16_data[i]);
+    }
+    return {fp32, bf16};
+  }
+
+  void ExpectNear(const DenseTensor& expected,
+                  const DenseTensor& out,
+                  float rtol,
+                  const std::string& name) {
+    ASSERT_EQ(expected.dims(), out.dims()) << name;
+    std::vector<float> out_fp32(out.numel());
+    funcs::BF16ToFloat(out.data<bfloat16>(), out_fp32.data(), out.numel());
+    const float* expected_data = expected.data<float>();
+    for (int64_t i = 0; i < out.numel(); ++i) {
+      ASSERT_NEAR(out_fp32[i],
+                  expected_data[i],
+                  rtol * (1.f + std::abs(expected_data[i])))
+          << name << " at " << i;
+    }
+  }
+
+  double TimeOf(const std::function<void()>& fn) {
+    fn();  // warm up
+    Timer timer;
+    timer.tic();
+    for (int i = 0; i < repeat_; ++i) {
+      fn();
+    }
+    return timer.toc() / repeat_;
+  }
+
+  const int repeat_ = 10;
+  std::unique_ptr<paddle::experimental::DefaultAllocator> alloc_;
+  phi::CPUContext dev_ctx_;
+};
+
+TEST_F(CPUBF16Test, convert) {
+  std::vector<float> x = {0.f, -1.f, 1.00390625f, 1.01171875f, 3e38f, 1e-3f};
+  x.resize(37, 0.25f);
+  x.push_back(std::nanf(""));
+  std::vector<bfloat16> y(x.size());
+  funcs::FloatToBF16(x.data(), y.data(), x.size());
+  // the ties round to the even mantissa
+  EXPECT_EQ(y[2].x, 0x3f80);
+  EXPECT_EQ(y[3].x, 0x3f82);
+  EXPECT_TRUE(std::isnan(static_cast<float>(y.back())));
+  std::vector<float> z(x.size());
+  funcs::BF16ToFloat(y.data(), z.data(), y.size());
+  for (size_t i = 0; i + 1 < x.size(); ++i) {
+    EXPECT_NEAR(z[i], x[i], std::abs(x[i]) / 256.f);
+  }
+}
+
+TEST_F(CPUBF16Test, matmul) {
+  struct Case {
+    std::vector<int64_t> x_dims;
+    std::vector<int64_t> y_dims;
+    bool trans_x;
+    bool trans_y;
+  };
+  std::vector<Case> cases = {
+      {{7, 13}, {13, 35}, false, false},
+      {{2, 5, 33}, {33, 17}, false, false},
+      {{3, 9, 16}, {3, 17, 16}, false, true},
+      {{3, 16, 9}, {3, 16, 17}, true, false},
+      {{2, 1, 4, 8}, {3, 8, 5}, false, false},  // broadcast batch
+      {{8}, {8, 5}, false, false},              // vector
+  };
+  for (auto& c : cases) {
+    auto x = Random(c.x_dims, 1);
+    auto y = Random(c.y_dims, 2);
+    auto expected = Empty(DataType::FLOAT32, {1});
+    auto out = Empty(DataType::BFLOAT16, {1});
+    MatmulKernel<float, CPUContext>(
+        dev_ctx_, x.first, y.first, c.trans_x, c.trans_y, &expected);
+    MatmulKernel<bfloat16, CPUContext>(
+        dev_ctx_, x.second, y.second, c.trans_x, c.trans_y, &out);
+    ExpectNear(expected, out, 1e-2f, "matmul");
+  }
+
+  // the fc of bert
+  auto x = Random({128, 768}, 1);
+  auto y = Random({768, 3072}, 2);
+  auto expected = Empty(DataType::FLOAT32, {1});
+  auto out = Empty(DataType::BFLOAT16, {1});
+  const double fp32_ms = TimeOf([&]() {
+    MatmulKernel<float, CPUContext>(
+        dev_ctx_, x.first, y.first, false, false, &expected);
+  });
+  const double bf16_ms = TimeOf([&]() {
+    MatmulKernel<bfloat16, CPUContext>(
+        dev_ctx_, x.second, y.second, false, false, &out);
+  });
+  ExpectNear(expected, out, 1e-2f, "matmul");
+  LOG(INFO) << "[128, 768] x [768, 3072] bfloat16 matmul ("
+            << funcs::BF16GemmKernelName() << ") costs: " << bf16_ms
+            << " ms, float matmul costs: " << fp32_ms << " ms.";
+}
+
+TEST_F(CPUBF16Test, layer_norm) {
+  auto x = Random({33, 768}, 1);
+  auto scale = Random({768}, 2);
+  auto bias = Random({768}, 3);
+  auto expected = Empty(DataType::FLOAT32, {33, 768});
+  auto mean = Empty(DataType::FLOAT32, {33});
+  auto var = Empty(DataType::FLOAT32, {33});
+  LayerNormKernel<float, CPUContext>(dev_ctx_,
+                                     x.first,
+                                     scale.first,
+                                     bias.first,
+                                     1e-5f,
+                                     1,
+                                     true,
+                                     &expected,
+                                     &mean,
+                                     &var);
+  auto out = Empty(DataType::BFLOAT16, {33, 768});
+  auto bf16_mean = Empty(DataType::FLOAT32, {33});
+  auto bf16_var = Empty(DataType::FLOAT32, {33});
+  LayerNormKernel<bfloat16, CPUContext>(dev_ctx_,
+                                        x.second,
+                                        scale.second,
+                                        bias.second,
+                                        1e-5f,
+                                        1,
+                                        true,
+                                        &out,
+                                        &bf16_mean,
+                                        &bf16_var);
+  ExpectNear(expected, out, 1e-2f, "layer_norm");
+  for (int i = 0; i < 33; ++i) {
+    EXPECT_NEAR(bf16_mean.data<float>()[i], mean.data<float>()[i], 1e-4f);
+    EXPECT_NEAR(bf16_var.data<float>()[i], var.data<float>()[i], 1e-4f);
+  }
+}
+
+TEST_F(CPUBF16Test, layer_norm_grad) {
+  auto x = Random({33, 768}, 1);
+  auto scale = Random({768}, 2);
+  auto bias = Random({768}, 3);
+  auto dy = Random({33, 768}, 4);
+  auto y = Empty(DataType::FLOAT32, {33, 768});
+  auto mean = Empty(DataType::FLOAT32, {33});
+  auto var = Empty(DataType::FLOAT32, {33});
+  LayerNormKernel<float, CPUContext>(dev_ctx_,
+                                     x.first,
+                                     scale.first,
+                                     bias.first,
+                                     1e-5f,
+                                     1,
+                                     false,
+                                     &y,
+                                     &mean,
+                                     &var);
+  auto dx = Empty(DataType::FLOAT32, {33, 768});
+  auto dscale = Empty(DataType::FLOAT32, {768});
+  auto dbias = Empty(DataType::FLOAT32, {768});
+  LayerNormGradKernel<float, CPUContext>(dev_ctx_,
+                                         x.first,
+                                         scale.first,
+                                         bias.first,
+                                         mean,
+                                         var,
+                                         dy.first,
+                                         1e-5f,
+                                         1,
+                                         false,
+                                         &dx,
+                                         &dscale,
+                                         &dbias);
+  // The bfloat16 kernel takes the float mean and variance.
+  auto bf16_dx = Empty(DataType::BFLOAT16, {33, 768});
+  auto bf16_dscale = Empty(DataType::BFLOAT16, {768});
+  auto bf16_dbias = Empty(DataType::BFLOAT16, {768});
+  LayerNormGradKernel<bfloat16, CPUContext>(dev_ctx_,
+                                            x.second,
+                                            scale.second,
+                                            bias.second,
+                                            mean,
+                                            var,
+                                            dy.second,
+                                            1e-5f,
+                                            1,
+                                            false,
+                                            &bf16_dx,
+                                            &bf16_dscale,
+                                            &bf16_dbias);
+  ExpectNear(dx, bf16_dx, 2e-2f, "layer_norm_grad x");
+  ExpectNear(dscale, bf16_dscale, 2e-2f, "layer_norm_grad scale");
+  ExpectNear(dbias, bf16_dbias, 2e-2f, "layer_norm_grad bias");
+}
+
+TEST_F(CPUBF16Test, softmax) {
+  for (int axis : {-1, 1}) {
+    auto x = Random({4, 12, 128}, 1);
+    auto expected = Empty(DataType::FLOAT32, {4, 12, 128});
+    auto out = Empty(DataType::BFLOAT16, {4, 12, 128});
+    SoftmaxKernel<float, CPUContext>(dev_ctx_, x.first, axis, &expected);
+    SoftmaxKernel<bfloat16, CPUContext>(dev_ctx_, x.second, axis, &out);
+    ExpectNear(expected, out, 1e-2f, "softmax");
+  }
+}
+
+TEST_F(CPUBF16Test, activation_and_add) {
+  auto x = Random({3, 1000}, 1);
+  auto y = Random({3, 1000}, 2);
+  auto expected = Empty(DataType::FLOAT32, {3, 1000});
+  auto out = Empty(DataType::BFLOAT16, {3, 1000});
+
+  for (bool approximate : {false, true}) {
+    GeluKernel<float, CPUContext>(dev_ctx_, x.first, approximate, &expected);
+    GeluKernel<bfloat16, CPUContext>(dev_ctx_, x.second, approximate, &out);
+    ExpectNear(expected, out, 1e-2f, "gelu");
+  }
+
+  ReluKernel<float, CPUContext>(dev_ctx_, x.first, &expected);
+  ReluKernel<bfloat16, CPUContext>(dev_ctx_, x.second, &out);
+  ExpectNear(expected, out, 1e-2f, "relu");
+
+  AddKernel<float, CPUContext>(dev_ctx_, x.first, y.first, &expected);
+  AddKernel<bfloat16, CPUContext>(dev_ctx_, x.second, y.second, &out);
+  ExpectNear(expected, out, 1e-2f, "add");
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,153 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/cast_kernel.h"
+#include "paddle/phi/kernels/elementwise_add_kernel.h"
+#include "paddle/phi/kernels/reduce_sum_kernel.h"
+#include "paddle/phi/kernels/transpose_kernel.h"
+
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/phi/api/lib/utils/allocator.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/funcs/eigen/common.h"
+#include "paddle/phi/tests/core/timer.h"
+
+namespace phi {
+namespace tests {
+
+// Runs the CPU kernels which use CPUContext::ParallelFor with a growing
+// number of threads, checks the results against the serial run and logs the
+// time of each, which shows how the kernels scale with the threads.
+class CPUParallelTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    alloc_ = std::make_unique<paddle::experimental::DefaultAllocator>(
+        paddle::platform::CPUPlace());
+    dev_ctx_.SetAllocator(
+        paddle::memory::allocation::AllocatorFacade::Instance()
+            .GetAllocator(paddle::platform::CPUPlace())
+            .get());
+    dev_ctx_.Init();
+
+    x_ = RandomTensor({rows_, cols_});
+    y_ = RandomTensor({cols_});
+  }
+
+  phi::DenseTensor RandomTensor(const std::vector<int64_t>& dims) {
+    phi::DenseTensor t(alloc_.get(),
+                       phi::DenseTensorMeta(phi::DataType::FLOAT32,
+                                            phi::make_ddim(dims),
+                                            phi::DataLayout::NCHW));
+    auto* data = t.mutable_data<float>(paddle::platform::CPUPlace());
+    for (int64_t i = 0; i < t.numel(); ++i) {
+      data[i] = static_cast<float>((i * 7919) % 1000) / 1000.f;
+    }
+    return t;
+  }
+
+  // Run fn with 1, 2, 4, ... threads, compare each output with the one of a
+  // single thread.
+  template <typename T>
+  void Benchmark(const std::string& name,
+                 const std::function<phi::DenseTensor()>& fn,
+                 T abs_error = 0) {
+    const int max_threads =
+        std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+    phi::DenseTensor expected;
+    for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+      dev_ctx_.SetNumThreads(num_threads);
+      auto out = fn();  // warm up the thread pool
+      Timer timer;
+      timer.tic();
+      for (int i = 0; i < repeat_; ++i) {
+        out = fn();
+      }
+      LOG(INFO) << name << " with " << num_threads
+                << " threads costs: " << timer.toc() / repeat_ << " ms.";
+      if (num_threads == 1) {
+        expected = out;
+        continue;
+      }
+      ASSERT_EQ(out.numel(), expected.numel());
+      for (int64_t i = 0; i < out.numel(); ++i) {
+        ASSERT_NEAR(out.data<T>()[i], expected.data<T>()[i], abs_error);
+      }
+    }
+    dev_ctx_.SetNumThreads(1);
+  }
+
+  const int64_t rows_ = 1024;
+  const int64_t cols_ = 4096;
+  const int repeat_ = 10;
+  std::unique_ptr<paddle::experimental::DefaultAllocator> alloc_;
+  phi::CPUContext dev_ctx_;
+  phi::DenseTensor x_;
+  phi::DenseTensor y_;
+};
+
+TEST_F(CPUParallelTest, add) {
+  Benchmark<float>("add",
+                   [&]() { return phi::Add<float>(dev_ctx_, x_, x_); });
+  Benchmark<float>("add_broadcast",
+                   [&]() { return phi::Add<float>(dev_ctx_, x_, y_); });
+}
+
+TEST_F(CPUParallelTest, sum) {
+  Benchmark<float>("sum_rows", [&]() {
+    return phi::Sum<float>(dev_ctx_, x_, {1}, phi::DataType::FLOAT32, false);
+  });
+  // the partials are summed in another order
+  Benchmark<float>(
+      "sum_all",
+      [&]() {
+        return phi::Sum<float>(
+            dev_ctx_, x_, {0, 1}, phi::DataType::FLOAT32, false);
+      },
+      1.f);
+}
+
+TEST_F(CPUParallelTest, sum_all_single_thread) {
+  // A single thread reduces the whole tensor by Eigen, as before the blocks.
+  dev_ctx_.SetNumThreads(1);
+  auto out =
+      phi::Sum<float>(dev_ctx_, x_, {0, 1}, phi::DataType::FLOAT32, false);
+  Eigen::Tensor<float, 0, Eigen::RowMajor, Eigen::DenseIndex> expected =
+      EigenVector<float>::Flatten(x_).sum();
+  ASSERT_EQ(out.data<float>()[0], expected());
+}
+
+TEST_F(CPUParallelTest, cast) {
+  Benchmark<double>("cast", [&]() {
+    return phi::Cast<float>(dev_ctx_, x_, phi::DataType::FLOAT64);
+  });
+}
+
+TEST_F(CPUParallelTest, transpose) {
+  Benchmark<float>("transpose", [&]() {
+    return phi::Transpose<float>(dev_ctx_, x_, {1, 0});
+  });
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,328 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/argsort_kernel.h"
+#include "paddle/phi/kernels/top_k_kernel.h"
+#include "paddle/phi/kernels/unique_kernel.h"
+
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/phi/api/lib/utils/allocator.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/tests/core/timer.h"
+
+namespace phi {
+namespace tests {
+
+// Checks the top_k, argsort and unique kernels against the std algorithms.
+// The benchmark logs the time of both for 1K to 10M candidates, it is
+// disabled by default, run it with --gtest_also_run_disabled_tests.
+class CPUSortTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    alloc_ = std::make_unique<paddle::experimental::DefaultAllocator>(
+        paddle::platform::CPUPlace());
+    dev_ctx_.SetAllocator(
+        paddle::memory::allocation::AllocatorFacade::Instance()
+            .GetAllocator(paddle::platform::CPUPlace())
+            .get());
+    dev_ctx_.Init();
+    dev_ctx_.SetNumThreads(
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+  }
+
+  void TearDown() override { dev_ctx_.SetNumThreads(1); }
+
+  DenseTensor Empty(DataType dtype, const std::vector<int64_t>& dims) {
+    return DenseTensor(
+        alloc_.get(),
+        DenseTensorMeta(dtype, phi::make_ddim(dims), DataLayout::NCHW));
+  }
+
+  // values in [0, range) with duplicates when range is small
+  DenseTensor Random(const std::vector<int64_t>& dims, int64_t range) {
+    auto t = Empty(DataType::FLOAT32, dims);
+    float* data = t.mutable_data<float>(paddle::platform::CPUPlace());
+    uint64_t state = 88172645463325252ULL;
+    for (int64_t i = 0; i < t.numel(); ++i) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      data[i] = static_cast<float>(state % range) * 0.5f;
+    }
+    return t;
+  }
+
+  // the positions of a row in the order of the kernels: by value, the equal
+  // values by position
+  std::vector<int64_t> StableOrder(const float* row,
+                                   int64_t width,
+                                   bool descending) {
+    std::vector<int64_t> order(width);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(
+        order.begin(), order.end(), [&](int64_t l, int64_t r) {
+          return descending ? row[l] > row[r] : row[l] < row[r];
+        });
+    return order;
+  }
+
+  double TimeOf(const std::function<void()>& fn, int repeat) {
+    fn();  // warm up
+    Timer timer;
+    timer.tic();
+    for (int i = 0; i < repeat; ++i) {
+      fn();
+    }
+    return timer.toc() / repeat;
+  }
+
+  std::unique_ptr<paddle::experimental::DefaultAllocator> alloc_;
+  phi::CPUContext dev_ctx_;
+};
+
+TEST_F(CPUSortTest, argsort) {
+  // many short rows, and a row sorted by chunks on all the threads
+  for (auto dims : std::vector<std::vector<int64_t>>{
+           {7, 1000}, {33, 20}, {1, 300000}}) {
+    auto x = Random(dims, 1000);
+    for (bool descending : {false, true}) {
+      auto out = Empty(DataType::FLOAT32, dims);
+      auto indices = Empty(DataType::INT64, dims);
+      ArgsortKernel<float, CPUContext>(
+          dev_ctx_, x, -1, descending, &out, &indices);
+      const int64_t width = dims[1];
+      for (int64_t row = 0; row < dims[0]; ++row) {
+        const float* row_x = x.data<float>() + row * width;
+        auto order = StableOrder(row_x, width, descending);
+        for (int64_t j = 0; j < width; ++j) {
+          ASSERT_EQ(indices.data<int64_t>()[row * width + j], order[j]);
+          ASSERT_EQ(out.data<float>()[row * width + j], row_x[order[j]]);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(CPUSortTest, top_k) {
+  for (auto dims :
+       std::vector<std::vector<int64_t>>{{5, 100}, {5, 5000}, {1, 300000}}) {
+    auto x = Random(dims, 5000);
+    const int64_t width = dims[1];
+    for (int64_t k : {int64_t(1), int64_t(10), width / 2, width}) {
+      for (bool largest : {true, false}) {
+        auto out = Empty(DataType::FLOAT32, {dims[0], k});
+        auto indices = Empty(DataType::INT64, {dims[0], k});
+        TopkKernel<float, CPUContext>(
+            dev_ctx_, x, Scalar(k), -1, largest, true, &out, &indices);
+        for (int64_t row = 0; row < dims[0]; ++row) {
+          const float* row_x = x.data<float>() + row * width;
+          auto order = StableOrder(row_x, width, largest);
+          for (int64_t j = 0; j < k; ++j) {
+            ASSERT_EQ(indices.data<int64_t>()[row * k + j], order[j]);
+            ASSERT_EQ(out.data<float>()[row * k + j], row_x[order[j]]);
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST_F(CPUSortTest, unique) {
+  auto x = Random({200000}, 3000);
+  auto out = Empty(DataType::FLOAT32, {1});
+  auto indices = Empty(DataType::INT64, {1});
+  auto inverse = Empty(DataType::INT64, {1});
+  auto counts = Empty(DataType::INT64, {1});
+  UniqueKernel<float, CPUContext>(dev_ctx_,
+                                  x,
+                                  true,
+                                  true,
+                                  true,
+                                  {},
+                                  DataType::INT64,
+                                  &out,
+                                  &indices,
+                                  &inverse,
+                                  &counts);
+
+  // value -> (first position, count)
+  std::map<float, std::pair<int64_t, int64_t>> expected;
+  const float* x_data = x.data<float>();
+  for (int64_t i = 0; i < x.numel(); ++i) {
+    auto it = expected.find(x_data[i]);
+    if (it == expected.end()) {
+      expected[x_data[i]] = std::make_pair(i, 1);
+    } else {
+      ++it->second.second;
+    }
+  }
+  ASSERT_EQ(out.numel(), static_cast<int64_t>(expected.size()));
+  int64_t g = 0;
+  for (auto& e : expected) {
+    EXPECT_EQ(out.data<float>()[g], e.first);
+    EXPECT_EQ(indices.data<int64_t>()[g], e.second.first);
+    EXPECT_EQ(counts.data<int64_t>()[g], e.second.second);
+    ++g;
+  }
+  for (int64_t i = 0; i < x.numel(); ++i) {
+    ASSERT_EQ(out.data<float>()[inverse.data<int64_t>()[i]], x_data[i]);
+  }
+}
+
+TEST_F(CPUSortTest, unique_nan) {
+  // NaN != NaN, so each NaN is unique and comes after the other values.
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const std::vector<float> values = {nan, 1.f, nan, 0.f, -0.f, 1.f, nan};
+  auto x = Empty(DataType::FLOAT32, {static_cast<int64_t>(values.size())});
+  std::copy(values.begin(),
+            values.end(),
+            x.mutable_data<float>(paddle::platform::CPUPlace()));
+  auto out = Empty(DataType::FLOAT32, {1});
+  auto indices = Empty(DataType::INT64, {1});
+  auto inverse = Empty(DataType::INT64, {1});
+  auto counts = Empty(DataType::INT64, {1});
+  UniqueKernel<float, CPUContext>(dev_ctx_,
+                                  x,
+                                  true,
+                                  true,
+                                  true,
+                                  {},
+                                  DataType::INT64,
+                                  &out,
+                                  &indices,
+                                  &inverse,
+                                  &counts);
+  ASSERT_EQ(out.numel(), 5);
+  EXPECT_EQ(out.data<float>()[0], 0.f);
+  EXPECT_EQ(out.data<float>()[1], 1.f);
+  const std::vector<int64_t> expected_indices = {3, 1, 0, 2, 6};
+  const std::vector<int64_t> expected_counts = {2, 2, 1, 1, 1};
+  for (int64_t g = 0; g < 5; ++g) {
+    if (g >= 2) {
+      EXPECT_TRUE(std::isnan(out.data<float>()[g]));
+    }
+    EXPECT_EQ(indices.data<int64_t>()[g], expected_indices[g]);
+    EXPECT_EQ(counts.data<int64_t>()[g], expected_counts[g]);
+  }
+  const std::vector<int64_t> expected_inverse = {2, 1, 3, 0, 0, 1, 4};
+  for (size_t i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(inverse.data<int64_t>()[i], expected_inverse[i]);
+  }
+}
+
+TEST_F(CPUSortTest, DISABLED_benchmark) {
+  for (int64_t n : {1000, 100000, 1000000, 10000000}) {
+    const int repeat = n >= 1000000 ? 3 : 10;
+    auto x = Random({1, n}, n);
+    const float* x_data = x.data<float>();
+    std::vector<std::pair<float, int64_t>> pairs(n);
+    auto reset_pairs = [&]() {
+      for (int64_t i = 0; i < n; ++i) {
+        pairs[i] = std::make_pair(x_data[i], i);
+      }
+    };
+
+    const int64_t k = 100;
+    auto topk_out = Empty(DataType::FLOAT32, {1, k});
+    auto topk_indices = Empty(DataType::INT64, {1, k});
+    const double topk_ms = TimeOf(
+        [&]() {
+          TopkKernel<float, CPUContext>(dev_ctx_,
+                                        x,
+                                        Scalar(k),
+                                        -1,
+                                        true,
+                                        true,
+                                        &topk_out,
+                                        &topk_indices);
+        },
+        repeat);
+    const double partial_sort_ms = TimeOf(
+        [&]() {
+          reset_pairs();
+          std::partial_sort(pairs.begin(),
+                            pairs.begin() + k,
+                            pairs.end(),
+                            std::greater<std::pair<float, int64_t>>());
+        },
+        repeat);
+
+    auto sort_out = Empty(DataType::FLOAT32, {1, n});
+    auto sort_indices = Empty(DataType::INT64, {1, n});
+    const double argsort_ms = TimeOf(
+        [&]() {
+          ArgsortKernel<float, CPUContext>(
+              dev_ctx_, x, -1, false, &sort_out, &sort_indices);
+        },
+        repeat);
+    const double sort_ms = TimeOf(
+        [&]() {
+          reset_pairs();
+          std::sort(pairs.begin(), pairs.end());
+        },
+        repeat);
+
+    auto out = Empty(DataType::FLOAT32, {1});
+    auto indices = Empty(DataType::INT64, {1});
+    auto inverse = Empty(DataType::INT64, {1});
+    auto counts = Empty(DataType::INT64, {1});
+    const double unique_ms = TimeOf(
+        [&]() {
+          UniqueKernel<float, CPUContext>(dev_ctx_,
+                                          x,
+                                          false,
+                                          true,
+                                          true,
+                                          {},
+                                          DataType::INT64,
+                                          &out,
+                                          &indices,
+                                          &inverse,
+                                          &counts);
+        },
+        repeat);
+    const double map_ms = TimeOf(
+        [&]() {
+          std::map<float, int64_t> count_map;
+          for (int64_t i = 0; i < n; ++i) {
+            ++count_map[x_data[i]];
+          }
+        },
+        repeat);
+
+    LOG(INFO) << n << " candidates with " << dev_ctx_.GetNumThreads()
+              << " threads, top_k(100) costs: " << topk_ms
+              << " ms (std::partial_sort " << partial_sort_ms
+              << " ms), argsort costs: " << argsort_ms << " ms (std::sort "
+              << sort_ms << " ms), unique costs: " << unique_ms
+              << " ms (std::map " << map_ms << " ms).";
+  }
+}
+
+}  // namespace tests
+}  // namespace phi
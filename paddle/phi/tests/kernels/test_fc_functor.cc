@@ -0,0 +1,139 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/funcs/fc_functor.h"
+
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace phi {
+namespace tests {
+
+// Runs FCFunctor with and without the padded weight, the packed weight, the
+// bias and relu, and checks each against the naive Y = X * W + B.
+class FCFunctorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dev_ctx_.SetAllocator(
+        paddle::memory::allocation::AllocatorFacade::Instance()
+            .GetAllocator(paddle::platform::CPUPlace())
+            .get());
+    dev_ctx_.Init();
+
+    x_ = RandomVector(m_ * k_);
+    w_ = RandomVector(k_ * n_);
+    b_ = RandomVector(n_);
+    // The padded weight is (K + 4) x (N + 4), see FCFunctor.
+    padded_w_.assign((k_ + 4) * (n_ + 4), 0.f);
+    for (int i = 0; i < k_; ++i) {
+      for (int j = 0; j < n_; ++j) {
+        padded_w_[i * (n_ + 4) + j] = w_[i * n_ + j];
+      }
+    }
+  }
+
+  std::vector<float> RandomVector(int n) {
+    std::vector<float> v(n);
+    for (int i = 0; i < n; ++i) {
+      v[i] = static_cast<float>((i * 7919) % 1000) / 1000.f - 0.5f;
+    }
+    return v;
+  }
+
+  std::vector<float> Reference(bool with_bias, bool relu) {
+    std::vector<float> y(m_ * n_);
+    for (int i = 0; i < m_; ++i) {
+      for (int j = 0; j < n_; ++j) {
+        double sum = with_bias ? b_[j] : 0.;
+        for (int l = 0; l < k_; ++l) {
+          sum += static_cast<double>(x_[i * k_ + l]) * w_[l * n_ + j];
+        }
+        y[i * n_ + j] = static_cast<float>((relu && sum < 0.) ? 0. : sum);
+      }
+    }
+    return y;
+  }
+
+  void Check(bool padding, bool packed, bool with_bias, bool relu) {
+    const std::string name = "padding: " + std::to_string(padding) +
+                             ", packed: " + std::to_string(packed) +
+                             ", bias: " + std::to_string(with_bias) +
+                             ", relu: " + std::to_string(relu);
+    const float* w = padding ? padded_w_.data() : w_.data();
+    DenseTensor packed_w;
+    if (packed) {
+      const int ldw = padding ? n_ + 4 : n_;
+      if (!funcs::PackFCWeight<float>(dev_ctx_, n_, k_, w, ldw, &packed_w)) {
+        LOG(INFO) << "The GEMM backend has no packed layout, skip " << name;
+        return;
+      }
+    }
+
+    std::vector<float> y(m_ * n_);
+    funcs::FCFunctor<CPUContext, float> fc;
+    fc(dev_ctx_,
+       m_,
+       n_,
+       k_,
+       x_.data(),
+       w,
+       y.data(),
+       with_bias ? b_.data() : nullptr,
+       relu,
+       padding,
+       packed ? packed_w.data<float>() : nullptr);
+
+    auto expected = Reference(with_bias, relu);
+    for (int i = 0; i < m_ * n_; ++i) {
+      ASSERT_NEAR(y[i], expected[i], 1e-4f) << name << " at " << i;
+    }
+  }
+
+  const int m_ = 13;
+  const int n_ = 19;
+  const int k_ = 23;
+  phi::CPUContext dev_ctx_;
+  std::vector<float> x_;
+  std::vector<float> w_;
+  std::vector<float> b_;
+  std::vector<float> padded_w_;
+};
+
+TEST_F(FCFunctorTest, without_bias) {
+  for (bool padding : {false, true}) {
+    for (bool packed : {false, true}) {
+      Check(padding, packed, false, false);
+    }
+  }
+}
+
+TEST_F(FCFunctorTest, with_bias) {
+  for (bool padding : {false, true}) {
+    for (bool packed : {false, true}) {
+      for (bool relu : {false, true}) {
+        Check(padding, packed, true, relu);
+      }
+    }
+  }
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,227 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/multihead_attention.h"
+
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/phi/tests/core/timer.h"
+
+namespace phi {
+namespace tests {
+
+struct AttentionCase {
+  int batch;
+  int seq_len;
+  int head_number;
+  int head_size;
+  // the dims of the mask, empty for no mask
+  std::vector<int64_t> mask_dims;
+};
+
+// Runs MultiHeadAttention and checks it against the attention that
+// materializes the [seq_len, seq_len] scores of every head.
+class MultiHeadAttentionTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dev_ctx_.SetAllocator(
+        paddle::memory::allocation::AllocatorFacade::Instance()
+            .GetAllocator(paddle::platform::CPUPlace())
+            .get());
+    dev_ctx_.Init();
+  }
+
+  void Prepare(const AttentionCase& c) {
+    const int hidden = c.head_number * c.head_size;
+    qkv_.resize(static_cast<size_t>(c.batch) * c.seq_len * 3 * hidden);
+    for (size_t i = 0; i < qkv_.size(); ++i) {
+      qkv_[i] = static_cast<float>((i * 7919 + 13) % 1000) / 250.f - 2.f;
+    }
+    mask_.clear();
+    if (!c.mask_dims.empty()) {
+      mask_.resize(phi::product(phi::make_ddim(c.mask_dims)));
+      const int64_t rows = c.mask_dims[2];
+      for (size_t i = 0; i < mask_.size(); ++i) {
+        const int64_t key = i % c.seq_len;
+        const int64_t query = (i / c.seq_len) % rows;
+        const int64_t b = i / (c.seq_len * rows * c.mask_dims[1]);
+        if (rows == 1) {
+          // the keys padded to seq_len
+          mask_[i] = key < c.seq_len - 5 * b ? 0.f : -10000.f;
+        } else {
+          // a causal mask
+          mask_[i] = key <= query ? static_cast<float>(i % 7) * 0.1f
+                                  : -std::numeric_limits<float>::infinity();
+        }
+      }
+    }
+    out_.assign(static_cast<size_t>(c.batch) * c.seq_len * hidden, 0.f);
+    expected_.assign(out_.size(), 0.f);
+  }
+
+  void Fused(const AttentionCase& c) {
+    phi::funcs::MultiHeadAttention(
+        dev_ctx_,
+        c.batch,
+        c.seq_len,
+        c.head_number,
+        c.head_size,
+        qkv_.data(),
+        mask_.empty() ? nullptr : mask_.data(),
+        mask_.empty() ? phi::make_ddim({1}) : phi::make_ddim(c.mask_dims),
+        scale_,
+        out_.data());
+  }
+
+  void Materialized(const AttentionCase& c) {
+    const int hidden = c.head_number * c.head_size;
+    const int ld = 3 * hidden;
+    auto blas = phi::funcs::GetBlas<phi::CPUContext, float>(dev_ctx_);
+    std::vector<float> scores(static_cast<size_t>(c.seq_len) * c.seq_len);
+    for (int b = 0; b < c.batch; ++b) {
+      for (int n = 0; n < c.head_number; ++n) {
+        const float* q = qkv_.data() +
+                         static_cast<int64_t>(b) * c.seq_len * ld +
+                         n * c.head_size;
+        blas.GEMM(false,
+                  true,
+                  c.seq_len,
+                  c.seq_len,
+                  c.head_size,
+                  scale_,
+                  q,
+                  ld,
+                  q + hidden,
+                  ld,
+                  0.f,
+                  scores.data(),
+                  c.seq_len);
+        for (int i = 0; i < c.seq_len; ++i) {
+          float* s = scores.data() + i * c.seq_len;
+          if (!mask_.empty()) {
+            const int64_t offset =
+                b * c.mask_dims[1] * c.mask_dims[2] * c.seq_len +
+                (c.mask_dims[1] == 1 ? 0 : n * c.mask_dims[2] * c.seq_len) +
+                (c.mask_dims[2] == 1 ? 0 : i * c.seq_len);
+            for (int j = 0; j < c.seq_len; ++j) {
+              s[j] += mask_[offset + j];
+            }
+          }
+          const float max = *std::max_element(s, s + c.seq_len);
+          float sum = 0.f;
+          for (int j = 0; j < c.seq_len; ++j) {
+            s[j] = std::exp(s[j] - max);
+            sum += s[j];
+          }
+          for (int j = 0; j < c.seq_len; ++j) {
+            s[j] /= sum;
+          }
+        }
+        blas.GEMM(false,
+                  false,
+                  c.seq_len,
+                  c.head_size,
+                  c.seq_len,
+                  1.f,
+                  scores.data(),
+                  c.seq_len,
+                  q + 2 * hidden,
+                  ld,
+                  0.f,
+                  expected_.data() +
+                      static_cast<int64_t>(b) * c.seq_len * hidden +
+                      n * c.head_size,
+                  hidden);
+      }
+    }
+  }
+
+  void Check(const AttentionCase& c) {
+    Prepare(c);
+    Fused(c);
+    Materialized(c);
+    for (size_t i = 0; i < out_.size(); ++i) {
+      ASSERT_NEAR(out_[i], expected_[i], 1e-4f * (1.f + std::abs(expected_[i])))
+          << "seq_len " << c.seq_len << " at " << i;
+    }
+  }
+
+  double TimeOf(const std::function<void()>& fn) {
+    fn();  // warm up
+    Timer timer;
+    timer.tic();
+    for (int i = 0; i < repeat_; ++i) {
+      fn();
+    }
+    return timer.toc() / repeat_;
+  }
+
+  const int repeat_ = 10;
+  const float scale_ = 0.125f;
+  phi::CPUContext dev_ctx_;
+  std::vector<float> qkv_;
+  std::vector<float> mask_;
+  std::vector<float> out_;
+  std::vector<float> expected_;
+};
+
+TEST_F(MultiHeadAttentionTest, shapes) {
+  // the tails of the query and key blocks
+  std::vector<AttentionCase> cases = {
+      {1, 1, 1, 1, {}},
+      {2, 37, 3, 8, {}},
+      {2, 129, 4, 16, {2, 1, 1, 129}},
+      {3, 300, 2, 64, {3, 1, 1, 300}},
+      {2, 150, 2, 32, {2, 2, 150, 150}},
+      {2, 70, 3, 16, {2, 1, 70, 70}},
+  };
+  for (auto& c : cases) {
+    Check(c);
+  }
+}
+
+TEST_F(MultiHeadAttentionTest, all_keys_masked) {
+  AttentionCase c{1, 40, 2, 8, {1, 1, 1, 40}};
+  Prepare(c);
+  std::fill(mask_.begin(), mask_.end(), -10000.f);
+  Fused(c);
+  Materialized(c);
+  for (size_t i = 0; i < out_.size(); ++i) {
+    // the scores are rounded to the precision of float at -10000
+    ASSERT_NEAR(out_[i], expected_[i], 1e-2f) << "at " << i;
+  }
+}
+
+TEST_F(MultiHeadAttentionTest, bert_seq_lens) {
+  for (int seq_len : {64, 128, 256, 384, 512}) {
+    AttentionCase c{1, seq_len, 12, 64, {1, 1, 1, seq_len}};
+    Check(c);
+    const double fused_ms = TimeOf([&]() { Fused(c); });
+    const double materialized_ms = TimeOf([&]() { Materialized(c); });
+    LOG(INFO) << "attention of 12 heads of 64 at seq_len " << seq_len
+              << ", fused costs: " << fused_ms
+              << " ms, materialized costs: " << materialized_ms << " ms.";
+  }
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,223 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/int8_gemm.h"
+#include "paddle/phi/kernels/quant_linear_kernel.h"
+
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/phi/api/lib/utils/allocator.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/tests/core/timer.h"
+
+namespace phi {
+namespace tests {
+
+struct LinearCase {
+  std::string name;
+  int m;
+  int k;
+  int n;
+};
+
+// Runs QuantLinearKernel, checks it against the float gemm of the same
+// quantized values and logs its time and the time of the float Blas gemm.
+class QuantLinearTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    alloc_ = std::make_unique<paddle::experimental::DefaultAllocator>(
+        paddle::platform::CPUPlace());
+    dev_ctx_.SetAllocator(
+        paddle::memory::allocation::AllocatorFacade::Instance()
+            .GetAllocator(paddle::platform::CPUPlace())
+            .get());
+    dev_ctx_.Init();
+  }
+
+  void TearDown() override {
+    phi::funcs::PackedInt8WeightCache::Instance().Clear();
+  }
+
+  phi::DenseTensor RandomTensor(const std::vector<int64_t>& dims,
+                                int seed) {
+    phi::DenseTensor t(alloc_.get(),
+                       phi::DenseTensorMeta(phi::DataType::FLOAT32,
+                                            phi::make_ddim(dims),
+                                            phi::DataLayout::NCHW));
+    auto* data = t.mutable_data<float>(paddle::platform::CPUPlace());
+    for (int64_t i = 0; i < t.numel(); ++i) {
+      data[i] = static_cast<float>((i * 7919 + seed) % 1000) / 500.f - 1.f;
+    }
+    return t;
+  }
+
+  phi::DenseTensor EmptyTensor(const std::vector<int64_t>& dims) {
+    return phi::DenseTensor(alloc_.get(),
+                            phi::DenseTensorMeta(phi::DataType::FLOAT32,
+                                                 phi::make_ddim(dims),
+                                                 phi::DataLayout::NCHW));
+  }
+
+  double TimeOf(const std::function<void()>& fn) {
+    fn();  // warm up
+    Timer timer;
+    timer.tic();
+    for (int i = 0; i < repeat_; ++i) {
+      fn();
+    }
+    return timer.toc() / repeat_;
+  }
+
+  void Run(const LinearCase& c, bool relu) {
+    auto x = RandomTensor({c.m, c.k}, 1);
+    auto w = RandomTensor({c.k, c.n}, 2);
+    auto bias = RandomTensor({c.n}, 3);
+    const float scale_in = 1.f / 127.f;
+    const std::string activation = relu ? "relu" : "";
+
+    auto out = EmptyTensor({c.m, c.n});
+    auto quant_linear = [&]() {
+      phi::QuantLinearKernel<float, phi::CPUContext>(dev_ctx_,
+                                                     x,
+                                                     w,
+                                                     bias,
+                                                     1,
+                                                     false,
+                                                     false,
+                                                     activation,
+                                                     scale_in,
+                                                     {},
+                                                     &out);
+    };
+    quant_linear();
+
+    // the float gemm of the dequantized x and w
+    auto x_dq = EmptyTensor({c.m, c.k});
+    auto w_dq = EmptyTensor({c.k, c.n});
+    const float* x_data = x.data<float>();
+    float* x_dq_data = x_dq.mutable_data<float>(paddle::platform::CPUPlace());
+    for (int64_t i = 0; i < x.numel(); ++i) {
+      const float q = std::round(x_data[i] / scale_in);
+      x_dq_data[i] = std::min(127.f, std::max(-128.f, q)) * scale_in;
+    }
+    const float* w_data = w.data<float>();
+    float* w_dq_data = w_dq.mutable_data<float>(paddle::platform::CPUPlace());
+    for (int j = 0; j < c.n; ++j) {
+      float max_abs = 0.f;
+      for (int i = 0; i < c.k; ++i) {
+        max_abs = std::max(max_abs, std::abs(w_data[i * c.n + j]));
+      }
+      const float scale = max_abs > 0.f ? max_abs / 127.f : 1.f;
+      for (int i = 0; i < c.k; ++i) {
+        const int idx = i * c.n + j;
+        w_dq_data[idx] = std::round(w_data[idx] / scale) * scale;
+      }
+    }
+
+    auto expected = EmptyTensor({c.m, c.n});
+    float* expected_data =
+        expected.mutable_data<float>(paddle::platform::CPUPlace());
+    auto blas = phi::funcs::GetBlas<phi::CPUContext, float>(dev_ctx_);
+    auto fp32_gemm = [&]() {
+      blas.GEMM(CblasNoTrans,
+                CblasNoTrans,
+                c.m,
+                c.n,
+                c.k,
+                1.f,
+                x_dq_data,
+                w_dq_data,
+                0.f,
+                expected_data);
+    };
+    fp32_gemm();
+    for (int i = 0; i < c.m; ++i) {
+      for (int j = 0; j < c.n; ++j) {
+        float e = expected_data[i * c.n + j] + bias.data<float>()[j];
+        if (relu) {
+          e = std::max(e, 0.f);
+        }
+        ASSERT_NEAR(
+            out.data<float>()[i * c.n + j], e, 1e-3f * (1 + std::abs(e)))
+            << c.name << " at (" << i << ", " << j << ")";
+      }
+    }
+
+    const double int8_ms = TimeOf(quant_linear);
+    const double fp32_ms = TimeOf(fp32_gemm);
+    LOG(INFO) << c.name << " [" << c.m << ", " << c.k << "] x [" << c.k
+              << ", " << c.n << "] int8 gemm ("
+              << phi::funcs::Int8GemmKernelName() << ") costs: " << int8_ms
+              << " ms, fp32 blas costs: " << fp32_ms << " ms.";
+  }
+
+  const int repeat_ = 10;
+  std::unique_ptr<paddle::experimental::DefaultAllocator> alloc_;
+  phi::CPUContext dev_ctx_;
+};
+
+TEST_F(QuantLinearTest, small_shapes) {
+  // the tails of the microkernels and of the groups of k
+  std::vector<LinearCase> cases = {
+      {"one", 1, 1, 1},
+      {"tails", 7, 13, 35},
+      {"k_tail", 5, 66, 16},
+  };
+  for (auto& c : cases) {
+    Run(c, false);
+    Run(c, true);
+  }
+}
+
+TEST_F(QuantLinearTest, bert) {
+  std::vector<LinearCase> cases = {
+      {"qkv_batch1", 1, 768, 2304},
+      {"ffn1_seq128", 128, 768, 3072},
+      {"ffn2_seq128", 128, 3072, 768},
+  };
+  for (auto& c : cases) {
+    Run(c, false);
+  }
+}
+
+TEST_F(QuantLinearTest, weight_cache) {
+  auto& cache = phi::funcs::PackedInt8WeightCache::Instance();
+  cache.Clear();
+  auto x = RandomTensor({4, 32}, 1);
+  auto w = RandomTensor({32, 8}, 2);
+  auto out = EmptyTensor({4, 8});
+  for (int i = 0; i < 3; ++i) {
+    phi::QuantLinearKernel<float, phi::CPUContext>(
+        dev_ctx_, x, w, paddle::none, 1, false, false, "", 0.01f, {}, &out);
+  }
+  EXPECT_EQ(cache.Size(), 1UL);
+
+  // a new allocation of the weight is packed again
+  w = RandomTensor({32, 8}, 3);
+  phi::QuantLinearKernel<float, phi::CPUContext>(
+      dev_ctx_, x, w, paddle::none, 1, false, false, "", 0.01f, {}, &out);
+  EXPECT_EQ(cache.Size(), 1UL);
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,253 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/blas/small_gemm.h"
+
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/phi/tests/core/timer.h"
+
+namespace phi {
+namespace tests {
+
+struct GemmShape {
+  int batch;
+  int m;
+  int n;
+  int k;
+};
+
+// Runs SmallBatchedGEMM and checks it against Blas::GEMM on each matrix of
+// the batch.
+class SmallBatchedGEMMTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dev_ctx_.SetAllocator(
+        paddle::memory::allocation::AllocatorFacade::Instance()
+            .GetAllocator(paddle::platform::CPUPlace())
+            .get());
+    dev_ctx_.Init();
+    dev_ctx_.SetNumThreads(
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+  }
+
+  void TearDown() override { dev_ctx_.SetNumThreads(1); }
+
+  void Prepare(const GemmShape& s) {
+    a_.resize(static_cast<size_t>(s.batch) * s.m * s.k);
+    b_.resize(static_cast<size_t>(s.batch) * s.k * s.n);
+    for (size_t i = 0; i < a_.size(); ++i) {
+      a_[i] = static_cast<float>((i * 7919 + 13) % 1000) / 500.f - 1.f;
+    }
+    for (size_t i = 0; i < b_.size(); ++i) {
+      b_[i] = static_cast<float>((i * 104729 + 7) % 1000) / 500.f - 1.f;
+    }
+    out_.resize(static_cast<size_t>(s.batch) * s.m * s.n);
+    for (size_t i = 0; i < out_.size(); ++i) {
+      out_[i] = static_cast<float>(i % 13);
+    }
+    expected_ = out_;
+    a_ptrs_.clear();
+    b_ptrs_.clear();
+    out_ptrs_.clear();
+    for (int i = 0; i < s.batch; ++i) {
+      a_ptrs_.push_back(a_.data() + static_cast<int64_t>(i) * s.m * s.k);
+      b_ptrs_.push_back(b_.data() + static_cast<int64_t>(i) * s.k * s.n);
+      out_ptrs_.push_back(out_.data() + static_cast<int64_t>(i) * s.m * s.n);
+    }
+  }
+
+  void Small(const GemmShape& s, bool trans_a, bool trans_b, float beta) {
+    phi::funcs::SmallBatchedGEMM<float>(dev_ctx_,
+                                        trans_a,
+                                        trans_b,
+                                        s.m,
+                                        s.n,
+                                        s.k,
+                                        alpha_,
+                                        a_ptrs_.data(),
+                                        b_ptrs_.data(),
+                                        beta,
+                                        out_ptrs_.data(),
+                                        s.batch);
+  }
+
+  void PerMatrix(const GemmShape& s,
+                 bool trans_a,
+                 bool trans_b,
+                 float beta,
+                 float* out) {
+    auto blas = phi::funcs::GetBlas<phi::CPUContext, float>(dev_ctx_);
+    for (int i = 0; i < s.batch; ++i) {
+      blas.GEMM(trans_a ? CblasTrans : CblasNoTrans,
+                trans_b ? CblasTrans : CblasNoTrans,
+                s.m,
+                s.n,
+                s.k,
+                alpha_,
+                a_ptrs_[i],
+                b_ptrs_[i],
+                beta,
+                out + static_cast<int64_t>(i) * s.m * s.n);
+    }
+  }
+
+  double TimeOf(const std::function<void()>& fn) {
+    fn();  // warm up
+    Timer timer;
+    timer.tic();
+    for (int i = 0; i < repeat_; ++i) {
+      fn();
+    }
+    return timer.toc() / repeat_;
+  }
+
+  const int repeat_ = 10;
+  const float alpha_ = 0.5f;
+  phi::CPUContext dev_ctx_;
+  std::vector<float> a_;
+  std::vector<float> b_;
+  std::vector<float> out_;
+  std::vector<float> expected_;
+  std::vector<const float*> a_ptrs_;
+  std::vector<const float*> b_ptrs_;
+  std::vector<float*> out_ptrs_;
+};
+
+TEST_F(SmallBatchedGEMMTest, transposes) {
+  // the tails of the 4-row tiles and of the panels of 16 columns
+  std::vector<GemmShape> shapes = {
+      {1, 1, 1, 1}, {3, 5, 17, 9}, {7, 16, 64, 64}, {2, 33, 31, 3}};
+  for (auto& s : shapes) {
+    for (bool trans_a : {false, true}) {
+      for (bool trans_b : {false, true}) {
+        for (float beta : {0.f, 1.f}) {
+          Prepare(s);
+          Small(s, trans_a, trans_b, beta);
+          PerMatrix(s, trans_a, trans_b, beta, expected_.data());
+          for (size_t i = 0; i < out_.size(); ++i) {
+            ASSERT_NEAR(out_[i], expected_[i], 1e-4f * (1.f + s.k))
+                << "shape " << s.m << "x" << s.n << "x" << s.k << " at " << i;
+          }
+        }
+      }
+    }
+  }
+}
+
+// Blas::BatchedGEMM takes SmallBatchedGEMM below the small sizes and GEMM
+// per matrix above them, unless MKLML runs the whole batch.
+TEST_F(SmallBatchedGEMMTest, blas_batched_gemm) {
+  auto blas = phi::funcs::GetBlas<phi::CPUContext, float>(dev_ctx_);
+  std::vector<GemmShape> shapes = {{5, 16, 64, 64}, {3, 130, 9, 17}};
+  for (auto& s : shapes) {
+    for (bool trans_a : {false, true}) {
+      for (bool trans_b : {false, true}) {
+        const std::string name = "shape " + std::to_string(s.m) + "x" +
+                                 std::to_string(s.n) + "x" +
+                                 std::to_string(s.k);
+        Prepare(s);
+        PerMatrix(s, trans_a, trans_b, 1.f, expected_.data());
+        blas.BatchedGEMM(trans_a ? CblasTrans : CblasNoTrans,
+                         trans_b ? CblasTrans : CblasNoTrans,
+                         s.m,
+                         s.n,
+                         s.k,
+                         alpha_,
+                         a_.data(),
+                         b_.data(),
+                         1.f,
+                         out_.data(),
+                         s.batch,
+                         static_cast<int64_t>(s.m) * s.k,
+                         static_cast<int64_t>(s.k) * s.n);
+        for (size_t i = 0; i < out_.size(); ++i) {
+          ASSERT_NEAR(out_[i], expected_[i], 1e-4f * (1.f + s.k))
+              << name << " strided at " << i;
+        }
+
+        Prepare(s);
+        blas.BatchedGEMM(trans_a ? CblasTrans : CblasNoTrans,
+                         trans_b ? CblasTrans : CblasNoTrans,
+                         s.m,
+                         s.n,
+                         s.k,
+                         alpha_,
+                         a_ptrs_.data(),
+                         b_ptrs_.data(),
+                         0.f,
+                         out_ptrs_.data(),
+                         s.batch);
+        PerMatrix(s, trans_a, trans_b, 0.f, expected_.data());
+        for (size_t i = 0; i < out_.size(); ++i) {
+          ASSERT_NEAR(out_[i], expected_[i], 1e-4f * (1.f + s.k))
+              << name << " pointers at " << i;
+        }
+      }
+    }
+  }
+}
+
+TEST_F(SmallBatchedGEMMTest, selection) {
+  EXPECT_TRUE(phi::funcs::UseSmallBatchedGEMM<float>(16, 64, 64));
+  EXPECT_TRUE(phi::funcs::UseSmallBatchedGEMM<double>(64, 64, 64));
+  EXPECT_FALSE(phi::funcs::UseSmallBatchedGEMM<float>(128, 128, 128));
+  EXPECT_FALSE(phi::funcs::UseSmallBatchedGEMM<float>(1, 1, 4096));
+  EXPECT_FALSE(
+      phi::funcs::UseSmallBatchedGEMM<phi::dtype::complex<float>>(4, 4, 4));
+
+  using complex64 = phi::dtype::complex<float>;
+  EXPECT_THROW(phi::funcs::SmallBatchedGEMM<complex64>(dev_ctx_,
+                                                       false,
+                                                       false,
+                                                       4,
+                                                       4,
+                                                       4,
+                                                       complex64(1),
+                                                       nullptr,
+                                                       nullptr,
+                                                       complex64(0),
+                                                       nullptr,
+                                                       1),
+               phi::enforce::EnforceNotMet);
+}
+
+TEST_F(SmallBatchedGEMMTest, benchmark) {
+  for (int batch : {64, 512}) {
+    for (auto mnk : std::vector<std::vector<int>>{
+             {4, 4, 4}, {16, 64, 64}, {32, 32, 32}, {64, 64, 64}}) {
+      GemmShape s{batch, mnk[0], mnk[1], mnk[2]};
+      Prepare(s);
+      const double small_ms = TimeOf([&]() { Small(s, false, false, 0.f); });
+      const double gemm_ms = TimeOf(
+          [&]() { PerMatrix(s, false, false, 0.f, expected_.data()); });
+      LOG(INFO) << "batch " << batch << " of " << s.m << "x" << s.n << "x"
+                << s.k << " with " << dev_ctx_.GetNumThreads()
+                << " threads, SmallBatchedGEMM costs: " << small_ms
+                << " ms, GEMM per matrix costs: " << gemm_ms << " ms.";
+    }
+  }
+}
+
+}  // namespace tests
+}  // namespace phi
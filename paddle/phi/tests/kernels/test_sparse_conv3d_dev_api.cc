@@ -13,17 +13,23 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <memory>
+#include <random>
+#include <thread>
+#include <unordered_set>
 
 #include "paddle/phi/backends/gpu/gpu_context.h"
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/kernels/copy_kernel.h"
+#include "paddle/phi/kernels/funcs/sparse/rulebook_cache.h"
 #include "paddle/phi/kernels/sparse/convolution_grad_kernel.h"
 #include "paddle/phi/kernels/sparse/convolution_kernel.h"
 
 #include "paddle/fluid/memory/allocation/allocator_facade.h"
 #include "paddle/phi/api/lib/utils/allocator.h"
 #include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/tests/core/timer.h"
 
 namespace phi {
 namespace tests {
@@ -821,5 +827,125 @@ TEST(DEV_API, sparse_conv3d_subm) {
              true);
 }
 
+// Random voxels of a point cloud, runs the CPU sparse conv with one and
+// with all threads, and a second time to reuse the cached rulebook. All the
+// runs must give the same result, the times are logged.
+TEST(DEV_API, sparse_conv3d_voxel_benchmark) {
+  phi::CPUContext dev_ctx_cpu;
+  dev_ctx_cpu.SetAllocator(
+      paddle::memory::allocation::AllocatorFacade::Instance()
+          .GetAllocator(paddle::platform::CPUPlace())
+          .get());
+  dev_ctx_cpu.Init();
+
+  const int in_channels = 16;
+  const int out_channels = 32;
+  const int non_zero_num = 50000;
+  DDim x_dims = {1, 40, 200, 176, in_channels};
+
+  std::mt19937 engine(2022);
+  std::unordered_set<int> voxels;
+  while (static_cast<int>(voxels.size()) < non_zero_num) {
+    voxels.insert(engine() % (x_dims[1] * x_dims[2] * x_dims[3]));
+  }
+  std::vector<int> sorted_voxels(voxels.begin(), voxels.end());
+  std::sort(sorted_voxels.begin(), sorted_voxels.end());
+
+  DenseTensor indices = phi::Empty(
+      dev_ctx_cpu,
+      DenseTensorMeta(DataType::INT32, {4, non_zero_num}, DataLayout::NCHW));
+  int* indices_ptr = indices.data<int>();
+  for (int i = 0; i < non_zero_num; i++) {
+    int index = sorted_voxels[i];
+    indices_ptr[i + non_zero_num * 3] = index % x_dims[3];
+    index /= x_dims[3];
+    indices_ptr[i + non_zero_num * 2] = index % x_dims[2];
+    indices_ptr[i + non_zero_num] = index / x_dims[2];
+    indices_ptr[i] = 0;
+  }
+  DenseTensor features = phi::Empty(
+      dev_ctx_cpu,
+      DenseTensorMeta(
+          DataType::FLOAT32, {non_zero_num, in_channels}, DataLayout::NHWC));
+  DenseTensor kernel = phi::Empty(
+      dev_ctx_cpu,
+      DenseTensorMeta(DataType::FLOAT32,
+                      {3, 3, 3, in_channels, out_channels},
+                      DataLayout::NHWC));
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  for (int64_t i = 0; i < features.numel(); i++) {
+    features.data<float>()[i] = dist(engine);
+  }
+  for (int64_t i = 0; i < kernel.numel(); i++) {
+    kernel.data<float>()[i] = dist(engine);
+  }
+  SparseCooTensor x(indices, features, x_dims);
+
+  const int max_threads =
+      std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+  for (bool subm : {true, false}) {
+    const std::string name = subm ? "subm_conv3d" : "conv3d_stride2";
+    std::vector<int> strides = subm ? std::vector<int>{1, 1, 1}
+                                    : std::vector<int>{2, 2, 2};
+    std::vector<float> expected_out, expected_x_grad;
+    for (int num_threads : {1, max_threads}) {
+      dev_ctx_cpu.SetNumThreads(num_threads);
+      phi::funcs::sparse::RulebookCache::Instance().Clear();
+      for (int run = 0; run < 2; run++) {
+        DenseTensor rulebook;
+        Timer timer;
+        timer.tic();
+        SparseCooTensor out = sparse::Conv3d<float>(dev_ctx_cpu,
+                                                    x,
+                                                    kernel,
+                                                    {1, 1, 1},
+                                                    {1, 1, 1},
+                                                    strides,
+                                                    1,
+                                                    subm,
+                                                    &rulebook);
+        const double forward_ms = timer.toc();
+        timer.tic();
+        auto grads = sparse::Conv3dGrad<float>(dev_ctx_cpu,
+                                               x,
+                                               kernel,
+                                               rulebook,
+                                               out,
+                                               {1, 1, 1},
+                                               {1, 1, 1},
+                                               strides,
+                                               1,
+                                               subm);
+        const double backward_ms = timer.toc();
+        LOG(INFO) << name << " of " << non_zero_num << " voxels with "
+                  << num_threads << " threads"
+                  << (run == 0 ? "" : " and the cached rulebook")
+                  << ", forward costs: " << forward_ms
+                  << " ms, backward costs: " << backward_ms << " ms.";
+
+        const auto& out_values = out.non_zero_elements();
+        const auto& x_grad = std::get<0>(grads).non_zero_elements();
+        if (expected_out.empty()) {
+          expected_out.assign(out_values.data<float>(),
+                              out_values.data<float>() + out_values.numel());
+          expected_x_grad.assign(x_grad.data<float>(),
+                                 x_grad.data<float>() + x_grad.numel());
+          continue;
+        }
+        ASSERT_EQ(static_cast<int64_t>(expected_out.size()),
+                  out_values.numel());
+        for (int64_t i = 0; i < out_values.numel(); i++) {
+          ASSERT_NEAR(expected_out[i], out_values.data<float>()[i], 1e-4);
+        }
+        for (int64_t i = 0; i < x_grad.numel(); i++) {
+          ASSERT_NEAR(expected_x_grad[i], x_grad.data<float>()[i], 1e-4);
+        }
+      }
+      ASSERT_EQ(phi::funcs::sparse::RulebookCache::Instance().Size(), 1UL);
+    }
+  }
+  dev_ctx_cpu.SetNumThreads(1);
+}
+
 }  // namespace tests
 }  // namespace phi
@@ -0,0 +1,266 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/adagrad_kernel.h"
+#include "paddle/phi/kernels/selected_rows/adam_kernel.h"
+#include "paddle/phi/kernels/sgd_kernel.h"
+
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/phi/api/lib/utils/allocator.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/core/selected_rows.h"
+#include "paddle/phi/tests/core/timer.h"
+
+namespace phi {
+namespace tests {
+
+// Runs the sparse sgd, adagrad and adam kernels on the gradient of an
+// embedding with duplicated ids and checks them against the update with the
+// summed gradient of every row. The benchmark is disabled by default, run it
+// with --gtest_also_run_disabled_tests.
+class SparseOptimizerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    alloc_ = std::make_unique<paddle::experimental::DefaultAllocator>(
+        paddle::platform::CPUPlace());
+    dev_ctx_.SetAllocator(
+        paddle::memory::allocation::AllocatorFacade::Instance()
+            .GetAllocator(paddle::platform::CPUPlace())
+            .get());
+    dev_ctx_.Init();
+    dev_ctx_.SetNumThreads(
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+  }
+
+  void TearDown() override { dev_ctx_.SetNumThreads(1); }
+
+  DenseTensor Filled(const std::vector<int64_t>& dims, float scale) {
+    DenseTensor t(alloc_.get(),
+                  DenseTensorMeta(DataType::FLOAT32,
+                                  phi::make_ddim(dims),
+                                  DataLayout::NCHW));
+    float* data = t.mutable_data<float>(paddle::platform::CPUPlace());
+    for (int64_t i = 0; i < t.numel(); ++i) {
+      data[i] = static_cast<float>((i * 7919 + 13) % 1000) / 1000.f * scale;
+    }
+    return t;
+  }
+
+  // num_ids rows of width for ids in [0, height), many of them duplicated
+  SelectedRows Grad(int64_t num_ids, int64_t height, int64_t width) {
+    std::vector<int64_t> rows(num_ids);
+    uint64_t state = 88172645463325252ULL;
+    for (auto& row : rows) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      row = static_cast<int64_t>(state % height);
+    }
+    SelectedRows grad(rows, height);
+    *grad.mutable_value() = Filled({num_ids, width}, 2.f);
+    return grad;
+  }
+
+  // row -> summed gradient of the row
+  std::map<int64_t, std::vector<float>> Merged(const SelectedRows& grad) {
+    const int64_t width = grad.value().dims()[1];
+    std::map<int64_t, std::vector<float>> merged;
+    for (size_t i = 0; i < grad.rows().size(); ++i) {
+      auto& sum = merged[grad.rows()[i]];
+      sum.resize(width, 0.f);
+      for (int64_t j = 0; j < width; ++j) {
+        sum[j] += grad.value().data<float>()[i * width + j];
+      }
+    }
+    return merged;
+  }
+
+  void ExpectNear(const DenseTensor& out, const std::vector<float>& expected) {
+    ASSERT_EQ(out.numel(), static_cast<int64_t>(expected.size()));
+    for (size_t i = 0; i < expected.size(); ++i) {
+      ASSERT_NEAR(out.data<float>()[i],
+                  expected[i],
+                  1e-5f * (1.f + std::abs(expected[i])))
+          << "at " << i;
+    }
+  }
+
+  std::unique_ptr<paddle::experimental::DefaultAllocator> alloc_;
+  phi::CPUContext dev_ctx_;
+  const int64_t height_ = 3000;
+  const int64_t width_ = 24;
+  const int64_t num_ids_ = 20000;
+};
+
+TEST_F(SparseOptimizerTest, sgd) {
+  auto param = Filled({height_, width_}, 1.f);
+  auto lr = Filled({1}, 0.f);
+  lr.data<float>()[0] = 0.1f;
+  auto grad = Grad(num_ids_, height_, width_);
+
+  std::vector<float> expected(param.data<float>(),
+                              param.data<float>() + param.numel());
+  for (auto& row : Merged(grad)) {
+    for (int64_t j = 0; j < width_; ++j) {
+      expected[row.first * width_ + j] -= 0.1f * row.second[j];
+    }
+  }
+
+  SGDDenseParamSparseGradKernel<float, CPUContext>(
+      dev_ctx_, param, lr, grad, paddle::none, false, &param, nullptr);
+  ExpectNear(param, expected);
+}
+
+TEST_F(SparseOptimizerTest, adagrad) {
+  auto param = Filled({height_, width_}, 1.f);
+  auto moment = Filled({height_, width_}, 0.5f);
+  auto lr = Filled({1}, 0.f);
+  lr.data<float>()[0] = 0.1f;
+  const float epsilon = 1e-6f;
+  auto grad = Grad(num_ids_, height_, width_);
+
+  std::vector<float> expected_param(param.data<float>(),
+                                    param.data<float>() + param.numel());
+  std::vector<float> expected_moment(moment.data<float>(),
+                                     moment.data<float>() + moment.numel());
+  for (auto& row : Merged(grad)) {
+    for (int64_t j = 0; j < width_; ++j) {
+      const int64_t i = row.first * width_ + j;
+      const float g = row.second[j];
+      expected_moment[i] += g * g;
+      expected_param[i] -=
+          0.1f * g / (std::sqrt(expected_moment[i]) + epsilon);
+    }
+  }
+
+  AdagradSparseKernel<float, CPUContext>(
+      dev_ctx_, param, grad, moment, lr, epsilon, &param, &moment);
+  ExpectNear(param, expected_param);
+  ExpectNear(moment, expected_moment);
+}
+
+TEST_F(SparseOptimizerTest, adam) {
+  const float beta1 = 0.9f;
+  const float beta2 = 0.999f;
+  const float epsilon = 1e-8f;
+  for (bool lazy_mode : {true, false}) {
+    auto param = Filled({height_, width_}, 1.f);
+    auto moment1 = Filled({height_, width_}, 0.1f);
+    auto moment2 = Filled({height_, width_}, 0.01f);
+    auto lr = Filled({1}, 0.f);
+    lr.data<float>()[0] = 0.01f;
+    auto beta1_pow = Filled({1}, 0.f);
+    beta1_pow.data<float>()[0] = beta1;
+    auto beta2_pow = Filled({1}, 0.f);
+    beta2_pow.data<float>()[0] = beta2;
+    auto grad = Grad(num_ids_, height_, width_);
+    auto merged = Merged(grad);
+
+    std::vector<float> expected_param(param.numel());
+    std::vector<float> expected_moment1(param.numel());
+    std::vector<float> expected_moment2(param.numel());
+    const float lr_t = 0.01f * std::sqrt(1 - beta2) / (1 - beta1);
+    for (int64_t row = 0; row < height_; ++row) {
+      auto it = merged.find(row);
+      for (int64_t j = 0; j < width_; ++j) {
+        const int64_t i = row * width_ + j;
+        float p = param.data<float>()[i];
+        float m1 = moment1.data<float>()[i];
+        float m2 = moment2.data<float>()[i];
+        if (it != merged.end()) {
+          const float g = it->second[j];
+          m1 = beta1 * m1 + (1 - beta1) * g;
+          m2 = beta2 * m2 + (1 - beta2) * g * g;
+          p -= lr_t * (m1 / (std::sqrt(m2) + epsilon * std::sqrt(1 - beta2)));
+        } else if (!lazy_mode) {
+          m1 = beta1 * m1;
+          m2 = beta2 * m2;
+          p -= lr_t * (m1 / (std::sqrt(m2) + epsilon));
+        }
+        expected_param[i] = p;
+        expected_moment1[i] = m1;
+        expected_moment2[i] = m2;
+      }
+    }
+
+    sr::AdamDenseParamSparseGradKernel<float, CPUContext>(dev_ctx_,
+                                                          param,
+                                                          grad,
+                                                          lr,
+                                                          moment1,
+                                                          moment2,
+                                                          beta1_pow,
+                                                          beta2_pow,
+                                                          paddle::none,
+                                                          paddle::none,
+                                                          beta1,
+                                                          beta2,
+                                                          epsilon,
+                                                          lazy_mode,
+                                                          1000,
+                                                          false,
+                                                          true,
+                                                          &param,
+                                                          &moment1,
+                                                          &moment2,
+                                                          &beta1_pow,
+                                                          &beta2_pow,
+                                                          nullptr);
+    ExpectNear(param, expected_param);
+    ExpectNear(moment1, expected_moment1);
+    ExpectNear(moment2, expected_moment2);
+  }
+}
+
+TEST_F(SparseOptimizerTest, DISABLED_benchmark) {
+  // the gradient of a batch of 1M ids of a table of 100K rows
+  const int64_t height = 100000;
+  const int64_t width = 32;
+  auto param = Filled({height, width}, 1.f);
+  auto moment = Filled({height, width}, 0.5f);
+  auto lr = Filled({1}, 0.f);
+  lr.data<float>()[0] = 0.1f;
+  auto grad = Grad(1000000, height, width);
+  const int repeat = 5;
+
+  Timer timer;
+  timer.tic();
+  for (int i = 0; i < repeat; ++i) {
+    SGDDenseParamSparseGradKernel<float, CPUContext>(
+        dev_ctx_, param, lr, grad, paddle::none, false, &param, nullptr);
+  }
+  const double sgd_ms = timer.toc() / repeat;
+  timer.tic();
+  for (int i = 0; i < repeat; ++i) {
+    AdagradSparseKernel<float, CPUContext>(
+        dev_ctx_, param, grad, moment, lr, 1e-6f, &param, &moment);
+  }
+  const double adagrad_ms = timer.toc() / repeat;
+  LOG(INFO) << "1M ids of 100K rows of 32 with " << dev_ctx_.GetNumThreads()
+            << " threads, sgd costs: " << sgd_ms
+            << " ms, adagrad costs: " << adagrad_ms << " ms.";
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -52,6 +52,22 @@ class TestCostModel(unittest.TestCase):
         self.assertGreaterEqual(cost_data.get_whole_time_ms(),
                                 fc_op_time + mean_op_time)
 
+        self.assertEqual(cost_data.get_var_dims()['X'], [16, 100])
+
+        cost_model.update_cost_table(main_program, cost_data, device)
+        predicted_time = cost_model.predict_program_time_ms(
+            main_program, device, cost_data)
+        print("predicted program time:", predicted_time, "actual:",
+              cost_data.get_whole_time_ms())
+        self.assertGreater(predicted_time, 0)
+        table_path = "./test_cost_model_table.txt"
+        cost_model.save_cost_table(table_path)
+        new_cost_model = core.CostModel()
+        new_cost_model.load_cost_table(table_path)
+        self.assertAlmostEqual(
+            new_cost_model.predict_program_time_ms(main_program, device,
+                                                   cost_data), predicted_time)
+
     def test_static_op_benchmark_cost_model(self):
         op_name = "abs"
         cost_model = CostModel()
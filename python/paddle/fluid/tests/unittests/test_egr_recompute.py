@@ -0,0 +1,80 @@
+# Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import paddle.fluid.core as core
+import paddle
+import numpy as np
+from paddle.fluid.framework import _test_eager_guard
+import unittest
+
+
+class EagerRecomputeTestCase(unittest.TestCase):
+    def run_segment(self, recompute, dropout=False):
+        paddle.seed(2022)
+        linear = paddle.nn.Linear(16, 8)
+        x = paddle.rand([4, 16])
+        x.stop_gradient = False
+
+        # linear.weight is a parameter of the segment, not one of its inputs
+        def segment(inputs):
+            out = linear(inputs[0])
+            if dropout:
+                out = paddle.nn.functional.dropout(out, p=0.5)
+            return [paddle.nn.functional.sigmoid(out)]
+
+        if recompute:
+            out = core.eager.recompute(segment, [x], True)[0]
+        else:
+            out = segment([x])[0]
+        out.sum().backward()
+        return [out.numpy(), x.grad.numpy(), linear.weight.grad.numpy()]
+
+    def check_same_as_no_recompute(self, dropout):
+        with _test_eager_guard():
+            paddle.set_device("cpu")
+            expected = self.run_segment(False, dropout)
+            actual = self.run_segment(True, dropout)
+        for e, a in zip(expected, actual):
+            self.assertTrue(np.allclose(a, e, rtol=1e-6, atol=1e-7))
+
+    def test_recompute(self):
+        self.check_same_as_no_recompute(dropout=False)
+
+    def test_recompute_dropout(self):
+        # the replay draws the same dropout mask as the forward
+        self.check_same_as_no_recompute(dropout=True)
+
+    def test_single_output(self):
+        with _test_eager_guard():
+            x = paddle.ones([2, 3])
+            x.stop_gradient = False
+            out = core.eager.recompute(lambda inputs: inputs[0] * 2, [x],
+                                       True)
+            self.assertEqual(len(out), 1)
+            out[0].sum().backward()
+            self.assertTrue(np.allclose(x.grad.numpy(), np.full([2, 3], 2.)))
+
+    def test_exception(self):
+        def segment(inputs):
+            raise ValueError("wrong segment")
+
+        with _test_eager_guard():
+            x = paddle.ones([2, 3])
+            x.stop_gradient = False
+            with self.assertRaises(RuntimeError):
+                core.eager.recompute(segment, [x], True)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,152 @@
+#   Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+from test_reorder_lod_tensor import convert_to_offset
+from sequence.test_sequence_pool import compute_seqpool_sum, compute_seqpool_avg, compute_seqpool_sqrt
+from test_cvm_op import cvm_compute
+
+
+class TestFusionEmbeddingSeqPoolCVMConcatOp(OpTest):
+    def setUp(self):
+        self.w = 16
+        self.table_h = 100
+        self.use_cvm = True
+        self.share_table = True
+        self.lods = [[[2, 3, 5]], [[1, 5, 2]]]
+        self.set_conf()
+        self.set_pooltype()
+        self.op_type = 'fusion_embedding_seqpool_cvm_concat'
+        self.axis = 1
+        bs = len(self.lods[0][0])
+        ids_list = []
+        tables = []
+        outs = []
+        # The cvm variable is not actually used.
+        cvm = np.array([[0.6, 0.4]]).astype("float32")
+        compute_seqpool = {
+            "SUM": compute_seqpool_sum,
+            "AVERAGE": compute_seqpool_avg,
+            "SQRT": compute_seqpool_sqrt,
+        }[self.pooltype]
+        for i, lod in enumerate(self.lods):
+            assert bs == len(lod[0]), 'All lod size should be equal'
+            if i == 0 or not self.share_table:
+                table = np.random.uniform(
+                    0.1, 1, [self.table_h, self.w]).astype('float32')
+                tables.append(('w_{0}'.format(i), table))
+            ids = np.random.randint(
+                0, self.table_h, [sum(lod[0]), 1]).astype('int64')
+            x = table[ids.flatten()]
+            offset = convert_to_offset(lod)
+            out = np.zeros((bs, self.w)).astype('float32')
+            compute_seqpool(x, offset, out)
+            outs.append(cvm_compute(out, self.w, self.use_cvm))
+            ids_list.append(('ids_{0}'.format(i), (ids, lod)))
+
+        self.inputs = {'Ids': ids_list, 'W': tables, "CVM": cvm}
+        self.outputs = {'Out': np.concatenate(outs, axis=self.axis)}
+        self.attrs = {
+            'pooltype': self.pooltype,
+            'use_cvm': self.use_cvm,
+            'axis': self.axis,
+        }
+
+    def set_pooltype(self):
+        self.pooltype = "SUM"
+
+    def set_conf(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestFusionEmbeddingSeqPoolCVMConcatOpCase1(
+        TestFusionEmbeddingSeqPoolCVMConcatOp):
+    def set_conf(self):
+        self.lods = [[[1]]]
+
+
+class TestFusionEmbeddingSeqPoolCVMConcatOpCase2(
+        TestFusionEmbeddingSeqPoolCVMConcatOp):
+    def set_conf(self):
+        self.lods = [[[2, 13, 4]], [[1, 1, 1]], [[5, 3, 1]], [[9, 10, 3]]]
+        self.w = 11
+        self.share_table = False
+
+
+class TestFusionEmbeddingSeqPoolCVMConcatOpCase3(
+        TestFusionEmbeddingSeqPoolCVMConcatOp):
+    def set_conf(self):
+        self.lods = [[[3, 0, 4]], [[0, 2, 1]]]
+        self.use_cvm = False
+
+
+class TestFusionEmbeddingSeqPoolCVMConcatOpCase4(
+        TestFusionEmbeddingSeqPoolCVMConcatOp):
+    def set_conf(self):
+        self.lods = [[[1, 3, 4, 6]], [[2, 2, 2, 2]]]
+        self.w = 10
+        self.use_cvm = False
+        self.share_table = False
+
+
+class TestFusionEmbeddingSeqPoolCVMConcatOpInvalidId(
+        TestFusionEmbeddingSeqPoolCVMConcatOp):
+    def set_conf(self):
+        self.bad_id = self.table_h
+
+    def test_check_output(self):
+        ids = self.inputs['Ids'][1][1][0]
+        ids[0, 0] = self.bad_id
+        self.assertRaises(ValueError, self.check_output)
+
+
+class TestFusionEmbeddingSeqPoolCVMConcatOpNegativeId(
+        TestFusionEmbeddingSeqPoolCVMConcatOpInvalidId):
+    def set_conf(self):
+        self.bad_id = -1
+
+
+## test avg pool and sqrt
+def create_test_avg_sqrt_class(parent):
+    class TestSeqPoolAvgCase(parent):
+        def set_pooltype(self):
+            self.pooltype = "AVERAGE"
+
+    class TestSeqPoolSqrtCase(parent):
+        def set_pooltype(self):
+            self.pooltype = "SQRT"
+
+    cls_name_avg = "{0}_{1}".format(parent.__name__, "avg")
+    cls_name_sqrt = "{0}_{1}".format(parent.__name__, "sqrt")
+    TestSeqPoolAvgCase.__name__ = cls_name_avg
+    TestSeqPoolSqrtCase.__name__ = cls_name_sqrt
+    globals()[cls_name_avg] = TestSeqPoolAvgCase
+    globals()[cls_name_sqrt] = TestSeqPoolSqrtCase
+
+
+create_test_avg_sqrt_class(TestFusionEmbeddingSeqPoolCVMConcatOp)
+create_test_avg_sqrt_class(TestFusionEmbeddingSeqPoolCVMConcatOpCase1)
+create_test_avg_sqrt_class(TestFusionEmbeddingSeqPoolCVMConcatOpCase2)
+create_test_avg_sqrt_class(TestFusionEmbeddingSeqPoolCVMConcatOpCase3)
+create_test_avg_sqrt_class(TestFusionEmbeddingSeqPoolCVMConcatOpCase4)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -46,8 +46,10 @@ class TestInplace(unittest.TestCase):
         self.func_test_forward_version()
 
     def func_test_backward_error(self):
-        # It raises an error because the inplace operator will result
-        # in incorrect gradient computation.
+        # It raises an error in the legacy dygraph because the inplace operator
+        # will result in incorrect gradient computation. In the eager mode,
+        # var_b saved for the gradient computation is copied before it is
+        # modified, so the gradient is the same as without the inplace operator.
         with paddle.fluid.dygraph.guard():
             var_a = paddle.ones(shape=[4, 2, 3], dtype="float32")
             var_a.stop_gradient = False
@@ -61,11 +63,31 @@ class TestInplace(unittest.TestCase):
             var_d = var_b**2
 
             loss = paddle.nn.functional.relu(var_c + var_d)
-            with self.assertRaisesRegexp(
-                    RuntimeError,
-                    "received tensor_version:{} != wrapper_version_snapshot:{}".
-                    format(1, 0)):
-                loss.backward()
+            if not in_dygraph_mode():
+                with self.assertRaisesRegexp(
+                        RuntimeError,
+                        "received tensor_version:{} != wrapper_version_snapshot:{}".
+                        format(1, 0)):
+                    loss.backward()
+                return
+            loss.backward()
+            grad_var_a_inplace = var_a.grad.numpy()
+
+        with paddle.fluid.dygraph.guard():
+            var_a = paddle.ones(shape=[4, 2, 3], dtype="float32")
+            var_a.stop_gradient = False
+
+            var_b = var_a**2
+            var_c = var_b**2
+            var_b_copy = var_b.clone()
+            var_b_copy[1:2] = 3.3
+            var_d = var_b_copy**2
+
+            loss = paddle.nn.functional.relu(var_c + var_d)
+            loss.backward()
+            grad_var_a = var_a.grad.numpy()
+
+        self.assertTrue(np.array_equal(grad_var_a_inplace, grad_var_a))
 
     def test_backward_error(self):
         with _test_eager_guard():
@@ -182,8 +204,10 @@ class TestDygraphInplace(unittest.TestCase):
         self.func_test_leaf_inplace_var_error()
 
     def func_test_backward_error(self):
-        # It raises an error because the inplace operator will result
-        # in incorrect gradient computation.
+        # It raises an error in the legacy dygraph because the inplace operator
+        # will result in incorrect gradient computation. In the eager mode,
+        # var_b saved for the gradient computation is copied before it is
+        # modified, so the gradient is the same as without the inplace operator.
         with paddle.fluid.dygraph.guard():
             var_a = paddle.to_tensor(self.input_var_numpy).astype(self.dtype)
             var_a.stop_gradient = False
@@ -195,11 +219,28 @@ class TestDygraphInplace(unittest.TestCase):
             self.inplace_api_processing(var_b)
 
             loss = paddle.nn.functional.relu(var_c)
-            with self.assertRaisesRegexp(
-                    RuntimeError,
-                    "received tensor_version:{} != wrapper_version_snapshot:{}".
-                    format(1, 0)):
-                loss.backward()
+            if not in_dygraph_mode():
+                with self.assertRaisesRegexp(
+                        RuntimeError,
+                        "received tensor_version:{} != wrapper_version_snapshot:{}".
+                        format(1, 0)):
+                    loss.backward()
+                return
+            loss.backward()
+            grad_var_a_inplace = var_a.grad.numpy()
+
+        with paddle.fluid.dygraph.guard():
+            var_a = paddle.to_tensor(self.input_var_numpy).astype(self.dtype)
+            var_a.stop_gradient = False
+
+            var_b = var_a**2
+            var_c = var_b**2
+
+            loss = paddle.nn.functional.relu(var_c)
+            loss.backward()
+            grad_var_a = var_a.grad.numpy()
+
+        self.assertTrue(self.np_compare(grad_var_a_inplace, grad_var_a))
 
     def test_backward_error(self):
         with _test_eager_guard():
@@ -29,6 +29,22 @@ class HostPythonNode:
         self.children_node = []
         self.runtime_node = []
         self.device_node = []
+        self.perf_counters = {}
+        self.mem_node = []
+
+
+class MemPythonNode:
+    def __init__(self, timestamp_ns, addr, type, process_id, thread_id,
+                 increase_bytes, place, current_allocated, peak_allocated):
+        self.timestamp_ns = timestamp_ns
+        self.addr = addr
+        self.type = type
+        self.process_id = process_id
+        self.thread_id = thread_id
+        self.increase_bytes = increase_bytes
+        self.place = place
+        self.current_allocated = current_allocated
+        self.peak_allocated = peak_allocated
 
 
 class DevicePythonNode:
@@ -523,6 +539,117 @@ class TestProfilerStatistic(unittest.TestCase):
                     thread_sep=False,
                     time_unit='ms'))
 
+    def test_statistic_perf_counters(self):
+        root_node = HostPythonNode('Root Node',
+                                   profiler.TracerEventType.UserDefined, 0,
+                                   float('inf'), 1000, 1001)
+        profilerstep_node = HostPythonNode('ProfileStep#1',
+                                           profiler.TracerEventType.ProfileStep,
+                                           0, 400, 1000, 1001)
+        matmul_node1 = HostPythonNode(
+            'matmul', profiler.TracerEventType.Operator, 10, 100, 1000, 1001)
+        matmul_node1.perf_counters = {
+            'cycles': 1000,
+            'instructions': 2000,
+            'llc_misses': 10,
+            'branch_misses': 3
+        }
+        matmul_node2 = HostPythonNode(
+            'matmul', profiler.TracerEventType.Operator, 110, 200, 1000, 1001)
+        matmul_node2.perf_counters = {'cycles': 500, 'instructions': 1000}
+        relu_node = HostPythonNode(
+            'relu', profiler.TracerEventType.Operator, 210, 220, 1000, 1001)
+        root_node.children_node.append(profilerstep_node)
+        profilerstep_node.children_node.extend(
+            [matmul_node1, matmul_node2, relu_node])
+        thread_tree = {'thread1001': root_node}
+        extra_info = {
+            'Process Cpu Utilization': '1.02',
+            'System Cpu Utilization': '0.68'
+        }
+        statistic_data = profiler.profiler_statistic.StatisticData(thread_tree,
+                                                                   extra_info)
+        event_summary = statistic_data.event_summary
+        self.assertEqual(event_summary.items['matmul'].perf_counter_call, 2)
+        self.assertEqual(event_summary.items['matmul'].perf_counters['cycles'],
+                         1500)
+        self.assertEqual(
+            event_summary.items['matmul'].perf_counters['instructions'], 3000)
+        self.assertEqual(event_summary.items['relu'].perf_counter_call, 0)
+        table = profiler.profiler_statistic._build_table(
+            statistic_data,
+            sorted_by=profiler.SortedKeys.CPUTotal,
+            op_detail=True,
+            thread_sep=False,
+            time_unit='ms')
+        self.assertIn('Operator Perf Counter Summary', table)
+        print(table)
+
+    def test_statistic_memory(self):
+        Allocate = profiler.profiler_statistic.TracerMemEventType.Allocate
+        Free = profiler.profiler_statistic.TracerMemEventType.Free
+        root_node = HostPythonNode('Root Node',
+                                   profiler.TracerEventType.UserDefined, 0,
+                                   float('inf'), 1000, 1001)
+        profilerstep_node = HostPythonNode('ProfileStep#1',
+                                           profiler.TracerEventType.ProfileStep,
+                                           0, 400, 1000, 1001)
+        matmul_node = HostPythonNode(
+            'matmul', profiler.TracerEventType.Operator, 10, 100, 1000, 1001)
+        matmul_compute = HostPythonNode('matmul::compute',
+                                        profiler.TracerEventType.OperatorInner,
+                                        20, 90, 1000, 1001)
+        relu_node = HostPythonNode(
+            'relu', profiler.TracerEventType.Operator, 110, 200, 1000, 1001)
+        # 100 bytes are allocated before profiling
+        matmul_compute.mem_node.append(
+            MemPythonNode(30, 0x1000, Allocate, 1000, 1001, 400, 'Place(cpu)',
+                          500, 500))
+        matmul_compute.mem_node.append(
+            MemPythonNode(40, 0x2000, Allocate, 1000, 1001, 200, 'Place(cpu)',
+                          700, 700))
+        matmul_node.mem_node.append(
+            MemPythonNode(95, 0x2000, Free, 1000, 1001, -200, 'Place(cpu)',
+                          500, 700))
+        relu_node.mem_node.append(
+            MemPythonNode(120, 0x3000, Allocate, 1000, 1001, 100, 'Place(cpu)',
+                          600, 700))
+        relu_node.mem_node.append(
+            MemPythonNode(130, 0x1000, Free, 1000, 1001, -400, 'Place(cpu)',
+                          200, 700))
+        root_node.children_node.append(profilerstep_node)
+        profilerstep_node.children_node.extend([matmul_node, relu_node])
+        matmul_node.children_node.append(matmul_compute)
+        thread_tree = {'thread1001': root_node}
+        extra_info = {
+            'Process Cpu Utilization': '1.02',
+            'System Cpu Utilization': '0.68'
+        }
+        statistic_data = profiler.profiler_statistic.StatisticData(thread_tree,
+                                                                   extra_info)
+        memory_summary = statistic_data.memory_summary
+        self.assertEqual(memory_summary.peak_allocated['Place(cpu)'], 700)
+        self.assertEqual(memory_summary.peak_untracked_bytes['Place(cpu)'],
+                         100)
+        matmul_item = memory_summary.items['Place(cpu)']['matmul']
+        self.assertEqual(matmul_item.allocation_count, 2)
+        self.assertEqual(matmul_item.free_count, 1)
+        self.assertEqual(matmul_item.allocated_bytes, 600)
+        self.assertEqual(matmul_item.peak_holding_bytes, 600)
+        self.assertEqual(matmul_item.unfreed_bytes, 0)
+        relu_item = memory_summary.items['Place(cpu)']['relu']
+        self.assertEqual(relu_item.freed_bytes, 400)
+        self.assertEqual(relu_item.peak_holding_bytes, 0)
+        self.assertEqual(relu_item.unfreed_bytes, 100)
+        table = profiler.profiler_statistic._build_table(
+            statistic_data,
+            sorted_by=profiler.SortedKeys.CPUTotal,
+            op_detail=True,
+            thread_sep=False,
+            time_unit='ms')
+        self.assertIn('Memory Summary', table)
+        print(table)
+
 
 if __name__ == '__main__':
     unittest.main()
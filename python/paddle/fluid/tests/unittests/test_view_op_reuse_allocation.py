@@ -77,8 +77,11 @@ class TestDygraphViewReuseAllocation(unittest.TestCase):
         self.func_test_forward_version()
 
     def func_test_backward_error(self):
-        # It raises an error because the inplace operator will result
-        # in incorrect gradient computation.
+        # It raises an error in the legacy dygraph because the inplace operator
+        # will result in incorrect gradient computation. In the eager mode,
+        # var_b saved for the gradient computation is copied before its view
+        # is modified, so the gradient is the same as without the inplace
+        # operator.
         with paddle.fluid.dygraph.guard():
             var_a = paddle.ones(shape=self.input_shape, dtype="float32")
             var_a.stop_gradient = False
@@ -91,11 +94,28 @@ class TestDygraphViewReuseAllocation(unittest.TestCase):
             view_var_b[0] = 2.  # var_b is modified inplace
 
             loss = paddle.nn.functional.relu(var_c)
-            with self.assertRaisesRegexp(
-                    RuntimeError,
-                    "received tensor_version:{} != wrapper_version_snapshot:{}".
-                    format(1, 0)):
-                loss.backward()
+            if not in_dygraph_mode():
+                with self.assertRaisesRegexp(
+                        RuntimeError,
+                        "received tensor_version:{} != wrapper_version_snapshot:{}".
+                        format(1, 0)):
+                    loss.backward()
+                return
+            loss.backward()
+            grad_var_a_inplace = var_a.grad.numpy()
+
+        with paddle.fluid.dygraph.guard():
+            var_a = paddle.ones(shape=self.input_shape, dtype="float32")
+            var_a.stop_gradient = False
+
+            var_b = var_a**2
+            var_c = var_b**2
+
+            loss = paddle.nn.functional.relu(var_c)
+            loss.backward()
+            grad_var_a = var_a.grad.numpy()
+
+        self.assertTrue(np.array_equal(grad_var_a_inplace, grad_var_a))
 
     def test_backward_error(self):
         with _test_eager_guard():
@@ -62,10 +62,13 @@ class ProfilerTarget(Enum):
     - **ProfilerTarget.GPU** : Profile events on GPU.
 
     - **ProfilerTarget.MLU** : Profile events on MLU.
+
+    - **ProfilerTarget.CPU_PERF_COUNTER** : Read hardware performance counters (cycles, instructions, llc misses, branch misses) around each CPU event. Only available on Linux, and never chosen by default.
     """
     CPU = 0
     GPU = 1
     MLU = 2
+    CPU_PERF_COUNTER = 3
 
 
 def make_scheduler(*,
@@ -260,11 +263,14 @@ def _get_supported_targets() -> Iterable[ProfilerTarget]:
     r"""
     Get the current supported profiler target in the system.
     """
+    targets = [ProfilerTarget.CPU]
     if _Profiler.is_cupti_supported():
-        return [ProfilerTarget.CPU, ProfilerTarget.GPU]
-    if _Profiler.is_cnpapi_supported():
-        return [ProfilerTarget.CPU, ProfilerTarget.MLU]
-    return [ProfilerTarget.CPU]
+        targets.append(ProfilerTarget.GPU)
+    elif _Profiler.is_cnpapi_supported():
+        targets.append(ProfilerTarget.MLU)
+    if _Profiler.is_perf_counter_supported():
+        targets.append(ProfilerTarget.CPU_PERF_COUNTER)
+    return targets
 
 
 class Profiler:
@@ -280,6 +286,9 @@ class Profiler:
             This callable object will be called when ``scheduler`` returns ``ProfilerState.RECORD_AND_RETURN``. The default value is :ref:`export_chrome_tracing <api_paddle_profiler_export_chrome_tracing>` (./profiler_log/).
         timer_only (bool, optional): If it is True, the cost of Dataloader and every step of the model will be count without profiling. Otherwise, the model will
             be timed and profiled. Default: False.
+        profile_memory (bool, optional): If it is True, allocation and free events of CPU and GPU memory are recorded, shown as a memory timeline in the
+            exported chrome tracing file and summarized by the operators which hold memory at peak. The CPU events are only recorded when the
+            environment variable FLAGS_enable_host_memory_stats is set to True before Paddle allocates any memory. Default: False.
 
     Examples:
         1. profiling range [2, 5).
@@ -397,7 +406,8 @@ class Profiler:
             targets: Optional[Iterable[ProfilerTarget]]=None,
             scheduler: Union[Callable[[int], ProfilerState], tuple, None]=None,
             on_trace_ready: Optional[Callable[..., Any]]=None,
-            timer_only: Optional[bool]=False):
+            timer_only: Optional[bool]=False,
+            profile_memory: Optional[bool]=False):
         supported_targets = _get_supported_targets()
         if targets:
             self.targets = set(targets)
@@ -407,7 +417,12 @@ class Profiler:
                     warn("Profiling {} is not supported in current context.".
                          format(target))
         else:
-            self.targets = supported_targets
+            # hardware counters add overhead to every event, so they are
+            # only read when requested explicitly
+            self.targets = [
+                target for target in supported_targets
+                if target != ProfilerTarget.CPU_PERF_COUNTER
+            ]
         profileoption = ProfilerOptions()
         if ProfilerTarget.CPU in self.targets:
             profileoption.trace_switch |= 1
@@ -415,6 +430,9 @@ class Profiler:
             profileoption.trace_switch |= (1 << 1)
         if ProfilerTarget.MLU in self.targets:
             profileoption.trace_switch |= (1 << 2)
+        if ProfilerTarget.CPU_PERF_COUNTER in self.targets:
+            profileoption.trace_switch |= (1 << 3)
+        profileoption.trace_memory = profile_memory
         wrap_optimizers()
         self.profiler = _Profiler.create(profileoption)
         if callable(scheduler):
@@ -821,5 +839,13 @@ def get_profiler(config_path):
         else:
             print(
                 'Set timer_only parameter error, use default parameter instead.')
+    if "profile_memory" in config_dict:
+        if isinstance(config_dict['profile_memory'], bool):
+            translated_config_dict['profile_memory'] = config_dict[
+                'profile_memory']
+        else:
+            print(
+                'Set profile_memory parameter error, use default parameter instead.'
+            )
 
     return Profiler(**translated_config_dict)
@@ -15,7 +15,7 @@ import collections
 from enum import Enum
 import re
 
-from paddle.fluid.core import TracerEventType
+from paddle.fluid.core import TracerEventType, TracerMemEventType
 
 from .statistic_helper import *
 
@@ -374,6 +374,8 @@ class EventSummary:
             self.general_gpu_time = 0
             self.min_general_gpu_time = float('inf')
             self.max_general_gpu_time = 0
+            self.perf_counter_call = 0  # calls which carry hardware counters
+            self.perf_counters = collections.defaultdict(int)
 
         @property
         def avg_cpu_time(self):
@@ -408,6 +410,13 @@ class EventSummary:
                 self.min_general_gpu_time = time
             self.general_gpu_time += time
 
+        def add_perf_counters(self, perf_counters):
+            if not perf_counters:
+                return
+            self.perf_counter_call += 1
+            for name, value in perf_counters.items():
+                self.perf_counters[name] += value
+
         def add_call(self):
             self.call += 1
 
@@ -416,6 +425,7 @@ class EventSummary:
             self.add_cpu_time(node.cpu_time)
             self.add_gpu_time(node.gpu_time)
             self.add_general_gpu_time(node.general_gpu_time)
+            self.add_perf_counters(getattr(node, "perf_counters", None))
             for child in node.children_node:
                 if child.name not in self.operator_inners:
                     self.operator_inners[
@@ -598,6 +608,87 @@ class EventSummary:
                 self.kernel_items[name].add_item(device_node)
 
 
+class MemorySummary:
+    r"""
+    Analysis memory events, attribute the peak memory of each place to the
+    operators which allocated the memory still alive at the peak.
+    """
+
+    class MemoryItem:
+        def __init__(self, name):
+            self.name = name
+            self.allocation_count = 0
+            self.free_count = 0
+            self.allocated_bytes = 0
+            self.freed_bytes = 0
+            self.peak_holding_bytes = 0  # allocated by it and alive at peak
+            self.unfreed_bytes = 0  # allocated by it and alive at the end
+
+    def __init__(self):
+        self.items = collections.defaultdict(dict)  # place -> {name: item}
+        self.peak_allocated = {}  # place -> peak allocated bytes
+        # place -> bytes alive at peak but allocated before profiling
+        self.peak_untracked_bytes = {}
+
+    def parse(self, nodetrees):
+        r"""
+        Replay memory events of each place in time order.
+        """
+        place2mem_events = collections.defaultdict(list)
+        for threadid, rootnode in nodetrees.items():
+            # (node, name of the nearest operator, name of the innermost node)
+            stack = [(rootnode, None, None)]
+            while stack:
+                node, operator_name, innermost_name = stack.pop()
+                if node is not rootnode:
+                    innermost_name = node.name
+                    if node.type == TracerEventType.Operator:
+                        operator_name = node.name
+                owner = operator_name or innermost_name or 'Others'
+                for mem_node in getattr(node, 'mem_node', []):
+                    place2mem_events[mem_node.place].append((mem_node, owner))
+                for child in node.children_node:
+                    stack.append((child, operator_name, innermost_name))
+
+        for place, mem_events in place2mem_events.items():
+            mem_events.sort(key=lambda x: x[0].timestamp_ns)
+            items = self.items[place]
+            live = {}  # addr -> (bytes, owner)
+            peak_allocated = -1
+            peak_index = -1
+            for index, (mem_node, owner) in enumerate(mem_events):
+                if owner not in items:
+                    items[owner] = MemorySummary.MemoryItem(owner)
+                if mem_node.type == TracerMemEventType.Allocate:
+                    items[owner].allocation_count += 1
+                    items[owner].allocated_bytes += mem_node.increase_bytes
+                    live[mem_node.addr] = (mem_node.increase_bytes, owner)
+                else:
+                    items[owner].free_count += 1
+                    items[owner].freed_bytes -= mem_node.increase_bytes
+                    live.pop(mem_node.addr, None)
+                if mem_node.current_allocated > peak_allocated:
+                    peak_allocated = mem_node.current_allocated
+                    peak_index = index
+            # replay the events once more to the peak, instead of copying the
+            # live set at every new peak
+            peak_live = {}
+            for mem_node, owner in mem_events[:peak_index + 1]:
+                if mem_node.type == TracerMemEventType.Allocate:
+                    peak_live[mem_node.addr] = (mem_node.increase_bytes, owner)
+                else:
+                    peak_live.pop(mem_node.addr, None)
+            tracked_bytes = 0
+            for size, owner in peak_live.values():
+                items[owner].peak_holding_bytes += size
+                tracked_bytes += size
+            for size, owner in live.values():
+                items[owner].unfreed_bytes += size
+            self.peak_allocated[place] = peak_allocated
+            self.peak_untracked_bytes[place] = max(
+                peak_allocated - tracked_bytes, 0)
+
+
 class StatisticData:
     r"""
     Hold all analysed results.
@@ -609,9 +700,11 @@ class StatisticData:
         self.time_range_summary = TimeRangeSummary()
         self.event_summary = EventSummary()
         self.distributed_summary = DistributedSummary()
+        self.memory_summary = MemorySummary()
         self.time_range_summary.parse(node_trees)
         self.event_summary.parse(node_trees)
         self.distributed_summary.parse(node_trees)
+        self.memory_summary.parse(node_trees)
 
 
 def _build_table(statistic_data,
@@ -1244,6 +1337,70 @@ def _build_table(statistic_data,
         append('')
         append('')
 
+    ###### Print Operator Perf Counter Summary Report ######
+    perf_counter_items = [
+        (name, item)
+        for name, item in statistic_data.event_summary.items.items()
+        if item.perf_counter_call > 0
+    ]
+    if perf_counter_items:
+        all_row_values = []
+        sorted_items = sorted(
+            perf_counter_items,
+            key=lambda x: x[1].perf_counters['cycles'],
+            reverse=True)
+        for name, item in sorted_items[:row_limit]:
+            counters = item.perf_counters
+            instructions = counters.get('instructions', 0)
+            if instructions == 0 or 'cycles' not in counters:
+                ipc = '-'
+            else:
+                ipc = '{:.2f}'.format(
+                    float(instructions) / max(counters['cycles'], 1))
+            if instructions == 0 or 'llc_misses' not in counters:
+                llc_mpki = '-'
+            else:
+                llc_mpki = '{:.2f}'.format(
+                    counters['llc_misses'] * 1000.0 / instructions)
+            row_values = [
+                name, item.perf_counter_call, counters.get('cycles', '-'),
+                counters.get('instructions', '-'), ipc,
+                counters.get('llc_misses', '-'), llc_mpki,
+                counters.get('branch_misses', '-')
+            ]
+            all_row_values.append(row_values)
+
+        headers = [
+            'Name', 'Calls', 'Cycles', 'Instructions', 'IPC', 'LLC Misses',
+            'LLC MPKI', 'Branch Misses'
+        ]
+        name_column_width = 52
+        DEFAULT_COLUMN_WIDTH = 16
+        row_format_list = [""]
+        header_sep_list = [""]
+        line_length_list = [-SPACING_SIZE]
+        add_column(name_column_width)
+        add_column(6)
+        for _ in headers[2:]:
+            add_column(DEFAULT_COLUMN_WIDTH)
+
+        row_format = row_format_list[0]
+        header_sep = header_sep_list[0]
+        line_length = line_length_list[0]
+
+        # construct table string
+        append(add_title(line_length, "Operator Perf Counter Summary"))
+        append(header_sep)
+        append(row_format.format(*headers))
+        append(header_sep)
+        for row_values in all_row_values:
+            if len(row_values[0]) > name_column_width:
+                row_values[0] = row_values[0][:name_column_width - 3] + '...'
+            append(row_format.format(*row_values))
+        append(header_sep)
+        append('')
+        append('')
+
     ###### Print Kernel Summary Report ######
     if statistic_data.event_summary.kernel_items:
         all_row_values = []
@@ -1543,4 +1700,67 @@ def _build_table(statistic_data,
         append('')
         append('')
 
+    ###### Print Memory Summary Report ######
+    if statistic_data.memory_summary.items:
+        all_row_values = []
+        memory_summary = statistic_data.memory_summary
+
+        def format_bytes(num_bytes):
+            return '{:.2f}'.format(num_bytes / 1024.0 / 1024.0)
+
+        for place, items in memory_summary.items.items():
+            all_row_values.append(
+                'Place: {}, Peak Allocated: {} MB, Allocated Before Profiling At Peak: {} MB'.
+                format(place,
+                       format_bytes(memory_summary.peak_allocated[place]),
+                       format_bytes(memory_summary.peak_untracked_bytes[
+                           place])))
+            sorted_items = sorted(
+                items.values(),
+                key=lambda x: (x.peak_holding_bytes, x.allocated_bytes),
+                reverse=True)
+            for item in sorted_items[:row_limit]:
+                all_row_values.append([
+                    item.name, item.allocation_count, item.free_count,
+                    format_bytes(item.allocated_bytes),
+                    format_bytes(item.freed_bytes),
+                    format_bytes(item.peak_holding_bytes),
+                    format_bytes(item.unfreed_bytes)
+                ])
+
+        headers = [
+            'Name', 'Allocations', 'Frees', 'Allocated', 'Freed',
+            'Held At Peak', 'Unfreed'
+        ]
+        name_column_width = 52
+        DEFAULT_COLUMN_WIDTH = 14
+        row_format_list = [""]
+        header_sep_list = [""]
+        line_length_list = [-SPACING_SIZE]
+        add_column(name_column_width)
+        for _ in headers[1:]:
+            add_column(DEFAULT_COLUMN_WIDTH)
+
+        row_format = row_format_list[0]
+        header_sep = header_sep_list[0]
+        line_length = line_length_list[0]
+
+        # construct table string
+        append(add_title(line_length, "Memory Summary"))
+        append('Memory unit: MB')
+        append(header_sep)
+        append(row_format.format(*headers))
+        append(header_sep)
+        for row_values in all_row_values:
+            if isinstance(row_values, str):
+                append(add_title(line_length, row_values))
+            else:
+                if len(row_values[0]) > name_column_width:
+                    row_values[0] = row_values[0][:name_column_width -
+                                                  3] + '...'
+                append(row_format.format(*row_values))
+        append(header_sep)
+        append('')
+        append('')
+
     return ''.join(result)